@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+import argparse
+import json
+import sys
+
+# Compares two google-benchmark json outputs (--benchmark_out_format=json),
+# exit code 1 if some benchmark became slower than threshold
+
+TIME_UNITS_NS = {'ns': 1.0, 'us': 1000.0, 'ms': 1000000.0, 's': 1000000000.0}
+
+
+def load_times(path: str) -> dict:  # name: cpu time ns, median of repetitions if any
+    with open(path) as file:
+        data = json.load(file)
+
+    iterations = {}
+    medians = {}
+    for bench in data.get('benchmarks', []):
+        if bench.get('error_occurred'):
+            continue
+
+        name = bench.get('run_name', bench['name'])
+        cpu_time = bench['cpu_time'] * TIME_UNITS_NS[bench.get('time_unit', 'ns')]
+        if bench.get('run_type') == 'aggregate':
+            if bench.get('aggregate_name') == 'median':
+                medians[name] = cpu_time
+        else:
+            iterations.setdefault(name, []).append(cpu_time)
+
+    result = {name: sorted(times)[len(times) // 2] for name, times in iterations.items()}
+    result.update(medians)
+    return result
+
+
+def format_ns(value: float) -> str:
+    for unit in ('s', 'ms', 'us'):
+        if value >= TIME_UNITS_NS[unit]:
+            return '{0:.2f} {1}'.format(value / TIME_UNITS_NS[unit], unit)
+    return '{0:.1f} ns'.format(value)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='Compare benchmarks results with baseline.')
+    parser.add_argument('baseline', help='json of previous run')
+    parser.add_argument('current', help='json of current run')
+    parser.add_argument('--threshold', type=float, default=10.0, help='allowed slowdown, percents')
+    args = parser.parse_args()
+
+    baseline = load_times(args.baseline)
+    current = load_times(args.current)
+
+    regressions = []
+    print('{0:<56} {1:>12} {2:>12} {3:>9}'.format('benchmark', 'baseline', 'current', 'change'))
+    for name in sorted(current):
+        if name not in baseline:
+            print('{0:<56} {1:>12} {2:>12} {3:>9}'.format(name, '-', format_ns(current[name]), 'new'))
+            continue
+
+        change = (current[name] - baseline[name]) * 100.0 / baseline[name] if baseline[name] else 0.0
+        mark = ''
+        if change > args.threshold:
+            regressions.append(name)
+            mark = ' REGRESSION'
+        print('{0:<56} {1:>12} {2:>12} {3:>+8.1f}%{4}'.format(name, format_ns(baseline[name]),
+                                                              format_ns(current[name]), change, mark))
+
+    for name in sorted(set(baseline) - set(current)):
+        print('{0:<56} {1:>12} {2:>12} {3:>9}'.format(name, format_ns(baseline[name]), '-', 'missing'))
+
+    if regressions:
+        print('\n{0} benchmarks slower than {1}%: {2}'.format(len(regressions), args.threshold,
+                                                              ', '.join(regressions)))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -57,69 +57,17 @@ bool ChannelInfo::IsEnableVideo() const {
   return enable_video_;
 }
 
-common::Error ChannelInfo::SerializeImpl(serialize_type* deserialized) const {
-  if (!IsValid()) {
-    return common::make_error_inval();
-  }
-
-  json_object* obj = json_object_new_object();
-  json_object* jepg = NULL;
-  common::Error err = epg_.Serialize(&jepg);
-  if (err) {
-    return err;
-  }
-
-  json_object_object_add(obj, CHANNEL_INFO_EPG_FIELD, jepg);
-  json_object_object_add(obj, CHANNEL_INFO_AUDIO_ENABLE_FIELD, json_object_new_boolean(enable_audio_));
-  json_object_object_add(obj, CHANNEL_INFO_VIDEO_ENABLE_FIELD, json_object_new_boolean(enable_video_));
-  *deserialized = obj;
-  return common::Error();
+bool ChannelInfo::Equals(const ChannelInfo& url) const {
+  return epg_ == url.epg_ && enable_audio_ == url.enable_audio_ && enable_video_ == url.enable_video_;
 }
 
-common::Error ChannelInfo::DeSerialize(const serialize_type& serialized, value_type* obj) {
-  if (!serialized || !obj) {
-    return common::make_error_inval();
-  }
-
-  json_object* jepg = NULL;
-  json_bool jepg_exists = json_object_object_get_ex(serialized, CHANNEL_INFO_EPG_FIELD, &jepg);
-  if (!jepg_exists) {
-    return common::make_error_inval();
-  }
-
-  EpgInfo epg;
-  common::Error err = EpgInfo::DeSerialize(jepg, &epg);
-  if (err) {
-    return err;
-  }
-
-  bool enable_audio = true;
-  json_object* jenable_audio = NULL;
-  json_bool jenable_audio_exists =
-      json_object_object_get_ex(serialized, CHANNEL_INFO_AUDIO_ENABLE_FIELD, &jenable_audio);
-  if (jenable_audio_exists) {
-    enable_audio = json_object_get_boolean(jenable_audio);
-  }
-
-  bool enable_video = true;
-  json_object* jdisable_video = NULL;
-  json_bool jdisable_video_exists =
-      json_object_object_get_ex(serialized, CHANNEL_INFO_VIDEO_ENABLE_FIELD, &jdisable_video);
-  if (jdisable_video_exists) {
-    enable_video = json_object_get_boolean(jdisable_video);
-  }
-
-  fastotv::ChannelInfo url(epg, enable_audio, enable_video);
-  if (!url.IsValid()) {
-    return common::make_error_inval();
-  }
-
-  *obj = url;
-  return common::Error();
+template <typename Self, typename Visitor>
+void ChannelInfo::Fields(Self* self, Visitor* visitor) {
+  visitor->Field(CHANNEL_INFO_EPG_FIELD, &self->epg_, serializer::FIELD_REQUIRED);
+  visitor->Field(CHANNEL_INFO_AUDIO_ENABLE_FIELD, &self->enable_audio_, serializer::FIELD_OPTIONAL);
+  visitor->Field(CHANNEL_INFO_VIDEO_ENABLE_FIELD, &self->enable_video_, serializer::FIELD_OPTIONAL);
 }
 
-bool ChannelInfo::Equals(const ChannelInfo& url) const {
-  return epg_ == url.epg_ && enable_audio_ == url.enable_audio_ && enable_video_ == url.enable_video_;
-}
+SERIALIZER_FIELDS_INSTANTIATE(ChannelInfo);
 
 }  // namespace fastotv
@@ -21,11 +21,11 @@
 #include <common/uri/url.h>  // for Uri
 
 #include "epg_info.h"
-#include "serializer/json_serializer.h"
+#include "serializer/fields_serializer.h"
 
 namespace fastotv {
 
-class ChannelInfo : public JsonSerializer<ChannelInfo> {
+class ChannelInfo : public FieldsSerializer<ChannelInfo> {
  public:
   ChannelInfo();
   ChannelInfo(const EpgInfo& epg, bool enable_audio, bool enable_video);
@@ -39,14 +39,13 @@ class ChannelInfo : public JsonSerializer<ChannelInfo> {
   bool IsEnableAudio() const;
   bool IsEnableVideo() const;
 
-  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
-
   bool Equals(const ChannelInfo& url) const;
 
- protected:
-  common::Error SerializeImpl(serialize_type* deserialized) const override;
-
  private:
+  friend struct serializer::FieldsAccess;
+  template <typename Self, typename Visitor>
+  static void Fields(Self* self, Visitor* visitor);
+
   EpgInfo epg_;
 
   bool enable_audio_;
@@ -0,0 +1,156 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "channels_delta.h"
+
+#include <string>         // for string
+#include <unordered_map>  // for unordered_map
+
+#define CHANNELS_DELTA_ORDER_FIELD "order"
+#define CHANNELS_DELTA_UPDATED_FIELD "updated"
+
+namespace fastotv {
+namespace {
+
+// ChannelInfo::Equals not compares epg programs and icon
+bool IsSameChannel(const ChannelInfo& left, const ChannelInfo& right) {
+  if (!(left == right)) {
+    return false;
+  }
+
+  const EpgInfo lepg = left.GetEpg();
+  const EpgInfo repg = right.GetEpg();
+  return lepg.GetIconUrl() == repg.GetIconUrl() && lepg.GetPrograms() == repg.GetPrograms();
+}
+
+}  // namespace
+
+ChannelsDelta::ChannelsDelta() : order_(), updated_() {}
+
+ChannelsDelta::ChannelsDelta(const ChannelsInfo& from, const ChannelsInfo& to) : order_(), updated_() {
+  std::unordered_map<stream_id, ChannelInfo> prev;
+  for (const ChannelInfo& channel : from.GetChannels()) {
+    prev[channel.GetId()] = channel;
+  }
+
+  for (const ChannelInfo& channel : to.GetChannels()) {
+    const stream_id sid = channel.GetId();
+    order_.push_back(sid);
+    auto it = prev.find(sid);
+    if (it == prev.end() || !IsSameChannel(it->second, channel)) {
+      updated_.push_back(channel);
+    }
+  }
+}
+
+ChannelsDelta::ids_t ChannelsDelta::GetOrder() const {
+  return order_;
+}
+
+ChannelsInfo::channels_t ChannelsDelta::GetUpdated() const {
+  return updated_;
+}
+
+bool ChannelsDelta::IsValid() const {
+  for (const ChannelInfo& channel : updated_) {
+    if (!channel.IsValid()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+common::Error ChannelsDelta::Apply(const ChannelsInfo& from, ChannelsInfo* to) const {
+  if (!to) {
+    return common::make_error_inval();
+  }
+
+  std::unordered_map<stream_id, ChannelInfo> channels;
+  for (const ChannelInfo& channel : from.GetChannels()) {
+    channels[channel.GetId()] = channel;
+  }
+  for (const ChannelInfo& channel : updated_) {
+    channels[channel.GetId()] = channel;
+  }
+
+  ChannelsInfo result;
+  for (const stream_id& sid : order_) {
+    auto it = channels.find(sid);
+    if (it == channels.end()) {
+      return common::make_error("Channels delta not matched with cached channels, unknown channel: " + sid);
+    }
+    result.AddChannel(it->second);
+  }
+
+  *to = result;
+  return common::Error();
+}
+
+bool ChannelsDelta::Equals(const ChannelsDelta& delta) const {
+  return order_ == delta.order_ && updated_ == delta.updated_;
+}
+
+common::Error ChannelsDelta::DeSerialize(const serialize_type& serialized, value_type* obj) {
+  if (!serialized || !obj) {
+    return common::make_error_inval();
+  }
+
+  json_object* jorder = NULL;
+  json_bool jorder_exists = json_object_object_get_ex(serialized, CHANNELS_DELTA_ORDER_FIELD, &jorder);
+  if (!jorder_exists) {
+    return common::make_error_inval();
+  }
+
+  json_object* jupdated = NULL;
+  json_bool jupdated_exists = json_object_object_get_ex(serialized, CHANNELS_DELTA_UPDATED_FIELD, &jupdated);
+  if (!jupdated_exists) {
+    return common::make_error_inval();
+  }
+
+  ChannelsDelta delta;
+  size_t len = json_object_array_length(jorder);
+  for (size_t i = 0; i < len; ++i) {
+    json_object* jsid = json_object_array_get_idx(jorder, i);
+    delta.order_.push_back(json_object_get_string(jsid));
+  }
+
+  len = json_object_array_length(jupdated);
+  for (size_t i = 0; i < len; ++i) {
+    json_object* jchannel = json_object_array_get_idx(jupdated, i);
+    ChannelInfo channel;
+    common::Error err = ChannelInfo::DeSerialize(jchannel, &channel);
+    if (err) {  // channel can't be skipped, order references it
+      return err;
+    }
+    delta.updated_.push_back(channel);
+  }
+
+  *obj = delta;
+  return common::Error();
+}
+
+template <typename Self, typename Visitor>
+void ChannelsDelta::Fields(Self* self, Visitor* visitor) {
+  visitor->Field(CHANNELS_DELTA_ORDER_FIELD, &self->order_, serializer::FIELD_REQUIRED);
+  visitor->Field(CHANNELS_DELTA_UPDATED_FIELD, &self->updated_, serializer::FIELD_REQUIRED);
+}
+
+SERIALIZER_FIELDS_INSTANTIATE(ChannelsDelta);
+
+}  // namespace fastotv
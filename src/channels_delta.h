@@ -0,0 +1,68 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <vector>  // for vector
+
+#include "channels_info.h"
+#include "client_server_types.h"
+
+#include "serializer/fields_serializer.h"
+
+namespace fastotv {
+
+// difference between two versions of channels list, channels identified by stream id
+class ChannelsDelta : public FieldsSerializer<ChannelsDelta> {
+ public:
+  typedef std::vector<stream_id> ids_t;
+
+  ChannelsDelta();
+  ChannelsDelta(const ChannelsInfo& from, const ChannelsInfo& to);
+
+  ids_t GetOrder() const;
+  ChannelsInfo::channels_t GetUpdated() const;
+
+  bool IsValid() const;  // updated channels can't be skipped, order references them
+
+  // to = from + delta
+  common::Error Apply(const ChannelsInfo& from, ChannelsInfo* to) const WARN_UNUSED_RESULT;
+
+  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;  // strict
+
+  bool Equals(const ChannelsDelta& delta) const;
+
+ private:
+  friend struct serializer::FieldsAccess;
+  template <typename Self, typename Visitor>
+  static void Fields(Self* self, Visitor* visitor);
+
+  ids_t order_;                       // all channels of new version, removed not listed
+  ChannelsInfo::channels_t updated_;  // added and changed channels
+};
+
+inline bool operator==(const ChannelsDelta& lhs, const ChannelsDelta& rhs) {
+  return lhs.Equals(rhs);
+}
+
+inline bool operator!=(const ChannelsDelta& x, const ChannelsDelta& y) {
+  return !(x == y);
+}
+
+}  // namespace fastotv
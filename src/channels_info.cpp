@@ -24,6 +24,10 @@ namespace fastotv {
 
 ChannelsInfo::ChannelsInfo() : channels_() {}
 
+bool ChannelsInfo::IsValid() const {
+  return true;
+}
+
 void ChannelsInfo::AddChannel(const ChannelInfo& channel) {
   channels_.push_back(channel);
 }
@@ -44,40 +48,11 @@ bool ChannelsInfo::Equals(const ChannelsInfo& chan) const {
   return channels_ == chan.channels_;
 }
 
-common::Error ChannelsInfo::SerializeImpl(serialize_type* deserialized) const {
-  json_object* jchannels = json_object_new_array();
-  for (ChannelInfo url : channels_) {
-    json_object* jurl = NULL;
-    common::Error err = url.Serialize(&jurl);
-    if (err) {
-      continue;
-    }
-    json_object_array_add(jchannels, jurl);
-  }
-
-  *deserialized = jchannels;
-  return common::Error();
+template <typename Self, typename Visitor>
+void ChannelsInfo::Fields(Self* self, Visitor* visitor) {
+  visitor->Field(NULL, &self->channels_, serializer::FIELD_REQUIRED);
 }
 
-common::Error ChannelsInfo::DeSerialize(const serialize_type& serialized, value_type* obj) {
-  if (!serialized || !obj) {
-    return common::make_error_inval();
-  }
-
-  channels_t chan;
-  size_t len = json_object_array_length(serialized);
-  for (size_t i = 0; i < len; ++i) {
-    json_object* jurl = json_object_array_get_idx(serialized, i);
-    ChannelInfo url;
-    common::Error err = ChannelInfo::DeSerialize(jurl, &url);
-    if (err) {
-      continue;
-    }
-    chan.push_back(url);
-  }
-
-  (*obj).channels_ = chan;
-  return common::Error();
-}
+SERIALIZER_FIELDS_INSTANTIATE(ChannelsInfo);
 
 }  // namespace fastotv
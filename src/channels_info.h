@@ -20,16 +20,16 @@
 
 #include "channel_info.h"
 
-#include "serializer/json_serializer.h"
+#include "serializer/fields_serializer.h"
 
 namespace fastotv {
 
-class ChannelsInfo : public JsonSerializer<ChannelsInfo> {
+class ChannelsInfo : public FieldsSerializer<ChannelsInfo> {
  public:
   typedef std::vector<ChannelInfo> channels_t;
   ChannelsInfo();
 
-  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
+  bool IsValid() const;  // always, invalid channels not serialized
 
   void AddChannel(const ChannelInfo& channel);
   channels_t GetChannels() const;
@@ -39,10 +39,11 @@ class ChannelsInfo : public JsonSerializer<ChannelsInfo> {
 
   bool Equals(const ChannelsInfo& chan) const;
 
- protected:
-  virtual common::Error SerializeImpl(serialize_type* deserialized) const override;
-
  private:
+  friend struct serializer::FieldsAccess;
+  template <typename Self, typename Visitor>
+  static void Fields(Self* self, Visitor* visitor);  // json array of channels
+
   channels_t channels_;
 };
 
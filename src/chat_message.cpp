@@ -70,69 +70,6 @@ ChatMessage::Type ChatMessage::GetType() const {
   return type_;
 }
 
-common::Error ChatMessage::SerializeImpl(serialize_type* deserialized) const {
-  if (!IsValid()) {
-    return common::make_error_inval();
-  }
-
-  json_object* obj = json_object_new_object();
-  json_object_object_add(obj, CHAT_MESSAGE_CHANNEL_ID_FIELD, json_object_new_string(channel_id_.c_str()));
-  json_object_object_add(obj, CHAT_MESSAGE_LOGIN_FIELD, json_object_new_string(login_.c_str()));
-  json_object_object_add(obj, CHAT_MESSAGE_MESSAGE_FIELD, json_object_new_string(message_.c_str()));
-  json_object_object_add(obj, CHAT_MESSAGE_TYPE_FIELD, json_object_new_int(type_));
-  *deserialized = obj;
-  return common::Error();
-}
-
-common::Error ChatMessage::DeSerialize(const serialize_type& serialized, value_type* obj) {
-  if (!serialized || !obj) {
-    return common::make_error_inval();
-  }
-
-  ChatMessage msg;
-  json_object* jchan = NULL;
-  json_bool jchan_exists = json_object_object_get_ex(serialized, CHAT_MESSAGE_CHANNEL_ID_FIELD, &jchan);
-  if (!jchan_exists) {
-    return common::make_error_inval();
-  }
-  const stream_id chan = json_object_get_string(jchan);
-  if (chan == invalid_stream_id) {
-    return common::make_error_inval();
-  }
-  msg.channel_id_ = chan;
-
-  json_object* jlogin = NULL;
-  json_bool jlogin_exists = json_object_object_get_ex(serialized, CHAT_MESSAGE_LOGIN_FIELD, &jlogin);
-  if (!jlogin_exists) {
-    return common::make_error_inval();
-  }
-  const std::string login = json_object_get_string(jlogin);
-  if (login.empty()) {
-    return common::make_error_inval();
-  }
-  msg.login_ = login;
-
-  json_object* jmessage = NULL;
-  json_bool jmessage_exists = json_object_object_get_ex(serialized, CHAT_MESSAGE_MESSAGE_FIELD, &jmessage);
-  if (!jmessage_exists) {
-    return common::make_error_inval();
-  }
-  const std::string message = json_object_get_string(jmessage);
-  if (message.empty()) {
-    return common::make_error_inval();
-  }
-  msg.message_ = message;
-
-  json_object* jtype = NULL;
-  json_bool jtype_exists = json_object_object_get_ex(serialized, CHAT_MESSAGE_TYPE_FIELD, &jtype);
-  if (jtype_exists) {
-    msg.type_ = static_cast<Type>(json_object_get_int(jtype));
-  }
-
-  *obj = msg;
-  return common::Error();
-}
-
 ChatMessage MakeEnterMessage(stream_id sid, login_t login) {
   return ChatMessage(sid, login, common::MemSPrintf(ENTER_MESSAGE_TEMPLATE, login), ChatMessage::CONTROL);
 }
@@ -163,4 +100,15 @@ bool ChatMessage::Equals(const ChatMessage& inf) const {
   return channel_id_ == inf.channel_id_ && login_ == inf.login_ && message_ == inf.message_ && type_ == inf.type_;
 }
 
+template <typename Self, typename Visitor>
+void ChatMessage::Fields(Self* self, Visitor* visitor) {
+  const serializer::field_flags_t required = serializer::FIELD_REQUIRED | serializer::FIELD_NOT_EMPTY;
+  visitor->Field(CHAT_MESSAGE_CHANNEL_ID_FIELD, &self->channel_id_, required);
+  visitor->Field(CHAT_MESSAGE_LOGIN_FIELD, &self->login_, required);
+  visitor->Field(CHAT_MESSAGE_MESSAGE_FIELD, &self->message_, required);
+  visitor->Field(CHAT_MESSAGE_TYPE_FIELD, &self->type_, serializer::FIELD_OPTIONAL);
+}
+
+SERIALIZER_FIELDS_INSTANTIATE(ChatMessage);
+
 }  // namespace fastotv
@@ -20,14 +20,14 @@
 
 #include "client_server_types.h"
 
-#include "serializer/json_serializer.h"
+#include "serializer/fields_serializer.h"
 
 // {"channel" : "1234", "login" : "atopilski@gmail.com", "message" : "leave the channel test", "type" : 0}
 // {"channel" : "1234", "login" : "atopilski@gmail.com", "message" : "Hello", "type" : 1}
 
 namespace fastotv {
 
-class ChatMessage : public JsonSerializer<ChatMessage> {
+class ChatMessage : public FieldsSerializer<ChatMessage> {
  public:
   enum Type { CONTROL = 0, MESSAGE };
   ChatMessage();
@@ -46,14 +46,13 @@ class ChatMessage : public JsonSerializer<ChatMessage> {
 
   Type GetType() const;
 
-  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
-
   bool Equals(const ChatMessage& inf) const;
 
- protected:
-  virtual common::Error SerializeImpl(serialize_type* deserialized) const override;
-
  private:
+  friend struct serializer::FieldsAccess;
+  template <typename Self, typename Visitor>
+  static void Fields(Self* self, Visitor* visitor);
+
   stream_id channel_id_;
   login_t login_;
   std::string message_;
@@ -18,126 +18,101 @@
 
 #include "client/commands.h"
 
-// requests
-// ping
-#define CLIENT_PING_REQ GENERATE_REQUEST_FMT(CLIENT_PING)
-#define CLIENT_PING_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_PING, "'%s'")
-#define CLIENT_PING_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(CLIENT_PING, "")
-
-// get_server_info
-#define CLIENT_GET_SERVER_INFO_REQ GENERATE_REQUEST_FMT(CLIENT_GET_SERVER_INFO)
-#define CLIENT_GET_SERVER_INFO_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_GET_SERVER_INFO, "'%s'")
-#define CLIENT_GET_SERVER_INFO_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(CLIENT_GET_SERVER_INFO, "")
-
-// get_channels
-#define CLIENT_GET_CHANNELS_REQ GENERATE_REQUEST_FMT(CLIENT_GET_CHANNELS)
-#define CLIENT_GET_CHANNELS_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_GET_CHANNELS, "'%s'")
-#define CLIENT_GET_CHANNELS_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(CLIENT_GET_CHANNELS, "")
-
-// get_runtime_channel_info
-#define CLIENT_GET_RUNTIME_CHANNEL_INFO_REQ_1E GENERATE_REQUEST_FMT_ARGS(CLIENT_GET_RUNTIME_CHANNEL_INFO, "'%s'")
-#define CLIENT_GET_RUNTIME_CHANNEL_INFO_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_GET_RUNTIME_CHANNEL_INFO, "'%s'")
-#define CLIENT_GET_RUNTIME_CHANNEL_INFO_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(CLIENT_GET_RUNTIME_CHANNEL_INFO, "")
-
-// send_chat_message
-#define CLIENT_SEND_CHAT_MESSAGE_REQ_1E GENERATE_REQUEST_FMT_ARGS(CLIENT_SEND_CHAT_MESSAGE, "'%s'")
-#define CLIENT_SEND_CHAT_MESSAGE_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_SEND_CHAT_MESSAGE, "'%s'")
-#define CLIENT_SEND_CHAT_MESSAGE_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(CLIENT_SEND_CHAT_MESSAGE, "")
-
-// responces
-// who are you
-#define CLIENT_WHO_ARE_YOU_RESP_FAIL_1E GENEATATE_FAIL_FMT(SERVER_WHO_ARE_YOU, "'%s'")
-#define CLIENT_WHO_ARE_YOU_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(SERVER_WHO_ARE_YOU, "'%s'")
-
-// system info
-#define CLIENT_PLEASE_SYSTEM_INFO_RESP_FAIL_1E GENEATATE_FAIL_FMT(SERVER_GET_CLIENT_INFO, "'%s'")
-#define CLIENT_PLEASE_SYSTEM_INFO_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(SERVER_GET_CLIENT_INFO, "'%s'")
-
-// ping
-#define CLIENT_PING_RESP_FAIL_1E GENEATATE_FAIL_FMT(SERVER_PING, "'%s'")
-#define CLIENT_PING_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(SERVER_PING, "'%s'")
-
-// server_send_chat_message
-#define CLIENT_SEND_CHAT_MESSAGE_RESP_FAIL_1E GENEATATE_FAIL_FMT(SERVER_SEND_CHAT_MESSAGE, "'%s'")
-#define CLIENT_SEND_CHAT_MESSAGE_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(SERVER_SEND_CHAT_MESSAGE, "'%s'")
-
 namespace fastotv {
 namespace client {
 
 cmd_request_t PingRequest(cmd_seq_t id) {
-  return MakeRequest(id, CLIENT_PING_REQ);
+  return MakeRequest(id, OPCODE_CLIENT_PING);
 }
 
 cmd_approve_t PingApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, CLIENT_PING_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_CLIENT_PING);
 }
 
 cmd_approve_t PingApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, CLIENT_PING_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_CLIENT_PING, error_text);
 }
 
 cmd_request_t GetServerInfoRequest(cmd_seq_t id) {
-  return MakeRequest(id, CLIENT_GET_SERVER_INFO_REQ);
+  return MakeRequest(id, OPCODE_CLIENT_GET_SERVER_INFO);
 }
 
 cmd_approve_t GetServerInfoApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, CLIENT_GET_SERVER_INFO_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_CLIENT_GET_SERVER_INFO);
 }
 
 cmd_approve_t GetServerInfoApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, CLIENT_GET_SERVER_INFO_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_CLIENT_GET_SERVER_INFO, error_text);
 }
 
 cmd_request_t GetChannelsRequest(cmd_seq_t id) {
-  return MakeRequest(id, CLIENT_GET_CHANNELS_REQ);
+  return MakeRequest(id, OPCODE_CLIENT_GET_CHANNELS);
+}
+
+cmd_request_t GetChannelsRequest(cmd_seq_t id, const std::string& version) {
+  return MakeRequest(id, OPCODE_CLIENT_GET_CHANNELS, version);
 }
 
 cmd_approve_t GetChannelsApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, CLIENT_GET_CHANNELS_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_CLIENT_GET_CHANNELS);
 }
 
 cmd_approve_t GetChannelsApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, CLIENT_GET_CHANNELS_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_CLIENT_GET_CHANNELS, error_text);
 }
 
 cmd_request_t GetRuntimeChannelInfoRequest(cmd_seq_t id, stream_id sid) {
-  return MakeRequest(id, CLIENT_GET_RUNTIME_CHANNEL_INFO_REQ_1E, sid);
+  return MakeRequest(id, OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO, sid);
 }
 
 cmd_approve_t GetRuntimeChannelInfoApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, CLIENT_GET_RUNTIME_CHANNEL_INFO_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO);
 }
 
 cmd_approve_t GetRuntimeChannelInfoApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, CLIENT_GET_RUNTIME_CHANNEL_INFO_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO, error_text);
 }
 
 cmd_request_t SendChatMessageRequest(cmd_seq_t id, const serializet_t& msg) {
-  return MakeRequest(id, CLIENT_SEND_CHAT_MESSAGE_REQ_1E, msg);
+  return MakeRequest(id, OPCODE_CLIENT_SEND_CHAT_MESSAGE, msg);
 }
 
 cmd_approve_t SendChatMessageApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, CLIENT_GET_SERVER_INFO_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_CLIENT_GET_SERVER_INFO);
 }
 
 cmd_approve_t SendChatMessageApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, CLIENT_GET_SERVER_INFO_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_CLIENT_GET_SERVER_INFO, error_text);
 }
 
 cmd_responce_t WhoAreYouResponceSuccsess(cmd_seq_t id, const serializet_t& auth_serialized) {
-  return MakeResponce(id, CLIENT_WHO_ARE_YOU_RESP_SUCCSESS_1E, auth_serialized);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_SERVER_WHO_ARE_YOU, auth_serialized);
+}
+
+cmd_responce_t WhoAreYouResponceSuccsess(cmd_seq_t id,
+                                         const serializet_t& auth_serialized,
+                                         protocol_version_t version) {
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_SERVER_WHO_ARE_YOU, auth_serialized, ConvertToString(version));
+}
+
+cmd_responce_t WhoAreYouResponceSuccsess(cmd_seq_t id,
+                                         const serializet_t& auth_serialized,
+                                         protocol_version_t version,
+                                         const std::string& frame_codec) {
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_SERVER_WHO_ARE_YOU, auth_serialized, ConvertToString(version),
+                      frame_codec);
 }
 
 cmd_responce_t SystemInfoResponceSuccsess(cmd_seq_t id, const serializet_t& system_info) {
-  return MakeResponce(id, CLIENT_PLEASE_SYSTEM_INFO_RESP_SUCCSESS_1E, system_info);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_SERVER_GET_CLIENT_INFO, system_info);
 }
 
 cmd_responce_t PingResponceSuccsess(cmd_seq_t id, const serializet_t& ping_info_serialized) {
-  return MakeResponce(id, CLIENT_PING_RESP_SUCCSESS_1E, ping_info_serialized);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_SERVER_PING, ping_info_serialized);
 }
 
 cmd_responce_t SendChatMessageResponceSuccsess(cmd_seq_t id, const serializet_t& chat_message_serialized) {
-  return MakeResponce(id, CLIENT_SEND_CHAT_MESSAGE_RESP_SUCCSESS_1E, chat_message_serialized);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_SERVER_SEND_CHAT_MESSAGE, chat_message_serialized);
 }
 
 }  // namespace client
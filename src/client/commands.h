@@ -38,6 +38,7 @@ cmd_approve_t GetServerInfoApproveResponceFail(cmd_seq_t id, const std::string&
 
 // get_channels
 cmd_request_t GetChannelsRequest(cmd_seq_t id);
+cmd_request_t GetChannelsRequest(cmd_seq_t id, const std::string& version);  // cached channels version
 cmd_approve_t GetChannelsApproveResponceSuccsess(cmd_seq_t id);
 cmd_approve_t GetChannelsApproveResponceFail(cmd_seq_t id, const std::string& error_text);  // escaped
 
@@ -54,6 +55,13 @@ cmd_approve_t SendChatMessageApproveResponceFail(cmd_seq_t id, const std::string
 // responces
 // who are you
 cmd_responce_t WhoAreYouResponceSuccsess(cmd_seq_t id, const serializet_t& auth_serialized);
+cmd_responce_t WhoAreYouResponceSuccsess(cmd_seq_t id,
+                                         const serializet_t& auth_serialized,
+                                         protocol_version_t version);  // accepted protocol
+cmd_responce_t WhoAreYouResponceSuccsess(cmd_seq_t id,
+                                         const serializet_t& auth_serialized,
+                                         protocol_version_t version,
+                                         const std::string& frame_codec);  // accepted protocol and codec
 // system info
 cmd_responce_t SystemInfoResponceSuccsess(cmd_seq_t id, const serializet_t& system_info);
 // ping
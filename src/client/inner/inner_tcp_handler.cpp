@@ -28,6 +28,7 @@
 
 #include <common/application/application.h>  // for fApp
 #include <common/error.h>                    // for DEBUG_MSG_ERROR
+#include <common/file_system/file_system.h>  // for is_file_exist
 #include <common/libev/io_client.h>          // for IoClient
 #include <common/libev/io_loop.h>            // for IoLoop
 #include <common/logger.h>                   // for COMPACT_LOG_WARNING
@@ -43,22 +44,88 @@
 
 #include "inner/inner_client.h"  // for InnerClient
 
-#include "channels_info.h"  // for ChannelsInfo
-#include "ping_info.h"      // for ClientPingInfo
-#include "server_info.h"    // for ServerInfo
+#include "channels_delta.h"  // for ChannelsDelta
+#include "channels_info.h"   // for ChannelsInfo
+#include "ping_info.h"       // for ClientPingInfo
+#include "server_info.h"     // for ServerInfo
+
+#define CHANNELS_CACHE_VERSION_FIELD "version"
+#define CHANNELS_CACHE_CHANNELS_FIELD "channels"
 
 namespace fastotv {
 namespace client {
 namespace inner {
+namespace {
+
+common::Error LoadChannelsCache(const std::string& path, ChannelsInfo* chan, std::string* version) {
+  json_object* obj = json_object_from_file(path.c_str());
+  if (!obj) {
+    return common::make_error("Can't read channels cache: " + path);
+  }
+
+  json_object* jversion = NULL;
+  json_object* jchannels = NULL;
+  if (!json_object_object_get_ex(obj, CHANNELS_CACHE_VERSION_FIELD, &jversion) ||
+      !json_object_object_get_ex(obj, CHANNELS_CACHE_CHANNELS_FIELD, &jchannels)) {
+    json_object_put(obj);
+    return common::make_error("Invalid channels cache: " + path);
+  }
+
+  ChannelsInfo lchan;
+  common::Error err = ChannelsInfo::DeSerialize(jchannels, &lchan);
+  if (err) {
+    json_object_put(obj);
+    return err;
+  }
+
+  *chan = lchan;
+  *version = json_object_get_string(jversion);
+  json_object_put(obj);
+  return common::Error();
+}
+
+common::Error SaveChannelsCache(const std::string& path, const ChannelsInfo& chan, const std::string& version) {
+  json_object* jchannels = NULL;
+  common::Error err = chan.Serialize(&jchannels);
+  if (err) {
+    return err;
+  }
+
+  json_object* obj = json_object_new_object();
+  json_object_object_add(obj, CHANNELS_CACHE_VERSION_FIELD, json_object_new_string(version.c_str()));
+  json_object_object_add(obj, CHANNELS_CACHE_CHANNELS_FIELD, jchannels);
+  int res = json_object_to_file(path.c_str(), obj);
+  json_object_put(obj);
+  if (res < 0) {
+    return common::make_error("Can't write channels cache: " + path);
+  }
+
+  return common::Error();
+}
+
+}  // namespace
 
 InnerTcpHandler::InnerTcpHandler(const StartConfig& config)
     : fastotv::inner::InnerServerCommandSeqParser(),
       common::libev::IoLoopObserver(),
       inner_connection_(nullptr),
+      commands_(),
       bandwidth_requests_(),
       ping_server_id_timer_(INVALID_TIMER_ID),
       config_(config),
-      current_bandwidth_(0) {}
+      current_bandwidth_(0),
+      request_handlers_({{OPCODE_SERVER_PING, &InnerTcpHandler::HandleServerPingRequest},
+                         {OPCODE_SERVER_WHO_ARE_YOU, &InnerTcpHandler::HandleWhoAreYouRequest},
+                         {OPCODE_SERVER_GET_CLIENT_INFO, &InnerTcpHandler::HandleClientInfoRequest},
+                         {OPCODE_SERVER_SEND_CHAT_MESSAGE, &InnerTcpHandler::HandleServerChatMessageRequest}}),
+      responce_handlers_({{OPCODE_CLIENT_PING, &InnerTcpHandler::HandlePingResponce},
+                          {OPCODE_CLIENT_GET_SERVER_INFO, &InnerTcpHandler::HandleServerInfoResponce},
+                          {OPCODE_CLIENT_GET_CHANNELS, &InnerTcpHandler::HandleChannelsInfoResponce},
+                          {OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO, &InnerTcpHandler::HandleRuntimeChannelInfoResponce},
+                          {OPCODE_CLIENT_SEND_CHAT_MESSAGE, &InnerTcpHandler::HandleSendChatMessageResponce}}),
+      channels_cache_loaded_(false),
+      channels_cache_(),
+      channels_cache_version_() {}
 
 InnerTcpHandler::~InnerTcpHandler() {
   CHECK(bandwidth_requests_.empty());
@@ -113,17 +180,26 @@ void InnerTcpHandler::Closed(common::libev::IoClient* client) {
 
 void InnerTcpHandler::DataReceived(common::libev::IoClient* client) {
   if (client == inner_connection_) {
-    std::string buff;
     fastotv::inner::InnerClient* iclient = static_cast<fastotv::inner::InnerClient*>(client);
-    common::Error err = iclient->ReadCommand(&buff);
+    size_t commands_count = 0;
+    common::Error err = iclient->ReadCommands(&commands_, &commands_count);
+    iclient->BeginWriteBatch();
+    for (size_t i = 0; i < commands_count; ++i) {
+      HandleInnerDataReceived(iclient, commands_[i]);
+      if (inner_connection_ != client) {  // closed while handling
+        return;
+      }
+    }
+
+    common::Error write_err = iclient->EndWriteBatch();
+    if (!err) {
+      err = write_err;
+    }
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
       client->Close();
       delete client;
-      return;
     }
-
-    HandleInnerDataReceived(iclient, buff);
     return;
   }
 
@@ -143,7 +219,17 @@ void InnerTcpHandler::DataReceived(common::libev::IoClient* client) {
 }
 
 void InnerTcpHandler::DataReadyToWrite(common::libev::IoClient* client) {
-  UNUSED(client);
+  if (client != inner_connection_) {
+    return;
+  }
+
+  fastotv::inner::InnerClient* iclient = static_cast<fastotv::inner::InnerClient*>(client);
+  common::Error err = iclient->Flush();
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    client->Close();
+    delete client;
+  }
 }
 
 void InnerTcpHandler::PostLooped(common::libev::IoLoop* server) {
@@ -196,7 +282,20 @@ void InnerTcpHandler::RequestChannels() {
     return;
   }
 
-  const cmd_request_t channels_request = GetChannelsRequest(NextRequestID());
+  if (!channels_cache_loaded_) {
+    channels_cache_loaded_ = true;
+    const std::string path = config_.channels_cache_path;
+    if (!path.empty() && common::file_system::is_file_exist(path)) {
+      common::Error err = LoadChannelsCache(path, &channels_cache_, &channels_cache_version_);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+      }
+    }
+  }
+
+  const cmd_request_t channels_request = channels_cache_version_.empty()
+                                             ? GetChannelsRequest(NextRequestID())
+                                             : GetChannelsRequest(NextRequestID(), channels_cache_version_);
   fastotv::inner::InnerClient* client = inner_connection_;
   common::Error err = client->Write(channels_request);
   if (err) {
@@ -304,310 +403,393 @@ common::Error InnerTcpHandler::CreateAndConnectTcpBandwidthClient(common::libev:
 
 void InnerTcpHandler::HandleInnerRequestCommand(fastotv::inner::InnerClient* connection,
                                                 cmd_seq_t id,
-                                                int argc,
-                                                char* argv[]) {
-  UNUSED(argc);
-  char* command = argv[0];
-
-  if (IS_EQUAL_COMMAND(command, SERVER_PING)) {
-    ServerPingInfo ping;
-    json_object* jping = NULL;
-    common::Error err = ping.Serialize(&jping);
-    if (err) {
-      NOTREACHED();
-    }
-    std::string ping_str = json_object_get_string(jping);
-    json_object_put(jping);
-    const cmd_responce_t pong = PingResponceSuccsess(id, ping_str);
-    err = connection->Write(pong);
+                                                const CommandArgsView& argv) {
+  const char* command = argv[0].data();
+  cmd_opcode_t opcode;
+  if (request_handlers_.Find(command, &opcode)) {
+    request_handlers_.Execute(this, opcode, connection, id, argv);
+    return;
+  }
+
+  WARNING_LOG() << "UNKNOWN REQUEST COMMAND: " << command;
+}
+
+void InnerTcpHandler::HandleInnerResponceCommand(fastotv::inner::InnerClient* connection,
+                                                 cmd_seq_t id,
+                                                 const CommandArgsView& argv) {
+  const char* state_command = argv[0].data();
+  const cmd_state_t state = argv.size() > 1 ? CommandToState(state_command) : STATE_NONE;
+  if (state == STATE_SUCCESS) {
+    common::Error err = HandleInnerSuccsessResponceCommand(connection, id, argv);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
     }
     return;
-  } else if (IS_EQUAL_COMMAND(command, SERVER_WHO_ARE_YOU)) {
-    json_object* jauth = NULL;
-    common::Error err = config_.ainf.Serialize(&jauth);
+  } else if (state == STATE_FAIL) {
+    common::Error err = HandleInnerFailedResponceCommand(connection, id, argv);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      return;
     }
+    return;
+  }
 
-    std::string auth_str = json_object_get_string(jauth);
-    json_object_put(jauth);
-    cmd_responce_t iAm = WhoAreYouResponceSuccsess(id, auth_str);
-    err = connection->Write(iAm);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    }
+  WARNING_LOG() << "UNKNOWN STATE COMMAND: " << state_command;
+}
+
+void InnerTcpHandler::HandleInnerApproveCommand(fastotv::inner::InnerClient* connection,
+                                                cmd_seq_t id,
+                                                const CommandArgsView& argv) {
+  UNUSED(id);
+  const char* command = argv[0].data();
+  const cmd_state_t state = CommandToState(command);
+  if (state == STATE_NONE) {
+    WARNING_LOG() << "UNKNOWN COMMAND: " << command;
     return;
-  } else if (IS_EQUAL_COMMAND(command, SERVER_GET_CLIENT_INFO)) {
-    const common::system_info::CpuInfo& c1 = common::system_info::CurrentCpuInfo();
-    std::string brand = c1.GetBrandName();
+  }
 
-    int64_t ram_total = common::system_info::AmountOfPhysicalMemory();
-    int64_t ram_free = common::system_info::AmountOfAvailablePhysicalMemory();
+  // only authorization approve handled
+  if (argv.size() < 2 || CommandToOpcode(argv[1].data()) != OPCODE_SERVER_WHO_ARE_YOU) {
+    return;
+  }
 
-    std::string os_name = common::system_info::OperatingSystemName();
-    std::string os_version = common::system_info::OperatingSystemVersion();
-    std::string os_arch = common::system_info::OperatingSystemArchitecture();
+  if (state == STATE_SUCCESS) {
+    connection->SetName(config_.ainf.GetLogin());
+    fApp->PostEvent(new events::ClientAuthorizedEvent(this, config_.ainf));
+    return;
+  }
 
-    std::string os = common::MemSPrintf("%s %s(%s)", os_name, os_version, os_arch);
+  common::Error err = common::make_error(argv.size() > 2 ? argv[2].as_string() : "Unknown");
+  auto ex_event = common::make_exception_event(new events::ClientAuthorizedEvent(this, config_.ainf), err);
+  fApp->PostEvent(ex_event);
+}
 
-    ClientInfo info(config_.ainf.GetLogin(), os, brand, ram_total, ram_free, current_bandwidth_);
-    serializet_t info_json_string;
-    common::Error err = info.SerializeToString(&info_json_string);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      return;
-    }
+common::Error InnerTcpHandler::HandleInnerSuccsessResponceCommand(fastotv::inner::InnerClient* connection,
+                                                                  cmd_seq_t id,
+                                                                  const CommandArgsView& argv) {
+  const char* command = argv[1].data();
+  cmd_opcode_t opcode;
+  if (responce_handlers_.Find(command, &opcode)) {
+    return responce_handlers_.Execute(this, opcode, connection, id, argv);
+  }
 
-    cmd_responce_t resp = SystemInfoResponceSuccsess(id, info_json_string);
-    err = connection->Write(resp);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    }
+  const std::string error_str = common::MemSPrintf("UNKNOWN RESPONCE COMMAND: %s", command);
+  return common::make_error(error_str);
+}
+
+void InnerTcpHandler::HandleServerPingRequest(fastotv::inner::InnerClient* connection,
+                                              cmd_seq_t id,
+                                              const CommandArgsView& argv) {
+  UNUSED(argv);
+  ServerPingInfo ping;
+  json_object* jping = NULL;
+  common::Error err = ping.Serialize(&jping);
+  if (err) {
+    NOTREACHED();
+  }
+  std::string ping_str = json_object_get_string(jping);
+  json_object_put(jping);
+  const cmd_responce_t pong = PingResponceSuccsess(id, ping_str);
+  err = connection->Write(pong);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+}
+
+void InnerTcpHandler::HandleWhoAreYouRequest(fastotv::inner::InnerClient* connection,
+                                             cmd_seq_t id,
+                                             const CommandArgsView& argv) {
+  json_object* jauth = NULL;
+  common::Error err = config_.ainf.Serialize(&jauth);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
     return;
-  } else if (IS_EQUAL_COMMAND(command, SERVER_SEND_CHAT_MESSAGE)) {
-    if (argc < 2 || !argv[1]) {
-      common::Error parse_err = common::make_error_inval();
-      DEBUG_MSG_ERROR(parse_err, common::logging::LOG_LEVEL_ERR);
-      return;
-    }
+  }
 
-    json_object* jmsg = json_tokener_parse(argv[1]);
-    if (!jmsg) {
-      common::Error parse_err = common::make_error_inval();
-      DEBUG_MSG_ERROR(parse_err, common::logging::LOG_LEVEL_ERR);
-      return;
-    }
+  std::string auth_str = json_object_get_string(jauth);
+  json_object_put(jauth);
+  protocol_version_t offered = PROTOCOL_V1;  // old servers not offer
+  if (argv.size() > 1 && !ConvertFromString(argv[1].as_string(), &offered)) {
+    offered = PROTOCOL_V1;
+  }
+  fastotv::inner::frame_codec_t codec;  // old servers not offer
+  if (argv.size() > 2 && fastotv::inner::SelectFrameCodec(argv[2].as_string(), &codec)) {
+    cmd_responce_t iAm =
+        WhoAreYouResponceSuccsess(id, auth_str, offered, fastotv::inner::FrameCodecToString(codec));
+    err = connection->Write(iAm);
+    connection->SetProtocolVersion(offered);
+    connection->SetFrameCodec(codec);  // this responce still legacy frame
+  } else if (offered == PROTOCOL_V2) {
+    cmd_responce_t iAm = WhoAreYouResponceSuccsess(id, auth_str, PROTOCOL_V2);
+    err = connection->Write(iAm);
+    connection->SetProtocolVersion(PROTOCOL_V2);
+  } else {
+    cmd_responce_t iAm = WhoAreYouResponceSuccsess(id, auth_str);
+    err = connection->Write(iAm);
+  }
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+}
 
-    ChatMessage msg;
-    common::Error err = ChatMessage::DeSerialize(jmsg, &msg);
-    std::string msg_str = json_object_get_string(jmsg);
-    json_object_put(jmsg);
-    if (err) {
-      return;
-    }
+void InnerTcpHandler::HandleClientInfoRequest(fastotv::inner::InnerClient* connection,
+                                              cmd_seq_t id,
+                                              const CommandArgsView& argv) {
+  UNUSED(argv);
+  const common::system_info::CpuInfo& c1 = common::system_info::CurrentCpuInfo();
+  std::string brand = c1.GetBrandName();
 
-    fApp->PostEvent(new events::ReceiveChatMessageEvent(this, msg));
-    cmd_responce_t resp = SystemInfoResponceSuccsess(id, msg_str);
-    err = connection->Write(resp);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    }
+  int64_t ram_total = common::system_info::AmountOfPhysicalMemory();
+  int64_t ram_free = common::system_info::AmountOfAvailablePhysicalMemory();
+
+  std::string os_name = common::system_info::OperatingSystemName();
+  std::string os_version = common::system_info::OperatingSystemVersion();
+  std::string os_arch = common::system_info::OperatingSystemArchitecture();
+
+  std::string os = common::MemSPrintf("%s %s(%s)", os_name, os_version, os_arch);
+
+  ClientInfo info(config_.ainf.GetLogin(), os, brand, ram_total, ram_free, current_bandwidth_);
+  serializet_t info_json_string;
+  common::Error err = info.SerializeToString(&info_json_string);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
     return;
   }
 
-  WARNING_LOG() << "UNKNOWN REQUEST COMMAND: " << command;
+  cmd_responce_t resp = SystemInfoResponceSuccsess(id, info_json_string);
+  err = connection->Write(resp);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
 }
 
-void InnerTcpHandler::HandleInnerResponceCommand(fastotv::inner::InnerClient* connection,
-                                                 cmd_seq_t id,
-                                                 int argc,
-                                                 char* argv[]) {
-  char* state_command = argv[0];
+void InnerTcpHandler::HandleServerChatMessageRequest(fastotv::inner::InnerClient* connection,
+                                                     cmd_seq_t id,
+                                                     const CommandArgsView& argv) {
+  if (argv.size() < 2) {
+    common::Error parse_err = common::make_error_inval();
+    DEBUG_MSG_ERROR(parse_err, common::logging::LOG_LEVEL_ERR);
+    return;
+  }
 
-  if (IS_EQUAL_COMMAND(state_command, SUCCESS_COMMAND) && argc > 1) {
-    common::Error err = HandleInnerSuccsessResponceCommand(connection, id, argc, argv);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    }
+  json_object* jmsg = json_tokener_parse(argv[1].data());
+  if (!jmsg) {
+    common::Error parse_err = common::make_error_inval();
+    DEBUG_MSG_ERROR(parse_err, common::logging::LOG_LEVEL_ERR);
     return;
-  } else if (IS_EQUAL_COMMAND(state_command, FAIL_COMMAND) && argc > 1) {
-    common::Error err = HandleInnerFailedResponceCommand(connection, id, argc, argv);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    }
+  }
+
+  ChatMessage msg;
+  common::Error err = ChatMessage::DeSerialize(jmsg, &msg);
+  std::string msg_str = json_object_get_string(jmsg);
+  json_object_put(jmsg);
+  if (err) {
     return;
   }
 
-  WARNING_LOG() << "UNKNOWN STATE COMMAND: " << state_command;
+  fApp->PostEvent(new events::ReceiveChatMessageEvent(this, msg));
+  cmd_responce_t resp = SystemInfoResponceSuccsess(id, msg_str);
+  err = connection->Write(resp);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
 }
 
-void InnerTcpHandler::HandleInnerApproveCommand(fastotv::inner::InnerClient* connection,
-                                                cmd_seq_t id,
-                                                int argc,
-                                                char* argv[]) {
-  UNUSED(id);
-  char* command = argv[0];
-
-  if (IS_EQUAL_COMMAND(command, SUCCESS_COMMAND)) {
-    if (argc > 1) {
-      const char* okrespcommand = argv[1];
-      if (IS_EQUAL_COMMAND(okrespcommand, SERVER_PING)) {
-      } else if (IS_EQUAL_COMMAND(okrespcommand, SERVER_WHO_ARE_YOU)) {
-        connection->SetName(config_.ainf.GetLogin());
-        fApp->PostEvent(new events::ClientAuthorizedEvent(this, config_.ainf));
-      } else if (IS_EQUAL_COMMAND(okrespcommand, SERVER_GET_CLIENT_INFO)) {
-      } else if (IS_EQUAL_COMMAND(okrespcommand, SERVER_SEND_CHAT_MESSAGE)) {
-      }
-    }
-    return;
-  } else if (IS_EQUAL_COMMAND(command, FAIL_COMMAND)) {
-    if (argc > 1) {
-      const char* failed_resp_command = argv[1];
-      if (IS_EQUAL_COMMAND(failed_resp_command, SERVER_PING)) {
-      } else if (IS_EQUAL_COMMAND(failed_resp_command, SERVER_WHO_ARE_YOU)) {
-        common::Error err = common::make_error(argc > 2 ? argv[2] : "Unknown");
-        auto ex_event = common::make_exception_event(new events::ClientAuthorizedEvent(this, config_.ainf), err);
-        fApp->PostEvent(ex_event);
-      } else if (IS_EQUAL_COMMAND(failed_resp_command, SERVER_GET_CLIENT_INFO)) {
-      } else if (IS_EQUAL_COMMAND(failed_resp_command, SERVER_SEND_CHAT_MESSAGE)) {
-      }
-    }
-    return;
+common::Error InnerTcpHandler::HandlePingResponce(fastotv::inner::InnerClient* connection,
+                                                  cmd_seq_t id,
+                                                  const CommandArgsView& argv) {
+  json_object* obj = NULL;
+  common::Error parse_err = ParserResponceResponceCommand(argv, &obj);
+  if (parse_err) {
+    cmd_approve_t resp = PingApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
   }
 
-  WARNING_LOG() << "UNKNOWN COMMAND: " << command;
+  ClientPingInfo ping_info;
+  common::Error err = ClientPingInfo::DeSerialize(obj, &ping_info);
+  json_object_put(obj);
+  if (err) {
+    return err;
+  }
+  cmd_approve_t resp = PingApproveResponceSuccsess(id);
+  return connection->Write(resp);
 }
 
-common::Error InnerTcpHandler::HandleInnerSuccsessResponceCommand(fastotv::inner::InnerClient* connection,
-                                                                  cmd_seq_t id,
-                                                                  int argc,
-                                                                  char* argv[]) {
-  char* command = argv[1];
-  if (IS_EQUAL_COMMAND(command, CLIENT_PING)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = PingApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
-    }
+common::Error InnerTcpHandler::HandleServerInfoResponce(fastotv::inner::InnerClient* connection,
+                                                        cmd_seq_t id,
+                                                        const CommandArgsView& argv) {
+  json_object* obj = NULL;
+  common::Error parse_err = ParserResponceResponceCommand(argv, &obj);
+  if (parse_err) {
+    cmd_approve_t resp = GetServerInfoApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
+  }
 
-    ClientPingInfo ping_info;
-    common::Error err = ClientPingInfo::DeSerialize(obj, &ping_info);
-    json_object_put(obj);
-    if (err) {
-      return err;
-    }
-    cmd_approve_t resp = PingApproveResponceSuccsess(id);
-    return connection->Write(resp);
-  } else if (IS_EQUAL_COMMAND(command, CLIENT_GET_SERVER_INFO)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = GetServerInfoApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
-    }
+  ServerInfo sinf;
+  common::Error err = ServerInfo::DeSerialize(obj, &sinf);
+  json_object_put(obj);
+  if (err) {
+    return err;
+  }
 
-    ServerInfo sinf;
-    common::Error err = ServerInfo::DeSerialize(obj, &sinf);
-    json_object_put(obj);
-    if (err) {
-      return err;
-    }
+  common::net::HostAndPort host = sinf.GetBandwidthHost();
+  bandwidth::TcpBandwidthClient* band_connection = NULL;
+  common::libev::IoLoop* server = connection->GetServer();
+  const BandwidthHostType hs = MAIN_SERVER;
+  err = CreateAndConnectTcpBandwidthClient(server, host, hs, &band_connection);
+  if (err) {
+    events::BandwidtInfo cinf(host, 0, hs);
+    current_bandwidth_ = 0;
+    auto ex_event = common::make_exception_event(new events::BandwidthEstimationEvent(this, cinf), err);
+    fApp->PostEvent(ex_event);
+    return err;
+  }
 
-    common::net::HostAndPort host = sinf.GetBandwidthHost();
-    bandwidth::TcpBandwidthClient* band_connection = NULL;
-    common::libev::IoLoop* server = connection->GetServer();
-    const BandwidthHostType hs = MAIN_SERVER;
-    err = CreateAndConnectTcpBandwidthClient(server, host, hs, &band_connection);
-    if (err) {
-      events::BandwidtInfo cinf(host, 0, hs);
-      current_bandwidth_ = 0;
-      auto ex_event = common::make_exception_event(new events::BandwidthEstimationEvent(this, cinf), err);
-      fApp->PostEvent(ex_event);
-      return err;
-    }
+  bandwidth_requests_.push_back(band_connection);
+  server->RegisterClient(band_connection);
+  return common::Error();
+}
 
-    bandwidth_requests_.push_back(band_connection);
-    server->RegisterClient(band_connection);
-    return common::Error();
-  } else if (IS_EQUAL_COMMAND(command, CLIENT_GET_CHANNELS)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = GetChannelsApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
-    }
+common::Error InnerTcpHandler::HandleChannelsInfoResponce(fastotv::inner::InnerClient* connection,
+                                                          cmd_seq_t id,
+                                                          const CommandArgsView& argv) {
+  ChannelsInfo chan;
+  common::Error parse_err = HandleChannelsResponce(argv, &chan);
+  if (parse_err) {
+    cmd_approve_t resp = GetChannelsApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
+  }
 
-    ChannelsInfo chan;
-    common::Error err = ChannelsInfo::DeSerialize(obj, &chan);
-    json_object_put(obj);
-    if (err) {
-      return err;
-    }
+  fApp->PostEvent(new events::ReceiveChannelsEvent(this, chan));
+  const cmd_approve_t resp = GetChannelsApproveResponceSuccsess(id);
+  return connection->Write(resp);
+}
 
-    fApp->PostEvent(new events::ReceiveChannelsEvent(this, chan));
-    const cmd_approve_t resp = GetChannelsApproveResponceSuccsess(id);
-    return connection->Write(resp);
-  } else if (IS_EQUAL_COMMAND(command, CLIENT_GET_RUNTIME_CHANNEL_INFO)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = GetRuntimeChannelInfoApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
-    }
+common::Error InnerTcpHandler::HandleRuntimeChannelInfoResponce(fastotv::inner::InnerClient* connection,
+                                                                cmd_seq_t id,
+                                                                const CommandArgsView& argv) {
+  json_object* obj = NULL;
+  common::Error parse_err = ParserResponceResponceCommand(argv, &obj);
+  if (parse_err) {
+    cmd_approve_t resp = GetRuntimeChannelInfoApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
+  }
 
-    RuntimeChannelInfo chan;
-    common::Error err = RuntimeChannelInfo::DeSerialize(obj, &chan);
-    json_object_put(obj);
-    if (err) {
-      return err;
-    }
+  RuntimeChannelInfo chan;
+  common::Error err = RuntimeChannelInfo::DeSerialize(obj, &chan);
+  json_object_put(obj);
+  if (err) {
+    return err;
+  }
 
-    fApp->PostEvent(new events::ReceiveRuntimeChannelEvent(this, chan));
-    const cmd_approve_t resp = GetRuntimeChannelInfoApproveResponceSuccsess(id);
-    return connection->Write(resp);
-  } else if (IS_EQUAL_COMMAND(command, CLIENT_SEND_CHAT_MESSAGE)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = SendChatMessageApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
-    }
+  fApp->PostEvent(new events::ReceiveRuntimeChannelEvent(this, chan));
+  const cmd_approve_t resp = GetRuntimeChannelInfoApproveResponceSuccsess(id);
+  return connection->Write(resp);
+}
 
-    ChatMessage msg;
-    common::Error err = ChatMessage::DeSerialize(obj, &msg);
-    json_object_put(obj);
-    if (err) {
-      return err;
-    }
+common::Error InnerTcpHandler::HandleSendChatMessageResponce(fastotv::inner::InnerClient* connection,
+                                                             cmd_seq_t id,
+                                                             const CommandArgsView& argv) {
+  json_object* obj = NULL;
+  common::Error parse_err = ParserResponceResponceCommand(argv, &obj);
+  if (parse_err) {
+    cmd_approve_t resp = SendChatMessageApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
+  }
 
-    fApp->PostEvent(new events::SendChatMessageEvent(this, msg));
-    const cmd_approve_t resp = SendChatMessageApproveResponceSuccsess(id);
-    return connection->Write(resp);
+  ChatMessage msg;
+  common::Error err = ChatMessage::DeSerialize(obj, &msg);
+  json_object_put(obj);
+  if (err) {
+    return err;
   }
 
-  const std::string error_str = common::MemSPrintf("UNKNOWN RESPONCE COMMAND: %s", command);
-  return common::make_error(error_str);
+  fApp->PostEvent(new events::SendChatMessageEvent(this, msg));
+  const cmd_approve_t resp = SendChatMessageApproveResponceSuccsess(id);
+  return connection->Write(resp);
 }
 
 common::Error InnerTcpHandler::HandleInnerFailedResponceCommand(fastotv::inner::InnerClient* connection,
                                                                 cmd_seq_t id,
-                                                                int argc,
-                                                                char* argv[]) {
+                                                                const CommandArgsView& argv) {
   UNUSED(connection);
   UNUSED(id);
-  UNUSED(argc);
 
-  char* command = argv[1];
+  const char* command = argv[1].data();
   const std::string error_str =
       common::MemSPrintf("Sorry now we can't handle failed pesponce for command: %s", command);
   return common::make_error(error_str);
 }
 
-common::Error InnerTcpHandler::ParserResponceResponceCommand(int argc, char* argv[], json_object** out) {
-  if (argc < 2) {
-    return common::make_error_inval();
+common::Error InnerTcpHandler::HandleChannelsResponce(const CommandArgsView& argv, ChannelsInfo* chan) {
+  const char* version = argv.size() > 3 ? argv[3].data() : NULL;  // not sent by old servers
+  const char* sync_type = argv.size() > 4 ? argv[4].data() : NULL;
+  if (IS_EQUAL_COMMAND(sync_type, CHANNELS_SYNC_NOT_MODIFIED)) {
+    *chan = channels_cache_;
+    return common::Error();
+  }
+
+  json_object* obj = NULL;
+  common::Error err = ParserResponceResponceCommand(argv, &obj);
+  if (err) {
+    return err;
+  }
+
+  ChannelsInfo lchan;
+  if (IS_EQUAL_COMMAND(sync_type, CHANNELS_SYNC_DELTA)) {
+    ChannelsDelta delta;
+    err = ChannelsDelta::DeSerialize(obj, &delta);
+    if (!err) {
+      err = delta.Apply(channels_cache_, &lchan);
+    }
+  } else {
+    err = ChannelsInfo::DeSerialize(obj, &lchan);
+  }
+  json_object_put(obj);
+  if (err) {
+    channels_cache_version_.clear();  // full list in next time
+    return err;
+  }
+
+  if (version) {
+    UpdateChannelsCache(lchan, version);
   }
+  *chan = lchan;
+  return common::Error();
+}
+
+void InnerTcpHandler::UpdateChannelsCache(const ChannelsInfo& chan, const std::string& version) {
+  if (version == channels_cache_version_) {
+    return;
+  }
+
+  channels_cache_ = chan;
+  channels_cache_version_ = version;
+  if (config_.channels_cache_path.empty()) {
+    return;
+  }
+
+  common::Error err = SaveChannelsCache(config_.channels_cache_path, chan, version);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+  }
+}
 
-  const char* arg_2_str = argv[2];
-  if (!arg_2_str) {
+common::Error InnerTcpHandler::ParserResponceResponceCommand(const CommandArgsView& argv, json_object** out) {
+  if (argv.size() < 3) {
     return common::make_error_inval();
   }
 
-  json_object* obj = json_tokener_parse(arg_2_str);
+  json_object* obj = json_tokener_parse(argv[2].data());
   if (!obj) {
     return common::make_error_inval();
   }
@@ -26,12 +26,14 @@
 
 #include "auth_info.h"  // for AuthInfo
 
+#include "channels_info.h"  // for ChannelsInfo
 #include "chat_message.h"
 #include "client/types.h"         // for BandwidthHostType
 #include "client_server_types.h"  // for bandwidth_t
 
 #include "commands/commands.h"  // for cmd_seq_t
 
+#include "inner/command_handlers.h"                 // for CommandHandlers
 #include "inner/inner_server_command_seq_parser.h"  // for InnerServerComman...
 
 #include <json-c/json_object.h>  // for json_object
@@ -60,6 +62,7 @@ namespace inner {
 struct StartConfig {
   common::net::HostAndPort inner_host;
   AuthInfo ainf;
+  std::string channels_cache_path;  // last received channels and version, empty - not cached
 };
 
 class InnerTcpHandler : public fastotv::inner::InnerServerCommandSeqParser, public common::libev::IoLoopObserver {
@@ -67,6 +70,8 @@ class InnerTcpHandler : public fastotv::inner::InnerServerCommandSeqParser, publ
   enum {
     ping_timeout_server = 30  // sec
   };
+  typedef fastotv::inner::CommandHandlers<InnerTcpHandler, void> request_handlers_t;
+  typedef fastotv::inner::CommandHandlers<InnerTcpHandler, common::Error> responce_handlers_t;
 
   explicit InnerTcpHandler(const StartConfig& config);
   virtual ~InnerTcpHandler();
@@ -95,36 +100,65 @@ class InnerTcpHandler : public fastotv::inner::InnerServerCommandSeqParser, publ
 
   virtual void HandleInnerRequestCommand(fastotv::inner::InnerClient* connection,
                                          cmd_seq_t id,
-                                         int argc,
-                                         char* argv[]) override;
+                                         const CommandArgsView& argv) override;
   virtual void HandleInnerResponceCommand(fastotv::inner::InnerClient* connection,
                                           cmd_seq_t id,
-                                          int argc,
-                                          char* argv[]) override;
+                                          const CommandArgsView& argv) override;
   virtual void HandleInnerApproveCommand(fastotv::inner::InnerClient* connection,
                                          cmd_seq_t id,
-                                         int argc,
-                                         char* argv[]) override;
+                                         const CommandArgsView& argv) override;
+
+  // server requests
+  void HandleServerPingRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleWhoAreYouRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleClientInfoRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleServerChatMessageRequest(fastotv::inner::InnerClient* connection,
+                                      cmd_seq_t id,
+                                      const CommandArgsView& argv);
+
+  // server responces on client requests
+  common::Error HandlePingResponce(fastotv::inner::InnerClient* connection,
+                                   cmd_seq_t id,
+                                   const CommandArgsView& argv) WARN_UNUSED_RESULT;
+  common::Error HandleServerInfoResponce(fastotv::inner::InnerClient* connection,
+                                         cmd_seq_t id,
+                                         const CommandArgsView& argv) WARN_UNUSED_RESULT;
+  common::Error HandleChannelsInfoResponce(fastotv::inner::InnerClient* connection,
+                                           cmd_seq_t id,
+                                           const CommandArgsView& argv) WARN_UNUSED_RESULT;
+  common::Error HandleRuntimeChannelInfoResponce(fastotv::inner::InnerClient* connection,
+                                                 cmd_seq_t id,
+                                                 const CommandArgsView& argv) WARN_UNUSED_RESULT;
+  common::Error HandleSendChatMessageResponce(fastotv::inner::InnerClient* connection,
+                                              cmd_seq_t id,
+                                              const CommandArgsView& argv) WARN_UNUSED_RESULT;
 
   // inner handlers
   common::Error HandleInnerSuccsessResponceCommand(fastotv::inner::InnerClient* connection,
                                                    cmd_seq_t id,
-                                                   int argc,
-                                                   char* argv[]) WARN_UNUSED_RESULT;
+                                                   const CommandArgsView& argv) WARN_UNUSED_RESULT;
   common::Error HandleInnerFailedResponceCommand(fastotv::inner::InnerClient* connection,
                                                  cmd_seq_t id,
-                                                 int argc,
-                                                 char* argv[]) WARN_UNUSED_RESULT;
+                                                 const CommandArgsView& argv) WARN_UNUSED_RESULT;
 
-  common::Error ParserResponceResponceCommand(int argc, char* argv[], json_object** out) WARN_UNUSED_RESULT;
+  common::Error ParserResponceResponceCommand(const CommandArgsView& argv, json_object** out) WARN_UNUSED_RESULT;
+  common::Error HandleChannelsResponce(const CommandArgsView& argv, ChannelsInfo* chan) WARN_UNUSED_RESULT;
+  void UpdateChannelsCache(const ChannelsInfo& chan, const std::string& version);
 
   fastotv::inner::InnerClient* inner_connection_;
+  std::vector<std::string> commands_;  // decoded commands, strings capacity reused between reads
   std::vector<bandwidth::TcpBandwidthClient*> bandwidth_requests_;
   common::libev::timer_id_t ping_server_id_timer_;
 
   const StartConfig config_;
 
   bandwidth_t current_bandwidth_;
+  request_handlers_t request_handlers_;
+  responce_handlers_t responce_handlers_;
+
+  bool channels_cache_loaded_;
+  ChannelsInfo channels_cache_;  // base for channels delta
+  std::string channels_cache_version_;
 };
 
 }  // namespace inner
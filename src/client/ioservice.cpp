@@ -123,7 +123,10 @@ class PrivateHandler : public inner::InnerTcpHandler {
 };
 }  // namespace
 
-IoService::IoService() : ILoopController(), loop_thread_(THREAD_MANAGER()->CreateThread(&IoService::Exec, this)) {}
+IoService::IoService(const std::string& channels_cache_path)
+    : ILoopController(),
+      channels_cache_path_(channels_cache_path),
+      loop_thread_(THREAD_MANAGER()->CreateThread(&IoService::Exec, this)) {}
 
 void IoService::Start() {
   ILoopController::Start();
@@ -188,6 +191,7 @@ common::libev::IoLoopObserver* IoService::CreateHandler() {
   inner::StartConfig conf;
   conf.inner_host = common::net::HostAndPort(SERVICE_HOST_NAME, SERVICE_HOST_PORT);
   conf.ainf = AuthInfo(USER_LOGIN, USER_PASSWORD, USER_DEVICE_ID);
+  conf.channels_cache_path = channels_cache_path_;
   PrivateHandler* handler = new PrivateHandler(conf);
   return handler;
 }
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include <common/libev/io_loop.h>           // for IoLoop
 #include <common/libev/io_loop_observer.h>  // for IoLoopObserver
@@ -39,7 +40,7 @@ namespace client {
 
 class IoService : public common::libev::ILoopController {
  public:
-  IoService();
+  explicit IoService(const std::string& channels_cache_path);  // empty - channels not cached between sessions
   virtual ~IoService();
 
   void Start();
@@ -61,6 +62,7 @@ class IoService : public common::libev::ILoopController {
   virtual void HandleStarted() override;
   virtual void HandleStoped() override;
 
+  const std::string channels_cache_path_;
   std::shared_ptr<common::threads::Thread<int> > loop_thread_;
 };
 
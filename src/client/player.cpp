@@ -49,6 +49,7 @@
 #define IMG_DOWN_BUTTON_PATH_RELATIVE "share/resources/down_arrow.png"
 
 #define CACHE_FOLDER_NAME "cache"
+#define CHANNELS_CACHE_FILE_NAME "channels.json"
 
 #define FOOTER_HIDE_DELAY_MSEC 2000  // 2 sec
 #define KEYPAD_HIDE_DELAY_MSEC 3000  // 3 sec
@@ -88,7 +89,8 @@ Player::Player(const std::string& app_directory_absolute_path,
       hide_playlist_button_(nullptr),
       show_chat_button_(nullptr),
       hide_chat_button_(nullptr),
-      controller_(new IoService),
+      controller_(new IoService(
+          common::file_system::make_path(app_directory_absolute_path, CHANNELS_CACHE_FILE_NAME))),
       current_stream_pos_(0),
       play_list_(),
       description_label_(nullptr),
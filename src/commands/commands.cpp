@@ -18,7 +18,193 @@
 
 #include "commands/commands.h"
 
+#include <ctype.h>   // for isspace
+#include <string.h>  // for memcpy, strcmp
+
+#include <algorithm>  // for count
+#include <utility>    // for make_pair, pair
+
+#include <common/sys_byteorder.h>  // for HostToNet32
+
+#define BINARY_FLAG_SUCCESS 0x01
+#define BINARY_FLAG_FAIL 0x02
+#define BINARY_FLAG_TEXT_SEQ 0x04  // seq follows header as string
+
+#define BINARY_SEQ_SIZE 16  // hex chars of NextRequestID
+
+#define STATIC_STRING(STR) \
+  { STR, sizeof(STR) - 1 }
+
 namespace fastotv {
+namespace {
+
+struct StaticString {
+  const char* data;
+  size_t size;
+};
+
+// sizes known at compile time, text commands written without format parsing and strlen
+constexpr StaticString opcode_commands[] = {{nullptr, 0},
+                                            STATIC_STRING(CLIENT_PING),
+                                            STATIC_STRING(CLIENT_GET_SERVER_INFO),
+                                            STATIC_STRING(CLIENT_GET_CHANNELS),
+                                            STATIC_STRING(CLIENT_GET_RUNTIME_CHANNEL_INFO),
+                                            STATIC_STRING(CLIENT_SEND_CHAT_MESSAGE),
+                                            STATIC_STRING(SERVER_PING),
+                                            STATIC_STRING(SERVER_WHO_ARE_YOU),
+                                            STATIC_STRING(SERVER_GET_CLIENT_INFO),
+                                            STATIC_STRING(SERVER_SEND_CHAT_MESSAGE)};
+static_assert(SIZEOFMASS(opcode_commands) == OPCODE_COUNT, "opcode_commands should cover all opcodes");
+
+constexpr StaticString unknown_command = STATIC_STRING("null");
+constexpr StaticString end_of_command = STATIC_STRING(END_OF_COMMAND);
+constexpr StaticString state_prefixes[] = {STATIC_STRING(""),
+                                           STATIC_STRING(SUCCESS_COMMAND " "),
+                                           STATIC_STRING(FAIL_COMMAND " ")};
+static_assert(SIZEOFMASS(state_prefixes) == STATE_FAIL + 1, "state_prefixes should cover all states");
+
+struct CommandOpcode {
+  const char* command;
+  cmd_opcode_t opcode;
+};
+
+// sorted by name for binary search, checked at compile time
+constexpr CommandOpcode sorted_commands[] = {{CLIENT_PING, OPCODE_CLIENT_PING},
+                                             {CLIENT_SEND_CHAT_MESSAGE, OPCODE_CLIENT_SEND_CHAT_MESSAGE},
+                                             {CLIENT_GET_CHANNELS, OPCODE_CLIENT_GET_CHANNELS},
+                                             {SERVER_GET_CLIENT_INFO, OPCODE_SERVER_GET_CLIENT_INFO},
+                                             {CLIENT_GET_RUNTIME_CHANNEL_INFO, OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO},
+                                             {CLIENT_GET_SERVER_INFO, OPCODE_CLIENT_GET_SERVER_INFO},
+                                             {SERVER_PING, OPCODE_SERVER_PING},
+                                             {SERVER_SEND_CHAT_MESSAGE, OPCODE_SERVER_SEND_CHAT_MESSAGE},
+                                             {SERVER_WHO_ARE_YOU, OPCODE_SERVER_WHO_ARE_YOU}};
+
+constexpr int CompareCommands(const char* first, const char* second) {
+  return *first != *second ? (*first < *second ? -1 : 1) : !*first ? 0 : CompareCommands(first + 1, second + 1);
+}
+
+constexpr bool IsSortedCommands(size_t pos) {
+  return pos + 1 >= SIZEOFMASS(sorted_commands) ||
+         (CompareCommands(sorted_commands[pos].command, sorted_commands[pos + 1].command) < 0 &&
+          IsSortedCommands(pos + 1));
+}
+
+static_assert(SIZEOFMASS(sorted_commands) == OPCODE_COUNT - 1, "sorted_commands should cover all known opcodes");
+static_assert(IsSortedCommands(0), "sorted_commands should be sorted by name");
+
+bool SeqToBinary(const cmd_seq_t& seq, uint64_t* out) {
+  if (seq.size() != BINARY_SEQ_SIZE) {
+    return false;
+  }
+
+  uint64_t result = 0;
+  for (char c : seq) {  // only lower case, the same as NextRequestID, so seq restored exactly
+    uint64_t digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else {
+      return false;
+    }
+    result = (result << 4) | digit;
+  }
+
+  *out = result;
+  return true;
+}
+
+cmd_seq_t BinaryToSeq(uint64_t seq) {
+  static const char digits[] = "0123456789abcdef";
+  char buff[BINARY_SEQ_SIZE];
+  for (size_t i = 0; i < BINARY_SEQ_SIZE; ++i) {
+    buff[BINARY_SEQ_SIZE - 1 - i] = digits[seq & 0xf];
+    seq >>= 4;
+  }
+  return cmd_seq_t(buff, BINARY_SEQ_SIZE);
+}
+
+// writes into memory reserved by caller, sizes counted before
+class TextCommandWriter {
+ public:
+  explicit TextCommandWriter(char* pos) : pos_(pos) {}
+
+  void Write(const char* data, size_t size) {
+    memcpy(pos_, data, size);
+    pos_ += size;
+  }
+
+  void Write(const StaticString& str) { Write(str.data, str.size); }
+
+  void Write(char c) { *pos_++ = c; }
+
+  void WriteNumber(uint8_t value) {
+    if (value >= 100) {
+      Write(static_cast<char>('0' + value / 100));
+    }
+    if (value >= 10) {
+      Write(static_cast<char>('0' + value / 10 % 10));
+    }
+    Write(static_cast<char>('0' + value % 10));
+  }
+
+  void WriteQuoted(const common::StringPiece& arg) {
+    Write('\'');
+    const char* data = arg.data();
+    const char* end = data + arg.size();
+    while (const char* quote = static_cast<const char*>(memchr(data, '\'', end - data))) {
+      Write(data, quote - data);
+      Write("\\'", 2);
+      data = quote + 1;
+    }
+    Write(data, end - data);
+    Write('\'');
+  }
+
+  char* GetPos() const { return pos_; }
+
+ private:
+  char* pos_;
+};
+
+size_t NumberSize(uint8_t value) {
+  return value >= 100 ? 3 : value >= 10 ? 2 : 1;
+}
+
+size_t QuotedSize(const common::StringPiece& arg) {
+  return arg.size() + std::count(arg.data(), arg.data() + arg.size(), '\'') + 2;
+}
+
+char CharAt(const char* p, const char* end, size_t offset) {
+  return static_cast<size_t>(end - p) > offset ? p[offset] : '\0';
+}
+
+bool IsHexDigit(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+int HexDigitToInt(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return c - 'A' + 10;
+}
+
+template <typename T>
+void AppendNumber(T value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T ReadNumber(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+}  // namespace
 
 std::string CmdIdToString(cmd_id_t id) {
   static const std::string seq_names[] = {"REQUEST", "RESPONCE", "APPROVE"};
@@ -30,6 +216,72 @@ std::string CmdIdToString(cmd_id_t id) {
   return std::string();
 }
 
+const char* OpcodeToCommand(cmd_opcode_t opcode) {
+  if (opcode < OPCODE_COUNT) {
+    return opcode_commands[opcode].data;
+  }
+
+  return nullptr;
+}
+
+cmd_opcode_t CommandToOpcode(const char* command) {
+  if (!command) {
+    return OPCODE_UNKNOWN;
+  }
+
+  size_t first = 0;
+  size_t last = SIZEOFMASS(sorted_commands);
+  while (first < last) {
+    const size_t middle = first + (last - first) / 2;
+    const int res = strcmp(command, sorted_commands[middle].command);
+    if (res == 0) {
+      return sorted_commands[middle].opcode;
+    }
+
+    if (res < 0) {
+      last = middle;
+    } else {
+      first = middle + 1;
+    }
+  }
+
+  return OPCODE_UNKNOWN;
+}
+
+cmd_state_t CommandToState(const char* state) {
+  if (!state) {
+    return STATE_NONE;
+  }
+
+  if (strcmp(state, SUCCESS_COMMAND) == 0) {
+    return STATE_SUCCESS;
+  } else if (strcmp(state, FAIL_COMMAND) == 0) {
+    return STATE_FAIL;
+  }
+
+  return STATE_NONE;
+}
+
+bool ConvertFromString(const std::string& from, protocol_version_t* out) {
+  if (!out) {
+    return false;
+  }
+
+  if (from == "1") {
+    *out = PROTOCOL_V1;
+    return true;
+  } else if (from == "2") {
+    *out = PROTOCOL_V2;
+    return true;
+  }
+
+  return false;
+}
+
+std::string ConvertToString(protocol_version_t version) {
+  return version == PROTOCOL_V2 ? "2" : "1";
+}
+
 common::Error StableCommand(const std::string& command, std::string* stabled_command) {
   if (command.empty() || !stabled_command) {
     return common::make_error("Prepare commands, invalid input");
@@ -44,34 +296,381 @@ common::Error StableCommand(const std::string& command, std::string* stabled_com
   return common::Error();
 }
 
-common::Error ParseCommand(const std::string& command, cmd_id_t* cmd_id, cmd_seq_t* seq_id, std::string* cmd_str) {
+common::Error ParseCommand(const std::string& command,
+                           cmd_id_t* cmd_id,
+                           cmd_seq_t* seq_id,
+                           common::StringPiece* cmd_str) {
   if (command.empty() || !cmd_id || !seq_id || !cmd_str) {
     return common::make_error("Parse command, invalid input");
   }
 
-  std::string stabled_command;
-  common::Error err = StableCommand(command, &stabled_command);
-  if (err) {
-    return err;
+  size_t pos = command.find_last_of(END_OF_COMMAND);
+  if (pos == std::string::npos || pos == 0) {
+    return common::make_error("UNKNOWN SEQUENCE: " + command);
   }
 
+  const char* start = command.c_str();
+  const char* end = start + pos - 1;  // the same as StableCommand
   char* star_seq = NULL;
-  cmd_id_t lcmd_id = strtoul(stabled_command.c_str(), &star_seq, 10);
-  if (*star_seq != ' ') {
+  cmd_id_t lcmd_id = strtoul(start, &star_seq, 10);
+  if (star_seq >= end || *star_seq != ' ') {
     return common::make_error("PROBLEM EXTRACTING SEQUENCE: " + command);
   }
 
-  const char* id_ptr = strchr(star_seq + 1, ' ');
+  const char* seq_start = star_seq + 1;
+  const char* id_ptr = static_cast<const char*>(memchr(seq_start, ' ', end - seq_start));
   if (!id_ptr) {
     return common::make_error("PROBLEM EXTRACTING ID: " + command);
   }
 
-  ptrdiff_t len_seq = id_ptr - (star_seq + 1);
-  cmd_seq_t lseq_id = cmd_seq_t(star_seq + 1, len_seq);
+  *cmd_id = lcmd_id;
+  seq_id->assign(seq_start, id_ptr - seq_start);
+  *cmd_str = common::StringPiece(id_ptr + 1, end - (id_ptr + 1));
+  return common::Error();
+}
+
+common::Error ParseCommand(const std::string& command, cmd_id_t* cmd_id, cmd_seq_t* seq_id, std::string* cmd_str) {
+  if (!cmd_str) {
+    return common::make_error("Parse command, invalid input");
+  }
+
+  common::StringPiece lcmd_str(nullptr, 0);
+  common::Error err = ParseCommand(command, cmd_id, seq_id, &lcmd_str);
+  if (err) {
+    return err;
+  }
+
+  cmd_str->assign(lcmd_str.data(), lcmd_str.size());
+  return common::Error();
+}
+
+common::Error SplitCommandArgs(const char* line,
+                               size_t size,
+                               std::string* buffer,
+                               std::vector<common::StringPiece>* argv) {
+  if (!line || !buffer || !argv) {
+    return common::make_error("Split command, invalid input");
+  }
+
+  const char* nul = static_cast<const char*>(memchr(line, 0, size));
+  const char* end = nul ? nul : line + size;  // zero ends line, the same as for sdssplitargslong
+  // unquoting only shrinks, so tokens with terminating zeros fit in twice the line, buffer never reallocated
+  const size_t required = (end - line) * 2 + 1;
+  if (buffer->size() < required) {
+    buffer->resize(required);
+  }
+
+  char* out = &(*buffer)[0];
+  argv->clear();
+  const char* p = line;
+  while (true) {
+    while (p != end && *p == ' ') {  // skip blanks
+      p++;
+    }
+    if (p == end) {
+      return common::Error();
+    }
+
+    char* token = out;
+    bool in_quotes = false;
+    bool in_single_quotes = false;
+    size_t json_depth = 0;
+    bool done = false;
+    while (!done) {
+      const char c = CharAt(p, end, 0);
+      const char next = CharAt(p, end, 1);
+      if (in_quotes) {
+        if (c == '\\' && next == 'x' && IsHexDigit(CharAt(p, end, 2)) && IsHexDigit(CharAt(p, end, 3))) {
+          *out++ = static_cast<char>(HexDigitToInt(p[2]) * 16 + HexDigitToInt(p[3]));
+          p += 3;
+        } else if (c == '"') {
+          if (next && !isspace(next)) {  // closing quote must be followed by a space or nothing at all
+            return common::make_error("Invalid closing quote");
+          }
+          done = true;
+        } else if (!c) {
+          return common::make_error("Unterminated quotes");
+        } else {
+          *out++ = c;
+        }
+      } else if (in_single_quotes) {
+        if (c == '\\' && next == '\'') {
+          p++;
+          *out++ = '\'';
+        } else if (c == '\'') {
+          if (next && !isspace(next)) {
+            return common::make_error("Invalid closing quote");
+          }
+          done = true;
+        } else if (!c) {
+          return common::make_error("Unterminated quotes");
+        } else {
+          *out++ = c;
+        }
+      } else if (json_depth) {
+        if (c == '\\' && next == '}') {
+          p++;
+          *out++ = '}';
+        } else if (c == '{') {
+          json_depth++;
+          *out++ = c;
+        } else if (c == '}') {
+          *out++ = c;
+          if (json_depth == 1) {
+            done = true;
+          } else {
+            json_depth--;
+          }
+        } else if (!c) {
+          return common::make_error("Unterminated json");
+        } else {
+          *out++ = c;
+        }
+      } else {
+        switch (c) {
+          case ' ':
+          case '\0':
+            done = true;
+            break;
+          case '"':
+            in_quotes = true;
+            break;
+          case '\'':
+            in_single_quotes = true;
+            break;
+          case '{':
+            json_depth = 1;
+            *out++ = c;
+            break;
+          default:
+            *out++ = c;
+            break;
+        }
+      }
+      if (p != end) {
+        p++;
+      }
+    }
+
+    argv->push_back(common::StringPiece(token, out - token));
+    *out++ = 0;
+  }
+}
+
+void AppendCommandArg(const common::StringPiece& arg, std::string* out) {
+  AppendNumber(common::HostToNet32(arg.size()), out);
+  out->append(arg.data(), arg.size());
+}
+
+bool ReadCommandArg(const cmd_args_t& args, size_t* pos, common::StringPiece* arg) {
+  if (args.size() - *pos < sizeof(uint32_t)) {
+    return false;
+  }
+
+  const uint32_t size = common::NetToHost32(ReadNumber<uint32_t>(args.data() + *pos));
+  DCHECK(args.size() - *pos - sizeof(uint32_t) >= size);
+  *arg = common::StringPiece(args.data() + *pos + sizeof(uint32_t), size);
+  *pos += sizeof(uint32_t) + size;
+  return true;
+}
+
+void WriteTextCommand(cmd_id_t cmd_id,
+                      const cmd_seq_t& id,
+                      cmd_opcode_t opcode,
+                      cmd_state_t state,
+                      const cmd_args_t& args,
+                      std::string* out) {
+  if (!out) {
+    return;
+  }
+
+  const StaticString& command =
+      opcode != OPCODE_UNKNOWN && opcode < OPCODE_COUNT ? opcode_commands[opcode] : unknown_command;
+  DCHECK(command.data != unknown_command.data);
+  const StaticString& state_prefix = state_prefixes[state <= STATE_FAIL ? state : STATE_NONE];
+
+  size_t size = NumberSize(cmd_id) + 1 + id.size() + 1 + state_prefix.size + command.size + end_of_command.size;
+  size_t pos = 0;
+  common::StringPiece arg;
+  while (ReadCommandArg(args, &pos, &arg)) {
+    size += 1 + QuotedSize(arg);
+  }
+
+  out->resize(size);  // capacity of out reused, so no allocations for commands not bigger than previous
+  TextCommandWriter writer(&(*out)[0]);
+  writer.WriteNumber(cmd_id);
+  writer.Write(' ');
+  writer.Write(id.data(), id.size());
+  writer.Write(' ');
+  writer.Write(state_prefix);
+  writer.Write(command);
+  pos = 0;
+  while (ReadCommandArg(args, &pos, &arg)) {
+    writer.Write(' ');
+    writer.WriteQuoted(arg);
+  }
+  writer.Write(end_of_command);
+  DCHECK(writer.GetPos() == out->data() + size);
+}
+
+std::string MakeTextCommand(cmd_id_t cmd_id,
+                            const cmd_seq_t& id,
+                            cmd_opcode_t opcode,
+                            cmd_state_t state,
+                            const cmd_args_t& args) {
+  std::string result;
+  WriteTextCommand(cmd_id, id, opcode, state, args, &result);
+  return result;
+}
+
+void AppendQuotedArg(const common::StringPiece& arg, std::string* out) {
+  if (!out) {
+    return;
+  }
+
+  const size_t pos = out->size();
+  const size_t size = QuotedSize(arg);
+  out->resize(pos + size);
+  TextCommandWriter writer(&(*out)[pos]);
+  writer.WriteQuoted(arg);
+}
+
+void WriteTextCommandHead(cmd_id_t cmd_id, const cmd_seq_t& id, std::string* out) {
+  if (!out) {
+    return;
+  }
+
+  const size_t size = NumberSize(cmd_id) + 1 + id.size();
+  out->resize(size);
+  TextCommandWriter writer(&(*out)[0]);
+  writer.WriteNumber(cmd_id);
+  writer.Write(' ');
+  writer.Write(id.data(), id.size());
+}
+
+common::Error MakeBinaryCommand(cmd_id_t cmd_id,
+                                const cmd_seq_t& id,
+                                cmd_opcode_t opcode,
+                                cmd_state_t state,
+                                const cmd_args_t& args,
+                                std::string* out) {
+  if (opcode == OPCODE_UNKNOWN || opcode >= OPCODE_COUNT || !out) {
+    return common::make_error_inval();
+  }
+
+  const size_t payload_size = args.size();  // packed in payload format
+  uint64_t seq = 0;
+  uint8_t flags = state == STATE_SUCCESS ? BINARY_FLAG_SUCCESS : state == STATE_FAIL ? BINARY_FLAG_FAIL : 0;
+  const bool text_seq = !SeqToBinary(id, &seq);
+  if (text_seq) {
+    if (id.size() > UINT16_MAX) {
+      return common::make_error("Too long request id");
+    }
+    flags |= BINARY_FLAG_TEXT_SEQ;
+  }
+
+  out->clear();
+  out->reserve(BINARY_COMMAND_HEADER_SIZE + (text_seq ? sizeof(uint16_t) + id.size() : 0) + payload_size);
+  out->push_back(static_cast<char>(BINARY_COMMAND_MAGIC));
+  out->push_back(static_cast<char>(cmd_id));
+  out->push_back(static_cast<char>(opcode));
+  out->push_back(static_cast<char>(flags));
+  AppendNumber(common::HostToNet32(payload_size), out);
+  AppendNumber(common::HostToNet64(seq), out);
+  if (text_seq) {
+    AppendNumber(common::HostToNet16(id.size()), out);
+    out->append(id);
+  }
+  out->append(args);
+  return common::Error();
+}
+
+bool IsBinaryCommand(const std::string& command) {
+  return !command.empty() && static_cast<uint8_t>(command[0]) == BINARY_COMMAND_MAGIC;
+}
+
+common::Error ParseBinaryCommand(const std::string& command,
+                                 cmd_id_t* cmd_id,
+                                 cmd_seq_t* seq_id,
+                                 std::string* args_buffer,
+                                 std::vector<common::StringPiece>* argv) {
+  if (!cmd_id || !seq_id || !args_buffer || !argv) {
+    return common::make_error("Parse binary command, invalid input");
+  }
+
+  if (command.size() < BINARY_COMMAND_HEADER_SIZE || !IsBinaryCommand(command)) {
+    return common::make_error("Invalid binary command header");
+  }
+
+  const char* data = command.data();
+  const cmd_id_t lcmd_id = data[1];
+  const cmd_opcode_t opcode = static_cast<cmd_opcode_t>(data[2]);
+  const uint8_t flags = data[3];
+  const uint32_t payload_size = common::NetToHost32(ReadNumber<uint32_t>(data + 4));
+  const uint64_t seq = common::NetToHost64(ReadNumber<uint64_t>(data + 8));
+  const char* command_name = OpcodeToCommand(opcode);
+  if (lcmd_id > APPROVE_COMMAND || !command_name) {
+    return common::make_error(common::MemSPrintf("Invalid binary command type: %u, opcode: %u", lcmd_id, opcode));
+  }
+
+  size_t pos = BINARY_COMMAND_HEADER_SIZE;
+  cmd_seq_t lseq_id;
+  if (flags & BINARY_FLAG_TEXT_SEQ) {
+    if (command.size() - pos < sizeof(uint16_t)) {
+      return common::make_error("Invalid binary command seq");
+    }
+    const uint16_t seq_size = common::NetToHost16(ReadNumber<uint16_t>(data + pos));
+    pos += sizeof(uint16_t);
+    if (command.size() - pos < seq_size) {
+      return common::make_error("Invalid binary command seq");
+    }
+    lseq_id.assign(data + pos, seq_size);
+    pos += seq_size;
+  } else {
+    lseq_id = BinaryToSeq(seq);
+  }
+
+  if (command.size() - pos != payload_size) {
+    return common::make_error("Invalid binary command payload size");
+  }
+
+  // [OK|FAIL]\0command\0arg\0...
+  std::vector<std::pair<size_t, size_t> > offsets;  // offset, size
+  args_buffer->clear();
+  args_buffer->reserve(payload_size + 32);
+  if (flags & (BINARY_FLAG_SUCCESS | BINARY_FLAG_FAIL)) {
+    const char* state_name = flags & BINARY_FLAG_FAIL ? FAIL_COMMAND : SUCCESS_COMMAND;
+    offsets.push_back(std::make_pair(args_buffer->size(), strlen(state_name)));
+    args_buffer->append(state_name);
+    args_buffer->push_back(0);
+  }
+  offsets.push_back(std::make_pair(args_buffer->size(), strlen(command_name)));
+  args_buffer->append(command_name);
+  args_buffer->push_back(0);
+
+  while (pos != command.size()) {
+    if (command.size() - pos < sizeof(uint32_t)) {
+      return common::make_error("Invalid binary command argument");
+    }
+    const uint32_t arg_size = common::NetToHost32(ReadNumber<uint32_t>(data + pos));
+    pos += sizeof(uint32_t);
+    if (command.size() - pos < arg_size) {
+      return common::make_error("Invalid binary command argument");
+    }
+    offsets.push_back(std::make_pair(args_buffer->size(), static_cast<size_t>(arg_size)));
+    args_buffer->append(data + pos, arg_size);
+    args_buffer->push_back(0);
+    pos += arg_size;
+  }
+
+  argv->clear();
+  argv->reserve(offsets.size());
+  for (const auto& offset : offsets) {  // buffer not changed anymore
+    argv->push_back(common::StringPiece(args_buffer->data() + offset.first, offset.second));
+  }
 
   *cmd_id = lcmd_id;
   *seq_id = lseq_id;
-  *cmd_str = id_ptr + 1;
   return common::Error();
 }
 
@@ -20,8 +20,14 @@
 
 #include <inttypes.h>
 
+#include <string>   // for string
+#include <utility>  // for move
+#include <vector>   // for vector
+
 #include <common/error.h>
+#include <common/macros.h>
 #include <common/sprintf.h>
+#include <common/string_piece.h>
 
 #include "client_server_types.h"
 
@@ -34,12 +40,6 @@
 
 #define CID_FMT PRIu8
 
-#define GENERATE_REQUEST_FMT(CMD) "%" CID_FMT " %s " CMD END_OF_COMMAND
-#define GENERATE_REQUEST_FMT_ARGS(CMD, CMD_FMT) "%" CID_FMT " %s " CMD " " CMD_FMT END_OF_COMMAND
-
-#define GENEATATE_SUCCESS_FMT(CMD, CMD_FMT) "%" CID_FMT " %s " SUCCESS_COMMAND " " CMD " " CMD_FMT END_OF_COMMAND
-#define GENEATATE_FAIL_FMT(CMD, CMD_FMT) "%" CID_FMT " %s " FAIL_COMMAND " " CMD " " CMD_FMT END_OF_COMMAND
-
 #define REQUEST_COMMAND 0
 #define RESPONCE_COMMAND 1
 #define APPROVE_COMMAND 2
@@ -57,8 +57,13 @@
 #define SERVER_GET_CLIENT_INFO "get_client_info"
 #define SERVER_SEND_CHAT_MESSAGE "server_send_chat_message"
 
+// get_channels [version] responce: 'channels' version [sync type]
+// without sync type - full channels list
+#define CHANNELS_SYNC_DELTA "delta"
+#define CHANNELS_SYNC_NOT_MODIFIED "not_modified"
+
 // request
-// [uint8_t](0) [hex_string]seq [std::string]command
+// [uint8_t](0) [hex_string]seq [std::string]command args ...
 
 // responce
 // [uint8_t](1) [hex_string]seq [OK|FAIL] [std::string]command args ...
@@ -66,52 +71,193 @@
 // approve
 // [uint8_t](2) [hex_string]seq [OK|FAIL] [std::string]command args ...
 
+// text args are single quoted, quotes inside escaped as \'
+
+// binary protocol (v2), used after who_are_you when both sides support it, text commands still accepted
+// header: [uint8_t]magic [uint8_t]type [uint8_t]opcode [uint8_t]flags [uint32_t]payload size [uint64_t]seq
+// [uint16_t]size [bytes]seq - only if seq not 16 chars hex
+// payload: ([uint32_t]size [bytes]arg)... - raw, not quoted
+// all integers in network byte order
+#define BINARY_COMMAND_MAGIC 0xF2
+#define BINARY_COMMAND_HEADER_SIZE 16
+
 namespace fastotv {
 
 typedef std::string cmd_seq_t;
 typedef uint8_t cmd_id_t;
+typedef std::string cmd_args_t;  // packed as binary payload: ([uint32_t]size [bytes]arg)...
+
+enum protocol_version_t : uint8_t { PROTOCOL_V1 = 1, PROTOCOL_V2 = 2 };
+
+enum cmd_opcode_t : uint8_t {
+  OPCODE_UNKNOWN = 0,  // text command only
+  OPCODE_CLIENT_PING,
+  OPCODE_CLIENT_GET_SERVER_INFO,
+  OPCODE_CLIENT_GET_CHANNELS,
+  OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO,
+  OPCODE_CLIENT_SEND_CHAT_MESSAGE,
+  OPCODE_SERVER_PING,
+  OPCODE_SERVER_WHO_ARE_YOU,
+  OPCODE_SERVER_GET_CLIENT_INFO,
+  OPCODE_SERVER_SEND_CHAT_MESSAGE,
+  OPCODE_COUNT
+};
+
+enum cmd_state_t : uint8_t { STATE_NONE = 0, STATE_SUCCESS, STATE_FAIL };  // requests without state
 
 std::string CmdIdToString(cmd_id_t id);
+const char* OpcodeToCommand(cmd_opcode_t opcode);  // nullptr if unknown
+cmd_opcode_t CommandToOpcode(const char* command);  // exact match, OPCODE_UNKNOWN if unknown
+cmd_state_t CommandToState(const char* state);      // STATE_NONE if not [OK|FAIL]
+bool ConvertFromString(const std::string& from, protocol_version_t* out);
+std::string ConvertToString(protocol_version_t version);
 
 common::Error StableCommand(const std::string& command, std::string* stabled_command);
 common::Error ParseCommand(const std::string& command, cmd_id_t* cmd_id, cmd_seq_t* seq_id, std::string* cmd_str);
+// cmd_str points into command
+common::Error ParseCommand(const std::string& command,
+                           cmd_id_t* cmd_id,
+                           cmd_seq_t* seq_id,
+                           common::StringPiece* cmd_str) WARN_UNUSED_RESULT;
+// the same rules as sdssplitargslong: "quoted \xHH", 'quoted \'', {json}
+// tokens zero terminated in buffer, which capacity reused between calls, argv points into buffer
+common::Error SplitCommandArgs(const char* line,
+                               size_t size,
+                               std::string* buffer,
+                               std::vector<common::StringPiece>* argv) WARN_UNUSED_RESULT;
+
+// arguments of parsed command passed to handlers: [OK|FAIL] command args ...,
+// pieces point into parser buffer and also zero terminated there, valid while command handled
+class CommandArgsView {
+ public:
+  CommandArgsView(const common::StringPiece* args, size_t count) : args_(args), count_(count) {}
+
+  size_t size() const { return count_; }
+  const common::StringPiece& operator[](size_t index) const { return args_[index]; }
+
+ private:
+  const common::StringPiece* args_;
+  size_t count_;
+};
+
+// args packed once from string pieces by MakeCommandArgs, not copied again when command made
+void AppendCommandArg(const common::StringPiece& arg, std::string* out);
+bool ReadCommandArg(const cmd_args_t& args, size_t* pos, common::StringPiece* arg);  // pos moved to next arg
+
+inline size_t CommandArgsSize() {
+  return 0;
+}
+
+template <typename... Args>
+size_t CommandArgsSize(const common::StringPiece& arg, const Args&... args) {
+  return sizeof(uint32_t) + arg.size() + CommandArgsSize(args...);
+}
+
+inline void AppendCommandArgs(std::string* out) {
+  UNUSED(out);
+}
+
+template <typename... Args>
+void AppendCommandArgs(std::string* out, const common::StringPiece& arg, const Args&... args) {
+  AppendCommandArg(arg, out);
+  AppendCommandArgs(out, args...);
+}
+
+template <typename... Args>
+cmd_args_t MakeCommandArgs(const Args&... args) {
+  cmd_args_t packed;
+  packed.reserve(CommandArgsSize(args...));
+  AppendCommandArgs(&packed, args...);
+  return packed;
+}
+
+// out cleared and its capacity reused, one allocation at most
+void WriteTextCommand(cmd_id_t cmd_id,
+                      const cmd_seq_t& id,
+                      cmd_opcode_t opcode,
+                      cmd_state_t state,
+                      const cmd_args_t& args,
+                      std::string* out);
+std::string MakeTextCommand(cmd_id_t cmd_id,
+                            const cmd_seq_t& id,
+                            cmd_opcode_t opcode,
+                            cmd_state_t state,
+                            const cmd_args_t& args);
+void WriteTextCommandHead(cmd_id_t cmd_id, const cmd_seq_t& id, std::string* out);  // [uint8_t]type [hex_string]seq
+void AppendQuotedArg(const common::StringPiece& arg, std::string* out);
+common::Error MakeBinaryCommand(cmd_id_t cmd_id,
+                                const cmd_seq_t& id,
+                                cmd_opcode_t opcode,
+                                cmd_state_t state,
+                                const cmd_args_t& args,
+                                std::string* out) WARN_UNUSED_RESULT;
+bool IsBinaryCommand(const std::string& command);
+// argv points into args_buffer: [OK|FAIL] command args ..., the same as sdssplitargslong of text command
+common::Error ParseBinaryCommand(const std::string& command,
+                                 cmd_id_t* cmd_id,
+                                 cmd_seq_t* seq_id,
+                                 std::string* args_buffer,
+                                 std::vector<common::StringPiece>* argv) WARN_UNUSED_RESULT;
 
 template <cmd_id_t cmd_id>
 class InnerCmd {
  public:
-  InnerCmd(cmd_seq_t id, const std::string& cmd) : id_(id), cmd_(cmd) {}
+  InnerCmd(cmd_seq_t id, const std::string& cmd)  // text only
+      : id_(id), opcode_(OPCODE_UNKNOWN), state_(STATE_NONE), args_(), cmd_(cmd) {}
+  InnerCmd(cmd_seq_t id, cmd_opcode_t opcode, cmd_state_t state, cmd_args_t args)
+      : id_(id), opcode_(opcode), state_(state), args_(std::move(args)), cmd_() {}
 
   static cmd_id_t GetType() { return cmd_id; }
 
   cmd_seq_t GetId() const { return id_; }
 
-  const std::string& GetCmd() const { return cmd_; }
+  const std::string& GetCmd() const {  // text, made on first call
+    if (cmd_.empty()) {
+      cmd_ = MakeTextCommand(cmd_id, id_, opcode_, state_, args_);
+    }
+    return cmd_;
+  }
+
+  void WriteCmd(std::string* out) const {  // text into caller buffer, not cached
+    if (!cmd_.empty()) {
+      *out = cmd_;
+      return;
+    }
+    WriteTextCommand(cmd_id, id_, opcode_, state_, args_, out);
+  }
+
+  bool IsBinarySupported() const { return opcode_ != OPCODE_UNKNOWN; }
+
+  common::Error GetBinaryCmd(std::string* out) const WARN_UNUSED_RESULT {
+    return MakeBinaryCommand(cmd_id, id_, opcode_, state_, args_, out);
+  }
 
  private:
   const cmd_seq_t id_;
-  const std::string cmd_;
+  const cmd_opcode_t opcode_;
+  const cmd_state_t state_;
+  cmd_args_t args_;  // not const, moved with command
+  mutable std::string cmd_;
 };
 
 typedef InnerCmd<REQUEST_COMMAND> cmd_request_t;
 typedef InnerCmd<RESPONCE_COMMAND> cmd_responce_t;
 typedef InnerCmd<APPROVE_COMMAND> cmd_approve_t;
 
+// args - anything convertible to common::StringPiece, copied once into packed args
 template <typename... Args>
-cmd_request_t MakeRequest(cmd_seq_t id, const char* cmd_fmt, Args... args) {
-  std::string buff = common::MemSPrintf(cmd_fmt, REQUEST_COMMAND, id, args...);
-  return cmd_request_t(id, buff);
+inline cmd_request_t MakeRequest(cmd_seq_t id, cmd_opcode_t opcode, const Args&... args) {
+  return cmd_request_t(id, opcode, STATE_NONE, MakeCommandArgs(args...));
 }
 
 template <typename... Args>
-cmd_approve_t MakeApproveResponce(cmd_seq_t id, const char* cmd_fmt, Args... args) {
-  std::string buff = common::MemSPrintf(cmd_fmt, APPROVE_COMMAND, id, args...);
-  return cmd_approve_t(id, buff);
+inline cmd_approve_t MakeApproveResponce(cmd_seq_t id, cmd_state_t state, cmd_opcode_t opcode, const Args&... args) {
+  return cmd_approve_t(id, opcode, state, MakeCommandArgs(args...));
 }
 
 template <typename... Args>
-cmd_responce_t MakeResponce(cmd_seq_t id, const char* cmd_fmt, Args... args) {
-  std::string buff = common::MemSPrintf(cmd_fmt, RESPONCE_COMMAND, id, args...);
-  return cmd_responce_t(id, buff);
+inline cmd_responce_t MakeResponce(cmd_seq_t id, cmd_state_t state, cmd_opcode_t opcode, const Args&... args) {
+  return cmd_responce_t(id, opcode, state, MakeCommandArgs(args...));
 }
 
 }  // namespace fastotv
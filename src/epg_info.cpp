@@ -100,103 +100,6 @@ common::uri::Url EpgInfo::GetIconUrl() const {
   return icon_src_;
 }
 
-common::Error EpgInfo::SerializeImpl(serialize_type* deserialized) const {
-  if (!IsValid()) {
-    return common::make_error_inval();
-  }
-
-  json_object* obj = json_object_new_object();
-  json_object_object_add(obj, EPG_INFO_ID_FIELD, json_object_new_string(channel_id_.c_str()));
-  const std::string url_str = uri_.GetUrl();
-  json_object_object_add(obj, EPG_INFO_URL_FIELD, json_object_new_string(url_str.c_str()));
-  json_object_object_add(obj, EPG_INFO_NAME_FIELD, json_object_new_string(display_name_.c_str()));
-  const std::string icon_url_str = icon_src_.GetUrl();
-  json_object_object_add(obj, EPG_INFO_ICON_FIELD, json_object_new_string(icon_url_str.c_str()));
-
-  json_object* jprograms = json_object_new_array();
-  for (ProgrammeInfo prog : programs_) {
-    json_object* jprog = NULL;
-    common::Error err = prog.Serialize(&jprog);
-    if (err) {
-      continue;
-    }
-    json_object_array_add(jprograms, jprog);
-  }
-  json_object_object_add(obj, EPG_INFO_PROGRAMS_FIELD, jprograms);
-
-  *deserialized = obj;
-  return common::Error();
-}
-
-common::Error EpgInfo::DeSerialize(const serialize_type& serialized, value_type* obj) {
-  if (!serialized || !obj) {
-    return common::make_error_inval();
-  }
-
-  json_object* jid = NULL;
-  json_bool jid_exists = json_object_object_get_ex(serialized, EPG_INFO_ID_FIELD, &jid);
-  if (!jid_exists) {
-    return common::make_error_inval();
-  }
-  stream_id id = json_object_get_string(jid);
-  if (id == invalid_stream_id) {
-    return common::make_error_inval();
-  }
-
-  json_object* jurl = NULL;
-  json_bool jurls_exists = json_object_object_get_ex(serialized, EPG_INFO_URL_FIELD, &jurl);
-  if (!jurls_exists) {
-    return common::make_error_inval();
-  }
-
-  common::uri::Url uri(json_object_get_string(jurl));
-  if (!uri.IsValid()) {
-    return common::make_error_inval();
-  }
-
-  json_object* jname = NULL;
-  json_bool jname_exists = json_object_object_get_ex(serialized, EPG_INFO_NAME_FIELD, &jname);
-  if (!jname_exists) {
-    return common::make_error_inval();
-  }
-
-  std::string name = json_object_get_string(jname);
-  if (name.empty()) {
-    return common::make_error_inval();
-  }
-
-  fastotv::EpgInfo url(id, uri, name);
-  if (!url.IsValid()) {
-    return common::make_error_inval();
-  }
-
-  json_object* jurl_icon = NULL;
-  json_bool jurl_icon_exists = json_object_object_get_ex(serialized, EPG_INFO_ICON_FIELD, &jurl_icon);
-  if (jurl_icon_exists) {
-    url.icon_src_ = common::uri::Url(json_object_get_string(jurl_icon));
-  }
-
-  json_object* jprogs = NULL;
-  json_bool jprogs_exists = json_object_object_get_ex(serialized, EPG_INFO_PROGRAMS_FIELD, &jprogs);
-  if (jprogs_exists) {
-    programs_t progs;
-    size_t len = json_object_array_length(jprogs);
-    for (size_t i = 0; i < len; ++i) {
-      json_object* jprog = json_object_array_get_idx(jprogs, i);
-      ProgrammeInfo prog;
-      common::Error err = ProgrammeInfo::DeSerialize(jprog, &prog);
-      if (err) {
-        continue;
-      }
-      progs.push_back(prog);
-    }
-    url.programs_ = progs;
-  }
-
-  *obj = url;
-  return common::Error();
-}
-
 bool EpgInfo::Equals(const EpgInfo& url) const {
   return channel_id_ == url.channel_id_ && uri_ == url.uri_ && display_name_ == url.display_name_;
 }
@@ -210,4 +113,16 @@ bool EpgInfo::IsUnknownIconUrl(const common::uri::Url& url) {
   return url == GetUnknownIconUrl();
 }
 
+template <typename Self, typename Visitor>
+void EpgInfo::Fields(Self* self, Visitor* visitor) {
+  const serializer::field_flags_t required = serializer::FIELD_REQUIRED | serializer::FIELD_NOT_EMPTY;
+  visitor->Field(EPG_INFO_ID_FIELD, &self->channel_id_, required);
+  visitor->Field(EPG_INFO_URL_FIELD, &self->uri_, required);
+  visitor->Field(EPG_INFO_NAME_FIELD, &self->display_name_, required);
+  visitor->Field(EPG_INFO_ICON_FIELD, &self->icon_src_, serializer::FIELD_OPTIONAL);
+  visitor->Field(EPG_INFO_PROGRAMS_FIELD, &self->programs_, serializer::FIELD_OPTIONAL);
+}
+
+SERIALIZER_FIELDS_INSTANTIATE(EpgInfo);
+
 }  // namespace fastotv
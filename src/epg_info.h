@@ -23,11 +23,11 @@
 #include "client_server_types.h"
 #include "programme_info.h"
 
-#include "serializer/json_serializer.h"
+#include "serializer/fields_serializer.h"
 
 namespace fastotv {
 
-class EpgInfo : public JsonSerializer<EpgInfo> {
+class EpgInfo : public FieldsSerializer<EpgInfo> {
  public:
   typedef std::vector<ProgrammeInfo> programs_t;
   EpgInfo();
@@ -51,17 +51,16 @@ class EpgInfo : public JsonSerializer<EpgInfo> {
   void SetPrograms(const programs_t& progs);
   programs_t GetPrograms() const;
 
-  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
-
   bool Equals(const EpgInfo& url) const;
 
   static const common::uri::Url& GetUnknownIconUrl();
   static bool IsUnknownIconUrl(const common::uri::Url& url);
 
- protected:
-  common::Error SerializeImpl(serialize_type* deserialized) const override;
-
  private:
+  friend struct serializer::FieldsAccess;
+  template <typename Self, typename Visitor>
+  static void Fields(Self* self, Visitor* visitor);
+
   stream_id channel_id_;
   common::uri::Url uri_;
   std::string display_name_;
@@ -0,0 +1,122 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>  // for uint64_t
+
+#include <chrono>            // for steady_clock
+#include <functional>        // for function
+#include <initializer_list>  // for initializer_list
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "commands/commands.h"  // for cmd_opcode_t, cmd_seq_t, CommandArgsView
+
+namespace fastotv {
+namespace inner {
+
+class InnerClient;
+
+// handlers of one kind of commands (requests or responces) by opcode, with per command counters,
+// Result - return type of handler methods
+template <typename Handler, typename Result>
+class CommandHandlers {
+ public:
+  typedef Result (Handler::*handler_t)(InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  typedef std::function<void(cmd_opcode_t opcode, uint64_t elapsed_nsec)> timing_hook_t;
+
+  struct Entry {
+    cmd_opcode_t opcode;
+    handler_t handler;
+  };
+
+  struct Stats {
+    Stats() : calls(0), total_nsec(0), max_nsec(0) {}
+
+    uint64_t calls;
+    uint64_t total_nsec;
+    uint64_t max_nsec;
+  };
+
+  explicit CommandHandlers(std::initializer_list<Entry> entries) : handlers_(), stats_(), hook_() {
+    for (const Entry& entry : entries) {
+      DCHECK(entry.opcode != OPCODE_UNKNOWN && entry.opcode < OPCODE_COUNT);
+      handlers_[entry.opcode] = entry.handler;
+    }
+  }
+
+  bool Find(const char* command, cmd_opcode_t* opcode) const {
+    const cmd_opcode_t lopcode = CommandToOpcode(command);
+    if (!handlers_[lopcode]) {  // OPCODE_UNKNOWN never registered
+      return false;
+    }
+
+    *opcode = lopcode;
+    return true;
+  }
+
+  Result Execute(Handler* self,
+                 cmd_opcode_t opcode,
+                 InnerClient* connection,
+                 cmd_seq_t id,
+                 const CommandArgsView& argv) {
+    ScopedTiming timing(this, opcode);  // connection can be deleted by handler, timing not uses it
+    return (self->*handlers_[opcode])(connection, id, argv);
+  }
+
+  const Stats& GetStats(cmd_opcode_t opcode) const { return stats_[opcode]; }
+
+  // called in handler thread after each handled command
+  void SetTimingHook(timing_hook_t hook) { hook_ = hook; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CommandHandlers);
+
+  class ScopedTiming {
+   public:
+    ScopedTiming(CommandHandlers* handlers, cmd_opcode_t opcode)
+        : handlers_(handlers), opcode_(opcode), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTiming() {
+      const uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now() - start_).count();
+      Stats* stats = &handlers_->stats_[opcode_];
+      stats->calls++;
+      stats->total_nsec += elapsed;
+      if (elapsed > stats->max_nsec) {
+        stats->max_nsec = elapsed;
+      }
+      if (handlers_->hook_) {
+        handlers_->hook_(opcode_, elapsed);
+      }
+    }
+
+   private:
+    CommandHandlers* const handlers_;
+    const cmd_opcode_t opcode_;
+    const std::chrono::steady_clock::time_point start_;
+  };
+
+  handler_t handlers_[OPCODE_COUNT];
+  Stats stats_[OPCODE_COUNT];
+  timing_hook_t hook_;
+};
+
+}  // namespace inner
+}  // namespace fastotv
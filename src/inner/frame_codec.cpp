@@ -0,0 +1,302 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inner/frame_codec.h"
+
+#include <atomic>  // for atomic
+#include <chrono>  // for steady_clock
+#include <memory>  // for unique_ptr
+
+#include <snappy.h>  // for GetUncompressedLength, Uncompress
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <common/sprintf.h>                                  // for MemSPrintf
+#include <common/text_decoders/compress_snappy_edcoder.h>  // for CompressSnappyEDcoder
+
+#define ZSTD_COMPRESSION_LEVEL 3  // fast enough for every frame, much better than snappy on json
+
+namespace fastotv {
+namespace inner {
+namespace {
+
+const char* const frame_codec_names[] = {"none", "snappy", "zstd"};
+static_assert(SIZEOFMASS(frame_codec_names) == FRAME_CODEC_COUNT, "frame_codec_names should cover all codecs");
+
+struct AtomicFrameCodecStats {
+  std::atomic<uint64_t> encoded_frames;
+  std::atomic<uint64_t> encoded_raw_bytes;
+  std::atomic<uint64_t> encoded_bytes;
+  std::atomic<uint64_t> encode_nsec;
+  std::atomic<uint64_t> decoded_frames;
+  std::atomic<uint64_t> decoded_bytes;
+  std::atomic<uint64_t> decoded_raw_bytes;
+  std::atomic<uint64_t> decode_nsec;
+};
+
+AtomicFrameCodecStats frame_codec_stats[FRAME_CODEC_COUNT];  // zero initialized, static storage
+
+uint64_t ElapsedNsec(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+#ifdef HAVE_ZSTD
+typedef std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> zstd_compress_context_t;
+typedef std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> zstd_decompress_context_t;
+
+ZSTD_CCtx* GetZstdCompressContext() {  // one per loop thread, contexts are expensive to create
+  static thread_local zstd_compress_context_t context(ZSTD_createCCtx(), ZSTD_freeCCtx);
+  return context.get();
+}
+
+ZSTD_DCtx* GetZstdDecompressContext() {
+  static thread_local zstd_decompress_context_t context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+  return context.get();
+}
+#endif
+
+common::Error Encode(frame_codec_t codec, const common::StringPiece& data, std::string* out) {
+  if (codec == FRAME_CODEC_NONE) {
+    out->assign(data.data(), data.size());
+    return common::Error();
+  } else if (codec == FRAME_CODEC_SNAPPY) {
+    common::CompressSnappyEDcoder compressor;
+    return compressor.Encode(data, out);
+  }
+#ifdef HAVE_ZSTD
+  else if (codec == FRAME_CODEC_ZSTD) {
+    const size_t bound = ZSTD_compressBound(data.size());
+    out->resize(bound);
+    const size_t size = ZSTD_compressCCtx(GetZstdCompressContext(), &(*out)[0], bound, data.data(), data.size(),
+                                          ZSTD_COMPRESSION_LEVEL);
+    if (ZSTD_isError(size)) {
+      return common::make_error(ZSTD_getErrorName(size));
+    }
+    out->resize(size);
+    return common::Error();
+  }
+#endif
+
+  return common::make_error(common::MemSPrintf("Not supported frame codec: %u", codec));
+}
+
+// raw size checked before decoding, small frame can't inflate past max_size
+common::Error Decode(frame_codec_t codec, const common::StringPiece& data, size_t max_size, std::string* out) {
+  if (codec == FRAME_CODEC_NONE) {
+    if (data.size() > max_size) {
+      return common::make_error("Invalid frame size");
+    }
+    out->assign(data.data(), data.size());
+    return common::Error();
+  } else if (codec == FRAME_CODEC_SNAPPY) {
+    size_t raw_size = 0;
+    if (!snappy::GetUncompressedLength(data.data(), data.size(), &raw_size) || raw_size > max_size) {
+      return common::make_error("Invalid snappy frame size");
+    }
+    if (!snappy::Uncompress(data.data(), data.size(), out)) {  // into out, capacity reused
+      return common::make_error("Invalid snappy frame");
+    }
+    return common::Error();
+  }
+#ifdef HAVE_ZSTD
+  else if (codec == FRAME_CODEC_ZSTD) {
+    const unsigned long long raw_size = ZSTD_getFrameContentSize(data.data(), data.size());
+    if (raw_size == ZSTD_CONTENTSIZE_ERROR || raw_size == ZSTD_CONTENTSIZE_UNKNOWN || raw_size > max_size) {
+      return common::make_error("Invalid zstd frame size");
+    }
+    out->resize(raw_size);
+    const size_t size = ZSTD_decompressDCtx(GetZstdDecompressContext(), &(*out)[0], raw_size, data.data(), data.size());
+    if (ZSTD_isError(size)) {
+      return common::make_error(ZSTD_getErrorName(size));
+    }
+    out->resize(size);
+    return common::Error();
+  }
+#endif
+
+  return common::make_error(common::MemSPrintf("Not supported frame codec: %u", codec));
+}
+
+}  // namespace
+
+bool IsFrameCodecSupported(frame_codec_t codec) {
+#ifdef HAVE_ZSTD
+  return codec < FRAME_CODEC_COUNT;
+#else
+  return codec == FRAME_CODEC_NONE || codec == FRAME_CODEC_SNAPPY;
+#endif
+}
+
+const char* FrameCodecToString(frame_codec_t codec) {
+  if (codec < FRAME_CODEC_COUNT) {
+    return frame_codec_names[codec];
+  }
+
+  DNOTREACHED();
+  return "unknown";
+}
+
+bool ConvertFromString(const std::string& from, frame_codec_t* out) {
+  if (!out) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < FRAME_CODEC_COUNT; ++i) {
+    if (from == frame_codec_names[i]) {
+      *out = static_cast<frame_codec_t>(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::string GetSupportedFrameCodecs(const std::string& preferred) {
+  std::string result;
+  size_t start = 0;
+  while (start <= preferred.size()) {
+    size_t end = preferred.find(FRAME_CODECS_SEPARATOR, start);
+    if (end == std::string::npos) {
+      end = preferred.size();
+    }
+
+    frame_codec_t codec;
+    if (ConvertFromString(preferred.substr(start, end - start), &codec) && IsFrameCodecSupported(codec)) {
+      if (!result.empty()) {
+        result += FRAME_CODECS_SEPARATOR;
+      }
+      result += frame_codec_names[codec];
+    }
+    start = end + 1;
+  }
+  return result;
+}
+
+bool SelectFrameCodec(const std::string& offered, frame_codec_t* out) {
+  if (!out) {
+    return false;
+  }
+
+  const std::string supported = GetSupportedFrameCodecs(offered);  // order of offered kept
+  if (supported.empty()) {
+    return false;
+  }
+
+  return ConvertFromString(supported.substr(0, supported.find(FRAME_CODECS_SEPARATOR)), out);
+}
+
+bool IsFrameCodecOffered(const std::string& offered, frame_codec_t codec) {
+  if (codec >= FRAME_CODEC_COUNT) {
+    return false;
+  }
+
+  const std::string name = frame_codec_names[codec];
+  size_t start = 0;
+  while (start <= offered.size()) {
+    size_t end = offered.find(FRAME_CODECS_SEPARATOR, start);
+    if (end == std::string::npos) {
+      end = offered.size();
+    }
+    if (offered.compare(start, end - start, name) == 0) {
+      return true;
+    }
+    start = end + 1;
+  }
+  return false;
+}
+
+common::Error EncodeFramePayload(frame_codec_t codec, const common::StringPiece& data, std::string* out) {
+  if (!out || codec >= FRAME_CODEC_COUNT) {
+    return common::make_error_inval();
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  common::Error err = Encode(codec, data, out);
+  if (err) {
+    return err;
+  }
+
+  CountEncodedFramePayload(codec, data.size(), out->size(), ElapsedNsec(start));
+  return common::Error();
+}
+
+common::Error EncodeSharedFramePayload(frame_codec_t codec, const common::StringPiece& data, std::string* out) {
+  if (!out || codec >= FRAME_CODEC_COUNT) {
+    return common::make_error_inval();
+  }
+
+  return Encode(codec, data, out);
+}
+
+void CountEncodedFramePayload(frame_codec_t codec, size_t raw_size, size_t size, uint64_t encode_nsec) {
+  if (codec >= FRAME_CODEC_COUNT) {
+    DNOTREACHED();
+    return;
+  }
+
+  AtomicFrameCodecStats& stats = frame_codec_stats[codec];
+  stats.encoded_frames.fetch_add(1, std::memory_order_relaxed);
+  stats.encoded_raw_bytes.fetch_add(raw_size, std::memory_order_relaxed);
+  stats.encoded_bytes.fetch_add(size, std::memory_order_relaxed);
+  stats.encode_nsec.fetch_add(encode_nsec, std::memory_order_relaxed);
+}
+
+common::Error DecodeFramePayload(frame_codec_t codec,
+                                 const common::StringPiece& data,
+                                 size_t max_size,
+                                 std::string* out) {
+  if (!out || codec >= FRAME_CODEC_COUNT) {
+    return common::make_error_inval();
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  common::Error err = Decode(codec, data, max_size, out);
+  if (err) {
+    return err;
+  }
+
+  AtomicFrameCodecStats& stats = frame_codec_stats[codec];
+  stats.decoded_frames.fetch_add(1, std::memory_order_relaxed);
+  stats.decoded_bytes.fetch_add(data.size(), std::memory_order_relaxed);
+  stats.decoded_raw_bytes.fetch_add(out->size(), std::memory_order_relaxed);
+  stats.decode_nsec.fetch_add(ElapsedNsec(start), std::memory_order_relaxed);
+  return common::Error();
+}
+
+FrameCodecStats GetFrameCodecStats(frame_codec_t codec) {
+  FrameCodecStats result = FrameCodecStats();
+  if (codec >= FRAME_CODEC_COUNT) {
+    return result;
+  }
+
+  const AtomicFrameCodecStats& stats = frame_codec_stats[codec];
+  result.encoded_frames = stats.encoded_frames.load(std::memory_order_relaxed);
+  result.encoded_raw_bytes = stats.encoded_raw_bytes.load(std::memory_order_relaxed);
+  result.encoded_bytes = stats.encoded_bytes.load(std::memory_order_relaxed);
+  result.encode_nsec = stats.encode_nsec.load(std::memory_order_relaxed);
+  result.decoded_frames = stats.decoded_frames.load(std::memory_order_relaxed);
+  result.decoded_bytes = stats.decoded_bytes.load(std::memory_order_relaxed);
+  result.decoded_raw_bytes = stats.decoded_raw_bytes.load(std::memory_order_relaxed);
+  result.decode_nsec = stats.decode_nsec.load(std::memory_order_relaxed);
+  return result;
+}
+
+}  // namespace inner
+}  // namespace fastotv
@@ -0,0 +1,77 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>  // for string
+
+#include <common/error.h>         // for Error
+#include <common/macros.h>        // for WARN_UNUSED_RESULT
+#include <common/string_piece.h>  // for StringPiece
+
+// frames: [uint32_t]size [bytes]payload, size in network byte order
+// legacy frame - payload snappy compressed, used until codec negotiated and for frames shared by all clients
+// codec frame - size with FRAME_CODEC_FLAG, payload: [uint8_t]codec [bytes]data
+#define FRAME_CODEC_FLAG 0x80000000
+#define FRAME_CODECS_SEPARATOR ','
+
+namespace fastotv {
+namespace inner {
+
+enum frame_codec_t : uint8_t { FRAME_CODEC_NONE = 0, FRAME_CODEC_SNAPPY, FRAME_CODEC_ZSTD, FRAME_CODEC_COUNT };
+
+struct FrameCodecStats {
+  uint64_t encoded_frames;
+  uint64_t encoded_raw_bytes;  // before encoding
+  uint64_t encoded_bytes;      // after encoding
+  uint64_t encode_nsec;
+  uint64_t decoded_frames;
+  uint64_t decoded_bytes;  // before decoding
+  uint64_t decoded_raw_bytes;
+  uint64_t decode_nsec;
+};
+
+bool IsFrameCodecSupported(frame_codec_t codec);  // zstd only if built with it
+const char* FrameCodecToString(frame_codec_t codec);
+bool ConvertFromString(const std::string& from, frame_codec_t* out);
+
+// codecs list "zstd,snappy,none" in preference order
+std::string GetSupportedFrameCodecs(const std::string& preferred);  // unknown and not built removed
+bool SelectFrameCodec(const std::string& offered, frame_codec_t* out);  // first supported of offered
+bool IsFrameCodecOffered(const std::string& offered, frame_codec_t codec);
+
+common::Error EncodeFramePayload(frame_codec_t codec,
+                                 const common::StringPiece& data,
+                                 std::string* out) WARN_UNUSED_RESULT;
+// payload encoded once and spliced into many frames, not counted, frames counted by CountEncodedFramePayload
+common::Error EncodeSharedFramePayload(frame_codec_t codec,
+                                       const common::StringPiece& data,
+                                       std::string* out) WARN_UNUSED_RESULT;
+void CountEncodedFramePayload(frame_codec_t codec, size_t raw_size, size_t size, uint64_t encode_nsec);
+common::Error DecodeFramePayload(frame_codec_t codec,
+                                 const common::StringPiece& data,
+                                 size_t max_size,
+                                 std::string* out) WARN_UNUSED_RESULT;
+
+// thread-safe, all connections of process
+FrameCodecStats GetFrameCodecStats(frame_codec_t codec);
+
+}  // namespace inner
+}  // namespace fastotv
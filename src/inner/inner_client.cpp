@@ -18,144 +18,639 @@
 
 #include "inner/inner_client.h"
 
+#include <errno.h>   // for EAGAIN
+#include <string.h>  // for memset, strerror
+
+#include <chrono>   // for steady_clock
+#include <utility>  // for move
+
+#ifdef _WIN32
+#include <winsock2.h>  // for WSAGetLastError
+#else
+#include <sys/socket.h>  // for sendmsg
+#include <sys/uio.h>     // for iovec
+#endif
+
+#include <common/libev/types.h>  // for flags_t
 #include <common/sys_byteorder.h>
 
-#include <common/text_decoders/compress_snappy_edcoder.h>
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL  // closed peer reported as write error, not SIGPIPE
+#else
+#define SEND_FLAGS 0
+#endif
 
 namespace fastotv {
 namespace inner {
+namespace {
+size_t FrameHeaderSize(const FrameKind& kind) {
+  return sizeof(InnerClient::protocoled_size_t) + (kind.legacy ? 0 : 1);  // codec frame with codec
+}
 
-InnerClient::InnerClient(common::libev::IoLoop* server, const common::net::socket_info& info)
-    : common::libev::tcp::TcpClient(server, info), compressor_(new common::CompressSnappyEDcoder) {}
+void AppendFrameHeader(const FrameKind& kind, size_t payload_size, std::string* out) {
+  if (kind.legacy) {
+    const InnerClient::protocoled_size_t message_size = common::HostToNet32(payload_size);  // stabled
+    out->append(reinterpret_cast<const char*>(&message_size), sizeof(InnerClient::protocoled_size_t));
+    return;
+  }
 
-InnerClient::~InnerClient() {
-  destroy(&compressor_);
+  const InnerClient::protocoled_size_t data_size = payload_size + 1;  // with codec
+  const InnerClient::protocoled_size_t frame_header = common::HostToNet32(data_size | FRAME_CODEC_FLAG);  // stabled
+  out->append(reinterpret_cast<const char*>(&frame_header), sizeof(InnerClient::protocoled_size_t));
+  out->push_back(static_cast<char>(kind.codec));
 }
 
+common::Error EncodeFrame(const FrameKind& kind, const std::string& message, std::string* out) {
+  if (message.empty() || !out) {
+    return common::make_error_inval();
+  }
+
+  std::string encoded;
+  common::Error err = EncodeFramePayload(kind.codec, message, &encoded);
+  if (err) {
+    return err;
+  }
+
+  out->clear();
+  out->reserve(FrameHeaderSize(kind) + encoded.size());
+  AppendFrameHeader(kind, encoded.size(), out);
+  out->append(encoded);
+  return common::Error();
+}
+
+// snappy stream: varint32 uncompressed size, then literal and copy elements,
+// copies reference only own already decompressed output so literal can be put in front of stream
+bool ReadSnappyLength(const std::string& compressed, uint32_t* length, size_t* header_size) {
+  uint32_t result = 0;
+  for (size_t i = 0; i < compressed.size() && i < 5; ++i) {
+    const uint8_t byte = compressed[i];
+    result |= static_cast<uint32_t>(byte & 0x7f) << (7 * i);
+    if (!(byte & 0x80)) {
+      *length = result;
+      *header_size = i + 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+void AppendSnappyLength(uint32_t length, std::string* out) {
+  while (length >= 0x80) {
+    out->push_back(static_cast<char>((length & 0x7f) | 0x80));
+    length >>= 7;
+  }
+  out->push_back(static_cast<char>(length));
+}
+
+void AppendSnappyLiteral(const std::string& literal, std::string* out) {
+  const uint32_t n = literal.size() - 1;
+  if (n < 60) {
+    out->push_back(static_cast<char>(n << 2));
+  } else {
+    size_t count = 0;
+    for (uint32_t rest = n; rest; rest >>= 8) {
+      count++;
+    }
+    out->push_back(static_cast<char>((59 + count) << 2));
+    for (size_t i = 0; i < count; ++i) {
+      out->push_back(static_cast<char>((n >> (8 * i)) & 0xff));
+    }
+  }
+  out->append(literal);
+}
+
+uint64_t ElapsedNsec(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool is_would_block() {
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+}  // namespace
+
+FrameKind::FrameKind() : legacy(true), codec(FRAME_CODEC_SNAPPY) {}
+
+FrameKind::FrameKind(frame_codec_t frame_codec) : legacy(false), codec(frame_codec) {}
+
+size_t FrameKind::GetIndex() const {
+  return legacy ? 0 : static_cast<size_t>(codec) + 1;
+}
+
+bool FrameKind::IsTailSpliceSupported() const {
+  return codec == FRAME_CODEC_SNAPPY;
+}
+
+InnerClient::OutFrame::OutFrame(const frame_t& frame, bool droppable) : data(frame), droppable(droppable) {}
+
+InnerClient::InnerClient(common::libev::IoLoop* server, const common::net::socket_info& info)
+    : common::libev::tcp::TcpClient(server, info),
+      protocol_(PROTOCOL_V1),
+      frame_codec_negotiated_(false),
+      frame_codec_(FRAME_CODEC_SNAPPY),
+      compression_threshold_(default_compression_threshold),
+      in_buffer_(),
+      in_start_(0),
+      in_end_(0),
+      max_frame_size_(default_max_frame_size),
+      out_queue_(),
+      out_offset_(0),
+      pending_bytes_(0),
+      low_watermark_(default_low_watermark),
+      high_watermark_(default_high_watermark),
+      overloaded_(false),
+      dropped_frames_(0),
+      write_batch_(false),
+#ifdef _WIN32
+      coalesce_buffer_(),
+#endif
+      command_buffer_() {}
+
+InnerClient::~InnerClient() {}
+
 const char* InnerClient::ClassName() const {
   return "InnerClient";
 }
 
+template <typename Cmd>
+common::Error InnerClient::WriteCommand(const Cmd& cmd) {
+  if (protocol_ == PROTOCOL_V2 && cmd.IsBinarySupported()) {
+    common::Error err = cmd.GetBinaryCmd(&command_buffer_);
+    if (err) {
+      return err;
+    }
+    return WriteMessage(command_buffer_);
+  }
+
+  cmd.WriteCmd(&command_buffer_);
+  return WriteMessage(command_buffer_);
+}
+
 common::Error InnerClient::Write(const cmd_request_t& request) {
-  return WriteMessage(request.GetCmd());
+  return WriteCommand(request);
 }
 
 common::Error InnerClient::Write(const cmd_responce_t& responce) {
-  return WriteMessage(responce.GetCmd());
+  return WriteCommand(responce);
 }
 
 common::Error InnerClient::Write(const cmd_approve_t& approve) {
-  return WriteMessage(approve.GetCmd());
+  return WriteCommand(approve);
 }
 
-common::Error InnerClient::ReadDataSize(protocoled_size_t* sz) {
-  if (!sz) {
+void InnerClient::SetProtocolVersion(protocol_version_t version) {
+  protocol_ = version;
+}
+
+protocol_version_t InnerClient::GetProtocolVersion() const {
+  return protocol_;
+}
+
+void InnerClient::SetFrameCodec(frame_codec_t codec) {
+  DCHECK(IsFrameCodecSupported(codec));
+  frame_codec_negotiated_ = true;
+  frame_codec_ = codec;
+}
+
+bool InnerClient::IsFrameCodecNegotiated() const {
+  return frame_codec_negotiated_;
+}
+
+frame_codec_t InnerClient::GetFrameCodec() const {
+  return frame_codec_;
+}
+
+void InnerClient::SetCompressionThreshold(size_t size) {
+  compression_threshold_ = size;
+}
+
+FrameKind InnerClient::GetFrameKind(size_t message_size) const {
+  if (!frame_codec_negotiated_) {
+    return FrameKind();
+  }
+
+  return FrameKind(message_size < compression_threshold_ ? FRAME_CODEC_NONE : frame_codec_);
+}
+
+common::Error InnerClient::ReadCommands(std::vector<std::string>* out, size_t* count) {
+  if (!out || !count) {
     return common::make_error_inval();
   }
 
-  protocoled_size_t lsz = 0;
+  *count = 0;
+  common::Error err = ReadToBuffer();
+  if (err) {
+    common::Error derr = DecodeFrames(out, count);  // frames received before close
+    UNUSED(derr);
+    return err;
+  }
+
+  return DecodeFrames(out, count);
+}
+
+void InnerClient::SetMaxFrameSize(size_t size) {
+  max_frame_size_ = size;
+}
+
+common::Error InnerClient::ReadToBuffer() {
+  ReserveInput(read_chunk_size);
   size_t nread = 0;
-  common::Error err = Read(reinterpret_cast<char*>(&lsz), sizeof(protocoled_size_t), &nread);
+  common::Error err = Read(in_buffer_.data() + in_end_, in_buffer_.size() - in_end_, &nread);
   if (err) {
+    if (is_would_block()) {
+      return common::Error();
+    }
     return err;
   }
 
-  if (nread != sizeof(protocoled_size_t)) {  // connection closed
-    if (nread == 0) {
-      return common::make_error("Connection closed");
+  if (nread == 0) {
+    return common::make_error("Connection closed");
+  }
+
+  in_end_ += nread;
+  return common::Error();
+}
+
+common::Error InnerClient::DecodeFrames(std::vector<std::string>* out, size_t* count) {
+  while (in_end_ - in_start_ >= sizeof(protocoled_size_t)) {
+    protocoled_size_t frame_header = 0;
+    memcpy(&frame_header, in_buffer_.data() + in_start_, sizeof(protocoled_size_t));
+    frame_header = common::NetToHost32(frame_header);  // stable
+    const protocoled_size_t message_size = frame_header & ~FRAME_CODEC_FLAG;
+    if (message_size == 0 || message_size > max_frame_size_) {
+      return common::make_error(
+          common::MemSPrintf("Invalid frame size: %u bytes, max: %lu", message_size, max_frame_size_));
+    }
+
+    const size_t frame_size = sizeof(protocoled_size_t) + message_size;
+    if (in_end_ - in_start_ < frame_size) {  // partial frame, wait for more data
+      ReserveInput(frame_size - (in_end_ - in_start_));
+      break;
+    }
+
+    const char* data = in_buffer_.data() + in_start_ + sizeof(protocoled_size_t);
+    if (*count == out->size()) {
+      out->push_back(std::string());
+    }
+    common::Error err = DecodeFrame(frame_header, data, message_size, &(*out)[*count]);
+    if (err) {
+      return err;
     }
-    return common::make_error(common::MemSPrintf("Error when reading needed to read: %lu bytes, but readed: %lu",
-                                                 sizeof(protocoled_size_t), nread));
+    (*count)++;
+    in_start_ += frame_size;
   }
 
-  *sz = lsz;
+  if (in_start_ == in_end_) {
+    in_start_ = in_end_ = 0;
+  }
   return common::Error();
 }
 
-common::Error InnerClient::ReadMessage(char* out, protocoled_size_t size) {
-  if (!out || size == 0) {
-    return common::make_error_inval();
+void InnerClient::ReserveInput(size_t size) {
+  if (in_buffer_.size() - in_end_ >= size) {
+    return;
   }
 
-  size_t nread;
-  common::Error err = Read(out, size, &nread);
-  if (err) {
-    return err;
+  if (in_start_ != 0) {  // move not decoded data to the begin
+    memmove(in_buffer_.data(), in_buffer_.data() + in_start_, in_end_ - in_start_);
+    in_end_ -= in_start_;
+    in_start_ = 0;
   }
 
-  if (nread != size) {  // connection closed
-    if (nread == 0) {
-      return common::make_error("Connection closed");
-    }
-    return common::make_error(
-        common::MemSPrintf("Error when reading needed to read: %lu bytes, but readed: %lu", size, nread));
+  if (in_buffer_.size() - in_end_ < size) {
+    in_buffer_.resize(in_end_ + size);
   }
+}
 
-  return common::Error();
+common::Error InnerClient::WriteFrame(const frame_t& frame, bool droppable) {
+  if (!frame || frame->empty()) {
+    return common::make_error_inval();
+  }
+
+  return SendFrame(frame, droppable);
 }
 
-common::Error InnerClient::ReadCommand(std::string* out) {
+common::Error InnerClient::MakeFrame(const FrameKind& kind, const std::string& message, frame_t* out) {
   if (!out) {
     return common::make_error_inval();
   }
 
-  protocoled_size_t message_size;
-  common::Error err = ReadDataSize(&message_size);
+  std::string frame;
+  common::Error err = EncodeFrame(kind, message, &frame);
   if (err) {
     return err;
   }
 
-  message_size = common::NetToHost32(message_size);  // stable
-  char* msg = static_cast<char*>(malloc(message_size));
-  err = ReadMessage(msg, message_size);
-  if (err) {
-    free(msg);
-    return err;
+  *out = std::make_shared<const std::string>(std::move(frame));
+  return common::Error();
+}
+
+common::Error InnerClient::EncodeTail(const FrameKind& kind, const std::string& tail, frame_t* encoded_tail) {
+  if (tail.empty() || !encoded_tail) {
+    return common::make_error_inval();
   }
 
-  const common::StringPiece compressed(msg, message_size);
-  std::string un_compressed;
-  err = compressor_->Decode(compressed, &un_compressed);
-  free(msg);
+  if (!kind.IsTailSpliceSupported()) {
+    return common::make_error(common::MemSPrintf("Tail splice not supported by frame codec: %u", kind.codec));
+  }
+
+  std::string encoded;
+  common::Error err = EncodeSharedFramePayload(kind.codec, tail, &encoded);  // counted by each frame
   if (err) {
     return err;
   }
 
-  *out = un_compressed;
+  *encoded_tail = std::make_shared<const std::string>(std::move(encoded));
   return common::Error();
 }
 
-common::Error InnerClient::WriteMessage(const std::string& message) {
-  if (message.empty()) {
+common::Error InnerClient::MakeFrame(const FrameKind& kind,
+                                     const std::string& head,
+                                     const std::string& tail,
+                                     const frame_t& encoded_tail,
+                                     frame_t* out) {
+  if (head.empty() || tail.empty() || !out) {
     return common::make_error_inval();
   }
 
+  if (!kind.IsTailSpliceSupported()) {
+    return MakeFrame(kind, head + tail, out);
+  }
+
+  uint32_t tail_size = 0;
+  size_t tail_header_size = 0;
+  if (!encoded_tail || !ReadSnappyLength(*encoded_tail, &tail_size, &tail_header_size) || tail_size != tail.size()) {
+    return common::make_error("Invalid encoded tail");
+  }
+
+  const auto start = std::chrono::steady_clock::now();
   std::string compressed;
-  common::Error err = compressor_->Encode(message, &compressed);
+  compressed.reserve(head.size() + encoded_tail->size() + 10);
+  AppendSnappyLength(head.size() + tail_size, &compressed);
+  AppendSnappyLiteral(head, &compressed);
+  compressed.append(*encoded_tail, tail_header_size, std::string::npos);
+
+  std::string frame;
+  frame.reserve(FrameHeaderSize(kind) + compressed.size());
+  AppendFrameHeader(kind, compressed.size(), &frame);
+  frame.append(compressed);
+  CountEncodedFramePayload(kind.codec, head.size() + tail.size(), compressed.size(), ElapsedNsec(start));
+  *out = std::make_shared<const std::string>(std::move(frame));
+  return common::Error();
+}
+
+void InnerClient::SetWatermarks(size_t low, size_t high) {
+  DCHECK(low <= high);
+  low_watermark_ = low <= high ? low : high;
+  high_watermark_ = high;
+}
+
+size_t InnerClient::GetPendingBytes() const {
+  return pending_bytes_;
+}
+
+size_t InnerClient::GetDroppedFrames() const {
+  return dropped_frames_;
+}
+
+bool InnerClient::IsOverloaded() const {
+  return overloaded_;
+}
+
+common::Error InnerClient::Flush() {
+  while (!out_queue_.empty()) {
+    size_t size = 0;
+    size_t nwrite = 0;
+    common::Error err = SendPending(&size, &nwrite);
+    if (err) {
+      return err;
+    }
+
+    ConsumePending(nwrite);
+    if (nwrite != size) {  // socket buffer full
+      break;
+    }
+  }
+
+  if (overloaded_ && pending_bytes_ <= low_watermark_) {
+    overloaded_ = false;
+  }
+  SetWriteNotify(!out_queue_.empty());
+  return common::Error();
+}
+
+void InnerClient::BeginWriteBatch() {
+  write_batch_ = true;
+}
+
+common::Error InnerClient::EndWriteBatch() {
+  write_batch_ = false;
+  return Flush();
+}
+
+common::Error InnerClient::SendFrame(const frame_t& frame, bool droppable) {
+  const size_t size = frame->size();
+  if (out_queue_.empty() && !write_batch_) {  // nothing pending, try to write directly
+    size_t nwrite = 0;
+    common::Error err = SendSome(frame->data(), size, &nwrite);
+    if (err) {
+      return err;
+    }
+
+    if (nwrite == size) {
+      return common::Error();
+    }
+
+    out_queue_.push_back(OutFrame(frame, droppable));
+    out_offset_ = nwrite;
+    pending_bytes_ = size - nwrite;
+    SetWriteNotify(true);
+    return common::Error();
+  }
+
+  if (!overloaded_ && pending_bytes_ + size > high_watermark_) {
+    overloaded_ = true;
+    DropPendingChat();
+  }
+
+  if (overloaded_ && droppable) {
+    dropped_frames_++;
+    return common::Error();
+  }
+
+  if (pending_bytes_ + size > high_watermark_ * slow_consumer_factor) {
+    return common::make_error(common::MemSPrintf("Slow consumer, pending: %lu bytes", pending_bytes_));
+  }
+
+  out_queue_.push_back(OutFrame(frame, droppable));
+  pending_bytes_ += size;
+  return common::Error();
+}
+
+common::Error InnerClient::SendSome(const char* data, size_t size, size_t* nwrite) {
+  size_t lnwrite = 0;
+  common::Error err = TcpClient::Write(data, size, &lnwrite);
   if (err) {
+    if (is_would_block()) {
+      *nwrite = 0;
+      return common::Error();
+    }
     return err;
   }
 
-  const char* data_ptr = compressed.data();
-  const size_t size = compressed.size();
+  *nwrite = lnwrite;
+  return common::Error();
+}
 
-  const protocoled_size_t data_size = size;
-  const protocoled_size_t message_size = common::HostToNet32(data_size);  // stabled
-  const size_t protocoled_data_len = size + sizeof(protocoled_size_t);
+common::Error InnerClient::SendPending(size_t* size, size_t* nwrite) {
+#ifdef _WIN32
+  const OutFrame& front = out_queue_.front();
+  const char* data = front.data->data() + out_offset_;
+  size_t lsize = front.data->size() - out_offset_;
+  if (out_queue_.size() > 1 && lsize < max_coalesced_write) {  // coalesce small frames into one write
+    coalesce_buffer_.assign(data, lsize);
+    for (size_t i = 1; i < out_queue_.size(); ++i) {
+      const frame_t& next = out_queue_[i].data;
+      if (coalesce_buffer_.size() + next->size() > max_coalesced_write) {
+        break;
+      }
+      coalesce_buffer_.append(*next);
+    }
+    data = coalesce_buffer_.data();
+    lsize = coalesce_buffer_.size();
+  }
+
+  *size = lsize;
+  return SendSome(data, lsize, nwrite);
+#else
+  struct iovec iov[max_write_frames];  // frames written in place, without copy
+  size_t count = 0;
+  size_t lsize = 0;
+  for (size_t i = 0; i < out_queue_.size() && count < max_write_frames; ++i) {
+    const std::string& frame = *out_queue_[i].data;
+    const size_t offset = i == 0 ? out_offset_ : 0;
+    if (count != 0 && lsize + frame.size() > max_coalesced_write) {
+      break;
+    }
+
+    iov[count].iov_base = const_cast<char*>(frame.data() + offset);
+    iov[count].iov_len = frame.size() - offset;
+    lsize += iov[count].iov_len;
+    count++;
+  }
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = count;
+  *size = lsize;
+  const ssize_t lnwrite = sendmsg(GetInfo().fd(), &msg, SEND_FLAGS);
+  if (lnwrite == -1) {
+    if (is_would_block() || errno == EINTR) {
+      *nwrite = 0;
+      return common::Error();
+    }
+    return common::make_error(std::string("Write error: ") + strerror(errno));
+  }
+
+  *nwrite = lnwrite;
+  return common::Error();
+#endif
+}
+
+void InnerClient::ConsumePending(size_t size) {
+  pending_bytes_ -= size;
+  while (size != 0) {
+    const size_t rest = out_queue_.front().data->size() - out_offset_;
+    if (size < rest) {
+      out_offset_ += size;
+      return;
+    }
+
+    size -= rest;
+    out_queue_.pop_front();
+    out_offset_ = 0;
+  }
+}
+
+void InnerClient::DropPendingChat() {
+  std::deque<OutFrame> kept;
+  for (size_t i = 0; i < out_queue_.size(); ++i) {
+    const OutFrame& frame = out_queue_[i];
+    if (i == 0 && out_offset_ != 0) {  // partially written, should be finished
+      kept.push_back(frame);
+      continue;
+    }
+
+    if (frame.droppable) {
+      pending_bytes_ -= frame.data->size();
+      dropped_frames_++;
+      continue;
+    }
+    kept.push_back(frame);
+  }
+  out_queue_.swap(kept);
+}
+
+void InnerClient::SetWriteNotify(bool enable) {
+  const common::libev::flags_t flags = GetFlags();
+  const common::libev::flags_t new_flags = enable ? (flags | EV_WRITE) : (flags & ~EV_WRITE);
+  if (flags != new_flags) {
+    SetFlags(new_flags);
+  }
+}
+
+common::Error InnerClient::WriteMessage(const std::string& message) {
+  std::string frame;
+  common::Error err = EncodeFrame(GetFrameKind(message.size()), message, &frame);
+  if (err) {
+    return err;
+  }
+
+  return SendFrame(std::make_shared<const std::string>(std::move(frame)), false);
+}
+
+common::Error InnerClient::DecodeFrame(protocoled_size_t frame_header,
+                                       const char* data,
+                                       size_t size,
+                                       std::string* out) {
+  if (!(frame_header & FRAME_CODEC_FLAG)) {  // legacy
+    return DecodeFramePayload(FRAME_CODEC_SNAPPY, common::StringPiece(data, size), max_frame_size_, out);
+  }
+
+  const frame_codec_t codec = static_cast<frame_codec_t>(data[0]);
+  if (!IsFrameCodecSupported(codec)) {
+    return common::make_error(common::MemSPrintf("Not supported frame codec: %u", codec));
+  }
+
+  return DecodeFramePayload(codec, common::StringPiece(data + 1, size - 1), max_frame_size_, out);
+}
+
+SharedFrame::SharedFrame(const std::string& message) : message_(message), mutex_(), frames_() {}
+
+size_t SharedFrame::GetMessageSize() const {
+  return message_.size();
+}
 
-  char* protocoled_data = static_cast<char*>(malloc(protocoled_data_len));
-  memcpy(protocoled_data, &message_size, sizeof(protocoled_size_t));
-  memcpy(protocoled_data + sizeof(protocoled_size_t), data_ptr, data_size);
-  size_t nwrite = 0;
-  err = TcpClient::Write(protocoled_data, protocoled_data_len, &nwrite);
-  if (nwrite != protocoled_data_len) {  // connection closed
-    free(protocoled_data);
-    return common::make_error(
-        common::MemSPrintf("Error when writing needed to write: %lu, but writed: %lu", protocoled_data_len, nwrite));
+common::Error SharedFrame::GetFrame(const FrameKind& kind, InnerClient::frame_t* out) {
+  if (!out) {
+    return common::make_error_inval();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);  // loops wait only for first frame of same kind
+  InnerClient::frame_t& frame = frames_[kind.GetIndex()];
+  if (!frame) {
+    common::Error err = InnerClient::MakeFrame(kind, message_, &frame);
+    if (err) {
+      return err;
+    }
   }
 
-  free(protocoled_data);
-  return err;
+  *out = frame;
+  return common::Error();
 }
 
 }  // namespace inner
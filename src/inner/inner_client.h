@@ -18,20 +18,50 @@
 
 #pragma once
 
+#include <deque>   // for deque
+#include <memory>  // for shared_ptr
+#include <mutex>   // for mutex
+#include <string>  // for string
+#include <vector>  // for vector
+
 #include <common/libev/tcp/tcp_client.h>  // for TcpClient
 
 #include "commands/commands.h"
-
-namespace common {
-class IEDcoder;
-}
+#include "inner/frame_codec.h"
 
 namespace fastotv {
 namespace inner {
 
+// frames written to clients: legacy snappy frame until codec negotiated, then codec frame,
+// frames shared by clients (chat, channels responces) made once for each kind
+struct FrameKind {
+  enum { count = FRAME_CODEC_COUNT + 1 };  // legacy and each codec
+
+  FrameKind();  // legacy
+  explicit FrameKind(frame_codec_t codec);
+
+  size_t GetIndex() const;             // for caches of shared frames
+  bool IsTailSpliceSupported() const;  // snappy, head put in front of encoded tail
+
+  bool legacy;
+  frame_codec_t codec;  // snappy for legacy
+};
+
 class InnerClient : public common::libev::tcp::TcpClient {
  public:
-  typedef uint32_t protocoled_size_t;  // sizeof 4 byte
+  typedef uint32_t protocoled_size_t;                  // sizeof 4 byte
+  typedef std::shared_ptr<const std::string> frame_t;  // length prefixed compressed message, ready to write
+  enum {
+    default_low_watermark = 256 * 1024,    // bytes, chat accepted again when queue drained below
+    default_high_watermark = 1024 * 1024,  // bytes, chat dropped when queue grows above
+    slow_consumer_factor = 2,              // disconnect when queue grows above high watermark * factor
+    max_coalesced_write = 64 * 1024,       // bytes, per one socket write
+    max_write_frames = 64,                 // queued frames per one socket write
+    default_max_frame_size = 16 * 1024 * 1024,  // bytes, compressed payload
+    read_chunk_size = 16 * 1024,                // bytes, min free space for one socket read
+    default_compression_threshold = 256         // bytes, smaller messages not compressed
+  };
+
   InnerClient(common::libev::IoLoop* server, const common::net::socket_info& info);
   virtual ~InnerClient();
 
@@ -40,19 +70,118 @@ class InnerClient : public common::libev::tcp::TcpClient {
   common::Error Write(const cmd_request_t& request) WARN_UNUSED_RESULT;
   common::Error Write(const cmd_responce_t& responce) WARN_UNUSED_RESULT;
   common::Error Write(const cmd_approve_t& approve) WARN_UNUSED_RESULT;
-
-  common::Error ReadCommand(std::string* out) WARN_UNUSED_RESULT;
+  common::Error WriteFrame(const frame_t& frame, bool droppable) WARN_UNUSED_RESULT;  // droppable - chat traffic
+
+  // commands written in binary form after peer agreed to v2, text commands accepted in both versions
+  void SetProtocolVersion(protocol_version_t version);
+  protocol_version_t GetProtocolVersion() const;
+
+  // frames written with codec after peer agreed to it, until then legacy snappy frames,
+  // both accepted regardless of codec
+  void SetFrameCodec(frame_codec_t codec);
+  bool IsFrameCodecNegotiated() const;
+  frame_codec_t GetFrameCodec() const;
+  void SetCompressionThreshold(size_t size);
+  FrameKind GetFrameKind(size_t message_size) const;  // of frame with message written to this client
+
+  // build frame once and write it to many clients of same kind
+  static common::Error MakeFrame(const FrameKind& kind, const std::string& message, frame_t* out) WARN_UNUSED_RESULT;
+  // frames which differ only by head (type and request id): tail encoded once, head spliced for each frame,
+  // kinds without splice support encode whole message and not use encoded tail
+  static common::Error EncodeTail(const FrameKind& kind,
+                                  const std::string& tail,
+                                  frame_t* encoded_tail) WARN_UNUSED_RESULT;
+  static common::Error MakeFrame(const FrameKind& kind,
+                                 const std::string& head,
+                                 const std::string& tail,
+                                 const frame_t& encoded_tail,
+                                 frame_t* out) WARN_UNUSED_RESULT;
+
+  // reads available data and decodes all complete frames into out[0, count), partial frame kept until next call,
+  // strings of out reused between calls, vector not shrunk to keep their capacity
+  common::Error ReadCommands(std::vector<std::string>* out, size_t* count) WARN_UNUSED_RESULT;
+  void SetMaxFrameSize(size_t size);
+
+  // outbound queue, frames which socket not accepted yet
+  void SetWatermarks(size_t low, size_t high);
+  size_t GetPendingBytes() const;
+  size_t GetDroppedFrames() const;
+  bool IsOverloaded() const;
+  common::Error Flush() WARN_UNUSED_RESULT;  // should be called when socket ready to write
+  // frames written until batch ended only queued and then written together by one flush,
+  // responces to all commands of one socket read
+  void BeginWriteBatch();
+  common::Error EndWriteBatch() WARN_UNUSED_RESULT;
 
  private:
-  common::Error ReadDataSize(protocoled_size_t* sz) WARN_UNUSED_RESULT;
-  common::Error ReadMessage(char* out, protocoled_size_t size) WARN_UNUSED_RESULT;
-
+  struct OutFrame {
+    OutFrame(const frame_t& frame, bool droppable);
+
+    frame_t data;
+    bool droppable;
+  };
+
+  common::Error SendFrame(const frame_t& frame, bool droppable) WARN_UNUSED_RESULT;
+  common::Error SendSome(const char* data, size_t size, size_t* nwrite) WARN_UNUSED_RESULT;
+  // one socket write of queue head, size - bytes tried
+  common::Error SendPending(size_t* size, size_t* nwrite) WARN_UNUSED_RESULT;
+  void ConsumePending(size_t size);
+  void DropPendingChat();
+  void SetWriteNotify(bool enable);
+
+  common::Error ReadToBuffer() WARN_UNUSED_RESULT;
+  common::Error DecodeFrames(std::vector<std::string>* out, size_t* count) WARN_UNUSED_RESULT;
+  void ReserveInput(size_t size);
+
+  template <typename Cmd>
+  common::Error WriteCommand(const Cmd& cmd) WARN_UNUSED_RESULT;
   common::Error WriteMessage(const std::string& message) WARN_UNUSED_RESULT;
+  common::Error DecodeFrame(protocoled_size_t frame_header,
+                            const char* data,
+                            size_t size,
+                            std::string* out) WARN_UNUSED_RESULT;
   using common::libev::tcp::TcpClient::Write;
   using common::libev::tcp::TcpClient::Read;
 
  private:
-  common::IEDcoder* compressor_;
+  protocol_version_t protocol_;
+  bool frame_codec_negotiated_;
+  frame_codec_t frame_codec_;
+  size_t compression_threshold_;
+
+  std::vector<char> in_buffer_;  // [in_start_, in_end_) not decoded data
+  size_t in_start_;
+  size_t in_end_;
+  size_t max_frame_size_;
+
+  std::deque<OutFrame> out_queue_;
+  size_t out_offset_;  // already written bytes of out_queue_.front()
+  size_t pending_bytes_;
+  size_t low_watermark_;
+  size_t high_watermark_;
+  bool overloaded_;
+  size_t dropped_frames_;
+  bool write_batch_;
+#ifdef _WIN32
+  std::string coalesce_buffer_;  // small frames joined into one write
+#endif
+  std::string command_buffer_;  // commands written before compression, capacity reused
+};
+
+// one message written to many clients (chat), framed at most once for each kind, thread-safe
+class SharedFrame {
+ public:
+  explicit SharedFrame(const std::string& message);
+
+  size_t GetMessageSize() const;
+  common::Error GetFrame(const FrameKind& kind, InnerClient::frame_t* out) WARN_UNUSED_RESULT;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SharedFrame);
+
+  const std::string message_;
+  std::mutex mutex_;
+  InnerClient::frame_t frames_[FrameKind::count];  // by kind index, made on first request
 };
 
 }  // namespace inner
@@ -18,16 +18,13 @@
 
 #include "inner/inner_server_command_seq_parser.h"
 
-#include <algorithm>
+#include <utility>  // for move, pair
 
 #include <common/convert2string.h>
 #include <common/sys_byteorder.h>
 
 #include "inner/inner_client.h"  // for InnerClient
-
-extern "C" {
-#include "sds.h"  // for sdsfreesplitres, sds
-}
+#include "inner/sampled_log.h"   // for SAMPLED_LOG
 
 #define GB (1024 * 1024 * 1024)
 #define BUF_SIZE 4096
@@ -35,21 +32,36 @@ extern "C" {
 namespace fastotv {
 namespace inner {
 
-RequestCallback::RequestCallback(cmd_seq_t request_id, callback_t cb) : request_id_(request_id), cb_(cb) {}
+RequestCallback::RequestCallback(cmd_seq_t request_id, callback_t cb, timeout_callback_t timeout_cb)
+    : request_id_(request_id), cb_(cb), timeout_cb_(timeout_cb) {}
 
 cmd_seq_t RequestCallback::GetRequestID() const {
   return request_id_;
 }
 
-void RequestCallback::Execute(int argc, char* argv[]) {
+void RequestCallback::Execute(const CommandArgsView& argv) {
   if (!cb_) {
     return;
   }
 
-  return cb_(request_id_, argc, argv);
+  return cb_(request_id_, argv);
+}
+
+void RequestCallback::ExecuteTimeout() {
+  if (!timeout_cb_) {
+    return;
+  }
+
+  return timeout_cb_(request_id_);
 }
 
-InnerServerCommandSeqParser::InnerServerCommandSeqParser() : id_() {}
+InnerServerCommandSeqParser::InnerServerCommandSeqParser()
+    : id_(),
+      subscribed_requests_(),
+      requests_wheel_(requests_wheel_size),
+      current_tick_(0),
+      args_buffer_(),
+      argv_() {}
 
 InnerServerCommandSeqParser::~InnerServerCommandSeqParser() {}
 
@@ -62,34 +74,70 @@ cmd_seq_t InnerServerCommandSeqParser::NextRequestID() {
   return hexed;
 }
 
-namespace {
-
-bool exec_reqest(RequestCallback req, cmd_seq_t request_id, int argc, char* argv[]) {
-  if (request_id == req.GetRequestID()) {
-    req.Execute(argc, argv);
-    return true;
+void InnerServerCommandSeqParser::ProcessRequest(cmd_seq_t request_id, const CommandArgsView& argv) {
+  subscribed_requests_t::iterator it = subscribed_requests_.find(request_id);
+  if (it == subscribed_requests_.end()) {
+    return;
   }
 
-  return false;
+  RequestCallback req = std::move(it->second.req);  // callback can subscribe new requests
+  subscribed_requests_.erase(it);
+  req.Execute(argv);
 }
 
-}  // namespace
+void InnerServerCommandSeqParser::SubscribeRequest(const RequestCallback& req, tick_t timeout) {
+  const cmd_seq_t request_id = req.GetRequestID();
+  const tick_t deadline = current_tick_ + (timeout ? timeout : 1);
+  SubscribedRequest sreq = {req, deadline};
+  std::pair<subscribed_requests_t::iterator, bool> res = subscribed_requests_.emplace(request_id, sreq);
+  if (!res.second) {
+    WARNING_LOG() << "Request id: " << request_id << " already subscribed, replaced.";
+    res.first->second = sreq;
+  }
+
+  WheelEntry entry = {request_id, deadline};
+  requests_wheel_[deadline % requests_wheel_size].push_back(entry);
+}
 
-void InnerServerCommandSeqParser::ProcessRequest(cmd_seq_t request_id, int argc, char* argv[]) {
-  subscribed_requests_.erase(std::remove_if(subscribed_requests_.begin(), subscribed_requests_.end(),
-                                            std::bind(&exec_reqest, std::placeholders::_1, request_id, argc, argv)),
-                             subscribed_requests_.end());
+size_t InnerServerCommandSeqParser::GetSubscribedRequestsCount() const {
+  return subscribed_requests_.size();
 }
 
-void InnerServerCommandSeqParser::SubscribeRequest(const RequestCallback& req) {
-  subscribed_requests_.push_back(req);
+void InnerServerCommandSeqParser::ExpireRequests() {
+  current_tick_++;
+  std::vector<WheelEntry> slot;
+  slot.swap(requests_wheel_[current_tick_ % requests_wheel_size]);
+  std::vector<RequestCallback> expired;
+  for (const WheelEntry& entry : slot) {
+    subscribed_requests_t::iterator it = subscribed_requests_.find(entry.request_id);
+    if (it == subscribed_requests_.end() || it->second.deadline != entry.deadline) {  // stale
+      continue;
+    }
+
+    if (entry.deadline > current_tick_) {  // next rounds
+      requests_wheel_[current_tick_ % requests_wheel_size].push_back(entry);
+      continue;
+    }
+
+    expired.push_back(std::move(it->second.req));
+    subscribed_requests_.erase(it);
+  }
+
+  for (RequestCallback& req : expired) {
+    WARNING_LOG() << "Request id: " << req.GetRequestID() << " timeout.";
+    req.ExecuteTimeout();
+  }
 }
 
 void InnerServerCommandSeqParser::HandleInnerDataReceived(InnerClient* connection, const std::string& input_command) {
+  if (IsBinaryCommand(input_command)) {
+    HandleBinaryDataReceived(connection, input_command);
+    return;
+  }
+
   cmd_id_t seq;
   cmd_seq_t id;
-  std::string cmd_str;
-
+  common::StringPiece cmd_str(nullptr, 0);
   common::Error err = ParseCommand(input_command, &seq, &id, &cmd_str);
   if (err) {
     WARNING_LOG() << err->GetDescription();
@@ -98,9 +146,8 @@ void InnerServerCommandSeqParser::HandleInnerDataReceived(InnerClient* connectio
     return;
   }
 
-  int argc;
-  sds* argv = sdssplitargslong(cmd_str.c_str(), &argc);
-  if (argv == NULL) {
+  err = SplitCommandArgs(cmd_str.data(), cmd_str.size(), &args_buffer_, &argv_);
+  if (err || argv_.empty()) {
     const std::string error_str = "PROBLEM PARSING INNER COMMAND: " + input_command;
     WARNING_LOG() << error_str;
     connection->Close();
@@ -108,21 +155,45 @@ void InnerServerCommandSeqParser::HandleInnerDataReceived(InnerClient* connectio
     return;
   }
 
-  ProcessRequest(id, argc, argv);
-  INFO_LOG() << "HANDLE INNER COMMAND client[" << connection->GetFormatedName() << "] seq: " << CmdIdToString(seq)
-             << ", id:" << id << ", cmd: " << cmd_str;
+  SAMPLED_LOG(LOG_CATEGORY_COMMANDS) << "client=" << connection->GetFormatedName() << " seq=" << CmdIdToString(seq)
+                                     << " id=" << id << " cmd=" << LogPayload(LOG_CATEGORY_COMMANDS, cmd_str);
+  DispatchCommand(connection, seq, id, CommandArgsView(argv_.data(), argv_.size()));
+}
+
+void InnerServerCommandSeqParser::HandleBinaryDataReceived(InnerClient* connection, const std::string& input_command) {
+  cmd_id_t seq;
+  cmd_seq_t id;
+  common::Error err = ParseBinaryCommand(input_command, &seq, &id, &args_buffer_, &argv_);
+  if (err) {
+    WARNING_LOG() << err->GetDescription();
+    connection->Close();
+    delete connection;
+    return;
+  }
+
+  const common::StringPiece args = argv_.size() > 1 ? argv_[1] : common::StringPiece();
+  SAMPLED_LOG(LOG_CATEGORY_COMMANDS) << "client=" << connection->GetFormatedName() << " seq=" << CmdIdToString(seq)
+                                     << " id=" << id << " binary_cmd=" << argv_[0].data()
+                                     << " args=" << LogPayload(LOG_CATEGORY_COMMANDS, args);
+  DispatchCommand(connection, seq, id, CommandArgsView(argv_.data(), argv_.size()));
+}
+
+void InnerServerCommandSeqParser::DispatchCommand(InnerClient* connection,
+                                                  cmd_id_t seq,
+                                                  cmd_seq_t id,
+                                                  const CommandArgsView& argv) {
+  ProcessRequest(id, argv);
   if (seq == REQUEST_COMMAND) {
-    HandleInnerRequestCommand(connection, id, argc, argv);
+    HandleInnerRequestCommand(connection, id, argv);
   } else if (seq == RESPONCE_COMMAND) {
-    HandleInnerResponceCommand(connection, id, argc, argv);
+    HandleInnerResponceCommand(connection, id, argv);
   } else if (seq == APPROVE_COMMAND) {
-    HandleInnerApproveCommand(connection, id, argc, argv);
+    HandleInnerApproveCommand(connection, id, argv);
   } else {
     DNOTREACHED();
     connection->Close();
     delete connection;
   }
-  sdsfreesplitres(argv, argc);
 }
 
 }  // namespace inner
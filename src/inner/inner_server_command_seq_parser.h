@@ -20,6 +20,9 @@
 
 #include <functional>
 #include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "commands/commands.h"  // for cmd_seq_t
 
@@ -34,49 +37,70 @@ namespace inner {
 
 class RequestCallback {
  public:
-  typedef std::function<void(cmd_seq_t request_id, int argc, char* argv[])> callback_t;
-  RequestCallback(cmd_seq_t request_id, callback_t cb);
+  typedef std::function<void(cmd_seq_t request_id, const CommandArgsView& argv)> callback_t;
+  typedef std::function<void(cmd_seq_t request_id)> timeout_callback_t;
+  RequestCallback(cmd_seq_t request_id, callback_t cb, timeout_callback_t timeout_cb = timeout_callback_t());
   cmd_seq_t GetRequestID() const;
-  void Execute(int argc, char* argv[]);
+  void Execute(const CommandArgsView& argv);
+  void ExecuteTimeout();
 
  private:
   cmd_seq_t request_id_;
   callback_t cb_;
+  timeout_callback_t timeout_cb_;
 };
 
 class InnerServerCommandSeqParser {
  public:
   typedef uint64_t id_t;
+  typedef uint64_t tick_t;
+  enum {
+    default_request_timeout = 30,  // sec
+    requests_wheel_size = 64       // slots of one tick
+  };
 
   InnerServerCommandSeqParser();
   virtual ~InnerServerCommandSeqParser();
 
-  void SubscribeRequest(const RequestCallback& req);
+  // timeout in ticks, request with same id replaces previous one
+  void SubscribeRequest(const RequestCallback& req, tick_t timeout = default_request_timeout);
+  size_t GetSubscribedRequestsCount() const;
 
  protected:
   void HandleInnerDataReceived(InnerClient* connection, const std::string& input_command);
 
   cmd_seq_t NextRequestID();  // for requests
 
+  void ExpireRequests();  // one tick passed (sec), expired requests removed and notified
+
  private:
-  void ProcessRequest(cmd_seq_t request_id, int argc, char* argv[]);
-
-  virtual void HandleInnerRequestCommand(InnerClient* connection,
-                                         cmd_seq_t id,
-                                         int argc,
-                                         char* argv[]) = 0;  // called when argv not NULL and argc > 0 , only responce
-  virtual void HandleInnerResponceCommand(
-      InnerClient* connection,
-      cmd_seq_t id,
-      int argc,
-      char* argv[]) = 0;  // called when argv not NULL and argc > 0, only approve responce
-  virtual void HandleInnerApproveCommand(InnerClient* connection,
-                                         cmd_seq_t id,
-                                         int argc,
-                                         char* argv[]) = 0;  // called when argv not NULL and argc > 0
+  struct SubscribedRequest {
+    RequestCallback req;
+    tick_t deadline;
+  };
+  struct WheelEntry {
+    cmd_seq_t request_id;
+    tick_t deadline;  // entry stale if request answered or resubscribed with other deadline
+  };
+  typedef std::unordered_map<cmd_seq_t, SubscribedRequest> subscribed_requests_t;
+
+  void ProcessRequest(cmd_seq_t request_id, const CommandArgsView& argv);
+  void HandleBinaryDataReceived(InnerClient* connection, const std::string& input_command);
+  void DispatchCommand(InnerClient* connection, cmd_id_t seq, cmd_seq_t id, const CommandArgsView& argv);
+
+  // called when argv not empty
+  virtual void HandleInnerRequestCommand(InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv) = 0;
+  virtual void HandleInnerResponceCommand(InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv) = 0;
+  virtual void HandleInnerApproveCommand(InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv) = 0;
 
   std::atomic<id_t> id_;
-  std::vector<RequestCallback> subscribed_requests_;
+  subscribed_requests_t subscribed_requests_;
+  std::vector<std::vector<WheelEntry> > requests_wheel_;  // by deadline % requests_wheel_size
+  tick_t current_tick_;
+
+  // arguments of handled command, argv_ points into args_buffer_, both reused for next commands
+  std::string args_buffer_;
+  std::vector<common::StringPiece> argv_;
 };
 
 }  // namespace inner
@@ -0,0 +1,191 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "inner/sampled_log.h"
+
+#include <atomic>  // for atomic
+#include <chrono>  // for steady_clock
+
+#include <common/logger.h>  // for RUNTIME_LOG
+
+namespace fastotv {
+namespace inner {
+namespace {
+
+const char* const log_category_names[] = {"commands", "pings", "external"};
+static_assert(SIZEOFMASS(log_category_names) == LOG_CATEGORY_COUNT, "log_category_names should cover all categories");
+
+struct LogCategory {
+  LogCategory()
+      : sample_rate(1),
+        max_per_second(0),
+        max_payload_size(LogCategoryPolicy::default_max_payload_size),
+        sequence(0),
+        window_second(0),
+        window_count(0),
+        logged(0),
+        sampled_out(0),
+        rate_limited(0) {}
+
+  std::atomic<size_t> sample_rate;
+  std::atomic<size_t> max_per_second;
+  std::atomic<size_t> max_payload_size;
+
+  std::atomic<uint64_t> sequence;       // messages seen, for sampling
+  std::atomic<uint64_t> window_second;  // current rate limit window
+  std::atomic<size_t> window_count;     // messages logged in window
+
+  std::atomic<uint64_t> logged;
+  std::atomic<uint64_t> sampled_out;
+  std::atomic<uint64_t> rate_limited;
+};
+
+LogCategory log_categories[LOG_CATEGORY_COUNT];
+std::atomic<ILogSink*> log_sink(nullptr);
+
+uint64_t SteadySeconds() {
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// not exact under contention, window can be reset by two threads or overrun by a few messages
+bool TakeRateLimitToken(LogCategory* category, size_t max_per_second) {
+  const uint64_t now = SteadySeconds();
+  uint64_t window = category->window_second.load(std::memory_order_relaxed);
+  if (window != now && category->window_second.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+    category->window_count.store(0, std::memory_order_relaxed);
+  }
+  return category->window_count.fetch_add(1, std::memory_order_relaxed) < max_per_second;
+}
+
+}  // namespace
+
+LogCategoryPolicy::LogCategoryPolicy()
+    : sample_rate(1), max_per_second(0), max_payload_size(default_max_payload_size) {}
+
+LogCategoryStats::LogCategoryStats() : logged(0), sampled_out(0), rate_limited(0) {}
+
+ILogSink::~ILogSink() {}
+
+const char* LogCategoryToString(log_category_t category) {
+  if (category < LOG_CATEGORY_COUNT) {
+    return log_category_names[category];
+  }
+
+  DNOTREACHED();
+  return "unknown";
+}
+
+void SetLogCategoryPolicy(log_category_t category, const LogCategoryPolicy& policy) {
+  if (category >= LOG_CATEGORY_COUNT) {
+    DNOTREACHED();
+    return;
+  }
+
+  LogCategory& lcategory = log_categories[category];
+  lcategory.sample_rate.store(policy.sample_rate, std::memory_order_relaxed);
+  lcategory.max_per_second.store(policy.max_per_second, std::memory_order_relaxed);
+  lcategory.max_payload_size.store(policy.max_payload_size, std::memory_order_relaxed);
+}
+
+LogCategoryPolicy GetLogCategoryPolicy(log_category_t category) {
+  LogCategoryPolicy policy;
+  if (category >= LOG_CATEGORY_COUNT) {
+    return policy;
+  }
+
+  const LogCategory& lcategory = log_categories[category];
+  policy.sample_rate = lcategory.sample_rate.load(std::memory_order_relaxed);
+  policy.max_per_second = lcategory.max_per_second.load(std::memory_order_relaxed);
+  policy.max_payload_size = lcategory.max_payload_size.load(std::memory_order_relaxed);
+  return policy;
+}
+
+LogCategoryStats GetLogCategoryStats(log_category_t category) {
+  LogCategoryStats stats;
+  if (category >= LOG_CATEGORY_COUNT) {
+    return stats;
+  }
+
+  const LogCategory& lcategory = log_categories[category];
+  stats.logged = lcategory.logged.load(std::memory_order_relaxed);
+  stats.sampled_out = lcategory.sampled_out.load(std::memory_order_relaxed);
+  stats.rate_limited = lcategory.rate_limited.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool ShouldLog(log_category_t category) {
+  DCHECK(category < LOG_CATEGORY_COUNT);
+  LogCategory& lcategory = log_categories[category];
+  const size_t sample_rate = lcategory.sample_rate.load(std::memory_order_relaxed);
+  if (sample_rate == 0 ||
+      (sample_rate > 1 && lcategory.sequence.fetch_add(1, std::memory_order_relaxed) % sample_rate != 0)) {
+    lcategory.sampled_out.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  const size_t max_per_second = lcategory.max_per_second.load(std::memory_order_relaxed);
+  if (max_per_second && !TakeRateLimitToken(&lcategory, max_per_second)) {
+    lcategory.rate_limited.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  lcategory.logged.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void SetLogSink(ILogSink* sink) {
+  log_sink.store(sink, std::memory_order_release);
+}
+
+LogPayload::LogPayload(log_category_t category, const common::StringPiece& data)
+    : data(data), max_size(LogCategoryPolicy::default_max_payload_size) {
+  if (category < LOG_CATEGORY_COUNT) {
+    max_size = log_categories[category].max_payload_size.load(std::memory_order_relaxed);
+  }
+}
+
+std::ostream& operator<<(std::ostream& out, const LogPayload& payload) {
+  if (payload.data.size() <= payload.max_size) {
+    return out.write(payload.data.data(), payload.data.size());
+  }
+
+  out.write(payload.data.data(), payload.max_size);
+  return out << "...(" << payload.data.size() << " bytes)";
+}
+
+SampledLogMessage::SampledLogMessage(log_category_t category, common::logging::LOG_LEVEL level)
+    : level_(level), stream_() {
+  stream_ << "[" << LogCategoryToString(category) << "] ";
+}
+
+SampledLogMessage::~SampledLogMessage() {
+  ILogSink* sink = log_sink.load(std::memory_order_acquire);
+  if (sink) {
+    sink->Write(level_, stream_.str());
+    return;
+  }
+
+  RUNTIME_LOG(level_) << stream_.str();
+}
+
+std::ostream& SampledLogMessage::Stream() {
+  return stream_;
+}
+
+}  // namespace inner
+}  // namespace fastotv
@@ -0,0 +1,112 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>  // for uint64_t
+
+#include <ostream>  // for ostream
+#include <sstream>  // for ostringstream
+#include <string>   // for string
+
+#include <common/log_levels.h>    // for LOG_LEVEL
+#include <common/macros.h>        // for DISALLOW_COPY_AND_ASSIGN
+#include <common/string_piece.h>  // for StringPiece
+
+// hot path messages, formatted only if category lets them through:
+// SAMPLED_LOG(fastotv::inner::LOG_CATEGORY_COMMANDS) << "client=" << name << " cmd=" << LogPayload(category, cmd);
+#define SAMPLED_LOG(CATEGORY)          \
+  !fastotv::inner::ShouldLog(CATEGORY) \
+      ? (void)0                        \
+      : fastotv::inner::SampledLogVoidify() & fastotv::inner::SampledLogMessage(CATEGORY).Stream()
+
+namespace fastotv {
+namespace inner {
+
+enum log_category_t : uint8_t {
+  LOG_CATEGORY_COMMANDS = 0,  // inner commands received from clients/server
+  LOG_CATEGORY_PINGS,         // pings sent by timers
+  LOG_CATEGORY_EXTERNAL,      // messages from redis subscriptions
+  LOG_CATEGORY_COUNT
+};
+
+struct LogCategoryPolicy {
+  enum { default_max_payload_size = 256 };
+  LogCategoryPolicy();
+
+  size_t sample_rate;       // 1 of N messages logged, 0 - disabled
+  size_t max_per_second;    // 0 - unlimited
+  size_t max_payload_size;  // bytes of LogPayload written
+};
+
+struct LogCategoryStats {
+  LogCategoryStats();
+
+  uint64_t logged;
+  uint64_t sampled_out;
+  uint64_t rate_limited;
+};
+
+// receives formatted messages instead of common logger, called from any thread
+class ILogSink {
+ public:
+  virtual void Write(common::logging::LOG_LEVEL level, std::string&& message) = 0;
+  virtual ~ILogSink();
+};
+
+// thread-safe, all categories settings and counters are process wide
+const char* LogCategoryToString(log_category_t category);
+void SetLogCategoryPolicy(log_category_t category, const LogCategoryPolicy& policy);
+LogCategoryPolicy GetLogCategoryPolicy(log_category_t category);
+LogCategoryStats GetLogCategoryStats(log_category_t category);
+bool ShouldLog(log_category_t category);  // lock-free, counts message as logged or dropped
+void SetLogSink(ILogSink* sink);          // nullptr - common logger, sink should outlive loggers threads
+
+// payload truncated to category max_payload_size, length of full payload appended
+struct LogPayload {
+  LogPayload(log_category_t category, const common::StringPiece& data);
+
+  common::StringPiece data;
+  size_t max_size;
+};
+
+std::ostream& operator<<(std::ostream& out, const LogPayload& payload);
+
+class SampledLogMessage {
+ public:
+  explicit SampledLogMessage(log_category_t category,
+                             common::logging::LOG_LEVEL level = common::logging::LOG_LEVEL_INFO);
+  ~SampledLogMessage();  // message written to sink
+
+  std::ostream& Stream();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SampledLogMessage);
+
+  const common::logging::LOG_LEVEL level_;
+  std::ostringstream stream_;
+};
+
+// lets SAMPLED_LOG be the expression of ternary operator
+class SampledLogVoidify {
+ public:
+  void operator&(std::ostream&) {}
+};
+
+}  // namespace inner
+}  // namespace fastotv
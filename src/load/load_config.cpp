@@ -0,0 +1,45 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "load/load_config.h"
+
+#define LOAD_DEFAULT_LOGIN_PREFIX "load_user_"
+#define LOAD_DEFAULT_PASSWORD "load_password"
+#define LOAD_DEFAULT_DEVICE "load_device"
+
+namespace fastotv {
+namespace load {
+
+LoadConfig::LoadConfig()
+    : host("localhost", SERVICE_HOST_PORT),
+      redis_host(),
+      clients(1000),
+      connect_rate(500),
+      workers(1),
+      duration(60),
+      report_interval(10),
+      login_prefix(LOAD_DEFAULT_LOGIN_PREFIX),
+      password(LOAD_DEFAULT_PASSWORD),
+      device(LOAD_DEFAULT_DEVICE),
+      channels(16),
+      zap_interval(20),
+      chat_interval(60),
+      ping_interval(30),
+      request_timeout(30) {}
+
+}  // namespace load
+}  // namespace fastotv
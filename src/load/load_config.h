@@ -0,0 +1,50 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <string>  // for string
+
+#include <common/net/types.h>  // for HostAndPort
+
+#include "client_server_types.h"  // for login_t, device_id_t
+
+namespace fastotv {
+namespace load {
+
+struct LoadConfig {
+  LoadConfig();
+
+  common::net::HostAndPort host;        // fastotv_server inner port
+  common::net::HostAndPort redis_host;  // users and channels seeded before run, not valid - already seeded
+  size_t clients;                       // simulated devices, one connection each
+  size_t connect_rate;                  // new connections per second, all workers
+  size_t workers;                       // loops driving clients
+  size_t duration;                      // sec, whole run including ramp up
+  size_t report_interval;               // sec, 0 - only final report
+  login_t login_prefix;                 // users logins: login_prefix0, login_prefix1, ...
+  std::string password;
+  device_id_t device;
+  size_t channels;                      // seeded channels of each user, all of them chat channels
+  size_t zap_interval;                  // sec, mean time between zaps (runtime channel info) of client, 0 - off
+  size_t chat_interval;                 // sec, mean time between chat messages of client, 0 - off
+  size_t ping_interval;                 // sec, client pings, 0 - off
+  size_t request_timeout;               // sec, not answered requests counted as timeouts
+};
+
+}  // namespace load
+}  // namespace fastotv
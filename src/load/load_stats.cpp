@@ -0,0 +1,124 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "load/load_stats.h"
+
+#include <inttypes.h>  // for PRIu64
+#include <stdio.h>     // for snprintf
+
+namespace fastotv {
+namespace load {
+namespace {
+
+const char* operations_names[] = {"connect", "auth", "channels", "zap", "chat", "ping"};
+static_assert(SIZEOFMASS(operations_names) == OPERATION_COUNT, "operations_names should match operation_t");
+
+const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+double UsecToMsec(uint64_t usec) {
+  return usec / 1000.0;
+}
+
+double Rate(uint64_t count, double elapsed_sec) {
+  return elapsed_sec > 0 ? count / elapsed_sec : 0;
+}
+
+}  // namespace
+
+const char* OperationToString(operation_t operation) {
+  if (operation >= OPERATION_COUNT) {
+    DNOTREACHED();
+    return "unknown";
+  }
+
+  return operations_names[operation];
+}
+
+LoadStats::LoadStats() : latencies_(), online_(0), disconnects_(0), chat_received_(0), server_requests_(0) {
+  for (size_t i = 0; i < OPERATION_COUNT; ++i) {
+    failures_[i].store(0, std::memory_order_relaxed);
+    timeouts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void LoadStats::RecordSuccess(operation_t operation, uint64_t elapsed_nsec) {
+  latencies_[operation].RecordNsec(elapsed_nsec);
+}
+
+void LoadStats::RecordFailure(operation_t operation) {
+  failures_[operation].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadStats::RecordTimeout(operation_t operation) {
+  timeouts_[operation].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadStats::ClientConnected() {
+  online_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadStats::ClientDisconnected() {
+  online_.fetch_sub(1, std::memory_order_relaxed);
+  disconnects_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadStats::ChatMessageReceived() {
+  chat_received_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadStats::ServerRequestReceived() {
+  server_requests_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string LoadStats::Report(double elapsed_sec) const {
+  char line[256];
+  std::string out;
+  snprintf(line, sizeof(line), "%-10s %10s %8s %8s %10s %9s %9s %9s %9s %9s\n", "operation", "ok", "failed",
+           "timeout", "ok/s", "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms");
+  out += line;
+
+  uint64_t total_ok = 0;
+  for (size_t i = 0; i < OPERATION_COUNT; ++i) {
+    const server::LatencyHistogram::Snapshot hist = latencies_[i].GetSnapshot();
+    total_ok += hist.count;
+    snprintf(line, sizeof(line), "%-10s %10" PRIu64 " %8" PRIu64 " %8" PRIu64 " %10.1f",
+             OperationToString(static_cast<operation_t>(i)), hist.count,
+             failures_[i].load(std::memory_order_relaxed), timeouts_[i].load(std::memory_order_relaxed),
+             Rate(hist.count, elapsed_sec));
+    out += line;
+    for (double quantile : quantiles) {
+      snprintf(line, sizeof(line), " %9.2f", UsecToMsec(hist.ValueAtQuantile(quantile)));
+      out += line;
+    }
+    snprintf(line, sizeof(line), " %9.2f\n", UsecToMsec(hist.max_usec));
+    out += line;
+  }
+
+  const uint64_t chat_received = chat_received_.load(std::memory_order_relaxed);
+  const uint64_t server_requests = server_requests_.load(std::memory_order_relaxed);
+  snprintf(line, sizeof(line),
+           "elapsed %.1f sec, online %" PRIu64 ", disconnects %" PRIu64 ", operations %.1f/s, "
+           "server requests %.1f/s, chat received %" PRIu64 " (%.1f/s)\n",
+           elapsed_sec, online_.load(std::memory_order_relaxed), disconnects_.load(std::memory_order_relaxed),
+           Rate(total_ok, elapsed_sec), Rate(server_requests, elapsed_sec), chat_received,
+           Rate(chat_received, elapsed_sec));
+  out += line;
+  return out;
+}
+
+}  // namespace load
+}  // namespace fastotv
@@ -0,0 +1,75 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <stdint.h>  // for uint64_t
+
+#include <atomic>  // for atomic
+#include <string>  // for string
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "server/latency_histogram.h"  // for LatencyHistogram
+
+namespace fastotv {
+namespace load {
+
+enum operation_t {
+  OPERATION_CONNECT = 0,  // tcp connect
+  OPERATION_AUTH,         // connected - who_are_you approved
+  OPERATION_CHANNELS,     // get_channels
+  OPERATION_ZAP,          // get_runtime_channel_info
+  OPERATION_CHAT,         // send_chat_message
+  OPERATION_PING,         // client ping
+  OPERATION_COUNT
+};
+
+const char* OperationToString(operation_t operation);
+
+// shared by all workers, thread-safe
+class LoadStats {
+ public:
+  LoadStats();
+
+  void RecordSuccess(operation_t operation, uint64_t elapsed_nsec);
+  void RecordFailure(operation_t operation);
+  void RecordTimeout(operation_t operation);
+
+  void ClientConnected();
+  void ClientDisconnected();
+  void ChatMessageReceived();  // server fan-out
+  void ServerRequestReceived();
+
+  // counts, rates since start and latency percentiles in msec of each operation
+  std::string Report(double elapsed_sec) const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LoadStats);
+
+  server::LatencyHistogram latencies_[OPERATION_COUNT];
+  std::atomic<uint64_t> failures_[OPERATION_COUNT];
+  std::atomic<uint64_t> timeouts_[OPERATION_COUNT];
+
+  std::atomic<uint64_t> online_;
+  std::atomic<uint64_t> disconnects_;
+  std::atomic<uint64_t> chat_received_;
+  std::atomic<uint64_t> server_requests_;
+};
+
+}  // namespace load
+}  // namespace fastotv
@@ -0,0 +1,513 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "load/load_tcp_handler.h"
+
+#include <string>  // for string
+
+#include <json-c/json_object.h>   // for json_object
+#include <json-c/json_tokener.h>  // for json_tokener_parse
+
+#include <common/libev/io_loop.h>  // for IoLoop
+#include <common/logger.h>         // for WARNING_LOG
+#include <common/net/net.h>        // for connect
+
+#include "auth_info.h"           // for AuthInfo
+#include "channels_info.h"       // for ChannelsInfo
+#include "chat_message.h"        // for ChatMessage
+#include "client/commands.h"     // for PingRequest, GetChannelsRequest
+#include "client_info.h"         // for ClientInfo
+#include "inner/frame_codec.h"   // for SelectFrameCodec
+#include "inner/inner_client.h"  // for InnerClient
+#include "ping_info.h"           // for ServerPingInfo
+
+#include "load/users_seeder.h"  // for MakeLogin
+
+#define LOAD_CLIENT_OS "load"
+#define LOAD_CHAT_MESSAGE "load message"
+
+namespace fastotv {
+namespace load {
+namespace {
+
+uint64_t ElapsedNsec(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+cmd_approve_t ApproveResponce(operation_t operation, cmd_seq_t id) {  // as player approves server responces
+  switch (operation) {
+    case OPERATION_CHANNELS:
+      return client::GetChannelsApproveResponceSuccsess(id);
+    case OPERATION_ZAP:
+      return client::GetRuntimeChannelInfoApproveResponceSuccsess(id);
+    case OPERATION_CHAT:
+      return client::SendChatMessageApproveResponceSuccsess(id);
+    default:
+      DCHECK(operation == OPERATION_PING);
+      return client::PingApproveResponceSuccsess(id);
+  }
+}
+
+}  // namespace
+
+LoadTcpHandler::Session::Session()
+    : login(),
+      connection(nullptr),
+      generation(0),
+      authorized(false),
+      connected_at(),
+      channels(),
+      current_stream(),
+      next_zap_msec(0),
+      next_chat_msec(0),
+      next_ping_msec(0) {}
+
+LoadTcpHandler::LoadTcpHandler(const LoadConfig& config,
+                               size_t first_user,
+                               size_t users_count,
+                               size_t connect_rate,
+                               LoadStats* stats)
+    : fastotv::inner::InnerServerCommandSeqParser(),
+      common::libev::IoLoopObserver(),
+      config_(config),
+      connect_rate_(connect_rate),
+      stats_(stats),
+      sessions_(users_count),
+      sessions_index_(),
+      commands_(),
+      next_connect_(0),
+      connect_credit_(0),
+      next_generation_(0),
+      ticks_(0),
+      tick_timer_(INVALID_TIMER_ID),
+      request_handlers_({{OPCODE_SERVER_PING, &LoadTcpHandler::HandleServerPingRequest},
+                         {OPCODE_SERVER_WHO_ARE_YOU, &LoadTcpHandler::HandleWhoAreYouRequest},
+                         {OPCODE_SERVER_GET_CLIENT_INFO, &LoadTcpHandler::HandleClientInfoRequest},
+                         {OPCODE_SERVER_SEND_CHAT_MESSAGE, &LoadTcpHandler::HandleServerChatMessageRequest}}),
+      random_(first_user) {
+  for (size_t i = 0; i < sessions_.size(); ++i) {
+    sessions_[i].login = MakeLogin(config, first_user + i);
+  }
+}
+
+LoadTcpHandler::~LoadTcpHandler() {
+  CHECK(sessions_index_.empty());
+}
+
+void LoadTcpHandler::PreLooped(common::libev::IoLoop* server) {
+  tick_timer_ = server->CreateTimer(1.0 / ticks_per_second, true);
+}
+
+void LoadTcpHandler::Accepted(common::libev::IoClient* client) {
+  UNUSED(client);
+}
+
+void LoadTcpHandler::Moved(common::libev::IoLoop* server, common::libev::IoClient* client) {
+  UNUSED(server);
+  UNUSED(client);
+}
+
+void LoadTcpHandler::Closed(common::libev::IoClient* client) {
+  fastotv::inner::InnerClient* iclient = static_cast<fastotv::inner::InnerClient*>(client);
+  sessions_index_t::iterator it = sessions_index_.find(iclient);
+  if (it == sessions_index_.end()) {
+    return;
+  }
+
+  Session* session = &sessions_[it->second];
+  session->connection = nullptr;
+  session->authorized = false;
+  sessions_index_.erase(it);
+  stats_->ClientDisconnected();
+}
+
+void LoadTcpHandler::DataReceived(common::libev::IoClient* client) {
+  fastotv::inner::InnerClient* iclient = static_cast<fastotv::inner::InnerClient*>(client);
+  size_t commands_count = 0;
+  common::Error err = iclient->ReadCommands(&commands_, &commands_count);
+  iclient->BeginWriteBatch();
+  for (size_t i = 0; i < commands_count; ++i) {
+    HandleInnerDataReceived(iclient, commands_[i]);
+    if (sessions_index_.find(iclient) == sessions_index_.end()) {  // closed while handling
+      return;
+    }
+  }
+
+  common::Error write_err = iclient->EndWriteBatch();
+  if (!err) {
+    err = write_err;
+  }
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    CloseConnection(iclient);
+  }
+}
+
+void LoadTcpHandler::DataReadyToWrite(common::libev::IoClient* client) {
+  fastotv::inner::InnerClient* iclient = static_cast<fastotv::inner::InnerClient*>(client);
+  common::Error err = iclient->Flush();
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    CloseConnection(iclient);
+  }
+}
+
+void LoadTcpHandler::PostLooped(common::libev::IoLoop* server) {
+  if (tick_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(tick_timer_);
+    tick_timer_ = INVALID_TIMER_ID;
+  }
+
+  for (size_t i = 0; i < sessions_.size(); ++i) {
+    if (sessions_[i].connection) {
+      CloseConnection(sessions_[i].connection);
+    }
+  }
+  CHECK(sessions_index_.empty());
+}
+
+void LoadTcpHandler::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
+  if (id != tick_timer_) {
+    return;
+  }
+
+  ConnectSessions(server);
+  if (++ticks_ % ticks_per_second == 0) {
+    ExpireRequests();
+    RunScenario();
+  }
+}
+
+void LoadTcpHandler::ConnectSessions(common::libev::IoLoop* server) {
+  connect_credit_ += connect_rate_;
+  size_t connects = connect_credit_ / ticks_per_second;
+  connect_credit_ %= ticks_per_second;
+  while (connects-- && next_connect_ < sessions_.size()) {
+    Connect(server, next_connect_++);
+  }
+}
+
+void LoadTcpHandler::Connect(common::libev::IoLoop* server, size_t slot) {
+  struct timeval tv = {static_cast<long>(config_.request_timeout), 0};
+  common::net::socket_info client_info;
+  const time_point_t start = std::chrono::steady_clock::now();
+  common::ErrnoError err = common::net::connect(config_.host, common::net::ST_SOCK_STREAM, &tv, &client_info);
+  if (err) {
+    stats_->RecordFailure(OPERATION_CONNECT);
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_DEBUG);
+    return;
+  }
+  stats_->RecordSuccess(OPERATION_CONNECT, ElapsedNsec(start));
+
+  Session* session = &sessions_[slot];
+  fastotv::inner::InnerClient* connection = new fastotv::inner::InnerClient(server, client_info);
+  session->connection = connection;
+  session->generation = ++next_generation_;
+  session->authorized = false;
+  session->connected_at = std::chrono::steady_clock::now();
+  sessions_index_[connection] = slot;
+  stats_->ClientConnected();
+  server->RegisterClient(connection);
+}
+
+void LoadTcpHandler::RunScenario() {
+  const common::time64_t now_msec = common::time::current_mstime();
+  const time_point_t now = std::chrono::steady_clock::now();
+  for (size_t slot = 0; slot < sessions_.size(); ++slot) {
+    Session* session = &sessions_[slot];
+    if (!session->connection) {
+      continue;
+    }
+
+    if (!session->authorized) {
+      if (now - session->connected_at > std::chrono::seconds(config_.request_timeout)) {
+        stats_->RecordTimeout(OPERATION_AUTH);
+        CloseConnection(session->connection);
+      }
+      continue;
+    }
+
+    if (session->next_ping_msec && session->next_ping_msec <= now_msec) {
+      session->next_ping_msec = NextActionTime(now_msec, config_.ping_interval);
+      SendRequest(slot, OPERATION_PING, client::PingRequest(NextRequestID()));
+    }
+
+    if (session->connection && !session->channels.empty() && session->next_zap_msec &&
+        session->next_zap_msec <= now_msec) {
+      session->next_zap_msec = NextActionTime(now_msec, config_.zap_interval);
+      std::uniform_int_distribution<size_t> channel(0, session->channels.size() - 1);
+      session->current_stream = session->channels[channel(random_)];
+      SendRequest(slot, OPERATION_ZAP, client::GetRuntimeChannelInfoRequest(NextRequestID(), session->current_stream));
+    }
+
+    if (session->connection && !session->current_stream.empty() && session->next_chat_msec &&
+        session->next_chat_msec <= now_msec) {
+      session->next_chat_msec = NextActionTime(now_msec, config_.chat_interval);
+      const ChatMessage msg(session->current_stream, session->login, LOAD_CHAT_MESSAGE, ChatMessage::MESSAGE);
+      serializet_t msg_ser;
+      common::Error err = msg.SerializeToString(&msg_ser);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        continue;
+      }
+      SendRequest(slot, OPERATION_CHAT, client::SendChatMessageRequest(NextRequestID(), msg_ser));
+    }
+  }
+}
+
+void LoadTcpHandler::CloseConnection(fastotv::inner::InnerClient* connection) {
+  connection->Close();
+  delete connection;
+}
+
+void LoadTcpHandler::SendRequest(size_t slot, operation_t operation, const cmd_request_t& request) {
+  Session* session = &sessions_[slot];
+  common::Error err = session->connection->Write(request);
+  if (err) {
+    stats_->RecordFailure(operation);
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    CloseConnection(session->connection);
+    return;
+  }
+
+  const uint64_t generation = session->generation;
+  const time_point_t sent_at = std::chrono::steady_clock::now();
+  auto cb = [this, slot, generation, operation, sent_at](cmd_seq_t request_id, const CommandArgsView& argv) {
+    HandleResponce(slot, generation, operation, sent_at, request_id, argv);
+  };
+  auto timeout_cb = [this, slot, generation, operation](cmd_seq_t request_id) {
+    UNUSED(request_id);
+    const Session& current = sessions_[slot];
+    if (current.connection && current.generation == generation) {  // requests of closed connections not counted
+      stats_->RecordTimeout(operation);
+    }
+  };
+  SubscribeRequest(fastotv::inner::RequestCallback(request.GetId(), cb, timeout_cb), config_.request_timeout);
+}
+
+void LoadTcpHandler::HandleResponce(size_t slot,
+                                    uint64_t generation,
+                                    operation_t operation,
+                                    time_point_t sent_at,
+                                    cmd_seq_t id,
+                                    const CommandArgsView& argv) {
+  Session* session = &sessions_[slot];
+  if (!session->connection || session->generation != generation) {
+    return;
+  }
+
+  const cmd_state_t state = argv.size() > 1 ? CommandToState(argv[0].data()) : STATE_NONE;
+  if (state != STATE_SUCCESS) {
+    stats_->RecordFailure(operation);
+    return;
+  }
+  stats_->RecordSuccess(operation, ElapsedNsec(sent_at));
+
+  if (operation == OPERATION_CHANNELS) {
+    HandleChannels(session, argv);
+  }
+
+  common::Error err = session->connection->Write(ApproveResponce(operation, id));
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    CloseConnection(session->connection);
+  }
+}
+
+void LoadTcpHandler::HandleChannels(Session* session, const CommandArgsView& argv) {
+  json_object* obj = argv.size() > 2 ? json_tokener_parse(argv[2].data()) : NULL;
+  if (!obj) {
+    return;
+  }
+
+  ChannelsInfo chan;
+  common::Error err = ChannelsInfo::DeSerialize(obj, &chan);
+  json_object_put(obj);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    return;
+  }
+
+  const ChannelsInfo::channels_t channels = chan.GetChannels();
+  session->channels.clear();
+  for (size_t i = 0; i < channels.size(); ++i) {
+    session->channels.push_back(channels[i].GetId());
+  }
+
+  const common::time64_t now_msec = common::time::current_mstime();
+  session->next_zap_msec = NextActionTime(now_msec, config_.zap_interval);
+  session->next_chat_msec = NextActionTime(now_msec, config_.chat_interval);
+}
+
+common::time64_t LoadTcpHandler::NextActionTime(common::time64_t now_msec, size_t interval_sec) {
+  if (interval_sec == 0) {
+    return 0;
+  }
+
+  // uniform in [interval / 2, interval * 3 / 2], so clients connected together not act together
+  const common::time64_t interval_msec = static_cast<common::time64_t>(interval_sec) * 1000;
+  std::uniform_int_distribution<common::time64_t> jitter(interval_msec / 2, interval_msec * 3 / 2);
+  return now_msec + jitter(random_);
+}
+
+void LoadTcpHandler::HandleInnerRequestCommand(fastotv::inner::InnerClient* connection,
+                                               cmd_seq_t id,
+                                               const CommandArgsView& argv) {
+  stats_->ServerRequestReceived();
+  const char* command = argv[0].data();
+  cmd_opcode_t opcode;
+  if (request_handlers_.Find(command, &opcode)) {
+    request_handlers_.Execute(this, opcode, connection, id, argv);
+    return;
+  }
+
+  WARNING_LOG() << "UNKNOWN REQUEST COMMAND: " << command;
+}
+
+void LoadTcpHandler::HandleInnerResponceCommand(fastotv::inner::InnerClient* connection,
+                                                cmd_seq_t id,
+                                                const CommandArgsView& argv) {
+  UNUSED(connection);
+  UNUSED(id);
+  UNUSED(argv);  // all requests subscribed, responces handled by callbacks or already timed out
+}
+
+void LoadTcpHandler::HandleInnerApproveCommand(fastotv::inner::InnerClient* connection,
+                                               cmd_seq_t id,
+                                               const CommandArgsView& argv) {
+  UNUSED(id);
+  // only authorization approve handled
+  if (argv.size() < 2 || CommandToOpcode(argv[1].data()) != OPCODE_SERVER_WHO_ARE_YOU) {
+    return;
+  }
+
+  sessions_index_t::const_iterator it = sessions_index_.find(connection);
+  if (it == sessions_index_.end()) {
+    return;
+  }
+
+  const size_t slot = it->second;
+  Session* session = &sessions_[slot];
+  if (CommandToState(argv[0].data()) != STATE_SUCCESS) {
+    stats_->RecordFailure(OPERATION_AUTH);
+    WARNING_LOG() << "Authorization of " << session->login
+                  << " failed: " << (argv.size() > 2 ? argv[2].data() : "Unknown");
+    CloseConnection(connection);
+    return;
+  }
+
+  stats_->RecordSuccess(OPERATION_AUTH, ElapsedNsec(session->connected_at));
+  session->authorized = true;
+  session->next_ping_msec = NextActionTime(common::time::current_mstime(), config_.ping_interval);
+  connection->SetName(session->login);
+  SendRequest(slot, OPERATION_CHANNELS, client::GetChannelsRequest(NextRequestID()));
+}
+
+void LoadTcpHandler::HandleServerPingRequest(fastotv::inner::InnerClient* connection,
+                                             cmd_seq_t id,
+                                             const CommandArgsView& argv) {
+  UNUSED(argv);
+  serializet_t ping_str;
+  common::Error err = ServerPingInfo().SerializeToString(&ping_str);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    return;
+  }
+
+  err = connection->Write(client::PingResponceSuccsess(id, ping_str));
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+}
+
+void LoadTcpHandler::HandleWhoAreYouRequest(fastotv::inner::InnerClient* connection,
+                                            cmd_seq_t id,
+                                            const CommandArgsView& argv) {
+  sessions_index_t::const_iterator it = sessions_index_.find(connection);
+  if (it == sessions_index_.end()) {
+    return;
+  }
+
+  const AuthInfo ainf(sessions_[it->second].login, config_.password, config_.device);
+  serializet_t auth_str;
+  common::Error err = ainf.SerializeToString(&auth_str);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    return;
+  }
+
+  protocol_version_t offered = PROTOCOL_V1;  // same negotiation as player
+  if (argv.size() > 1 && !ConvertFromString(argv[1].as_string(), &offered)) {
+    offered = PROTOCOL_V1;
+  }
+  fastotv::inner::frame_codec_t codec;
+  if (argv.size() > 2 && fastotv::inner::SelectFrameCodec(argv[2].as_string(), &codec)) {
+    err = connection->Write(
+        client::WhoAreYouResponceSuccsess(id, auth_str, offered, fastotv::inner::FrameCodecToString(codec)));
+    connection->SetProtocolVersion(offered);
+    connection->SetFrameCodec(codec);
+  } else if (offered == PROTOCOL_V2) {
+    err = connection->Write(client::WhoAreYouResponceSuccsess(id, auth_str, PROTOCOL_V2));
+    connection->SetProtocolVersion(PROTOCOL_V2);
+  } else {
+    err = connection->Write(client::WhoAreYouResponceSuccsess(id, auth_str));
+  }
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+}
+
+void LoadTcpHandler::HandleClientInfoRequest(fastotv::inner::InnerClient* connection,
+                                             cmd_seq_t id,
+                                             const CommandArgsView& argv) {
+  UNUSED(argv);
+  sessions_index_t::const_iterator it = sessions_index_.find(connection);
+  if (it == sessions_index_.end()) {
+    return;
+  }
+
+  const ClientInfo info(sessions_[it->second].login, LOAD_CLIENT_OS, LOAD_CLIENT_OS, 0, 0, 0);
+  serializet_t info_str;
+  common::Error err = info.SerializeToString(&info_str);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    return;
+  }
+
+  err = connection->Write(client::SystemInfoResponceSuccsess(id, info_str));
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+}
+
+void LoadTcpHandler::HandleServerChatMessageRequest(fastotv::inner::InnerClient* connection,
+                                                    cmd_seq_t id,
+                                                    const CommandArgsView& argv) {
+  if (argv.size() < 2) {
+    return;
+  }
+
+  stats_->ChatMessageReceived();
+  const serializet_t msg = argv[1].as_string();
+  common::Error err = connection->Write(client::SendChatMessageResponceSuccsess(id, msg));  // echo as player
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+}
+
+}  // namespace load
+}  // namespace fastotv
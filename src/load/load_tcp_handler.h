@@ -0,0 +1,138 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <chrono>         // for steady_clock
+#include <random>         // for mt19937
+#include <unordered_map>  // for unordered_map
+#include <vector>         // for vector
+
+#include <common/libev/io_loop_observer.h>  // for IoLoopObserver
+#include <common/libev/types.h>             // for timer_id_t
+#include <common/time.h>                    // for time64_t
+
+#include "commands/commands.h"                      // for cmd_seq_t
+#include "inner/command_handlers.h"                 // for CommandHandlers
+#include "inner/inner_server_command_seq_parser.h"  // for InnerServerCommandSeqParser
+
+#include "client_server_types.h"  // for login_t, stream_id
+
+#include "load/load_config.h"  // for LoadConfig
+#include "load/load_stats.h"   // for operation_t
+
+namespace fastotv {
+namespace inner {
+class InnerClient;
+}
+namespace load {
+
+// drives simulated devices of one loop: connects them with configured rate, answers server requests like
+// player does and scripts channels, zaps, chat and pings, each request timed until server responce
+class LoadTcpHandler : public fastotv::inner::InnerServerCommandSeqParser, public common::libev::IoLoopObserver {
+ public:
+  enum { ticks_per_second = 10 };
+  typedef fastotv::inner::CommandHandlers<LoadTcpHandler, void> request_handlers_t;
+
+  // users [first_user, first_user + users_count) connected with connect_rate per second
+  LoadTcpHandler(const LoadConfig& config,
+                 size_t first_user,
+                 size_t users_count,
+                 size_t connect_rate,
+                 LoadStats* stats);
+  virtual ~LoadTcpHandler();
+
+  virtual void PreLooped(common::libev::IoLoop* server) override;
+  virtual void Accepted(common::libev::IoClient* client) override;
+  virtual void Moved(common::libev::IoLoop* server, common::libev::IoClient* client) override;
+  virtual void Closed(common::libev::IoClient* client) override;
+  virtual void DataReceived(common::libev::IoClient* client) override;
+  virtual void DataReadyToWrite(common::libev::IoClient* client) override;
+  virtual void PostLooped(common::libev::IoLoop* server) override;
+  virtual void TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) override;
+
+ private:
+  typedef std::chrono::steady_clock::time_point time_point_t;
+  struct Session {
+    Session();
+
+    login_t login;
+    fastotv::inner::InnerClient* connection;  // nullptr if not connected
+    uint64_t generation;                      // changed on each connect, callbacks of old connections ignored
+    bool authorized;
+    time_point_t connected_at;
+    std::vector<stream_id> channels;
+    stream_id current_stream;
+    common::time64_t next_zap_msec;  // 0 - not scheduled
+    common::time64_t next_chat_msec;
+    common::time64_t next_ping_msec;
+  };
+  typedef std::unordered_map<fastotv::inner::InnerClient*, size_t> sessions_index_t;
+
+  void ConnectSessions(common::libev::IoLoop* server);
+  void Connect(common::libev::IoLoop* server, size_t slot);
+  void RunScenario();
+  void CloseConnection(fastotv::inner::InnerClient* connection);
+
+  // request written and subscribed, result and latency recorded when responce received or timed out
+  void SendRequest(size_t slot, operation_t operation, const cmd_request_t& request);
+  void HandleResponce(size_t slot,
+                      uint64_t generation,
+                      operation_t operation,
+                      time_point_t sent_at,
+                      cmd_seq_t id,
+                      const CommandArgsView& argv);
+  void HandleChannels(Session* session, const CommandArgsView& argv);
+  common::time64_t NextActionTime(common::time64_t now_msec, size_t interval_sec);
+
+  virtual void HandleInnerRequestCommand(fastotv::inner::InnerClient* connection,
+                                         cmd_seq_t id,
+                                         const CommandArgsView& argv) override;
+  virtual void HandleInnerResponceCommand(fastotv::inner::InnerClient* connection,
+                                          cmd_seq_t id,
+                                          const CommandArgsView& argv) override;
+  virtual void HandleInnerApproveCommand(fastotv::inner::InnerClient* connection,
+                                         cmd_seq_t id,
+                                         const CommandArgsView& argv) override;
+
+  // server requests
+  void HandleServerPingRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleWhoAreYouRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleClientInfoRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleServerChatMessageRequest(fastotv::inner::InnerClient* connection,
+                                      cmd_seq_t id,
+                                      const CommandArgsView& argv);
+
+  const LoadConfig config_;
+  const size_t connect_rate_;
+  LoadStats* const stats_;
+
+  std::vector<Session> sessions_;
+  sessions_index_t sessions_index_;
+  std::vector<std::string> commands_;  // decoded commands, strings capacity reused between reads
+  size_t next_connect_;    // sessions [0, next_connect_) connect attempted
+  size_t connect_credit_;  // connect_rate_ accumulated by ticks, ticks_per_second per connection
+  uint64_t next_generation_;
+  uint64_t ticks_;
+
+  common::libev::timer_id_t tick_timer_;
+  request_handlers_t request_handlers_;
+  std::mt19937 random_;
+};
+
+}  // namespace load
+}  // namespace fastotv
@@ -0,0 +1,209 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdio.h>   // for printf, fprintf, stderr
+#include <stdlib.h>  // for EXIT_FAILURE, EXIT_SUCCESS
+#include <unistd.h>  // for getopt, optarg
+
+#include <chrono>  // for steady_clock, seconds
+#include <memory>  // for shared_ptr
+#include <string>  // for string
+#include <thread>  // for this_thread::sleep_for
+#include <vector>  // for vector
+
+#include <common/convert2string.h>          // for ConvertFromString
+#include <common/log_levels.h>              // for LOG_LEVEL
+#include <common/logger.h>                  // for INIT_LOGGER
+#include <common/sprintf.h>                 // for MemSPrintf
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+
+#include "client/inner/inner_tcp_server.h"  // for InnerTcpServer
+
+#include "load/load_config.h"       // for LoadConfig
+#include "load/load_stats.h"        // for LoadStats
+#include "load/load_tcp_handler.h"  // for LoadTcpHandler
+#include "load/users_seeder.h"      // for SeedUsers
+
+namespace {
+
+void usage(const char* name) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  -s host:port  fastotv_server inner address (default localhost:%d)\n"
+          "  -r host:port  redis to seed users and chat channels into before run\n"
+          "  -n count      simulated clients\n"
+          "  -c count      new connections per second\n"
+          "  -w count      worker loops\n"
+          "  -t sec        run duration, including ramp up\n"
+          "  -i sec        report interval, 0 - only final report\n"
+          "  -l prefix     users logins prefix\n"
+          "  -p password   users password\n"
+          "  -d device     users device id\n"
+          "  -C count      seeded channels\n"
+          "  -z sec        mean zap interval of client, 0 - off\n"
+          "  -m sec        mean chat message interval of client, 0 - off\n"
+          "  -P sec        mean ping interval of client, 0 - off\n"
+          "  -T sec        request timeout\n",
+          name, SERVICE_HOST_PORT);
+}
+
+bool parse_args(int argc, char* argv[], fastotv::load::LoadConfig* config) {
+  int opt;
+  while ((opt = getopt(argc, argv, "s:r:n:c:w:t:i:l:p:d:C:z:m:P:T:h")) != -1) {
+    bool res = true;
+    switch (opt) {
+      case 's':
+        res = common::ConvertFromString(std::string(optarg), &config->host);
+        break;
+      case 'r':
+        res = common::ConvertFromString(std::string(optarg), &config->redis_host);
+        break;
+      case 'n':
+        res = common::ConvertFromString(std::string(optarg), &config->clients);
+        break;
+      case 'c':
+        res = common::ConvertFromString(std::string(optarg), &config->connect_rate);
+        break;
+      case 'w':
+        res = common::ConvertFromString(std::string(optarg), &config->workers) && config->workers != 0;
+        break;
+      case 't':
+        res = common::ConvertFromString(std::string(optarg), &config->duration);
+        break;
+      case 'i':
+        res = common::ConvertFromString(std::string(optarg), &config->report_interval);
+        break;
+      case 'l':
+        config->login_prefix = optarg;
+        break;
+      case 'p':
+        config->password = optarg;
+        break;
+      case 'd':
+        config->device = optarg;
+        break;
+      case 'C':
+        res = common::ConvertFromString(std::string(optarg), &config->channels);
+        break;
+      case 'z':
+        res = common::ConvertFromString(std::string(optarg), &config->zap_interval);
+        break;
+      case 'm':
+        res = common::ConvertFromString(std::string(optarg), &config->chat_interval);
+        break;
+      case 'P':
+        res = common::ConvertFromString(std::string(optarg), &config->ping_interval);
+        break;
+      case 'T':
+        res = common::ConvertFromString(std::string(optarg), &config->request_timeout);
+        break;
+      default: /* '?' or 'h' */
+        return false;
+    }
+
+    if (!res) {
+      fprintf(stderr, "Invalid -%c value: %s\n", opt, optarg);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int exec_loop(common::libev::IoLoop* loop) {
+  return loop->Exec();
+}
+
+size_t share(size_t total, size_t parts, size_t index) {  // total split between parts, remainder to first ones
+  return total / parts + (index < total % parts ? 1 : 0);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  fastotv::load::LoadConfig config;
+  if (!parse_args(argc, argv, &config)) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+#if defined(NDEBUG)
+  common::logging::LOG_LEVEL level = common::logging::LOG_LEVEL_INFO;
+#else
+  common::logging::LOG_LEVEL level = common::logging::LOG_LEVEL_DEBUG;
+#endif
+  INIT_LOGGER(PROJECT_NAME_LOAD_TITLE, level);
+
+  if (config.redis_host.IsValid()) {
+    common::Error err = fastotv::load::SeedUsers(config);
+    if (err) {
+      fprintf(stderr, "Users not seeded: %s\n", err->GetDescription().c_str());
+      return EXIT_FAILURE;
+    }
+    printf("Seeded %zu users with %zu chat channels\n", config.clients, config.channels);
+  }
+
+  fastotv::load::LoadStats stats;
+  std::vector<fastotv::load::LoadTcpHandler*> handlers;
+  std::vector<common::libev::IoLoop*> loops;  // loops[i] observed by handlers[i]
+  std::vector<std::shared_ptr<common::threads::Thread<int> > > threads;
+  size_t first_user = 0;
+  for (size_t i = 0; i < config.workers; ++i) {
+    const size_t users = share(config.clients, config.workers, i);
+    fastotv::load::LoadTcpHandler* handler = new fastotv::load::LoadTcpHandler(
+        config, first_user, users, share(config.connect_rate, config.workers, i), &stats);
+    common::libev::IoLoop* loop = new fastotv::client::inner::InnerTcpServer(handler);
+    loop->SetName(common::MemSPrintf("load_worker_%lu", i));
+    handlers.push_back(handler);
+    loops.push_back(loop);
+    first_user += users;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (common::libev::IoLoop* loop : loops) {
+    std::shared_ptr<common::threads::Thread<int> > thread = THREAD_MANAGER()->CreateThread(&exec_loop, loop);
+    if (!thread->Start()) {
+      fprintf(stderr, "Worker %s not started\n", loop->GetName().c_str());
+      continue;
+    }
+    threads.push_back(thread);
+  }
+
+  for (size_t sec = 1; sec <= config.duration; ++sec) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    if (config.report_interval && sec % config.report_interval == 0 && sec != config.duration) {
+      const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      printf("%s\n", stats.Report(elapsed).c_str());
+      fflush(stdout);
+    }
+  }
+
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%s", stats.Report(elapsed).c_str());  // before clients disconnected by stop
+  for (common::libev::IoLoop* loop : loops) {
+    loop->Stop();
+  }
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i]->Join();
+  }
+
+  for (size_t i = 0; i < loops.size(); ++i) {
+    delete loops[i];
+    delete handlers[i];
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "load/users_seeder.h"
+
+#include <string>  // for string
+#include <vector>  // for vector
+
+#include <hiredis/hiredis.h>  // for redisContext, redisAppendCommand
+
+#include <json-c/json_object.h>  // for json_object
+
+#include <common/sprintf.h>  // for MemSPrintf
+
+#include "channel_info.h"   // for ChannelInfo
+#include "channels_info.h"  // for ChannelsInfo
+#include "epg_info.h"       // for EpgInfo
+
+#include "server/redis/redis_connect.h"  // for redis_tcp_connect
+#include "server/user_info.h"            // for UserInfo
+
+#include "load/load_config.h"
+
+#define SET_KEY_2E "SET %s %s"
+#define SET_CHAT_CHANNELS_1E "SET chat_channels %s"
+#define PUBLISH_CHAT_CHANNELS_UPDATES "PUBLISH CHAT_CHANNELS_UPDATES reload"
+#define ID_FIELD "id"
+
+#define LOAD_STREAM_ID_PREFIX "load_channel_"
+#define LOAD_STREAM_URL_PREFIX "http://localhost/load/"
+
+namespace fastotv {
+namespace load {
+namespace {
+
+const size_t pipeline_size = 1024;  // commands in flight
+
+common::Error ReadReplies(redisContext* redis, size_t count) {
+  common::Error first_err;
+  for (size_t i = 0; i < count; ++i) {
+    void* reply = NULL;
+    if (redisGetReply(redis, &reply) != REDIS_OK) {
+      return common::make_error(redis->errstr);
+    }
+
+    redisReply* rreply = static_cast<redisReply*>(reply);
+    if (rreply->type == REDIS_REPLY_ERROR && !first_err) {
+      first_err = common::make_error(rreply->str);
+    }
+    freeReplyObject(rreply);
+  }
+  return first_err;
+}
+
+common::Error MakeUserJson(const LoadConfig& config,
+                           size_t user_index,
+                           const ChannelsInfo& channels,
+                           std::string* out) {
+  server::UserInfo user(MakeLogin(config, user_index), config.password, channels, {config.device});
+  json_object* juser = NULL;
+  common::Error err = user.Serialize(&juser);
+  if (err) {
+    return err;
+  }
+
+  const std::string uid = common::MemSPrintf("%024lu", user_index);  // mongodb id sized
+  json_object_object_add(juser, ID_FIELD, json_object_new_string(uid.c_str()));
+  *out = json_object_get_string(juser);
+  json_object_put(juser);
+  return common::Error();
+}
+
+}  // namespace
+
+login_t MakeLogin(const LoadConfig& config, size_t user_index) {
+  return common::MemSPrintf("%s%lu", config.login_prefix, user_index);
+}
+
+stream_id MakeStreamId(size_t channel_index) {
+  return common::MemSPrintf(LOAD_STREAM_ID_PREFIX "%lu", channel_index);
+}
+
+common::Error SeedUsers(const LoadConfig& config) {
+  ChannelsInfo channels;
+  json_object* jchat_channels = json_object_new_array();
+  for (size_t i = 0; i < config.channels; ++i) {
+    const stream_id sid = MakeStreamId(i);
+    const common::uri::Url url(LOAD_STREAM_URL_PREFIX + sid + ".m3u8");
+    channels.AddChannel(ChannelInfo(EpgInfo(sid, url, sid), true, true));
+    json_object_array_add(jchat_channels, json_object_new_string(sid.c_str()));
+  }
+  const std::string chat_channels = json_object_get_string(jchat_channels);
+  json_object_put(jchat_channels);
+
+  redisContext* redis = NULL;
+  common::Error err = server::redis::redis_tcp_connect(config.redis_host, &redis);
+  if (err) {
+    return err;
+  }
+
+  size_t in_flight = 0;
+  for (size_t i = 0; i < config.clients; ++i) {
+    std::string user_json;
+    err = MakeUserJson(config, i, channels, &user_json);
+    if (err) {
+      redisFree(redis);
+      return err;
+    }
+
+    const login_t login = MakeLogin(config, i);
+    redisAppendCommand(redis, SET_KEY_2E, login.c_str(), user_json.c_str());
+    if (++in_flight == pipeline_size) {
+      err = ReadReplies(redis, in_flight);
+      in_flight = 0;
+      if (err) {
+        redisFree(redis);
+        return err;
+      }
+    }
+  }
+
+  redisAppendCommand(redis, SET_CHAT_CHANNELS_1E, chat_channels.c_str());
+  redisAppendCommand(redis, PUBLISH_CHAT_CHANNELS_UPDATES);
+  err = ReadReplies(redis, in_flight + 2);
+  redisFree(redis);
+  return err;
+}
+
+}  // namespace load
+}  // namespace fastotv
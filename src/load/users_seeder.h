@@ -0,0 +1,38 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for WARN_UNUSED_RESULT
+
+#include "client_server_types.h"  // for login_t, stream_id
+
+namespace fastotv {
+namespace load {
+
+struct LoadConfig;
+
+login_t MakeLogin(const LoadConfig& config, size_t user_index);
+stream_id MakeStreamId(size_t channel_index);
+
+// users records and chat channels written in the same form as fastotv_server reads them,
+// chat channels reload published, so running server picks them up
+common::Error SeedUsers(const LoadConfig& config) WARN_UNUSED_RESULT;
+
+}  // namespace load
+}  // namespace fastotv
@@ -47,56 +47,6 @@ bool ProgrammeInfo::IsValid() const {
   return channel_ != invalid_stream_id && !title_.empty();
 }
 
-common::Error ProgrammeInfo::SerializeImpl(serialize_type* deserialized) const {
-  if (!IsValid()) {
-    return common::make_error_inval();
-  }
-
-  json_object* obj = json_object_new_object();
-  json_object_object_add(obj, PROGRAMME_INFO_CHANNEL_FIELD, json_object_new_string(channel_.c_str()));
-  json_object_object_add(obj, PROGRAMME_INFO_START_FIELD, json_object_new_int64(start_time_));
-  json_object_object_add(obj, PROGRAMME_INFO_STOP_FIELD, json_object_new_int64(stop_time_));
-  json_object_object_add(obj, PROGRAMME_INFO_TITLE_FIELD, json_object_new_string(title_.c_str()));
-
-  *deserialized = obj;
-  return common::Error();
-}
-
-common::Error ProgrammeInfo::DeSerialize(const serialize_type& serialized, value_type* obj) {
-  if (!serialized || !obj) {
-    return common::make_error_inval();
-  }
-
-  json_object* jchannel = NULL;
-  json_bool jchannel_exists = json_object_object_get_ex(serialized, PROGRAMME_INFO_CHANNEL_FIELD, &jchannel);
-  if (!jchannel_exists) {
-    return common::make_error_inval();
-  }
-
-  json_object* jstart = NULL;
-  json_bool jstart_exists = json_object_object_get_ex(serialized, PROGRAMME_INFO_START_FIELD, &jstart);
-  if (!jstart_exists) {
-    return common::make_error_inval();
-  }
-
-  json_object* jstop = NULL;
-  json_bool jstop_exists = json_object_object_get_ex(serialized, PROGRAMME_INFO_STOP_FIELD, &jstop);
-  if (!jstop_exists) {
-    return common::make_error_inval();
-  }
-
-  json_object* jtitle = NULL;
-  json_bool jtitle_exists = json_object_object_get_ex(serialized, PROGRAMME_INFO_TITLE_FIELD, &jtitle);
-  if (!jtitle_exists) {
-    return common::make_error_inval();
-  }
-
-  fastotv::ProgrammeInfo prog(json_object_get_string(jchannel), json_object_get_int64(jstart),
-                              json_object_get_int64(jstop), json_object_get_string(jtitle));
-  *obj = prog;
-  return common::Error();
-}
-
 void ProgrammeInfo::SetChannel(stream_id channel) {
   channel_ = channel;
 }
@@ -134,4 +84,14 @@ bool ProgrammeInfo::Equals(const ProgrammeInfo& prog) const {
          title_ == prog.title_;
 }
 
+template <typename Self, typename Visitor>
+void ProgrammeInfo::Fields(Self* self, Visitor* visitor) {
+  visitor->Field(PROGRAMME_INFO_CHANNEL_FIELD, &self->channel_, serializer::FIELD_REQUIRED);
+  visitor->Field(PROGRAMME_INFO_START_FIELD, &self->start_time_, serializer::FIELD_REQUIRED);
+  visitor->Field(PROGRAMME_INFO_STOP_FIELD, &self->stop_time_, serializer::FIELD_REQUIRED);
+  visitor->Field(PROGRAMME_INFO_TITLE_FIELD, &self->title_, serializer::FIELD_REQUIRED);
+}
+
+SERIALIZER_FIELDS_INSTANTIATE(ProgrammeInfo);
+
 }  // namespace fastotv
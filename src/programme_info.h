@@ -20,11 +20,11 @@
 
 #include "client_server_types.h"
 
-#include "serializer/json_serializer.h"
+#include "serializer/fields_serializer.h"
 
 namespace fastotv {
 
-class ProgrammeInfo : public JsonSerializer<ProgrammeInfo> {
+class ProgrammeInfo : public FieldsSerializer<ProgrammeInfo> {
  public:
   ProgrammeInfo();
   ProgrammeInfo(stream_id id, timestamp_t start_time, timestamp_t stop_time, const std::string& title);
@@ -43,14 +43,13 @@ class ProgrammeInfo : public JsonSerializer<ProgrammeInfo> {
   void SetTitle(const std::string& title);
   std::string GetTitle() const;
 
-  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
-
   bool Equals(const ProgrammeInfo& prog) const;
 
- protected:
-  common::Error SerializeImpl(serialize_type* deserialized) const override;
-
  private:
+  friend struct serializer::FieldsAccess;
+  template <typename Self, typename Visitor>
+  static void Fields(Self* self, Visitor* visitor);
+
   stream_id channel_;
   timestamp_t start_time_;  // utc time
   timestamp_t stop_time_;   // utc time
@@ -102,101 +102,22 @@ ChannelType RuntimeChannelInfo::GetChannelType() const {
   return type_;
 }
 
-common::Error RuntimeChannelInfo::SerializeImpl(serialize_type* deserialized) const {
-  if (!IsValid()) {
-    return common::make_error_inval();
-  }
-
-  json_object* obj = json_object_new_object();
-  json_object* jmsgs = json_object_new_array();
-  for (size_t i = 0; i < messages_.size(); ++i) {
-    serialize_type jmsg = NULL;
-    common::Error err = messages_[i].Serialize(&jmsg);
-    if (err) {
-      continue;
-    }
-    json_object_array_add(jmsgs, jmsg);
-  }
-
-  json_object_object_add(obj, RUNTIME_CHANNEL_INFO_CHANNEL_ID_FIELD, json_object_new_string(channel_id_.c_str()));
-  json_object_object_add(obj, RUNTIME_CHANNEL_INFO_WATCHERS_FIELD, json_object_new_int(watchers_));
-  json_object_object_add(obj, RUNTIME_CHANNEL_INFO_CHANNEL_TYPE_FIELD, json_object_new_int(type_));
-  json_object_object_add(obj, RUNTIME_CHANNEL_INFO_CHAT_ENABLED_FIELD, json_object_new_boolean(chat_enabled_));
-  json_object_object_add(obj, RUNTIME_CHANNEL_INFO_CHAT_READONLY_FIELD, json_object_new_boolean(chat_read_only_));
-  json_object_object_add(obj, RUNTIME_CHANNEL_INFO_MESSAGES_FIELD, jmsgs);
-  *deserialized = obj;
-  return common::Error();
-}
-
-common::Error RuntimeChannelInfo::DeSerialize(const serialize_type& serialized, value_type* obj) {
-  if (!serialized || !obj) {
-    return common::make_error_inval();
-  }
-
-  RuntimeChannelInfo inf;
-
-  json_object* jwatchers = NULL;
-  json_bool jwatchers_exists = json_object_object_get_ex(serialized, RUNTIME_CHANNEL_INFO_WATCHERS_FIELD, &jwatchers);
-  if (jwatchers_exists) {
-    inf.watchers_ = json_object_get_int64(jwatchers);
-  }
-
-  json_object* jcid = NULL;
-  json_bool jcid_exists = json_object_object_get_ex(serialized, RUNTIME_CHANNEL_INFO_CHANNEL_ID_FIELD, &jcid);
-  if (!jcid_exists) {
-    return common::make_error_inval();
-  }
-  stream_id cid = json_object_get_string(jcid);
-  if (cid == invalid_stream_id) {
-    return common::make_error_inval();
-  }
-  inf.channel_id_ = cid;
-
-  json_object* jchat_type = NULL;
-  json_bool jchat_type_exists =
-      json_object_object_get_ex(serialized, RUNTIME_CHANNEL_INFO_CHANNEL_TYPE_FIELD, &jchat_type);
-  if (jchat_type_exists) {
-    inf.type_ = static_cast<ChannelType>(json_object_get_int(jchat_type));
-  }
-
-  json_object* jchat_enabled = NULL;
-  json_bool jchat_enabled_exists =
-      json_object_object_get_ex(serialized, RUNTIME_CHANNEL_INFO_CHAT_ENABLED_FIELD, &jchat_enabled);
-  if (jchat_enabled_exists) {
-    inf.chat_enabled_ = json_object_get_boolean(jchat_enabled);
-  }
-
-  json_object* jchat_readonly = NULL;
-  json_bool jchat_readonly_exists =
-      json_object_object_get_ex(serialized, RUNTIME_CHANNEL_INFO_CHAT_READONLY_FIELD, &jchat_readonly);
-  if (jchat_readonly_exists) {
-    inf.chat_read_only_ = json_object_get_boolean(jchat_readonly);
-  }
-
-  json_object* jmsgs = NULL;
-  json_bool jmsgs_exists = json_object_object_get_ex(serialized, RUNTIME_CHANNEL_INFO_MESSAGES_FIELD, &jmsgs);
-  if (jmsgs_exists) {
-    messages_t msgs;
-    size_t len = json_object_array_length(jmsgs);
-    for (size_t i = 0; i < len; ++i) {
-      json_object* jmess = json_object_array_get_idx(jmsgs, i);
-      ChatMessage msg;
-      common::Error err = ChatMessage::DeSerialize(jmess, &msg);
-      if (err) {
-        continue;
-      }
-      msgs.push_back(msg);
-    }
-    inf.messages_ = msgs;
-  }
-
-  *obj = inf;
-  return common::Error();
-}
-
 bool RuntimeChannelInfo::Equals(const RuntimeChannelInfo& inf) const {
   return channel_id_ == inf.channel_id_ && watchers_ == inf.watchers_ && chat_enabled_ == inf.chat_enabled_ &&
          messages_ == inf.messages_;
 }
 
+template <typename Self, typename Visitor>
+void RuntimeChannelInfo::Fields(Self* self, Visitor* visitor) {
+  visitor->Field(RUNTIME_CHANNEL_INFO_CHANNEL_ID_FIELD, &self->channel_id_,
+                 serializer::FIELD_REQUIRED | serializer::FIELD_NOT_EMPTY);
+  visitor->Field(RUNTIME_CHANNEL_INFO_WATCHERS_FIELD, &self->watchers_, serializer::FIELD_OPTIONAL);
+  visitor->Field(RUNTIME_CHANNEL_INFO_CHANNEL_TYPE_FIELD, &self->type_, serializer::FIELD_OPTIONAL);
+  visitor->Field(RUNTIME_CHANNEL_INFO_CHAT_ENABLED_FIELD, &self->chat_enabled_, serializer::FIELD_OPTIONAL);
+  visitor->Field(RUNTIME_CHANNEL_INFO_CHAT_READONLY_FIELD, &self->chat_read_only_, serializer::FIELD_OPTIONAL);
+  visitor->Field(RUNTIME_CHANNEL_INFO_MESSAGES_FIELD, &self->messages_, serializer::FIELD_OPTIONAL);
+}
+
+SERIALIZER_FIELDS_INSTANTIATE(RuntimeChannelInfo);
+
 }  // namespace fastotv
@@ -22,11 +22,11 @@
 
 #include "chat_message.h"
 
-#include "serializer/json_serializer.h"
+#include "serializer/fields_serializer.h"
 
 namespace fastotv {
 
-class RuntimeChannelInfo : public JsonSerializer<RuntimeChannelInfo> {
+class RuntimeChannelInfo : public FieldsSerializer<RuntimeChannelInfo> {
  public:
   typedef std::vector<ChatMessage> messages_t;
   RuntimeChannelInfo();
@@ -40,8 +40,6 @@ class RuntimeChannelInfo : public JsonSerializer<RuntimeChannelInfo> {
 
   bool IsValid() const;
 
-  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
-
   void SetChannelId(stream_id sid);
   stream_id GetChannelId() const;
 
@@ -62,10 +60,11 @@ class RuntimeChannelInfo : public JsonSerializer<RuntimeChannelInfo> {
 
   bool Equals(const RuntimeChannelInfo& inf) const;
 
- protected:
-  common::Error SerializeImpl(serialize_type* deserialized) const override;
-
  private:
+  friend struct serializer::FieldsAccess;
+  template <typename Self, typename Visitor>
+  static void Fields(Self* self, Visitor* visitor);
+
   stream_id channel_id_;
   size_t watchers_;
   ChannelType type_;
@@ -0,0 +1,167 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "serializer/binary_fields.h"
+
+#define MAX_VARINT_SIZE 10
+
+namespace fastotv {
+namespace serializer {
+namespace {
+
+size_t EncodeVarint(uint64_t value, char* out) {
+  size_t size = 0;
+  while (value >= 0x80) {
+    out[size++] = static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  out[size++] = static_cast<char>(value);
+  return size;
+}
+
+}  // namespace
+
+BinaryReader::BinaryReader(const char* data, size_t size) : pos_(data), end_(data + size) {}
+
+bool BinaryReader::IsEnd() const {
+  return pos_ == end_;
+}
+
+common::Error BinaryReader::ReadVarint(uint64_t* out) {
+  uint64_t result = 0;
+  for (size_t i = 0; i < MAX_VARINT_SIZE; ++i) {
+    if (pos_ == end_) {
+      return common::make_error("Binary data truncated");
+    }
+
+    const uint8_t byte = static_cast<uint8_t>(*pos_++);
+    result |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+    if (!(byte & 0x80)) {
+      *out = result;
+      return common::Error();
+    }
+  }
+
+  return common::make_error("Binary varint too long");
+}
+
+common::Error BinaryReader::ReadBytes(size_t size, const char** out) {
+  if (static_cast<size_t>(end_ - pos_) < size) {
+    return common::make_error("Binary data truncated");
+  }
+
+  *out = pos_;
+  pos_ += size;
+  return common::Error();
+}
+
+common::Error BinaryReader::ReadSubReader(BinaryReader* out) {
+  uint64_t size;
+  common::Error err = ReadVarint(&size);
+  if (err) {
+    return err;
+  }
+
+  const char* data = NULL;
+  err = ReadBytes(size, &data);
+  if (err) {
+    return err;
+  }
+
+  *out = BinaryReader(data, size);
+  return common::Error();
+}
+
+void AppendVarint(uint64_t value, std::string* out) {
+  char buff[MAX_VARINT_SIZE];
+  out->append(buff, EncodeVarint(value, buff));
+}
+
+void InsertVarint(uint64_t value, size_t pos, std::string* out) {
+  char buff[MAX_VARINT_SIZE];
+  out->insert(pos, buff, EncodeVarint(value, buff));
+}
+
+common::Error ToBinary(const std::string& value, std::string* out) {
+  AppendVarint(value.size(), out);
+  out->append(value);
+  return common::Error();
+}
+
+common::Error ToBinary(bool value, std::string* out) {
+  out->push_back(value ? 1 : 0);
+  return common::Error();
+}
+
+common::Error ToBinary(const common::uri::Url& value, std::string* out) {
+  return ToBinary(value.GetUrl(), out);
+}
+
+common::Error FromBinary(BinaryReader* reader, std::string* out) {
+  uint64_t size;
+  common::Error err = reader->ReadVarint(&size);
+  if (err) {
+    return err;
+  }
+
+  const char* data = NULL;
+  err = reader->ReadBytes(size, &data);
+  if (err) {
+    return err;
+  }
+
+  out->assign(data, size);
+  return common::Error();
+}
+
+common::Error FromBinary(BinaryReader* reader, bool* out) {
+  const char* data = NULL;
+  common::Error err = reader->ReadBytes(1, &data);
+  if (err) {
+    return err;
+  }
+
+  *out = *data != 0;
+  return common::Error();
+}
+
+common::Error FromBinary(BinaryReader* reader, common::uri::Url* out) {
+  std::string url;
+  common::Error err = FromBinary(reader, &url);
+  if (err) {
+    return err;
+  }
+
+  *out = common::uri::Url(url);
+  return common::Error();
+}
+
+BinaryFieldsWriter::BinaryFieldsWriter(std::string* out) : out_(out), err_() {}
+
+common::Error BinaryFieldsWriter::GetError() const {
+  return err_;
+}
+
+BinaryFieldsReader::BinaryFieldsReader(BinaryReader* reader) : reader_(reader), err_() {}
+
+common::Error BinaryFieldsReader::GetError() const {
+  return err_;
+}
+
+}  // namespace serializer
+}  // namespace fastotv
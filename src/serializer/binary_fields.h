@@ -0,0 +1,320 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>       // for string
+#include <type_traits>  // for integral_constant
+#include <utility>      // for move
+#include <vector>       // for vector
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "serializer/fields.h"
+
+// binary encoder of fields tables, fields without names in table order:
+// unsigned integers - varint (7 bits per byte, little endian), signed integers and enums - zigzag varint,
+// bool - 1 byte, strings and urls - [varint]size [bytes], arrays - [varint]count elements,
+// objects - [varint]size fields; fields missing at the end of object (written by older version) read as missing,
+// unknown fields at the end (written by newer version) skipped
+
+namespace fastotv {
+namespace serializer {
+
+class BinaryReader {
+ public:
+  BinaryReader(const char* data, size_t size);
+
+  bool IsEnd() const;
+  common::Error ReadVarint(uint64_t* out) WARN_UNUSED_RESULT;
+  common::Error ReadBytes(size_t size, const char** out) WARN_UNUSED_RESULT;  // out points into data
+  common::Error ReadSubReader(BinaryReader* out) WARN_UNUSED_RESULT;          // [varint]size [bytes]
+
+ private:
+  const char* pos_;
+  const char* end_;
+};
+
+void AppendVarint(uint64_t value, std::string* out);
+void InsertVarint(uint64_t value, size_t pos, std::string* out);
+inline uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+inline int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+common::Error ToBinary(const std::string& value, std::string* out);
+common::Error ToBinary(bool value, std::string* out);
+common::Error ToBinary(const common::uri::Url& value, std::string* out);
+template <typename T>
+common::Error ToBinary(const std::vector<T>& values, std::string* out);
+template <typename T>
+common::Error ToBinary(const T& value, std::string* out);  // integers, enums and classes with fields table
+
+common::Error FromBinary(BinaryReader* reader, std::string* out);
+common::Error FromBinary(BinaryReader* reader, bool* out);
+common::Error FromBinary(BinaryReader* reader, common::uri::Url* out);
+template <typename T>
+common::Error FromBinary(BinaryReader* reader, std::vector<T>* out);
+template <typename T>
+common::Error FromBinary(BinaryReader* reader, T* out);
+
+class BinaryFieldsWriter {
+ public:
+  explicit BinaryFieldsWriter(std::string* out);
+
+  template <typename T>
+  void Field(const char* name, const T* value, field_flags_t flags) {
+    UNUSED(name);
+    UNUSED(flags);
+    if (err_) {
+      return;
+    }
+    err_ = ToBinary(*value, out_);
+  }
+
+  common::Error GetError() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BinaryFieldsWriter);
+
+  std::string* const out_;
+  common::Error err_;
+};
+
+class BinaryFieldsReader {
+ public:
+  explicit BinaryFieldsReader(BinaryReader* reader);
+
+  template <typename T>
+  void Field(const char* name, T* value, field_flags_t flags) {
+    UNUSED(name);
+    if (err_) {
+      return;
+    }
+
+    if (reader_->IsEnd()) {
+      if (flags & FIELD_REQUIRED) {
+        err_ = common::make_error_inval();
+      }
+      return;
+    }
+
+    T result = T();
+    err_ = FromBinary(reader_, &result);
+    if (err_) {
+      return;
+    }
+    if (!IsFieldValueValid(result, flags)) {
+      err_ = common::make_error_inval();
+      return;
+    }
+    *value = std::move(result);
+  }
+
+  common::Error GetError() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BinaryFieldsReader);
+
+  BinaryReader* const reader_;
+  common::Error err_;
+};
+
+// object fields without size, invalid objects not serialized
+template <typename T>
+common::Error WriteBinaryObject(const T& obj, std::string* out) {
+  if (!out || !obj.IsValid()) {
+    return common::make_error_inval();
+  }
+
+  BinaryFieldsWriter writer(out);
+  FieldsAccess::Visit(&obj, &writer);
+  return writer.GetError();
+}
+
+template <typename T>
+common::Error ReadBinaryObject(BinaryReader* reader, T* out) {
+  if (!reader || !out) {
+    return common::make_error_inval();
+  }
+
+  T result;
+  BinaryFieldsReader fields(reader);
+  FieldsAccess::Visit(&result, &fields);
+  common::Error err = fields.GetError();
+  if (err) {
+    return err;
+  }
+
+  *out = std::move(result);
+  return common::Error();
+}
+
+namespace detail {
+
+template <typename T>
+common::Error ToBinary(const T& value, std::string* out, std::true_type /* signed */, std::true_type /* number */) {
+  AppendVarint(ZigZagEncode(static_cast<int64_t>(value)), out);
+  return common::Error();
+}
+
+template <typename T>
+common::Error ToBinary(const T& value, std::string* out, std::false_type /* signed */, std::true_type /* number */) {
+  AppendVarint(static_cast<uint64_t>(value), out);
+  return common::Error();
+}
+
+template <typename T, typename S>
+common::Error ToBinary(const T& obj, std::string* out, S /* signed */, std::false_type /* number */) {
+  const size_t start = out->size();
+  common::Error err = WriteBinaryObject(obj, out);
+  if (err) {
+    out->resize(start);
+    return err;
+  }
+
+  InsertVarint(out->size() - start, start, out);
+  return common::Error();
+}
+
+template <typename T>
+common::Error FromBinary(BinaryReader* reader, T* out, std::true_type /* signed */, std::true_type /* number */) {
+  uint64_t value;
+  common::Error err = reader->ReadVarint(&value);
+  if (err) {
+    return err;
+  }
+
+  *out = static_cast<T>(ZigZagDecode(value));
+  return common::Error();
+}
+
+template <typename T>
+common::Error FromBinary(BinaryReader* reader, T* out, std::false_type /* signed */, std::true_type /* number */) {
+  uint64_t value;
+  common::Error err = reader->ReadVarint(&value);
+  if (err) {
+    return err;
+  }
+
+  *out = static_cast<T>(value);
+  return common::Error();
+}
+
+template <typename T, typename S>
+common::Error FromBinary(BinaryReader* reader, T* out, S /* signed */, std::false_type /* number */) {
+  BinaryReader object(NULL, 0);
+  common::Error err = reader->ReadSubReader(&object);
+  if (err) {
+    return err;
+  }
+
+  return ReadBinaryObject(&object, out);
+}
+
+// array element, invalid object skipped: its size known, malformed data not
+template <typename T>
+common::Error FromBinaryElement(BinaryReader* reader, T* out, bool* skip, std::true_type /* object */) {
+  BinaryReader object(NULL, 0);
+  common::Error err = reader->ReadSubReader(&object);
+  if (err) {
+    return err;
+  }
+
+  err = ReadBinaryObject(&object, out);
+  *skip = static_cast<bool>(err);
+  return err;
+}
+
+template <typename T>
+common::Error FromBinaryElement(BinaryReader* reader, T* out, bool* skip, std::false_type /* object */) {
+  *skip = false;
+  return FromBinary(reader, out);
+}
+
+template <typename T>
+struct IsSigned : std::integral_constant<bool, std::is_enum<T>::value || std::is_signed<T>::value> {};
+
+template <typename T>
+struct IsObject : std::integral_constant<bool,
+                                         !IsNumber<T>::value && !std::is_same<T, std::string>::value &&
+                                             !std::is_same<T, common::uri::Url>::value> {};
+
+}  // namespace detail
+
+template <typename T>
+common::Error ToBinary(const std::vector<T>& values, std::string* out) {
+  const size_t start = out->size();
+  uint64_t count = 0;
+  for (const T& value : values) {
+    const size_t value_start = out->size();
+    common::Error err = ToBinary(value, out);
+    if (err) {
+      out->resize(value_start);
+      continue;
+    }
+    count++;
+  }
+
+  InsertVarint(count, start, out);
+  return common::Error();
+}
+
+template <typename T>
+common::Error ToBinary(const T& value, std::string* out) {
+  return detail::ToBinary(value, out, detail::IsSigned<T>(), IsNumber<T>());
+}
+
+template <typename T>
+common::Error FromBinary(BinaryReader* reader, std::vector<T>* out) {
+  uint64_t count;
+  common::Error err = reader->ReadVarint(&count);
+  if (err) {
+    return err;
+  }
+
+  std::vector<T> result;
+  for (uint64_t i = 0; i < count; ++i) {
+    T value = T();
+    bool skip = false;
+    err = detail::FromBinaryElement(reader, &value, &skip, detail::IsObject<T>());
+    if (err) {
+      if (skip) {
+        continue;
+      }
+      return err;
+    }
+    result.push_back(std::move(value));
+  }
+
+  out->swap(result);
+  return common::Error();
+}
+
+template <typename T>
+common::Error FromBinary(BinaryReader* reader, T* out) {
+  return detail::FromBinary(reader, out, detail::IsSigned<T>(), IsNumber<T>());
+}
+
+}  // namespace serializer
+}  // namespace fastotv
@@ -0,0 +1,78 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>       // for string
+#include <type_traits>  // for remove_const, integral_constant
+
+#include <common/macros.h>   // for UNUSED
+#include <common/uri/url.h>  // for Url
+
+// fields table of serializable class, one definition for all encoders:
+//   friend struct serializer::FieldsAccess;
+//   template <typename Self, typename Visitor>
+//   static void Fields(Self* self, Visitor* visitor) {
+//     visitor->Field("name", &self->name_, serializer::FIELD_REQUIRED | serializer::FIELD_NOT_EMPTY);
+//   }
+// Self is const for writers, field types: std::string, bool, integers, enums, common::uri::Url,
+// serializable classes, std::vector of them; name NULL - only field, object serialized as its value
+// (json array for vector); fields order is binary layout, new fields only appended
+
+namespace fastotv {
+namespace serializer {
+
+enum field_flags_t : uint8_t {
+  FIELD_OPTIONAL = 0,       // missing - default value of object kept
+  FIELD_REQUIRED = 1 << 0,  // missing - error
+  FIELD_NOT_EMPTY = 1 << 1  // strings not empty, urls valid
+};
+
+inline field_flags_t operator|(field_flags_t lhs, field_flags_t rhs) {
+  return static_cast<field_flags_t>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+}
+
+template <typename T>  // encoded as integer
+struct IsNumber : std::integral_constant<bool, std::is_integral<T>::value || std::is_enum<T>::value> {};
+
+struct FieldsAccess {
+  template <typename T, typename Visitor>
+  static void Visit(T* obj, Visitor* visitor) {
+    std::remove_const<T>::type::Fields(obj, visitor);
+  }
+};
+
+template <typename T>
+inline bool IsFieldValueValid(const T& value, field_flags_t flags) {
+  UNUSED(value);
+  UNUSED(flags);
+  return true;
+}
+
+inline bool IsFieldValueValid(const std::string& value, field_flags_t flags) {
+  return !(flags & FIELD_NOT_EMPTY) || !value.empty();
+}
+
+inline bool IsFieldValueValid(const common::uri::Url& value, field_flags_t flags) {
+  return !(flags & FIELD_NOT_EMPTY) || value.IsValid();
+}
+
+}  // namespace serializer
+}  // namespace fastotv
@@ -0,0 +1,83 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>  // for string
+
+#include <common/string_piece.h>  // for StringPiece
+
+#include "serializer/binary_fields.h"
+#include "serializer/json_fields.h"
+#include "serializer/json_serializer.h"  // for JsonSerializer
+#include "serializer/json_string_fields.h"
+
+// fields table instantiated for all encoders in source file of class, after Fields defined
+#define SERIALIZER_FIELDS_INSTANTIATE(T)                                           \
+  template void T::Fields(const T*, fastotv::serializer::JsonFieldsWriter*);       \
+  template void T::Fields(T*, fastotv::serializer::JsonFieldsReader*);             \
+  template void T::Fields(const T*, fastotv::serializer::JsonStringFieldsWriter*); \
+  template void T::Fields(const T*, fastotv::serializer::BinaryFieldsWriter*);     \
+  template void T::Fields(T*, fastotv::serializer::BinaryFieldsReader*)
+
+namespace fastotv {
+
+// json (redis, admin, protocol) and binary (caches) forms of one fields table,
+// T declares fields table (serializer/fields.h) and IsValid, invalid objects not serialized
+template <typename T>
+class FieldsSerializer : public JsonSerializer<T> {
+ public:
+  typedef JsonSerializer<T> base_class;
+  typedef typename base_class::value_type value_type;
+  typedef typename base_class::serialize_type serialize_type;
+
+  // streaming, without json objects tree; out cleared, its capacity reused
+  virtual common::Error SerializeToString(std::string* out) const override WARN_UNUSED_RESULT {
+    if (!out) {
+      return common::make_error_inval();
+    }
+
+    out->clear();
+    return serializer::WriteJsonStringObject(static_cast<const T&>(*this), out);
+  }
+
+  common::Error SerializeToBinary(std::string* out) const WARN_UNUSED_RESULT {  // out cleared
+    if (!out) {
+      return common::make_error_inval();
+    }
+
+    out->clear();
+    return serializer::WriteBinaryObject(static_cast<const T&>(*this), out);
+  }
+
+  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT {
+    return serializer::ReadJsonObject(serialized, obj);
+  }
+
+  static common::Error DeSerializeFromBinary(const common::StringPiece& data, value_type* obj) WARN_UNUSED_RESULT {
+    serializer::BinaryReader reader(data.data(), data.size());
+    return serializer::ReadBinaryObject(&reader, obj);
+  }
+
+ protected:
+  virtual common::Error SerializeImpl(serialize_type* deserialized) const override {
+    return serializer::WriteJsonObject(static_cast<const T&>(*this), deserialized);
+  }
+};
+
+}  // namespace fastotv
@@ -0,0 +1,115 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "serializer/json_fields.h"
+
+namespace fastotv {
+namespace serializer {
+
+common::Error ToJson(const std::string& value, json_object** out) {
+  *out = json_object_new_string_len(value.data(), static_cast<int>(value.size()));
+  return common::Error();
+}
+
+common::Error ToJson(bool value, json_object** out) {
+  *out = json_object_new_boolean(value);
+  return common::Error();
+}
+
+common::Error ToJson(const common::uri::Url& value, json_object** out) {
+  return ToJson(value.GetUrl(), out);
+}
+
+common::Error FromJson(json_object* json, std::string* out) {
+  const char* value = json_object_get_string(json);
+  if (!value) {
+    return common::make_error_inval();
+  }
+
+  *out = std::string(value, json_object_get_string_len(json));
+  return common::Error();
+}
+
+common::Error FromJson(json_object* json, bool* out) {
+  *out = json_object_get_boolean(json);
+  return common::Error();
+}
+
+common::Error FromJson(json_object* json, common::uri::Url* out) {
+  std::string url;
+  common::Error err = FromJson(json, &url);
+  if (err) {
+    return err;
+  }
+
+  *out = common::uri::Url(url);
+  return common::Error();
+}
+
+JsonFieldsWriter::JsonFieldsWriter() : result_(NULL), err_() {}
+
+JsonFieldsWriter::~JsonFieldsWriter() {
+  if (result_) {
+    json_object_put(result_);
+  }
+}
+
+common::Error JsonFieldsWriter::Release(json_object** out) {
+  if (err_) {
+    return err_;
+  }
+
+  *out = result_ ? result_ : json_object_new_object();  // class without fields
+  result_ = NULL;
+  return common::Error();
+}
+
+void JsonFieldsWriter::Add(const char* name, json_object* value) {
+  if (!name) {  // only field, object is its value
+    DCHECK(!result_);
+    result_ = value;
+    return;
+  }
+
+  if (!result_) {
+    result_ = json_object_new_object();
+  }
+  json_object_object_add(result_, name, value);
+}
+
+JsonFieldsReader::JsonFieldsReader(json_object* json) : json_(json), err_() {}
+
+common::Error JsonFieldsReader::GetError() const {
+  return err_;
+}
+
+json_object* JsonFieldsReader::Find(const char* name) const {
+  if (!name) {
+    return json_;
+  }
+
+  json_object* value = NULL;
+  json_bool exists = json_object_object_get_ex(json_, name, &value);
+  if (!exists) {
+    return NULL;
+  }
+  return value;
+}
+
+}  // namespace serializer
+}  // namespace fastotv
@@ -0,0 +1,238 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>       // for string
+#include <type_traits>  // for true_type
+#include <utility>      // for move
+#include <vector>       // for vector
+
+#include <json-c/json_object.h>
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "serializer/fields.h"
+
+// json encoder of fields tables: object per class, arrays of invalid elements skip them
+
+namespace fastotv {
+namespace serializer {
+
+common::Error ToJson(const std::string& value, json_object** out);
+common::Error ToJson(bool value, json_object** out);
+common::Error ToJson(const common::uri::Url& value, json_object** out);
+template <typename T>
+common::Error ToJson(const std::vector<T>& values, json_object** out);
+template <typename T>
+common::Error ToJson(const T& value, json_object** out);  // integers, enums and classes with fields table
+
+common::Error FromJson(json_object* json, std::string* out);
+common::Error FromJson(json_object* json, bool* out);
+common::Error FromJson(json_object* json, common::uri::Url* out);
+template <typename T>
+common::Error FromJson(json_object* json, std::vector<T>* out);
+template <typename T>
+common::Error FromJson(json_object* json, T* out);
+
+class JsonFieldsWriter {
+ public:
+  JsonFieldsWriter();
+  ~JsonFieldsWriter();
+
+  template <typename T>
+  void Field(const char* name, const T* value, field_flags_t flags) {
+    UNUSED(flags);
+    if (err_) {
+      return;
+    }
+
+    json_object* jvalue = NULL;
+    err_ = ToJson(*value, &jvalue);
+    if (err_) {
+      return;
+    }
+    Add(name, jvalue);
+  }
+
+  common::Error Release(json_object** out) WARN_UNUSED_RESULT;  // error of first failed field
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(JsonFieldsWriter);
+
+  void Add(const char* name, json_object* value);
+
+  json_object* result_;
+  common::Error err_;
+};
+
+class JsonFieldsReader {
+ public:
+  explicit JsonFieldsReader(json_object* json);
+
+  template <typename T>
+  void Field(const char* name, T* value, field_flags_t flags) {
+    if (err_) {
+      return;
+    }
+
+    json_object* jvalue = Find(name);
+    if (!jvalue) {
+      if (flags & FIELD_REQUIRED) {
+        err_ = common::make_error_inval();
+      }
+      return;
+    }
+
+    T result = *value;
+    err_ = FromJson(jvalue, &result);
+    if (err_) {
+      return;
+    }
+    if (!IsFieldValueValid(result, flags)) {
+      err_ = common::make_error_inval();
+      return;
+    }
+    *value = std::move(result);
+  }
+
+  common::Error GetError() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(JsonFieldsReader);
+
+  json_object* Find(const char* name) const;  // NULL if missing or null
+
+  json_object* const json_;
+  common::Error err_;
+};
+
+// invalid objects not serialized
+template <typename T>
+common::Error WriteJsonObject(const T& obj, json_object** out) {
+  if (!out || !obj.IsValid()) {
+    return common::make_error_inval();
+  }
+
+  JsonFieldsWriter writer;
+  FieldsAccess::Visit(&obj, &writer);
+  return writer.Release(out);
+}
+
+template <typename T>
+common::Error ReadJsonObject(json_object* json, T* out) {
+  if (!json || !out) {
+    return common::make_error_inval();
+  }
+
+  T result;
+  JsonFieldsReader reader(json);
+  FieldsAccess::Visit(&result, &reader);
+  common::Error err = reader.GetError();
+  if (err) {
+    return err;
+  }
+
+  *out = std::move(result);
+  return common::Error();
+}
+
+namespace detail {
+
+template <typename T>
+common::Error ToJson(const T& value, json_object** out, std::true_type /* number */) {
+  *out = json_object_new_int64(static_cast<int64_t>(value));
+  return common::Error();
+}
+
+template <typename T>
+common::Error ToJson(const T& obj, json_object** out, std::false_type /* number */) {
+  return WriteJsonObject(obj, out);
+}
+
+template <typename T>
+common::Error FromJson(json_object* json, T* out, std::true_type /* number */) {
+  *out = static_cast<T>(json_object_get_int64(json));
+  return common::Error();
+}
+
+template <typename T>
+common::Error FromJson(json_object* json, T* out, std::false_type /* number */) {
+  return ReadJsonObject(json, out);
+}
+
+}  // namespace detail
+
+template <typename T>
+common::Error ToJson(const std::vector<T>& values, json_object** out) {
+  json_object* jvalues = json_object_new_array();
+  for (const T& value : values) {
+    json_object* jvalue = NULL;
+    common::Error err = ToJson(value, &jvalue);
+    if (err) {
+      continue;
+    }
+    json_object_array_add(jvalues, jvalue);
+  }
+
+  *out = jvalues;
+  return common::Error();
+}
+
+template <typename T>
+common::Error ToJson(const T& value, json_object** out) {
+  return detail::ToJson(value, out, IsNumber<T>());
+}
+
+template <typename T>
+common::Error FromJson(json_object* json, std::vector<T>* out) {
+  if (!json_object_is_type(json, json_type_array)) {
+    return common::make_error_inval();
+  }
+
+  std::vector<T> result;
+  const size_t len = json_object_array_length(json);
+  result.reserve(len);
+  for (size_t i = 0; i < len; ++i) {
+    json_object* jvalue = json_object_array_get_idx(json, i);
+    if (!jvalue) {
+      continue;
+    }
+
+    T value = T();
+    common::Error err = FromJson(jvalue, &value);
+    if (err) {
+      continue;
+    }
+    result.push_back(std::move(value));
+  }
+
+  *out = std::move(result);
+  return common::Error();
+}
+
+template <typename T>
+common::Error FromJson(json_object* json, T* out) {
+  return detail::FromJson(json, out, IsNumber<T>());
+}
+
+}  // namespace serializer
+}  // namespace fastotv
@@ -32,7 +32,7 @@ class JsonSerializer : public ISerializer<T, struct json_object*> {
   typedef typename base_class::value_type value_type;
   typedef typename base_class::serialize_type serialize_type;
 
-  virtual common::Error SerializeToString(std::string* deserialized) const override final WARN_UNUSED_RESULT {
+  virtual common::Error SerializeToString(std::string* deserialized) const override WARN_UNUSED_RESULT {
     serialize_type des = NULL;
     common::Error err = base_class::Serialize(&des);
     if (err) {
@@ -0,0 +1,118 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "serializer/json_string_fields.h"
+
+#include <inttypes.h>  // for PRId64
+#include <stdio.h>     // for snprintf
+
+namespace fastotv {
+namespace serializer {
+namespace {
+
+const char hex_chars[] = "0123456789abcdef";
+
+// same as json-c escaping
+const char* EscapeOf(unsigned char c) {
+  switch (c) {
+    case '\b':
+      return "\\b";
+    case '\n':
+      return "\\n";
+    case '\r':
+      return "\\r";
+    case '\t':
+      return "\\t";
+    case '\f':
+      return "\\f";
+    case '"':
+      return "\\\"";
+    case '\\':
+      return "\\\\";
+    case '/':
+      return "\\/";
+    default:
+      return NULL;
+  }
+}
+
+}  // namespace
+
+void AppendJsonString(const char* data, size_t size, std::string* out) {
+  out->reserve(out->size() + size + 2);
+  out->push_back('"');
+  size_t start = 0;
+  for (size_t pos = 0; pos < size; ++pos) {
+    const unsigned char c = static_cast<unsigned char>(data[pos]);
+    if (c >= ' ' && c != '"' && c != '\\' && c != '/') {
+      continue;
+    }
+
+    out->append(data + start, pos - start);
+    start = pos + 1;
+    const char* escape = EscapeOf(c);
+    if (escape) {
+      out->append(escape);
+      continue;
+    }
+
+    const char unicode[] = {'\\', 'u', '0', '0', hex_chars[c >> 4], hex_chars[c & 0xf]};
+    out->append(unicode, sizeof(unicode));
+  }
+  out->append(data + start, size - start);
+  out->push_back('"');
+}
+
+void AppendJsonInteger(int64_t value, std::string* out) {
+  char buff[24];
+  const int size = snprintf(buff, sizeof(buff), "%" PRId64, value);
+  out->append(buff, size);
+}
+
+common::Error ToJsonString(const std::string& value, std::string* out) {
+  AppendJsonString(value.data(), value.size(), out);
+  return common::Error();
+}
+
+common::Error ToJsonString(bool value, std::string* out) {
+  out->append(value ? "true" : "false");
+  return common::Error();
+}
+
+common::Error ToJsonString(const common::uri::Url& value, std::string* out) {
+  return ToJsonString(value.GetUrl(), out);
+}
+
+JsonStringFieldsWriter::JsonStringFieldsWriter(std::string* out)
+    : out_(out), fields_count_(0), is_value_(false), err_() {}
+
+common::Error JsonStringFieldsWriter::Finish() {
+  if (err_) {
+    return err_;
+  }
+
+  if (is_value_) {
+    return common::Error();
+  }
+
+  out_->append(fields_count_ ? " }" : "{ }");  // class without fields
+  return common::Error();
+}
+
+}  // namespace serializer
+}  // namespace fastotv
@@ -0,0 +1,144 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>  // for strlen
+
+#include <string>       // for string
+#include <type_traits>  // for true_type
+#include <vector>       // for vector
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "serializer/fields.h"
+
+// streaming json encoder of fields tables, appends text without json objects tree,
+// output same as json_object_get_string of json encoder (serializer/json_fields.h):
+// spaced format, '/' and control characters escaped, arrays of invalid elements skip them
+
+namespace fastotv {
+namespace serializer {
+
+void AppendJsonString(const char* data, size_t size, std::string* out);  // quoted and escaped
+void AppendJsonInteger(int64_t value, std::string* out);
+
+common::Error ToJsonString(const std::string& value, std::string* out);
+common::Error ToJsonString(bool value, std::string* out);
+common::Error ToJsonString(const common::uri::Url& value, std::string* out);
+template <typename T>
+common::Error ToJsonString(const std::vector<T>& values, std::string* out);
+template <typename T>
+common::Error ToJsonString(const T& value, std::string* out);  // integers, enums and classes with fields table
+
+class JsonStringFieldsWriter {
+ public:
+  explicit JsonStringFieldsWriter(std::string* out);
+
+  template <typename T>
+  void Field(const char* name, const T* value, field_flags_t flags) {
+    UNUSED(flags);
+    if (err_) {
+      return;
+    }
+
+    if (name) {
+      out_->append(fields_count_ ? ", " : "{ ");
+      AppendJsonString(name, strlen(name), out_);
+      out_->append(": ");
+      fields_count_++;
+    } else {  // only field, object is its value
+      DCHECK(!fields_count_);
+      is_value_ = true;
+    }
+    err_ = ToJsonString(*value, out_);
+  }
+
+  common::Error Finish() WARN_UNUSED_RESULT;  // closes object, error of first failed field
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(JsonStringFieldsWriter);
+
+  std::string* const out_;
+  size_t fields_count_;
+  bool is_value_;
+  common::Error err_;
+};
+
+// appends, nothing appended on error; invalid objects not serialized
+template <typename T>
+common::Error WriteJsonStringObject(const T& obj, std::string* out) {
+  if (!out || !obj.IsValid()) {
+    return common::make_error_inval();
+  }
+
+  const size_t start = out->size();
+  JsonStringFieldsWriter writer(out);
+  FieldsAccess::Visit(&obj, &writer);
+  common::Error err = writer.Finish();
+  if (err) {
+    out->resize(start);
+    return err;
+  }
+
+  return common::Error();
+}
+
+namespace detail {
+
+template <typename T>
+common::Error ToJsonString(const T& value, std::string* out, std::true_type /* number */) {
+  AppendJsonInteger(static_cast<int64_t>(value), out);
+  return common::Error();
+}
+
+template <typename T>
+common::Error ToJsonString(const T& obj, std::string* out, std::false_type /* number */) {
+  return WriteJsonStringObject(obj, out);
+}
+
+}  // namespace detail
+
+template <typename T>
+common::Error ToJsonString(const std::vector<T>& values, std::string* out) {
+  out->push_back('[');
+  bool empty = true;
+  for (const T& value : values) {
+    const size_t value_start = out->size();
+    out->append(empty ? " " : ", ");
+    common::Error err = ToJsonString(value, out);
+    if (err) {
+      out->resize(value_start);
+      continue;
+    }
+    empty = false;
+  }
+
+  out->append(" ]");
+  return common::Error();
+}
+
+template <typename T>
+common::Error ToJsonString(const T& value, std::string* out) {
+  return detail::ToJsonString(value, out, IsNumber<T>());
+}
+
+}  // namespace serializer
+}  // namespace fastotv
@@ -0,0 +1,117 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/async_log_sink.h"
+
+#include <chrono>   // for milliseconds
+#include <utility>  // for move
+
+#include <common/logger.h>                  // for RUNTIME_LOG
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+
+namespace fastotv {
+namespace server {
+
+AsyncLogSink::Stats::Stats() : written(0), dropped(0) {}
+
+AsyncLogSink::Entry::Entry() : level(common::logging::LOG_LEVEL_INFO), message() {}
+
+AsyncLogSink::Entry::Entry(common::logging::LOG_LEVEL level, std::string&& message)
+    : level(level), message(std::move(message)) {}
+
+AsyncLogSink::AsyncLogSink()
+    : queue_(),
+      stop_(false),
+      sleeping_(false),
+      wake_mutex_(),
+      wake_cond_(),
+      written_(0),
+      dropped_(0),
+      thread_() {}
+
+AsyncLogSink::~AsyncLogSink() {
+  Stop();
+}
+
+void AsyncLogSink::Start(size_t queue_size) {
+  DCHECK(!thread_);
+  queue_.reset(new BoundedMPSCQueue<Entry>(queue_size));
+  stop_ = false;
+
+  thread_ = THREAD_MANAGER()->CreateThread(&AsyncLogSink::Work, this);
+  bool result = thread_->Start();
+  if (!result) {
+    WARNING_LOG() << "Don't started log writer thread.";
+  }
+}
+
+void AsyncLogSink::Stop() {
+  if (!thread_) {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    stop_ = true;
+    wake_cond_.notify_one();
+  }
+  thread_->Join();
+  thread_.reset();
+}
+
+void AsyncLogSink::Write(common::logging::LOG_LEVEL level, std::string&& message) {
+  if (!queue_ || !queue_->Push(Entry(level, std::move(message)))) {
+    dropped_++;
+    return;
+  }
+
+  if (sleeping_) {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cond_.notify_one();
+  }
+}
+
+AsyncLogSink::Stats AsyncLogSink::GetStats() const {
+  Stats stats;
+  stats.written = written_;
+  stats.dropped = dropped_;
+  return stats;
+}
+
+void AsyncLogSink::Work() {
+  while (true) {
+    Entry entry;
+    if (queue_->Pop(&entry)) {
+      RUNTIME_LOG(entry.level) << entry.message;
+      written_++;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    if (stop_) {  // queue drained
+      break;
+    }
+    sleeping_ = true;
+    wake_cond_.wait_for(lock, std::chrono::milliseconds(idle_wait_msec),
+                        [this]() { return stop_ || !queue_->IsEmpty(); });
+    sleeping_ = false;
+  }
+}
+
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,96 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>              // for atomic
+#include <condition_variable>  // for condition_variable
+#include <memory>              // for shared_ptr, unique_ptr
+#include <mutex>               // for mutex
+#include <string>              // for string
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "inner/sampled_log.h"  // for ILogSink
+
+#include "server/bounded_mpsc_queue.h"
+
+namespace common {
+namespace threads {
+template <typename RT>
+class Thread;
+}
+}  // namespace common
+
+namespace fastotv {
+namespace server {
+
+// hot path messages written to common logger from own thread, loops never wait for log file:
+// bounded lock-free queue, messages dropped if writer not keeps up
+class AsyncLogSink : public fastotv::inner::ILogSink {
+ public:
+  enum {
+    default_queue_size = 4096,  // messages, rounded up to power of 2
+    idle_wait_msec = 100        // max writer sleep, if wakeup missed
+  };
+
+  struct Stats {
+    Stats();
+
+    size_t written;
+    size_t dropped;  // queue overflow
+  };
+
+  AsyncLogSink();
+  virtual ~AsyncLogSink();
+
+  void Start(size_t queue_size);
+  void Stop();  // queued messages written before stop
+
+  virtual void Write(common::logging::LOG_LEVEL level, std::string&& message) override;  // thread-safe
+
+  Stats GetStats() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(AsyncLogSink);
+
+  struct Entry {
+    Entry();
+    Entry(common::logging::LOG_LEVEL level, std::string&& message);
+
+    common::logging::LOG_LEVEL level;
+    std::string message;
+  };
+
+  void Work();
+
+  std::unique_ptr<BoundedMPSCQueue<Entry> > queue_;
+
+  std::atomic<bool> stop_;
+  std::atomic<bool> sleeping_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cond_;
+
+  std::atomic<size_t> written_;
+  std::atomic<size_t> dropped_;
+
+  std::shared_ptr<common::threads::Thread<void> > thread_;
+};
+
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,110 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>  // for intptr_t
+
+#include <atomic>   // for atomic
+#include <memory>   // for unique_ptr
+#include <utility>  // for move
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+namespace fastotv {
+namespace server {
+
+// bounded lock-free queue, many producers and one consumer,
+// each cell has sequence number which tells whose turn to use it (D. Vyukov)
+template <typename T>
+class BoundedMPSCQueue {
+ public:
+  explicit BoundedMPSCQueue(size_t size) : cells_(), mask_(0), enqueue_pos_(0), dequeue_pos_(0) {
+    size_t capacity = 2;
+    while (capacity < size) {
+      capacity <<= 1;
+    }
+
+    cells_.reset(new Cell[capacity]);
+    for (size_t i = 0; i < capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask_ = capacity - 1;
+  }
+
+  size_t GetCapacity() const { return mask_ + 1; }
+
+  bool Push(T value) {  // thread-safe, false if full
+    Cell* cell = nullptr;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      const size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool Pop(T* value) {  // consumer thread only, false if empty
+    Cell* cell = &cells_[dequeue_pos_ & mask_];
+    const size_t seq = cell->sequence.load(std::memory_order_acquire);
+    if (seq != dequeue_pos_ + 1) {
+      return false;
+    }
+
+    *value = std::move(cell->value);
+    cell->value = T();
+    cell->sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+    dequeue_pos_++;
+    return true;
+  }
+
+  bool IsEmpty() const {  // consumer thread only
+    const Cell* cell = &cells_[dequeue_pos_ & mask_];
+    return cell->sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BoundedMPSCQueue);
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  std::atomic<size_t> enqueue_pos_;
+  size_t dequeue_pos_;
+};
+
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,289 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "server/channels_responce_cache.h"
+
+#include <inttypes.h>  // for PRIx64, SCNx64
+#include <stdio.h>     // for sscanf
+
+#include <memory>  // for make_shared
+
+#include <common/logger.h>   // for DEBUG_MSG_ERROR
+#include <common/sprintf.h>  // for MemSPrintf
+
+#include "server/commands.h"  // for GetChannelsResponceSuccsessHead
+
+#include "channels_delta.h"  // for ChannelsDelta
+
+namespace fastotv {
+namespace server {
+namespace {
+
+// FNV-1a
+const ChannelsResponceCache::hash_t fnv_offset_basis = 14695981039346656037ULL;
+const ChannelsResponceCache::hash_t fnv_prime = 1099511628211ULL;
+
+void HashBytes(const void* data, size_t size, ChannelsResponceCache::hash_t* hash) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    *hash ^= bytes[i];
+    *hash *= fnv_prime;
+  }
+}
+
+// responce made for one client, not cached: whole message encoded once
+common::Error MakeWholeFrame(const fastotv::inner::InnerClient* client,
+                             const std::string& head,
+                             const std::string& tail,
+                             fastotv::inner::InnerClient::frame_t* out) {
+  const std::string message = head + tail;
+  return fastotv::inner::InnerClient::MakeFrame(client->GetFrameKind(message.size()), message, out);
+}
+
+}  // namespace
+
+ChannelsResponceCache::Stats::Stats() : size(0), hits(0), misses(0), evictions(0), deltas(0), not_modified(0) {}
+
+ChannelsResponceCache::ChannelsResponceCache()
+    : mutex_(), max_size_(default_max_size), entries_(), index_(), stats_() {}
+
+void ChannelsResponceCache::SetMaxSize(size_t max_size) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  max_size_ = max_size;
+  EvictOverflow();
+}
+
+common::Error ChannelsResponceCache::MakeResponceFrame(cmd_seq_t id,
+                                                       const UserInfo& user,
+                                                       const std::string& client_version,
+                                                       const fastotv::inner::InnerClient* client,
+                                                       fastotv::inner::InnerClient::frame_t* out) {
+  if (!client || !out) {
+    return common::make_error_inval();
+  }
+
+  packed_channels_t packed_chan = user.GetPackedChannels();
+  common::Error err;
+  if (!packed_chan) {
+    err = PackChannels(user.GetChannelInfo(), &packed_chan);
+    if (err) {
+      return err;
+    }
+  }
+
+  const std::string& packed = packed_chan->packed;
+  const hash_t hash = packed_chan->hash;
+  const std::string version = MakeVersion(hash);
+  const std::string head = GetChannelsResponceSuccsessHead(id);
+  if (!client_version.empty()) {
+    if (client_version == version) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      stats_.not_modified++;
+      lock.unlock();
+      return MakeWholeFrame(client, head, GetChannelsNotModifiedResponceSuccsessTail(version), out);
+    }
+
+    hash_t prev_hash;
+    ChannelsInfo prev;
+    if (ParseVersion(client_version, &prev_hash) && FindChannels(prev_hash, &prev)) {
+      std::string delta_tail;
+      err = MakeDeltaTail(prev, user.GetChannelInfo(), version, &delta_tail);
+      if (!err) {
+        Insert(hash, packed, fastotv::inner::InnerClient::frame_t());  // base for next delta
+        return MakeWholeFrame(client, head, delta_tail, out);
+      }
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);  // full responce
+    }
+  }
+
+  fastotv::inner::InnerClient::frame_t tail;
+  fastotv::inner::InnerClient::frame_t encoded_tail;
+  if (!Find(hash, packed, &tail, &encoded_tail)) {
+    serializet_t channels_str;
+    err = user.GetChannelInfo().SerializeToString(&channels_str);
+    if (err) {
+      return err;
+    }
+
+    tail = std::make_shared<const std::string>(GetChannelsResponceSuccsessTail(channels_str, version));
+    Insert(hash, packed, tail);
+  }
+
+  const fastotv::inner::FrameKind kind = client->GetFrameKind(head.size() + tail->size());
+  if (kind.IsTailSpliceSupported() && !encoded_tail) {
+    err = fastotv::inner::InnerClient::EncodeTail(kind, *tail, &encoded_tail);
+    if (err) {
+      return err;
+    }
+    SetEncodedTail(hash, tail, encoded_tail);
+  }
+
+  return fastotv::inner::InnerClient::MakeFrame(kind, head, *tail, encoded_tail, out);
+}
+
+void ChannelsResponceCache::Clear() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+}
+
+ChannelsResponceCache::Stats ChannelsResponceCache::GetStats() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.size = entries_.size();
+  return stats;
+}
+
+ChannelsResponceCache::hash_t ChannelsResponceCache::MakeHash(const std::string& packed) {
+  hash_t hash = fnv_offset_basis;
+  HashBytes(packed.data(), packed.size(), &hash);
+  return hash;
+}
+
+common::Error ChannelsResponceCache::PackChannels(const ChannelsInfo& chan, packed_channels_t* out) {
+  if (!out) {
+    return common::make_error_inval();
+  }
+
+  std::shared_ptr<PackedChannels> packed = std::make_shared<PackedChannels>();
+  common::Error err = chan.SerializeToBinary(&packed->packed);
+  if (err) {
+    return err;
+  }
+
+  packed->hash = MakeHash(packed->packed);
+  *out = packed;
+  return common::Error();
+}
+
+std::string ChannelsResponceCache::MakeVersion(hash_t hash) {
+  return common::MemSPrintf("%016" PRIx64, hash);
+}
+
+bool ChannelsResponceCache::ParseVersion(const std::string& version, hash_t* hash) {
+  uint64_t result = 0;
+  char tail = 0;
+  if (sscanf(version.c_str(), "%" SCNx64 "%c", &result, &tail) != 1) {
+    return false;
+  }
+
+  *hash = result;
+  return true;
+}
+
+bool ChannelsResponceCache::Find(hash_t hash,
+                                 const std::string& packed,
+                                 fastotv::inner::InnerClient::frame_t* tail,
+                                 fastotv::inner::InnerClient::frame_t* encoded_tail) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  index_t::iterator it = index_.find(hash);
+  if (it == index_.end() || !it->second->tail || it->second->packed != packed) {
+    stats_.misses++;
+    return false;
+  }
+
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *tail = it->second->tail;
+  *encoded_tail = it->second->encoded_tail;
+  stats_.hits++;
+  return true;
+}
+
+void ChannelsResponceCache::SetEncodedTail(hash_t hash,
+                                           const fastotv::inner::InnerClient::frame_t& tail,
+                                           const fastotv::inner::InnerClient::frame_t& encoded_tail) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  index_t::iterator it = index_.find(hash);
+  if (it != index_.end() && it->second->tail == tail) {  // not replaced while encoded
+    it->second->encoded_tail = encoded_tail;
+  }
+}
+
+bool ChannelsResponceCache::FindChannels(hash_t hash, ChannelsInfo* chan) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  index_t::const_iterator it = index_.find(hash);
+  if (it == index_.end()) {
+    return false;
+  }
+
+  const std::string packed = it->second->packed;
+  lock.unlock();
+  common::Error err = ChannelsInfo::DeSerializeFromBinary(packed, chan);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    return false;
+  }
+  return true;
+}
+
+common::Error ChannelsResponceCache::MakeDeltaTail(const ChannelsInfo& prev,
+                                                   const ChannelsInfo& chan,
+                                                   const std::string& version,
+                                                   std::string* tail) {
+  const ChannelsDelta delta(prev, chan);
+  serializet_t delta_str;
+  common::Error err = delta.SerializeToString(&delta_str);
+  if (err) {
+    return err;
+  }
+
+  *tail = GetChannelsDeltaResponceSuccsessTail(delta_str, version);
+  std::unique_lock<std::mutex> lock(mutex_);
+  stats_.deltas++;
+  return common::Error();
+}
+
+void ChannelsResponceCache::Insert(hash_t hash,
+                                   const std::string& packed,
+                                   const fastotv::inner::InnerClient::frame_t& tail) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (max_size_ == 0) {
+    return;
+  }
+
+  index_t::iterator it = index_.find(hash);
+  if (it != index_.end()) {
+    if (!tail && it->second->packed == packed) {  // keep serialized responce
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return;
+    }
+    entries_.erase(it->second);  // collision or concurrent miss, newest wins
+    index_.erase(it);
+  }
+
+  Entry entry;
+  entry.hash = hash;
+  entry.packed = packed;
+  entry.tail = tail;
+  entry.encoded_tail = fastotv::inner::InnerClient::frame_t();
+  entries_.push_front(entry);
+  index_[hash] = entries_.begin();
+  EvictOverflow();
+}
+
+void ChannelsResponceCache::EvictOverflow() {
+  while (entries_.size() > max_size_) {
+    index_.erase(entries_.back().hash);
+    entries_.pop_back();
+    stats_.evictions++;
+  }
+}
+
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,116 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <list>           // for list
+#include <string>         // for string
+#include <mutex>          // for mutex
+#include <unordered_map>  // for unordered_map
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "inner/inner_client.h"  // for InnerClient::frame_t
+
+#include "server/user_info.h"  // for UserInfo, packed_channels_t
+
+#include "channels_info.h"  // for ChannelsInfo
+
+namespace fastotv {
+namespace server {
+
+// thread-safe lru cache of get_channels responces keyed by channels content (binary form),
+// users with the same package share one serialized responce tail, compressed once for frames which splice it,
+// cached packages also used as base versions for delta responces
+class ChannelsResponceCache {
+ public:
+  typedef uint64_t hash_t;
+  enum { default_max_size = 256 };
+
+  struct Stats {
+    Stats();
+
+    size_t size;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t deltas;
+    size_t not_modified;
+  };
+
+  ChannelsResponceCache();
+
+  void SetMaxSize(size_t max_size);  // 0 - cache disabled
+
+  // ready frame of user channels in frame kind of client, serializes and compresses channels only if same content
+  // not cached, channels packed when user loaded, packed here if not,
+  // client_version - version which client has, empty if nothing: not modified or delta responce if possible
+  common::Error MakeResponceFrame(cmd_seq_t id,
+                                  const UserInfo& user,
+                                  const std::string& client_version,
+                                  const fastotv::inner::InnerClient* client,
+                                  fastotv::inner::InnerClient::frame_t* out) WARN_UNUSED_RESULT;
+  void Clear();
+
+  Stats GetStats() const;
+
+  static hash_t MakeHash(const std::string& packed);  // of ChannelsInfo::SerializeToBinary
+  static common::Error PackChannels(const ChannelsInfo& chan, packed_channels_t* out) WARN_UNUSED_RESULT;
+  static std::string MakeVersion(hash_t hash);
+  static bool ParseVersion(const std::string& version, hash_t* hash);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ChannelsResponceCache);
+
+  struct Entry {
+    hash_t hash;
+    std::string packed;  // binary channels, to rule out hash collisions
+    fastotv::inner::InnerClient::frame_t tail;  // not encoded, empty if only delta responces made for this version
+    fastotv::inner::InnerClient::frame_t encoded_tail;  // snappy, legacy and snappy frames, made on first of them
+  };
+  typedef std::list<Entry> entries_t;
+  typedef std::unordered_map<hash_t, entries_t::iterator> index_t;
+
+  bool Find(hash_t hash,
+            const std::string& packed,
+            fastotv::inner::InnerClient::frame_t* tail,
+            fastotv::inner::InnerClient::frame_t* encoded_tail);
+  void SetEncodedTail(hash_t hash,
+                      const fastotv::inner::InnerClient::frame_t& tail,
+                      const fastotv::inner::InnerClient::frame_t& encoded_tail);
+  bool FindChannels(hash_t hash, ChannelsInfo* chan) const;
+  common::Error MakeDeltaTail(const ChannelsInfo& prev,
+                              const ChannelsInfo& chan,
+                              const std::string& version,
+                              std::string* tail) WARN_UNUSED_RESULT;
+  void Insert(hash_t hash,
+              const std::string& packed,
+              const fastotv::inner::InnerClient::frame_t& tail);  // empty tail - only channels for deltas
+  void EvictOverflow();  // under lock
+
+  mutable std::mutex mutex_;
+  size_t max_size_;
+  entries_t entries_;  // most recently used first
+  index_t index_;
+  Stats stats_;
+};
+
+}  // namespace server
+}  // namespace fastotv
@@ -18,125 +18,126 @@
 
 #include "server/commands.h"
 
-// requests
-// ping
-#define SERVER_PING_REQ GENERATE_REQUEST_FMT(SERVER_PING)
-#define SERVER_PING_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(SERVER_PING, "'%s'")
-#define SERVER_PING_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(SERVER_PING, "")
-
-// who_are_you
-#define SERVER_WHO_ARE_YOU_REQ GENERATE_REQUEST_FMT(SERVER_WHO_ARE_YOU)
-#define SERVER_WHO_ARE_YOU_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(SERVER_WHO_ARE_YOU, "'%s'")
-#define SERVER_WHO_ARE_YOU_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(SERVER_WHO_ARE_YOU, "")
-
-// system_info
-#define SERVER_GET_CLIENT_INFO_REQ GENERATE_REQUEST_FMT(SERVER_GET_CLIENT_INFO)
-#define SERVER_GET_CLIENT_INFO_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(SERVER_GET_CLIENT_INFO, "'%s'")
-#define SERVER_GET_CLIENT_INFO_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(SERVER_GET_CLIENT_INFO, "")
-
-// chat_message
-#define SERVER_SEND_CHAT_MESSAGE_REQ_1E GENERATE_REQUEST_FMT_ARGS(SERVER_SEND_CHAT_MESSAGE, "'%s'")
-#define SERVER_SEND_CHAT_MESSAGE_APPROVE_FAIL_1E GENEATATE_FAIL_FMT(SERVER_SEND_CHAT_MESSAGE, "'%s'")
-#define SERVER_SEND_CHAT_MESSAGE_APPROVE_SUCCESS GENEATATE_SUCCESS_FMT(SERVER_SEND_CHAT_MESSAGE, "")
-
-// responces
-// get_server_info
-#define SERVER_GET_SERVER_INFO_RESP_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_GET_SERVER_INFO, "'%s'")
-#define SERVER_GET_SERVER_INFO_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(CLIENT_GET_SERVER_INFO, "'%s'")
-
-// get_channels
-#define SERVER_GET_CHANNELS_RESP_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_GET_CHANNELS, "'%s'")
-#define SERVER_GET_CHANNELS_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(CLIENT_GET_CHANNELS, "'%s'")
-
-// get_runtime_channel_info
-#define SERVER_GET_RUNTIME_CHANNEL_INFO_RESP_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_GET_RUNTIME_CHANNEL_INFO, "'%s'")
-#define SERVER_GET_RUNTIME_CHANNEL_INFO_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(CLIENT_GET_RUNTIME_CHANNEL_INFO, "'%s'")
-
-// send_chat_message
-#define SERVER_SEND_CHAT_MESSAGE_RESP_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_SEND_CHAT_MESSAGE, "'%s'")
-#define SERVER_SEND_CHAT_MESSAGE_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(CLIENT_SEND_CHAT_MESSAGE, "'%s'")
-
-// ping
-#define SERVER_PING_RESP_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_PING, "'%s'")
-#define SERVER_PING_RESP_SUCCSESS_1E GENEATATE_SUCCESS_FMT(CLIENT_PING, "'%s'")
+#include <string.h>  // for strlen
+
+// get_channels, head and tails of cached text responce
+#define SERVER_GET_CHANNELS_RESP_SUCCSESS_TAIL_PREFIX " " SUCCESS_COMMAND " " CLIENT_GET_CHANNELS " "
+#define SERVER_GET_CHANNELS_DELTA_RESP_SUCCSESS_TAIL_SUFFIX " " CHANNELS_SYNC_DELTA END_OF_COMMAND
+#define SERVER_GET_CHANNELS_NOT_MODIFIED_RESP_SUCCSESS_TAIL_SUFFIX " " CHANNELS_SYNC_NOT_MODIFIED END_OF_COMMAND
 
 namespace fastotv {
 namespace server {
+namespace {
+
+// prefix 'args' version suffix
+std::string MakeChannelsTail(const serializet_t& args, const std::string& version, const char* suffix) {
+  constexpr size_t prefix_size = SIZEOFMASS(SERVER_GET_CHANNELS_RESP_SUCCSESS_TAIL_PREFIX) - 1;
+  std::string tail;
+  tail.reserve(prefix_size + args.size() + version.size() + strlen(suffix) + 3);  // quotes and space
+  tail.append(SERVER_GET_CHANNELS_RESP_SUCCSESS_TAIL_PREFIX, prefix_size);
+  AppendQuotedArg(args, &tail);
+  tail += ' ';
+  tail += version;
+  tail += suffix;
+  return tail;
+}
+
+}  // namespace
 
 cmd_request_t WhoAreYouRequest(cmd_seq_t id) {
-  return MakeRequest(id, SERVER_WHO_ARE_YOU_REQ);
+  return MakeRequest(id, OPCODE_SERVER_WHO_ARE_YOU);
+}
+cmd_request_t WhoAreYouRequest(cmd_seq_t id, protocol_version_t max_version) {
+  return MakeRequest(id, OPCODE_SERVER_WHO_ARE_YOU, ConvertToString(max_version));
+}
+cmd_request_t WhoAreYouRequest(cmd_seq_t id, protocol_version_t max_version, const std::string& frame_codecs) {
+  return MakeRequest(id, OPCODE_SERVER_WHO_ARE_YOU, ConvertToString(max_version), frame_codecs);
 }
 cmd_approve_t WhoAreYouApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, SERVER_WHO_ARE_YOU_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_SERVER_WHO_ARE_YOU);
 }
 cmd_approve_t WhoAreYouApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, SERVER_WHO_ARE_YOU_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_SERVER_WHO_ARE_YOU, error_text);
 }
 
 cmd_request_t SystemInfoRequest(cmd_seq_t id) {
-  return MakeRequest(id, SERVER_GET_CLIENT_INFO_REQ);
+  return MakeRequest(id, OPCODE_SERVER_GET_CLIENT_INFO);
 }
 cmd_approve_t SystemInfoApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, SERVER_GET_CLIENT_INFO_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_SERVER_GET_CLIENT_INFO);
 }
 cmd_approve_t SystemInfoApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, SERVER_GET_CLIENT_INFO_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_SERVER_GET_CLIENT_INFO, error_text);
 }
 
 cmd_request_t ServerSendChatMessageRequest(cmd_seq_t id, const serializet_t& msg) {
-  return MakeRequest(id, SERVER_SEND_CHAT_MESSAGE_REQ_1E, msg);
+  return MakeRequest(id, OPCODE_SERVER_SEND_CHAT_MESSAGE, msg);
 }
 cmd_approve_t ServerSendChatMessageApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, SERVER_SEND_CHAT_MESSAGE_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_SERVER_SEND_CHAT_MESSAGE);
 }
 cmd_approve_t ServerSendChatMessageApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, SERVER_SEND_CHAT_MESSAGE_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_SERVER_SEND_CHAT_MESSAGE, error_text);
 }
 
 cmd_request_t PingRequest(cmd_seq_t id) {
-  return MakeRequest(id, SERVER_PING_REQ);
+  return MakeRequest(id, OPCODE_SERVER_PING);
 }
 cmd_approve_t PingApproveResponceSuccsess(cmd_seq_t id) {
-  return MakeApproveResponce(id, SERVER_PING_APPROVE_SUCCESS);
+  return MakeApproveResponce(id, STATE_SUCCESS, OPCODE_SERVER_PING);
 }
 cmd_approve_t PingApproveResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeApproveResponce(id, SERVER_PING_APPROVE_FAIL_1E, error_text);
+  return MakeApproveResponce(id, STATE_FAIL, OPCODE_SERVER_PING, error_text);
 }
 
 cmd_responce_t GetServerInfoResponceSuccsess(cmd_seq_t id, const serializet_t& server_info) {
-  return MakeResponce(id, SERVER_GET_SERVER_INFO_RESP_SUCCSESS_1E, server_info);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_CLIENT_GET_SERVER_INFO, server_info);
 }
 
 cmd_responce_t GetServerInfoResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeResponce(id, SERVER_GET_SERVER_INFO_RESP_FAIL_1E, error_text);
+  return MakeResponce(id, STATE_FAIL, OPCODE_CLIENT_GET_SERVER_INFO, error_text);
 }
 
 cmd_responce_t GetChannelsResponceSuccsess(cmd_seq_t id, const serializet_t& channels_info) {
-  return MakeResponce(id, SERVER_GET_CHANNELS_RESP_SUCCSESS_1E, channels_info);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_CLIENT_GET_CHANNELS, channels_info);
 }
 cmd_responce_t GetChannelsResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeResponce(id, SERVER_GET_CHANNELS_RESP_FAIL_1E, error_text);
+  return MakeResponce(id, STATE_FAIL, OPCODE_CLIENT_GET_CHANNELS, error_text);
+}
+std::string GetChannelsResponceSuccsessHead(cmd_seq_t id) {
+  std::string head;
+  WriteTextCommandHead(RESPONCE_COMMAND, id, &head);
+  return head;
+}
+std::string GetChannelsResponceSuccsessTail(const serializet_t& channels_info, const std::string& version) {
+  return MakeChannelsTail(channels_info, version, END_OF_COMMAND);
+}
+std::string GetChannelsDeltaResponceSuccsessTail(const serializet_t& channels_delta, const std::string& version) {
+  return MakeChannelsTail(channels_delta, version, SERVER_GET_CHANNELS_DELTA_RESP_SUCCSESS_TAIL_SUFFIX);
+}
+std::string GetChannelsNotModifiedResponceSuccsessTail(const std::string& version) {
+  return MakeChannelsTail(serializet_t(), version, SERVER_GET_CHANNELS_NOT_MODIFIED_RESP_SUCCSESS_TAIL_SUFFIX);
 }
 
 cmd_responce_t GetRuntimeChannelInfoResponceSuccsess(cmd_seq_t id, const serializet_t& rchannel_info) {
-  return MakeResponce(id, SERVER_GET_RUNTIME_CHANNEL_INFO_RESP_SUCCSESS_1E, rchannel_info);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO, rchannel_info);
 }
 cmd_responce_t GetRuntimeChannelInfoResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeResponce(id, SERVER_GET_RUNTIME_CHANNEL_INFO_RESP_FAIL_1E, error_text);
+  return MakeResponce(id, STATE_FAIL, OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO, error_text);
 }
 
 cmd_responce_t SendChatMessageResponceSuccsess(cmd_seq_t id, const serializet_t& message) {
-  return MakeResponce(id, SERVER_SEND_CHAT_MESSAGE_RESP_SUCCSESS_1E, message);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_CLIENT_SEND_CHAT_MESSAGE, message);
 }
 cmd_responce_t SendChatMessageResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeResponce(id, SERVER_SEND_CHAT_MESSAGE_RESP_FAIL_1E, error_text);
+  return MakeResponce(id, STATE_FAIL, OPCODE_CLIENT_SEND_CHAT_MESSAGE, error_text);
 }
 
 cmd_responce_t PingResponceSuccsess(cmd_seq_t id, const serializet_t& ping_info) {
-  return MakeResponce(id, SERVER_PING_RESP_SUCCSESS_1E, ping_info);
+  return MakeResponce(id, STATE_SUCCESS, OPCODE_CLIENT_PING, ping_info);
 }
 cmd_responce_t PingResponceFail(cmd_seq_t id, const std::string& error_text) {
-  return MakeResponce(id, SERVER_PING_RESP_FAIL_1E, error_text);
+  return MakeResponce(id, STATE_FAIL, OPCODE_CLIENT_PING, error_text);
 }
 
 }  // namespace server
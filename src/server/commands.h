@@ -33,6 +33,10 @@ cmd_approve_t PingApproveResponceFail(cmd_seq_t id, const std::string& error_tex
 
 // who_are_you
 cmd_request_t WhoAreYouRequest(cmd_seq_t id);
+cmd_request_t WhoAreYouRequest(cmd_seq_t id, protocol_version_t max_version);  // offers binary protocol
+cmd_request_t WhoAreYouRequest(cmd_seq_t id,
+                               protocol_version_t max_version,
+                               const std::string& frame_codecs);  // offers frames codecs too
 cmd_approve_t WhoAreYouApproveResponceSuccsess(cmd_seq_t id);
 cmd_approve_t WhoAreYouApproveResponceFail(cmd_seq_t id, const std::string& error_text);  // escaped
 
@@ -54,6 +58,11 @@ cmd_responce_t GetServerInfoResponceFail(cmd_seq_t id, const std::string& error_
 // get_channels
 cmd_responce_t GetChannelsResponceSuccsess(cmd_seq_t id, const serializet_t& channels_info);
 cmd_responce_t GetChannelsResponceFail(cmd_seq_t id, const std::string& error_text);  // escaped
+// responce splitted to head and tail, tail not depends on id so can be cached
+std::string GetChannelsResponceSuccsessHead(cmd_seq_t id);
+std::string GetChannelsResponceSuccsessTail(const serializet_t& channels_info, const std::string& version);
+std::string GetChannelsDeltaResponceSuccsessTail(const serializet_t& channels_delta, const std::string& version);
+std::string GetChannelsNotModifiedResponceSuccsessTail(const std::string& version);
 
 // get_runtime_channel_info
 cmd_responce_t GetRuntimeChannelInfoResponceSuccsess(cmd_seq_t id, const serializet_t& rchannel_info);
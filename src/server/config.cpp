@@ -24,9 +24,21 @@
 
 #include "inih/ini.h"
 
+#include "inner/frame_codec.h"                      // for GetSupportedFrameCodecs
+#include "inner/inner_client.h"                     // for InnerClient
+#include "inner/inner_server_command_seq_parser.h"  // for InnerServerCommandSeqParser
+#include "inner/sampled_log.h"                      // for LogCategoryPolicy
+
+#include "server/channels_responce_cache.h"  // for ChannelsResponceCache
+#include "server/redis/redis_pool.h"           // for RedisPool
+#include "server/redis/redis_publisher.h"      // for RedisPublisher
+#include "server/redis/users_cache.h"          // for UsersCache
+
 #define CHANNEL_COMMANDS_IN_NAME "COMMANDS_IN"
 #define CHANNEL_COMMANDS_OUT_NAME "COMMANDS_OUT"
 #define CHANNEL_CLIENTS_STATE_NAME "CLIENTS_STATE"
+#define CHANNEL_USERS_UPDATES_NAME "USERS_UPDATES"
+#define CHANNEL_CHAT_CHANNELS_UPDATES_NAME "CHAT_CHANNELS_UPDATES"
 
 #define CONFIG_SERVER_OPTIONS "server"
 #define CONFIG_SERVER_OPTIONS_HOST_FIELD "host"
@@ -35,14 +47,60 @@
 #define CONFIG_SERVER_OPTIONS_REDIS_CHANNEL_IN_FIELD "redis_channel_in_name"
 #define CONFIG_SERVER_OPTIONS_REDIS_CHANNEL_OUT_FIELD "redis_channel_out_name"
 #define CONFIG_SERVER_OPTIONS_REDIS_CHANNEL_STATUS_FIELD "redis_channel_clients_state_name"
+#define CONFIG_SERVER_OPTIONS_REDIS_CHANNEL_USERS_UPDATES_FIELD "redis_channel_users_updates_name"
+#define CONFIG_SERVER_OPTIONS_REDIS_CHANNEL_CHAT_CHANNELS_UPDATES_FIELD "redis_channel_chat_channels_updates_name"
+#define CONFIG_SERVER_OPTIONS_REDIS_POOL_SIZE_FIELD "redis_pool_size"
+#define CONFIG_SERVER_OPTIONS_USERS_CACHE_SIZE_FIELD "users_cache_size"
+#define CONFIG_SERVER_OPTIONS_USERS_CACHE_TTL_FIELD "users_cache_ttl"
+#define CONFIG_SERVER_OPTIONS_CHANNELS_CACHE_SIZE_FIELD "channels_cache_size"
+#define CONFIG_SERVER_OPTIONS_STATE_QUEUE_SIZE_FIELD "state_queue_size"
+#define CONFIG_SERVER_OPTIONS_STATE_COALESCE_FIELD "state_coalesce"
+#define CONFIG_SERVER_OPTIONS_REQUEST_TIMEOUT_FIELD "request_timeout"
+#define CONFIG_SERVER_OPTIONS_BINARY_PROTOCOL_FIELD "binary_protocol"
 #define CONFIG_SERVER_OPTIONS_BANDWIDT_SERVER_FIELD "bandwidth_server"
+#define CONFIG_SERVER_OPTIONS_WORKERS_FIELD "workers"
+#define CONFIG_SERVER_OPTIONS_WRITE_LOW_WATERMARK_FIELD "write_low_watermark"
+#define CONFIG_SERVER_OPTIONS_WRITE_HIGH_WATERMARK_FIELD "write_high_watermark"
+#define CONFIG_SERVER_OPTIONS_MAX_FRAME_SIZE_FIELD "max_frame_size"
+#define CONFIG_SERVER_OPTIONS_FRAME_CODECS_FIELD "frame_codecs"
+#define CONFIG_SERVER_OPTIONS_COMPRESSION_THRESHOLD_FIELD "compression_threshold"
+#define CONFIG_SERVER_OPTIONS_LOG_SAMPLE_RATE_FIELD "log_sample_rate"
+#define CONFIG_SERVER_OPTIONS_LOG_RATE_LIMIT_FIELD "log_rate_limit"
+#define CONFIG_SERVER_OPTIONS_LOG_PAYLOAD_SIZE_FIELD "log_payload_size"
+#define CONFIG_SERVER_OPTIONS_LOG_ASYNC_FIELD "log_async"
+#define CONFIG_SERVER_OPTIONS_METRICS_SERVER_FIELD "metrics_server"
+#define CONFIG_SERVER_OPTIONS_METRICS_REDIS_KEY_FIELD "metrics_redis_key"
+#define CONFIG_SERVER_OPTIONS_METRICS_PUBLISH_INTERVAL_FIELD "metrics_publish_interval"
+
+#define METRICS_REDIS_KEY_NAME "fastotv_server_metrics"
 
 /*
   [server]
   host=fastotv.com:7040
   redis_server=localhost:6379
   redis_unix_path=/var/run/redis/redis.sock
+  redis_pool_size=8
+  users_cache_size=100000
+  users_cache_ttl=300
+  channels_cache_size=256
+  state_queue_size=8192
+  state_coalesce=false
+  request_timeout=30
+  binary_protocol=true
   bandwidth_server=localhost:5544
+  workers=1
+  write_low_watermark=262144
+  write_high_watermark=1048576
+  max_frame_size=16777216
+  frame_codecs=zstd,snappy,none
+  compression_threshold=256
+  log_sample_rate=1
+  log_rate_limit=100
+  log_payload_size=256
+  log_async=true
+  metrics_server=127.0.0.1:7041
+  metrics_redis_key=fastotv_server_metrics
+  metrics_publish_interval=10
 */
 
 namespace fastotv {
@@ -82,6 +140,84 @@ int ini_handler_fasto(void* user_data, const char* section, const char* name, co
   } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_REDIS_CHANNEL_STATUS_FIELD)) {
     pconfig->server.redis.channel_clients_state = value;
     return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_REDIS_CHANNEL_USERS_UPDATES_FIELD)) {
+    pconfig->server.redis.channel_users_updates = value;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_REDIS_CHANNEL_CHAT_CHANNELS_UPDATES_FIELD)) {
+    pconfig->server.redis.channel_chat_channels_updates = value;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_REDIS_POOL_SIZE_FIELD)) {
+    size_t pool_size;
+    bool res = common::ConvertFromString(value, &pool_size);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_REDIS_POOL_SIZE_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.redis_pool_size = pool_size;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_USERS_CACHE_SIZE_FIELD)) {
+    size_t cache_size;
+    bool res = common::ConvertFromString(value, &cache_size);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_USERS_CACHE_SIZE_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.users_cache_size = cache_size;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_USERS_CACHE_TTL_FIELD)) {
+    size_t ttl;
+    bool res = common::ConvertFromString(value, &ttl);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_USERS_CACHE_TTL_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.users_cache_ttl = ttl;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_CHANNELS_CACHE_SIZE_FIELD)) {
+    size_t cache_size;
+    bool res = common::ConvertFromString(value, &cache_size);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_CHANNELS_CACHE_SIZE_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.channels_cache_size = cache_size;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_STATE_QUEUE_SIZE_FIELD)) {
+    size_t queue_size;
+    bool res = common::ConvertFromString(value, &queue_size);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_STATE_QUEUE_SIZE_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.state_queue_size = queue_size;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_STATE_COALESCE_FIELD)) {
+    bool coalesce;
+    bool res = common::ConvertFromString(value, &coalesce);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_STATE_COALESCE_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.state_coalesce = coalesce;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_REQUEST_TIMEOUT_FIELD)) {
+    size_t timeout;
+    bool res = common::ConvertFromString(value, &timeout);
+    if (!res || timeout == 0) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_REQUEST_TIMEOUT_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.request_timeout = timeout;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_BINARY_PROTOCOL_FIELD)) {
+    bool binary;
+    bool res = common::ConvertFromString(value, &binary);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_BINARY_PROTOCOL_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.binary_protocol = binary;
+    return 1;
   } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_BANDWIDT_SERVER_FIELD)) {
     common::net::HostAndPort hs;
     bool res = common::ConvertFromString(value, &hs);
@@ -91,13 +227,148 @@ int ini_handler_fasto(void* user_data, const char* section, const char* name, co
     }
     pconfig->server.bandwidth_host = hs;
     return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_WORKERS_FIELD)) {
+    size_t workers;
+    bool res = common::ConvertFromString(value, &workers);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_WORKERS_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.workers = workers;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_WRITE_LOW_WATERMARK_FIELD)) {
+    size_t watermark;
+    bool res = common::ConvertFromString(value, &watermark);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_WRITE_LOW_WATERMARK_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.write_low_watermark = watermark;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_WRITE_HIGH_WATERMARK_FIELD)) {
+    size_t watermark;
+    bool res = common::ConvertFromString(value, &watermark);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_WRITE_HIGH_WATERMARK_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.write_high_watermark = watermark;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_MAX_FRAME_SIZE_FIELD)) {
+    size_t max_frame_size;
+    bool res = common::ConvertFromString(value, &max_frame_size);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_MAX_FRAME_SIZE_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.max_frame_size = max_frame_size;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_FRAME_CODECS_FIELD)) {
+    const std::string codecs = value;
+    const std::string supported = fastotv::inner::GetSupportedFrameCodecs(codecs);
+    if (supported != codecs) {
+      WARNING_LOG() << "Not supported " CONFIG_SERVER_OPTIONS_FRAME_CODECS_FIELD " skipped: " << codecs
+                    << ", offered: " << supported;
+    }
+    pconfig->server.frame_codecs = supported;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_COMPRESSION_THRESHOLD_FIELD)) {
+    size_t threshold;
+    bool res = common::ConvertFromString(value, &threshold);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_COMPRESSION_THRESHOLD_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.compression_threshold = threshold;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_LOG_SAMPLE_RATE_FIELD)) {
+    size_t sample_rate;
+    bool res = common::ConvertFromString(value, &sample_rate);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_LOG_SAMPLE_RATE_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.log_sample_rate = sample_rate;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_LOG_RATE_LIMIT_FIELD)) {
+    size_t rate_limit;
+    bool res = common::ConvertFromString(value, &rate_limit);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_LOG_RATE_LIMIT_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.log_rate_limit = rate_limit;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_LOG_PAYLOAD_SIZE_FIELD)) {
+    size_t payload_size;
+    bool res = common::ConvertFromString(value, &payload_size);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_LOG_PAYLOAD_SIZE_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.log_payload_size = payload_size;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_LOG_ASYNC_FIELD)) {
+    bool async;
+    bool res = common::ConvertFromString(value, &async);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_LOG_ASYNC_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.log_async = async;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_METRICS_SERVER_FIELD)) {
+    common::net::HostAndPort hs;
+    bool res = common::ConvertFromString(value, &hs);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_METRICS_SERVER_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.metrics_host = hs;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_METRICS_REDIS_KEY_FIELD)) {
+    pconfig->server.metrics_redis_key = value;
+    return 1;
+  } else if (MATCH(CONFIG_SERVER_OPTIONS, CONFIG_SERVER_OPTIONS_METRICS_PUBLISH_INTERVAL_FIELD)) {
+    size_t interval;
+    bool res = common::ConvertFromString(value, &interval);
+    if (!res) {
+      WARNING_LOG() << "Invalid " CONFIG_SERVER_OPTIONS_METRICS_PUBLISH_INTERVAL_FIELD " value: " << value;
+      return 0;
+    }
+    pconfig->server.metrics_publish_interval = interval;
+    return 1;
   } else {
     return 0; /* unknown section/name, error */
   }
 }
 }  // namespace
 
-ServerSettings::ServerSettings() : host(), redis(), bandwidth_host() {
+ServerSettings::ServerSettings()
+    : host(),
+      redis(),
+      redis_pool_size(redis::RedisPool::default_max_connections),
+      users_cache_size(redis::UsersCache::default_max_size),
+      users_cache_ttl(redis::UsersCache::default_ttl_msec / 1000),
+      channels_cache_size(ChannelsResponceCache::default_max_size),
+      state_queue_size(redis::RedisPublisher::default_queue_size),
+      state_coalesce(false),
+      request_timeout(fastotv::inner::InnerServerCommandSeqParser::default_request_timeout),
+      binary_protocol(true),
+      bandwidth_host(),
+      workers(1),
+      write_low_watermark(fastotv::inner::InnerClient::default_low_watermark),
+      write_high_watermark(fastotv::inner::InnerClient::default_high_watermark),
+      max_frame_size(fastotv::inner::InnerClient::default_max_frame_size),
+      frame_codecs(fastotv::inner::GetSupportedFrameCodecs("zstd,snappy,none")),
+      compression_threshold(fastotv::inner::InnerClient::default_compression_threshold),
+      log_sample_rate(1),
+      log_rate_limit(100),
+      log_payload_size(fastotv::inner::LogCategoryPolicy::default_max_payload_size),
+      log_async(true),
+      metrics_host(),
+      metrics_redis_key(METRICS_REDIS_KEY_NAME),
+      metrics_publish_interval(10) {
   // in config by default
   // redis.redis_host = redis_default_host;
   // redis.redis_unix_socket = redis_default_unix_path;
@@ -105,6 +376,8 @@ ServerSettings::ServerSettings() : host(), redis(), bandwidth_host() {
   redis.channel_in = CHANNEL_COMMANDS_IN_NAME;
   redis.channel_out = CHANNEL_COMMANDS_OUT_NAME;
   redis.channel_clients_state = CHANNEL_CLIENTS_STATE_NAME;
+  redis.channel_users_updates = CHANNEL_USERS_UPDATES_NAME;
+  redis.channel_chat_channels_updates = CHANNEL_CHAT_CHANNELS_UPDATES_NAME;
 
   // bandwidth_host = bandwidth_default_host;
 }
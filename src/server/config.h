@@ -34,7 +34,28 @@ struct ServerSettings {
 
   common::net::HostAndPort host;
   redis::RedisSubConfig redis;
+  size_t redis_pool_size;  // max persistent connections to redis
+  size_t users_cache_size;  // max cached users records, 0 - disabled
+  size_t users_cache_ttl;   // sec
+  size_t channels_cache_size;  // max cached get_channels responces, 0 - disabled
+  size_t state_queue_size;     // max not published clients state messages
+  bool state_coalesce;         // publish queued clients states as one json array
+  size_t request_timeout;      // sec, external requests not answered in time failed
+  bool binary_protocol;        // offer binary commands (v2) to clients in who_are_you
   common::net::HostAndPort bandwidth_host;
+  size_t workers;               // count of loops handling clients, 0 - by cpu cores
+  size_t write_low_watermark;   // bytes, client outbound queue drained, chat resumed
+  size_t write_high_watermark;  // bytes, client outbound queue overloaded, chat dropped
+  size_t max_frame_size;        // bytes, max size of incoming compressed frame
+  std::string frame_codecs;     // offered to clients in who_are_you in preference order, empty - legacy snappy
+  size_t compression_threshold;  // bytes, smaller frames sent not compressed after codec negotiated
+  size_t log_sample_rate;        // 1 of N hot path messages (commands, pings, external) logged, 0 - disabled
+  size_t log_rate_limit;         // max hot path messages per second of each category, 0 - unlimited
+  size_t log_payload_size;       // bytes of commands/messages payload logged
+  bool log_async;                // hot path messages written from own thread
+  common::net::HostAndPort metrics_host;  // admin port serving GET /metrics, not valid - disabled
+  std::string metrics_redis_key;          // metrics also published to this key
+  size_t metrics_publish_interval;        // sec, 0 - not published
 };
 
 struct Config {
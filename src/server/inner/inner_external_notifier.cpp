@@ -18,20 +18,17 @@
 
 #include "server/inner/inner_external_notifier.h"
 
-extern "C" {
-#include "sds.h"
-}
-
 #include <common/error.h>   // for Error, DEBUG_MSG_...
 #include <common/logger.h>  // for COMPACT_LOG_WARNING
 #include <common/macros.h>  // for STRINGIZE
 
 #include "inner/inner_server_command_seq_parser.h"  // for RequestCallback
+#include "inner/sampled_log.h"                      // for SAMPLED_LOG
 
 #include "server/inner/inner_tcp_client.h"
-#include "server/inner/inner_tcp_handler.h"
 
 #include "server/responce_info.h"  // for ResponceInfo
+#include "server/server_host.h"    // for ServerHost
 #include "server/user_info.h"      // for user_id_t
 
 // publish COMMANDS_IN 'user_id 0 1 ping' 0 => request
@@ -42,14 +39,14 @@ namespace fastotv {
 namespace server {
 namespace inner {
 
-InnerSubHandler::InnerSubHandler(InnerTcpHandlerHost* parent) : parent_(parent) {}
+InnerSubHandler::InnerSubHandler(ServerHost* parent) : parent_(parent), args_buffer_(), argv_() {}
 
 InnerSubHandler::~InnerSubHandler() {}
 
-void InnerSubHandler::ProcessSubscribed(cmd_seq_t request_id, int argc, char* argv[]) {  // incoming responce
-  const char* state_command = argc > 0 ? argv[0] : FAIL_COMMAND;                         // [OK|FAIL]
-  const char* command = argc > 1 ? argv[1] : "null";                                     // command
-  const std::string json = argc > 2 ? argv[2] : "{}";                                    // encoded args
+void InnerSubHandler::ProcessSubscribed(cmd_seq_t request_id, const CommandArgsView& argv) {  // incoming responce
+  const char* state_command = argv.size() > 0 ? argv[0].data() : FAIL_COMMAND;                  // [OK|FAIL]
+  const char* command = argv.size() > 1 ? argv[1].data() : "null";                              // command
+  const std::string json = argv.size() > 2 ? argv[2].as_string() : "{}";                        // encoded args
 
   ResponceInfo resp(request_id, state_command, command, json);
   PublishResponce(resp);
@@ -58,7 +55,8 @@ void InnerSubHandler::ProcessSubscribed(cmd_seq_t request_id, int argc, char* ar
 void InnerSubHandler::HandleMessage(const std::string& channel, const std::string& msg) {
   // [user_id_t]login [device_id_t]device_id [cmd_id_t]seq [std::string]command args ...
   // [cmd_id_t]seq OK/FAIL [std::string]command args ..
-  INFO_LOG() << "InnerSubHandler channel: " << channel << ", msg: " << msg;
+  const fastotv::inner::log_category_t category = fastotv::inner::LOG_CATEGORY_EXTERNAL;
+  SAMPLED_LOG(category) << "channel=" << channel << " msg=" << fastotv::inner::LogPayload(category, msg);
   size_t space_pos = msg.find_first_of(' ');
   if (space_pos == std::string::npos) {
     const std::string resp = common::MemSPrintf("UNKNOWN COMMAND: %s", msg);
@@ -80,7 +78,7 @@ void InnerSubHandler::HandleMessage(const std::string& channel, const std::strin
   const std::string input_command = common::MemSPrintf(STRINGIZE(REQUEST_COMMAND) " %s" END_OF_COMMAND, cmd);
   cmd_id_t seq;
   cmd_seq_t id;
-  std::string cmd_str;
+  common::StringPiece cmd_str(nullptr, 0);
   common::Error err = ParseCommand(input_command, &seq, &id, &cmd_str);
   if (err) {
     std::string resp = err->GetDescription();
@@ -88,53 +86,53 @@ void InnerSubHandler::HandleMessage(const std::string& channel, const std::strin
     return;
   }
 
-  InnerTcpClient* fclient = parent_->FindInnerConnectionByUserIDAndDeviceID(uid, dev);
+  err = SplitCommandArgs(cmd_str.data(), cmd_str.size(), &args_buffer_, &argv_);
+  ExternalRequest req;
+  req.uid = uid;
+  req.dev = dev;
+  req.id = id;
+  req.command = !err && !argv_.empty() ? argv_[0].as_string() : "null";
+  req.input_command = input_command;
+  req.loop = parent_->FindInnerConnectionLoop(uid, dev);
+
+  if (!req.loop) {
+    PublishFail(req, "not connected");
+    return;
+  }
+
+  if (!parent_->PostToLoop(req.loop, [this, req]() { HandleRequest(req); })) {
+    PublishFail(req, "overloaded");
+  }
+}
+
+void InnerSubHandler::HandleRequest(const ExternalRequest& req) {
+  // connection can be closed or moved while request was queued
+  InnerTcpClient* fclient = parent_->FindInnerConnectionByUserIDAndDeviceID(req.loop, req.uid, req.dev);
   if (!fclient) {
-    int argc;
-    sds* argv = sdssplitargslong(cmd_str.c_str(), &argc);
-    char* command = argv[0];
-
-    ResponceInfo resp(id, FAIL_COMMAND, command, "{\"cause\": \"not connected\"}");
-    std::string resp_str;
-    common::Error err = resp.SerializeToString(&resp_str);
-    if (err) {
-      PublishResponce(resp);
-      sdsfreesplitres(argv, argc);
-      return;
-    }
-
-    WARNING_LOG() << resp_str;
-    PublishResponce(resp);
-    sdsfreesplitres(argv, argc);
+    PublishFail(req, "not connected");
     return;
   }
 
-  cmd_request_t req(id, input_command);
-  err = fclient->Write(req);
+  cmd_request_t request(req.id, req.input_command);
+  common::Error err = fclient->Write(request);
   if (err) {
-    int argc;
-    sds* argv = sdssplitargslong(cmd_str.c_str(), &argc);
-    char* command = argv[0];
-
-    ResponceInfo resp(id, FAIL_COMMAND, command, "{\"cause\": \"not handled\"}");
-    std::string resp_str;
-    common::Error err = resp.SerializeToString(&resp_str);
-    if (err) {
-      PublishResponce(resp);
-      sdsfreesplitres(argv, argc);
-      return;
-    }
-
-    WARNING_LOG() << resp_str;
-    PublishResponce(resp);
-    sdsfreesplitres(argv, argc);
+    PublishFail(req, "not handled");
     return;
   }
 
-  auto cb = std::bind(&InnerSubHandler::ProcessSubscribed, this, std::placeholders::_1, std::placeholders::_2,
-                      std::placeholders::_3);
-  fastotv::inner::RequestCallback rc(id, cb);
-  parent_->SubscribeRequest(rc);
+  auto cb = std::bind(&InnerSubHandler::ProcessSubscribed, this, std::placeholders::_1, std::placeholders::_2);
+  auto timeout_cb = [this, req](cmd_seq_t request_id) {
+    UNUSED(request_id);
+    PublishFail(req, "timeout");
+  };
+  fastotv::inner::RequestCallback rc(req.id, cb, timeout_cb);
+  parent_->SubscribeRequest(req.loop, rc);  // loop thread, subscribed before responce can be read
+}
+
+void InnerSubHandler::PublishFail(const ExternalRequest& req, const std::string& cause) {
+  ResponceInfo resp(req.id, FAIL_COMMAND, req.command, common::MemSPrintf("{\"cause\": \"%s\"}", cause));
+  WARNING_LOG() << "External request " << req.id << " to " << req.uid << " failed: " << cause;
+  PublishResponce(resp);
 }
 
 void InnerSubHandler::PublishResponce(const ResponceInfo& resp) {
@@ -19,32 +19,54 @@
 #pragma once
 
 #include <string>  // for string
+#include <vector>  // for vector
 
 #include "commands/commands.h"  // for cmd_seq_t
 
 #include "server/redis/redis_pub_sub_handler.h"
+#include "server/user_info.h"  // for user_id_t, device_id_t
+
+namespace common {
+namespace libev {
+class IoLoop;
+}
+}  // namespace common
 
 namespace fastotv {
 namespace server {
 class ResponceInfo;
+class ServerHost;
 namespace inner {
 
-class InnerTcpHandlerHost;
-
+// messages come in subscribe thread, requests handed off to loop of connection,
+// responces queued to commands out publisher, neither thread waits for redis
 class InnerSubHandler : public redis::RedisSubHandler {
  public:
-  explicit InnerSubHandler(InnerTcpHandlerHost* parent);
+  explicit InnerSubHandler(ServerHost* parent);
   virtual ~InnerSubHandler();
 
  protected:
   virtual void HandleMessage(const std::string& channel, const std::string& msg) override;
 
  private:
-  void ProcessSubscribed(cmd_seq_t request_id, int argc, char* argv[]);
-
-  void PublishResponce(const ResponceInfo& resp);
-
-  InnerTcpHandlerHost* parent_;
+  struct ExternalRequest {
+    user_id_t uid;
+    device_id_t dev;
+    cmd_seq_t id;
+    std::string command;        // name only, for fail responces
+    std::string input_command;  // full request line
+    common::libev::IoLoop* loop;
+  };
+
+  void HandleRequest(const ExternalRequest& req);  // loop thread
+  void PublishFail(const ExternalRequest& req, const std::string& cause);
+  void ProcessSubscribed(cmd_seq_t request_id, const CommandArgsView& argv);
+
+  void PublishResponce(const ResponceInfo& resp);  // any thread, not blocks
+
+  ServerHost* const parent_;
+  std::string args_buffer_;  // subscriber thread only, reused for each message
+  std::vector<common::StringPiece> argv_;
 };
 
 }  // namespace inner
@@ -0,0 +1,80 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/inner/inner_tcp_acceptor.h"
+
+#include <common/libev/io_client.h>  // for IoClient
+#include <common/libev/io_loop.h>    // for IoLoop
+#include <common/logger.h>           // for COMPACT_LOG_WARNING
+
+namespace fastotv {
+namespace server {
+namespace inner {
+
+InnerTcpAcceptor::InnerTcpAcceptor(const workers_t& workers) : workers_(workers), next_worker_(0) {
+  CHECK(!workers_.empty());
+}
+
+InnerTcpAcceptor::~InnerTcpAcceptor() {}
+
+void InnerTcpAcceptor::PreLooped(common::libev::IoLoop* server) {
+  UNUSED(server);
+}
+
+void InnerTcpAcceptor::Accepted(common::libev::IoClient* client) {
+  common::libev::IoLoop* server = client->GetServer();
+  common::libev::IoLoop* worker = NextWorker();
+  server->UnRegisterClient(client);  // Moved called
+  auto cb = [worker, client]() { worker->RegisterClient(client); };
+  worker->ExecInLoopThread(cb);
+}
+
+void InnerTcpAcceptor::Moved(common::libev::IoLoop* server, common::libev::IoClient* client) {
+  UNUSED(server);
+  UNUSED(client);
+}
+
+void InnerTcpAcceptor::Closed(common::libev::IoClient* client) {
+  UNUSED(client);
+}
+
+void InnerTcpAcceptor::DataReceived(common::libev::IoClient* client) {
+  UNUSED(client);
+}
+
+void InnerTcpAcceptor::DataReadyToWrite(common::libev::IoClient* client) {
+  UNUSED(client);
+}
+
+void InnerTcpAcceptor::PostLooped(common::libev::IoLoop* server) {
+  UNUSED(server);
+}
+
+void InnerTcpAcceptor::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
+  UNUSED(server);
+  UNUSED(id);
+}
+
+common::libev::IoLoop* InnerTcpAcceptor::NextWorker() {
+  const size_t pos = next_worker_++;
+  return workers_[pos % workers_.size()];
+}
+
+}  // namespace inner
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,63 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>  // for vector
+
+#include <common/libev/io_loop_observer.h>  // for IoLoopObserver
+
+namespace common {
+namespace libev {
+class IoLoop;
+class IoClient;
+}  // namespace libev
+}  // namespace common
+
+namespace fastotv {
+namespace server {
+namespace inner {
+
+// observer of listening loop, hands accepted connections to worker loops by round robin
+class InnerTcpAcceptor : public common::libev::IoLoopObserver {
+ public:
+  typedef std::vector<common::libev::IoLoop*> workers_t;
+  explicit InnerTcpAcceptor(const workers_t& workers);
+  virtual ~InnerTcpAcceptor();
+
+  virtual void PreLooped(common::libev::IoLoop* server) override;
+
+  virtual void Accepted(common::libev::IoClient* client) override;
+  virtual void Moved(common::libev::IoLoop* server, common::libev::IoClient* client) override;
+  virtual void Closed(common::libev::IoClient* client) override;
+
+  virtual void DataReceived(common::libev::IoClient* client) override;
+  virtual void DataReadyToWrite(common::libev::IoClient* client) override;
+  virtual void PostLooped(common::libev::IoLoop* server) override;
+  virtual void TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) override;
+
+ private:
+  common::libev::IoLoop* NextWorker();
+
+  const workers_t workers_;
+  size_t next_worker_;
+};
+
+}  // namespace inner
+}  // namespace server
+}  // namespace fastotv
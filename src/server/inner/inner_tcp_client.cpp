@@ -18,7 +18,7 @@
 
 #include "server/inner/inner_tcp_client.h"
 
-#include <common/libev/tcp/tcp_server.h>
+#include <common/libev/io_loop.h>
 
 namespace fastotv {
 namespace server {
@@ -26,7 +26,7 @@ namespace inner {
 
 const AuthInfo InnerTcpClient::anonim_user(USER_LOGIN, USER_PASSWORD, USER_DEVICE_ID);
 
-InnerTcpClient::InnerTcpClient(common::libev::tcp::TcpServer* server, const common::net::socket_info& info)
+InnerTcpClient::InnerTcpClient(common::libev::IoLoop* server, const common::net::socket_info& info)
     : InnerClient(server, info), hinfo_(), uid_(), current_stream_id_(invalid_stream_id) {}
 
 bool InnerTcpClient::IsAnonimUser() const {
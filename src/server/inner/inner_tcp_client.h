@@ -28,10 +28,8 @@
 
 namespace common {
 namespace libev {
-namespace tcp {
-class TcpServer;
+class IoLoop;
 }
-}  // namespace libev
 }  // namespace common
 namespace common {
 namespace net {
@@ -47,7 +45,7 @@ class InnerTcpClient : public fastotv::inner::InnerClient {
  public:
   static const AuthInfo anonim_user;
 
-  InnerTcpClient(common::libev::tcp::TcpServer* server, const common::net::socket_info& info);
+  InnerTcpClient(common::libev::IoLoop* server, const common::net::socket_info& info);
   ~InnerTcpClient();
 
   virtual const char* ClassName() const override;
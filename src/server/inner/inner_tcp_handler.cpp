@@ -19,31 +19,32 @@
 #include "server/inner/inner_tcp_handler.h"
 
 #include <stddef.h>  // for NULL
-#include <string>    // for string
+
+#include <algorithm>  // for max
+#include <chrono>     // for steady_clock
+#include <string>     // for string
 
 #include <json-c/json_object.h>  // for json_object
 
-#include <common/libev/io_client.h>         // for IoClient
-#include <common/libev/io_loop.h>           // for IoLoop
-#include <common/logger.h>                  // for COMPACT_LOG_WARNING
-#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+#include <common/libev/io_client.h>  // for IoClient
+#include <common/libev/io_loop.h>    // for IoLoop
+#include <common/logger.h>           // for COMPACT_LOG_WARNING
 
 #include "auth_info.h"            // for AuthInfo
 #include "channels_info.h"        // for ChannelsInfo
 #include "client_info.h"          // for ClientInfo
 #include "client_server_types.h"  // for Encode
 #include "inner/inner_client.h"   // for InnerClient
+#include "inner/sampled_log.h"    // for SAMPLED_LOG
 #include "ping_info.h"            // for ClientPingInfo
 
 #include "server/commands.h"
 
-#include "server/redis/redis_pub_sub.h"
-
-#include "server/inner/inner_external_notifier.h"  // for InnerSubHandler
-#include "server/inner/inner_tcp_client.h"         // for InnerTcpClient
+#include "server/inner/inner_tcp_client.h"  // for InnerTcpClient
 
 #include "runtime_channel_info.h"
 #include "server/server_host.h"      // for ServerHost
+#include "server/server_metrics.h"   // for ServerMetrics
 #include "server/user_info.h"        // for user_id_t, UserInfo
 #include "server/user_state_info.h"  // for UserStateInfo
 #include "server_info.h"             // for ServerInfo
@@ -51,37 +52,119 @@
 namespace fastotv {
 namespace server {
 namespace inner {
+namespace {
+
+bool IsAnsweredAfterLookup(cmd_opcode_t opcode) {  // handler returns before answer
+  return opcode == OPCODE_CLIENT_GET_SERVER_INFO || opcode == OPCODE_CLIENT_GET_CHANNELS ||
+         opcode == OPCODE_SERVER_WHO_ARE_YOU;
+}
+
+}  // namespace
 
 InnerTcpHandlerHost::InnerTcpHandlerHost(ServerHost* parent, const Config& config)
     : parent_(parent),
-      sub_commands_in_(NULL),
-      handler_(NULL),
       ping_client_id_timer_(INVALID_TIMER_ID),
-      reread_cache_id_timer_(INVALID_TIMER_ID),
+      requests_timer_(INVALID_TIMER_ID),
       config_(config),
-      chat_channels_() {
-  handler_ = new InnerSubHandler(this);
-  sub_commands_in_ = new redis::RedisPubSub(handler_);
-  redis_subscribe_command_in_thread_ = THREAD_MANAGER()->CreateThread(&redis::RedisPubSub::Listen, sub_commands_in_);
+      subscribers_(),
+      reading_client_(nullptr),
+      slow_clients_(),
+      commands_(),
+      next_lookup_id_(0),
+      lookups_(),
+      request_handlers_({{OPCODE_CLIENT_PING, &InnerTcpHandlerHost::HandleClientPingRequest},
+                         {OPCODE_CLIENT_GET_SERVER_INFO, &InnerTcpHandlerHost::HandleGetServerInfoRequest},
+                         {OPCODE_CLIENT_GET_CHANNELS, &InnerTcpHandlerHost::HandleGetChannelsRequest},
+                         {OPCODE_CLIENT_GET_RUNTIME_CHANNEL_INFO,
+                          &InnerTcpHandlerHost::HandleGetRuntimeChannelInfoRequest},
+                         {OPCODE_CLIENT_SEND_CHAT_MESSAGE, &InnerTcpHandlerHost::HandleSendChatMessageRequest}}),
+      responce_handlers_({{OPCODE_SERVER_PING, &InnerTcpHandlerHost::HandleServerPingResponce},
+                          {OPCODE_SERVER_WHO_ARE_YOU, &InnerTcpHandlerHost::HandleWhoAreYouResponce},
+                          {OPCODE_SERVER_GET_CLIENT_INFO, &InnerTcpHandlerHost::HandleClientInfoResponce},
+                          {OPCODE_SERVER_SEND_CHAT_MESSAGE, &InnerTcpHandlerHost::HandleServerChatMessageResponce}}),
+      commands_timing_hook_(),
+      tasks_(tasks_queue_size),
+      tasks_scheduled_(false),
+      loop_stats_mutex_(),
+      loop_stats_() {}
+
+InnerTcpHandlerHost::~InnerTcpHandlerHost() {}
+
+InnerTcpHandlerHost::LoopStats::LoopStats()
+    : clients(0), pending_bytes(0), max_pending_bytes(0), overloaded_clients(0), dropped_frames(0) {}
+
+void InnerTcpHandlerHost::SetCommandsTimingHook(timing_hook_t hook) {
+  commands_timing_hook_ = hook;
+  timing_hook_t handled_hook;
+  if (hook) {
+    handled_hook = [hook](cmd_opcode_t opcode, uint64_t elapsed_nsec) {
+      if (!IsAnsweredAfterLookup(opcode)) {  // dispatch only, recorded by RecordCommandCompleted
+        hook(opcode, elapsed_nsec);
+      }
+    };
+  }
+  request_handlers_.SetTimingHook(handled_hook);
+  responce_handlers_.SetTimingHook(handled_hook);
+}
 
-  sub_commands_in_->SetConfig(config.server.redis);
-  bool result = redis_subscribe_command_in_thread_->Start();
-  if (!result) {
-    WARNING_LOG() << "Don't started listen thread for external commands.";
+void InnerTcpHandlerHost::RecordCommandCompleted(cmd_opcode_t opcode, std::chrono::steady_clock::time_point start) {
+  if (commands_timing_hook_) {
+    commands_timing_hook_(
+        opcode, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
   }
 }
 
-InnerTcpHandlerHost::~InnerTcpHandlerHost() {
-  sub_commands_in_->Stop();
-  redis_subscribe_command_in_thread_->Join();
-  delete sub_commands_in_;
-  delete handler_;
+InnerTcpHandlerHost::LoopStats InnerTcpHandlerHost::GetLoopStats() const {
+  std::unique_lock<std::mutex> lock(loop_stats_mutex_);
+  return loop_stats_;
+}
+
+void InnerTcpHandlerHost::UpdateLoopStats(common::libev::IoLoop* server) {
+  LoopStats stats;
+  std::vector<common::libev::IoClient*> online_clients = server->GetClients();
+  for (size_t i = 0; i < online_clients.size(); ++i) {
+    InnerTcpClient* iclient = static_cast<InnerTcpClient*>(online_clients[i]);
+    const size_t pending_bytes = iclient->GetPendingBytes();
+    stats.pending_bytes += pending_bytes;
+    stats.max_pending_bytes = std::max(stats.max_pending_bytes, pending_bytes);
+    stats.dropped_frames += iclient->GetDroppedFrames();
+    if (iclient->IsOverloaded()) {
+      stats.overloaded_clients++;
+    }
+  }
+  stats.clients = online_clients.size();
+
+  std::unique_lock<std::mutex> lock(loop_stats_mutex_);
+  loop_stats_ = stats;
 }
 
 void InnerTcpHandlerHost::PreLooped(common::libev::IoLoop* server) {
-  UpdateCache();
   ping_client_id_timer_ = server->CreateTimer(ping_timeout_clients, true);
-  reread_cache_id_timer_ = server->CreateTimer(reread_cache_timeout, true);
+  requests_timer_ = server->CreateTimer(requests_tick_timeout, true);
+}
+
+bool InnerTcpHandlerHost::PostTask(common::libev::IoLoop* server, task_t task) {
+  if (!tasks_.Push(std::move(task))) {
+    return false;
+  }
+
+  if (!tasks_scheduled_.exchange(true)) {
+    server->ExecInLoopThread([this, server]() { HandleTasks(server); });
+  }
+  return true;
+}
+
+void InnerTcpHandlerHost::HandleTasks(common::libev::IoLoop* server) {
+  // reset before taking, task posted after that schedules new wakeup
+  tasks_scheduled_.exchange(false);
+  task_t task;
+  for (size_t i = 0; i < max_tasks_per_wakeup && tasks_.Pop(&task); ++i) {
+    task();
+  }
+
+  if (!tasks_.IsEmpty() && !tasks_scheduled_.exchange(true)) {
+    server->ExecInLoopThread([this, server]() { HandleTasks(server); });
+  }
 }
 
 void InnerTcpHandlerHost::Moved(common::libev::IoLoop* server, common::libev::IoClient* client) {
@@ -94,10 +177,9 @@ void InnerTcpHandlerHost::PostLooped(common::libev::IoLoop* server) {
     server->RemoveTimer(ping_client_id_timer_);
     ping_client_id_timer_ = INVALID_TIMER_ID;
   }
-
-  if (reread_cache_id_timer_ != INVALID_TIMER_ID) {
-    server->RemoveTimer(reread_cache_id_timer_);
-    reread_cache_id_timer_ = INVALID_TIMER_ID;
+  if (requests_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(requests_timer_);
+    requests_timer_ = INVALID_TIMER_ID;
   }
 }
 
@@ -115,20 +197,32 @@ void InnerTcpHandlerHost::TimerEmited(common::libev::IoLoop* server, common::lib
           client->Close();
           delete client;
         } else {
-          INFO_LOG() << "Pinged to client[" << client->GetFormatedName() << "], from server["
-                     << server->GetFormatedName() << "], " << online_clients.size() << " client(s) connected.";
+          SAMPLED_LOG(fastotv::inner::LOG_CATEGORY_PINGS) << "client=" << client->GetFormatedName()
+                                                          << " server=" << server->GetFormatedName()
+                                                          << " clients=" << online_clients.size();
         }
       }
     }
-  } else if (reread_cache_id_timer_ == id) {
-    UpdateCache();
+  } else if (requests_timer_ == id) {
+    CloseSlowClients();  // marked by broadcasts from other threads or timers
+    ExpireRequests();
+    UpdateLoopStats(server);
+    parent_->ReloadChatChannelsIfStale();  // updates message can be lost while redis reconnects
   }
 }
 
 void InnerTcpHandlerHost::Accepted(common::libev::IoClient* client) {
-  cmd_request_t whoareyou = WhoAreYouRequest(NextRequestID());
+  const cmd_seq_t whoareyou_id = NextRequestID();
+  const protocol_version_t max_version = config_.server.binary_protocol ? PROTOCOL_V2 : PROTOCOL_V1;
+  cmd_request_t whoareyou = !config_.server.frame_codecs.empty()
+                                ? WhoAreYouRequest(whoareyou_id, max_version, config_.server.frame_codecs)
+                                : config_.server.binary_protocol ? WhoAreYouRequest(whoareyou_id, PROTOCOL_V2)
+                                                                 : WhoAreYouRequest(whoareyou_id);
   InnerTcpClient* iclient = static_cast<InnerTcpClient*>(client);
   if (iclient) {
+    iclient->SetWatermarks(config_.server.write_low_watermark, config_.server.write_high_watermark);
+    iclient->SetMaxFrameSize(config_.server.max_frame_size);
+    iclient->SetCompressionThreshold(config_.server.compression_threshold);
     common::Error err = iclient->Write(whoareyou);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
@@ -137,10 +231,19 @@ void InnerTcpHandlerHost::Accepted(common::libev::IoClient* client) {
 }
 
 void InnerTcpHandlerHost::Closed(common::libev::IoClient* client) {
+  if (client == reading_client_) {
+    reading_client_ = nullptr;
+  }
+
   InnerTcpClient* iconnection = static_cast<InnerTcpClient*>(client);
+  slow_clients_.erase(iconnection);
+  CancelLookups(iconnection);
   AuthInfo auth = iconnection->GetServerHostInfo();
-  common::libev::IoLoop* server = client->GetServer();
-  SendLeaveChatMessage(server, iconnection->GetCurrentStreamId(), auth.GetLogin());
+  const stream_id sid = iconnection->GetCurrentStreamId();
+  if (sid != invalid_stream_id) {
+    ChangeCurrentStream(iconnection, invalid_stream_id);
+    SendLeaveChatMessage(sid, auth.GetLogin());
+  }
 
   if (iconnection->IsAnonimUser()) {  // anonim user
     INFO_LOG() << "Byu anonim user: " << auth.GetLogin();
@@ -159,31 +262,92 @@ void InnerTcpHandlerHost::Closed(common::libev::IoClient* client) {
 }
 
 void InnerTcpHandlerHost::DataReceived(common::libev::IoClient* client) {
-  std::string buff;
   InnerTcpClient* iclient = static_cast<InnerTcpClient*>(client);
-  common::Error err = iclient->ReadCommand(&buff);
+  size_t commands_count = 0;
+  common::Error err = iclient->ReadCommands(&commands_, &commands_count);
+  reading_client_ = iclient;
+  iclient->BeginWriteBatch();
+  for (size_t i = 0; i < commands_count && reading_client_; ++i) {
+    HandleInnerDataReceived(iclient, commands_[i]);
+  }
+
+  if (!reading_client_) {  // closed while handling
+    CloseSlowClients();
+    return;
+  }
+
+  reading_client_ = nullptr;
+  common::Error write_err = iclient->EndWriteBatch();
+  if (!err) {
+    err = write_err;
+  }
   if (err) {
     DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
     client->Close();
     delete client;
-    return;
   }
-
-  HandleInnerDataReceived(iclient, buff);
+  CloseSlowClients();
 }
 
 void InnerTcpHandlerHost::DataReadyToWrite(common::libev::IoClient* client) {
-  UNUSED(client);
+  InnerTcpClient* iclient = static_cast<InnerTcpClient*>(client);
+  common::Error err = iclient->Flush();
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    client->Close();
+    delete client;
+  }
+  CloseSlowClients();
 }
 
-common::Error InnerTcpHandlerHost::PublishToChannelOut(const std::string& msg) {
-  return sub_commands_in_->PublishToChannelOut(msg);
+void InnerTcpHandlerHost::FindUserAsync(InnerTcpClient* client, const AuthInfo& auth, user_found_cb_t cb) {
+  const lookup_id_t lid = next_lookup_id_++;
+  lookups_[lid] = client;
+  auto done_cb = [this, lid, cb](common::Error err, user_id_t uid, const UserInfo& uinf) {
+    lookups_t::iterator it = lookups_.find(lid);
+    if (it == lookups_.end()) {  // client closed while lookup
+      return;
+    }
+
+    InnerTcpClient* client = it->second;
+    lookups_.erase(it);
+    cb(client, err, uid, uinf);
+  };
+  parent_->FindUserAsync(client->GetServer(), auth, done_cb);
 }
 
-void InnerTcpHandlerHost::UpdateCache() {
-  std::vector<stream_id> channels;
-  parent_->GetChatChannels(&channels);
-  chat_channels_ = channels;
+void InnerTcpHandlerHost::CancelLookups(InnerTcpClient* client) {
+  for (lookups_t::iterator it = lookups_.begin(); it != lookups_.end();) {
+    if (it->second == client) {
+      it = lookups_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void InnerTcpHandlerHost::ChangeCurrentStream(InnerTcpClient* client, stream_id sid) {
+  const stream_id prev_sid = client->GetCurrentStreamId();
+  if (prev_sid == sid) {
+    return;
+  }
+
+  if (prev_sid != invalid_stream_id) {
+    subscribers_index_t::iterator it = subscribers_.find(prev_sid);
+    if (it != subscribers_.end()) {
+      it->second.erase(client);
+      if (it->second.empty()) {
+        subscribers_.erase(it);
+      }
+    }
+  }
+
+  if (sid != invalid_stream_id) {
+    subscribers_[sid].insert(client);
+  }
+
+  parent_->ChangeWatchingStream(prev_sid, sid);
+  client->SetCurrentStreamId(sid);
 }
 
 void InnerTcpHandlerHost::PublishUserStateInfo(const UserStateInfo& state) {
@@ -196,453 +360,392 @@ void InnerTcpHandlerHost::PublishUserStateInfo(const UserStateInfo& state) {
 
   std::string connected_resp = json_object_get_string(user_state_json);
   json_object_put(user_state_json);
-  err = sub_commands_in_->PublishStateToChannel(connected_resp);
+  err = parent_->PublishStateToChannel(connected_resp);
   if (err) {
     WARNING_LOG() << "Publish message: " << connected_resp << " to channel clients state failed.";
   }
 }
 
-inner::InnerTcpClient* InnerTcpHandlerHost::FindInnerConnectionByUserIDAndDeviceID(user_id_t user,
-                                                                                   device_id_t dev) const {
-  return parent_->FindInnerConnectionByUserIDAndDeviceID(user, dev);
-}
-
 void InnerTcpHandlerHost::HandleInnerRequestCommand(fastotv::inner::InnerClient* connection,
                                                     cmd_seq_t id,
-                                                    int argc,
-                                                    char* argv[]) {
-  UNUSED(argc);
-  char* command = argv[0];
-  if (IS_EQUAL_COMMAND(command, CLIENT_PING)) {
-    ClientPingInfo ping;
-    json_object* jping_info = NULL;
-    common::Error err = ping.Serialize(&jping_info);
-    if (err) {
-      cmd_responce_t resp = PingResponceFail(id, err->GetDescription());
-      common::Error err = connection->Write(resp);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      connection->Close();
-      delete connection;
-      return;
-    }
-    serializet_t ping_info_str = json_object_get_string(jping_info);
-    json_object_put(jping_info);
+                                                    const CommandArgsView& argv) {
+  const char* command = argv[0].data();
+  cmd_opcode_t opcode;
+  if (request_handlers_.Find(command, &opcode)) {
+    request_handlers_.Execute(this, opcode, connection, id, argv);
+    return;
+  }
 
-    cmd_responce_t pong = PingResponceSuccsess(id, ping_info_str);
-    err = connection->Write(pong);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    }
+  WARNING_LOG() << "UNKNOWN COMMAND: " << command;
+}
+
+void InnerTcpHandlerHost::HandleInnerResponceCommand(fastotv::inner::InnerClient* connection,
+                                                     cmd_seq_t id,
+                                                     const CommandArgsView& argv) {
+  const char* state_command = argv[0].data();
+  const cmd_state_t state = argv.size() > 1 ? CommandToState(state_command) : STATE_NONE;
+  if (state == STATE_NONE) {
+    const std::string error_str = common::MemSPrintf("UNKNOWN STATE COMMAND: %s", state_command);
+    common::Error err = common::make_error(error_str);
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    CloseConnection(connection);
     return;
-  } else if (IS_EQUAL_COMMAND(command, CLIENT_GET_SERVER_INFO)) {
-    inner::InnerTcpClient* client = static_cast<inner::InnerTcpClient*>(connection);
-    AuthInfo hinf = client->GetServerHostInfo();
-    UserInfo user;
-    user_id_t uid;
-    common::Error err = parent_->FindUser(hinf, &uid, &user);
-    if (err) {
-      cmd_responce_t resp = GetServerInfoResponceFail(id, err->GetDescription());
-      common::Error err = connection->Write(resp);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      connection->Close();
-      delete connection;
-      return;
-    }
+  }
 
-    ServerInfo serv(config_.server.bandwidth_host);
-    json_object* jserver_info = NULL;
-    err = serv.Serialize(&jserver_info);
-    if (err) {
-      NOTREACHED();
-    }
+  common::Error err = state == STATE_SUCCESS ? HandleInnerSuccsessResponceCommand(connection, id, argv)
+                                             : HandleInnerFailedResponceCommand(connection, id, argv);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    CloseConnection(connection);
+  }
+}
 
-    serializet_t server_info_str = json_object_get_string(jserver_info);
-    json_object_put(jserver_info);
+common::Error InnerTcpHandlerHost::HandleInnerSuccsessResponceCommand(fastotv::inner::InnerClient* connection,
+                                                                      cmd_seq_t id,
+                                                                      const CommandArgsView& argv) {
+  const char* command = argv[1].data();
+  cmd_opcode_t opcode;
+  if (responce_handlers_.Find(command, &opcode)) {
+    return responce_handlers_.Execute(this, opcode, connection, id, argv);
+  }
+
+  const std::string error_str = common::MemSPrintf("UNKNOWN RESPONCE COMMAND: %s", command);
+  return common::make_error(error_str);
+}
 
-    cmd_responce_t server_info_responce = GetServerInfoResponceSuccsess(id, server_info_str);
-    err = connection->Write(server_info_responce);
+void InnerTcpHandlerHost::HandleClientPingRequest(fastotv::inner::InnerClient* connection,
+                                                  cmd_seq_t id,
+                                                  const CommandArgsView& argv) {
+  UNUSED(argv);
+  ClientPingInfo ping;
+  json_object* jping_info = NULL;
+  common::Error err = ping.Serialize(&jping_info);
+  if (err) {
+    cmd_responce_t resp = PingResponceFail(id, err->GetDescription());
+    common::Error err = connection->Write(resp);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
     }
+    CloseConnection(connection);
     return;
-  } else if (IS_EQUAL_COMMAND(command, CLIENT_GET_CHANNELS)) {
-    inner::InnerTcpClient* client = static_cast<inner::InnerTcpClient*>(connection);
-    AuthInfo hinf = client->GetServerHostInfo();
-    UserInfo user;
-    user_id_t uid;
-    common::Error err = parent_->FindUser(hinf, &uid, &user);
-    if (err) {
-      cmd_responce_t resp = GetChannelsResponceFail(id, err->GetDescription());
-      common::Error err = connection->Write(resp);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      connection->Close();
-      delete connection;
-      return;
-    }
+  }
+  serializet_t ping_info_str = json_object_get_string(jping_info);
+  json_object_put(jping_info);
 
-    serializet_t channels_str;
-    ChannelsInfo chan = user.GetChannelInfo();
-    err = chan.SerializeToString(&channels_str);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      return;
-    }
+  cmd_responce_t pong = PingResponceSuccsess(id, ping_info_str);
+  err = connection->Write(pong);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+}
 
-    cmd_responce_t channels_responce = GetChannelsResponceSuccsess(id, channels_str);
-    err = connection->Write(channels_responce);
+void InnerTcpHandlerHost::HandleGetServerInfoRequest(fastotv::inner::InnerClient* connection,
+                                                     cmd_seq_t id,
+                                                     const CommandArgsView& argv) {
+  UNUSED(argv);
+  inner::InnerTcpClient* client = static_cast<inner::InnerTcpClient*>(connection);
+  AuthInfo hinf = client->GetServerHostInfo();
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  auto cb = [this, id, start](InnerTcpClient* client, common::Error err, user_id_t uid, const UserInfo& user) {
+    UNUSED(uid);
+    UNUSED(user);
+    GetServerInfoUserFound(client, id, err);
+    RecordCommandCompleted(OPCODE_CLIENT_GET_SERVER_INFO, start);
+  };
+  FindUserAsync(client, hinf, cb);
+}
+
+void InnerTcpHandlerHost::HandleGetChannelsRequest(fastotv::inner::InnerClient* connection,
+                                                   cmd_seq_t id,
+                                                   const CommandArgsView& argv) {
+  inner::InnerTcpClient* client = static_cast<inner::InnerTcpClient*>(connection);
+  AuthInfo hinf = client->GetServerHostInfo();
+  // channels which client has
+  const std::string client_version = argv.size() > 1 ? argv[1].as_string() : std::string();
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  auto cb = [this, id, client_version, start](InnerTcpClient* client, common::Error err, user_id_t uid,
+                                              const UserInfo& user) {
+    UNUSED(uid);
+    GetChannelsUserFound(client, id, client_version, err, user);
+    RecordCommandCompleted(OPCODE_CLIENT_GET_CHANNELS, start);
+  };
+  FindUserAsync(client, hinf, cb);
+}
+
+void InnerTcpHandlerHost::HandleGetRuntimeChannelInfoRequest(fastotv::inner::InnerClient* connection,
+                                                             cmd_seq_t id,
+                                                             const CommandArgsView& argv) {
+  if (argv.size() < 2) {
+    common::Error err = common::make_error_inval();
+    cmd_responce_t resp = GetRuntimeChannelInfoResponceFail(id, err->GetDescription());
+    err = connection->Write(resp);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
     }
+    CloseConnection(connection);
     return;
-  } else if (IS_EQUAL_COMMAND(command, CLIENT_GET_RUNTIME_CHANNEL_INFO)) {
-    inner::InnerTcpClient* client = static_cast<inner::InnerTcpClient*>(connection);
-    if (argc > 1) {
-      common::libev::IoLoop* server = client->GetServer();
-      bool is_anonim = client->IsAnonimUser();
-      AuthInfo ainf = client->GetServerHostInfo();
-      const login_t login = ainf.GetLogin();
-      const stream_id channel = argv[1];
-      const stream_id prev_channel = client->GetCurrentStreamId();
-
-      size_t watchers = GetOnlineUserByStreamId(server, channel);  // calc watchers
-      client->SetCurrentStreamId(channel);                         // add to watcher
-
-      RuntimeChannelInfo rinf;
-      rinf.SetChannelId(channel);
-      rinf.SetWatchersCount(watchers);
-      if (!is_anonim) {  // registered user
-        rinf.SetChatEnabled(false);
-        rinf.SetChatReadOnly(true);
-        rinf.SetChannelType(PRIVATE_CHANNEL);
-
-        for (size_t i = 0; i < chat_channels_.size(); ++i) {
-          if (chat_channels_[i] == channel) {
-            rinf.SetChatEnabled(true);
-            rinf.SetChatReadOnly(false);
-            rinf.SetChannelType(OFFICAL_CHANNEL);
-            break;
-          }
-        }
-      } else {  // anonim have only offical channels and readonly mode
-        rinf.SetChannelType(OFFICAL_CHANNEL);
-        rinf.SetChatEnabled(true);
-        rinf.SetChatReadOnly(true);
-      }
-
-      serializet_t rchannel_str;
-      common::Error err = rinf.SerializeToString(&rchannel_str);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-        return;
-      }
+  }
 
-      cmd_responce_t channels_responce = GetRuntimeChannelInfoResponceSuccsess(id, rchannel_str);
-      err = connection->Write(channels_responce);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      } else {
-        if (prev_channel == invalid_stream_id) {  // first channel
-          SendEnterChatMessage(server, channel, login);
-        } else {
-          SendLeaveChatMessage(server, prev_channel, login);
-          SendEnterChatMessage(server, channel, login);
-        }
-      }
-      return;
-    } else {
-      common::Error err = common::make_error_inval();
-      cmd_responce_t resp = GetRuntimeChannelInfoResponceFail(id, err->GetDescription());
-      err = connection->Write(resp);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      connection->Close();
-      delete connection;
-      return;
-    }
-  } else if (IS_EQUAL_COMMAND(command, CLIENT_SEND_CHAT_MESSAGE)) {
-    if (argc > 1) {
-      inner::InnerTcpClient* client = static_cast<inner::InnerTcpClient*>(connection);
-      serializet_t msg_str = argv[1];
-      json_object* jmsg = json_tokener_parse(argv[1]);
-      if (!jmsg) {
-        common::Error err = common::make_error_inval();
-        cmd_responce_t resp = SendChatMessageResponceFail(id, err->GetDescription());
-        err = connection->Write(resp);
-        if (err) {
-          DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-        }
-        connection->Close();
-        delete connection;
-        return;
-      }
+  inner::InnerTcpClient* client = static_cast<inner::InnerTcpClient*>(connection);
+  bool is_anonim = client->IsAnonimUser();
+  AuthInfo ainf = client->GetServerHostInfo();
+  const login_t login = ainf.GetLogin();
+  const stream_id channel = argv[1].as_string();
+  const stream_id prev_channel = client->GetCurrentStreamId();
+
+  size_t watchers = parent_->GetOnlineUserByStreamId(channel);  // calc watchers
+  ChangeCurrentStream(client, channel);                         // add to watcher
+
+  RuntimeChannelInfo rinf;
+  rinf.SetChannelId(channel);
+  rinf.SetWatchersCount(watchers);
+  if (!is_anonim) {  // registered user
+    const bool is_chat_channel = parent_->IsChatChannel(channel);
+    rinf.SetChatEnabled(is_chat_channel);
+    rinf.SetChatReadOnly(!is_chat_channel);
+    rinf.SetChannelType(is_chat_channel ? OFFICAL_CHANNEL : PRIVATE_CHANNEL);
+  } else {  // anonim have only offical channels and readonly mode
+    rinf.SetChannelType(OFFICAL_CHANNEL);
+    rinf.SetChatEnabled(true);
+    rinf.SetChatReadOnly(true);
+  }
 
-      ChatMessage msg;
-      common::Error err = ChatMessage::DeSerialize(jmsg, &msg);
-      json_object_put(jmsg);
-      if (err) {
-        cmd_responce_t resp = SendChatMessageResponceFail(id, err->GetDescription());
-        err = connection->Write(resp);
-        if (err) {
-          DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-        }
-        connection->Close();
-        delete connection;
-        return;
-      }
+  serializet_t rchannel_str;
+  common::Error err = rinf.SerializeToString(&rchannel_str);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    return;
+  }
 
-      BrodcastChatMessage(client->GetServer(), msg);
-      cmd_responce_t resp = SendChatMessageResponceSuccsess(id, msg_str);
-      err = connection->Write(resp);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      return;
-    } else {
-      common::Error err = common::make_error_inval();
-      cmd_responce_t resp = SendChatMessageResponceFail(id, err->GetDescription());
-      err = connection->Write(resp);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      connection->Close();
-      delete connection;
-      return;
-    }
+  cmd_responce_t channels_responce = GetRuntimeChannelInfoResponceSuccsess(id, rchannel_str);
+  err = connection->Write(channels_responce);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    return;
   }
 
-  WARNING_LOG() << "UNKNOWN COMMAND: " << command;
+  if (prev_channel == invalid_stream_id) {  // first channel
+    SendEnterChatMessage(channel, login);
+  } else {
+    SendLeaveChatMessage(prev_channel, login);
+    SendEnterChatMessage(channel, login);
+  }
 }
 
-void InnerTcpHandlerHost::HandleInnerResponceCommand(fastotv::inner::InnerClient* connection,
-                                                     cmd_seq_t id,
-                                                     int argc,
-                                                     char* argv[]) {
-  char* state_command = argv[0];
-
-  if (IS_EQUAL_COMMAND(state_command, SUCCESS_COMMAND) && argc > 1) {
-    common::Error err = HandleInnerSuccsessResponceCommand(connection, id, argc, argv);
+void InnerTcpHandlerHost::HandleSendChatMessageRequest(fastotv::inner::InnerClient* connection,
+                                                       cmd_seq_t id,
+                                                       const CommandArgsView& argv) {
+  if (argv.size() < 2) {
+    common::Error err = common::make_error_inval();
+    cmd_responce_t resp = SendChatMessageResponceFail(id, err->GetDescription());
+    err = connection->Write(resp);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      connection->Close();
-      delete connection;
     }
+    CloseConnection(connection);
     return;
-  } else if (IS_EQUAL_COMMAND(state_command, FAIL_COMMAND) && argc > 1) {
-    common::Error err = HandleInnerFailedResponceCommand(connection, id, argc, argv);
+  }
+
+  serializet_t msg_str = argv[1].as_string();
+  json_object* jmsg = json_tokener_parse(argv[1].data());
+  if (!jmsg) {
+    common::Error err = common::make_error_inval();
+    cmd_responce_t resp = SendChatMessageResponceFail(id, err->GetDescription());
+    err = connection->Write(resp);
     if (err) {
       DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      connection->Close();
-      delete connection;
     }
+    CloseConnection(connection);
     return;
   }
 
-  const std::string error_str = common::MemSPrintf("UNKNOWN STATE COMMAND: %s", state_command);
-  common::Error err = common::make_error(error_str);
-  DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-  connection->Close();
-  delete connection;
-}
-
-common::Error InnerTcpHandlerHost::HandleInnerSuccsessResponceCommand(fastotv::inner::InnerClient* connection,
-                                                                      cmd_seq_t id,
-                                                                      int argc,
-                                                                      char* argv[]) {
-  char* command = argv[1];
-  if (IS_EQUAL_COMMAND(command, SERVER_PING)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = PingApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
-    }
-
-    ServerPingInfo ping_info;
-    common::Error err = ServerPingInfo::DeSerialize(obj, &ping_info);
-    json_object_put(obj);
-    if (err) {
-      cmd_approve_t resp = PingApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return err;
-    }
-
-    cmd_approve_t resp = PingApproveResponceSuccsess(id);
+  ChatMessage msg;
+  common::Error err = ChatMessage::DeSerialize(jmsg, &msg);
+  json_object_put(jmsg);
+  if (err) {
+    cmd_responce_t resp = SendChatMessageResponceFail(id, err->GetDescription());
     err = connection->Write(resp);
     if (err) {
-      return err;
-    }
-    return common::Error();
-  } else if (IS_EQUAL_COMMAND(command, SERVER_WHO_ARE_YOU)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = WhoAreYouApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
     }
+    CloseConnection(connection);
+    return;
+  }
 
-    AuthInfo uauth;
-    common::Error err = AuthInfo::DeSerialize(obj, &uauth);
-    json_object_put(obj);
-    if (err) {
-      const std::string error_str = err->GetDescription();
-      cmd_approve_t resp = WhoAreYouApproveResponceFail(id, error_str);
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return err;
-    }
+  cmd_responce_t resp = SendChatMessageResponceSuccsess(id, msg_str);
+  err = connection->Write(resp);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+  parent_->BrodcastChatMessage(msg.GetChannelId(), msg_str);  // forward validated original, after last use of sender
+}
 
-    if (!uauth.IsValid()) {
-      common::Error lerr = common::make_error_inval();
-      cmd_approve_t resp = WhoAreYouApproveResponceFail(id, lerr->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return lerr;
-    }
+common::Error InnerTcpHandlerHost::HandleServerPingResponce(fastotv::inner::InnerClient* connection,
+                                                            cmd_seq_t id,
+                                                            const CommandArgsView& argv) {
+  json_object* obj = NULL;
+  common::Error parse_err = ParserResponceResponceCommand(argv, &obj);
+  if (parse_err) {
+    cmd_approve_t resp = PingApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
+  }
 
-    user_id_t uid;
-    UserInfo registered_user;
-    err = parent_->FindUser(uauth, &uid, &registered_user);
-    if (err) {
-      cmd_approve_t resp = WhoAreYouApproveResponceFail(id, err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return err;
-    }
+  ServerPingInfo ping_info;
+  common::Error err = ServerPingInfo::DeSerialize(obj, &ping_info);
+  json_object_put(obj);
+  if (err) {
+    cmd_approve_t resp = PingApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return err;
+  }
 
-    const device_id_t dev = uauth.GetDeviceID();
-    if (!registered_user.HaveDevice(dev)) {
-      const std::string error_str = "Unknown device reject";
-      cmd_approve_t resp = WhoAreYouApproveResponceFail(id, error_str);
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return err;
-    }
+  cmd_approve_t resp = PingApproveResponceSuccsess(id);
+  err = connection->Write(resp);
+  if (err) {
+    return err;
+  }
+  return common::Error();
+}
 
-    if (uauth == InnerTcpClient::anonim_user) {  // anonim user
-      cmd_approve_t resp = WhoAreYouApproveResponceSuccsess(id);
-      err = connection->Write(resp);
-      if (err) {
-        return err;
-      }
+common::Error InnerTcpHandlerHost::HandleWhoAreYouResponce(fastotv::inner::InnerClient* connection,
+                                                           cmd_seq_t id,
+                                                           const CommandArgsView& argv) {
+  json_object* obj = NULL;
+  common::Error parse_err = ParserResponceResponceCommand(argv, &obj);
+  if (parse_err) {
+    cmd_approve_t resp = WhoAreYouApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
+  }
 
-      InnerTcpClient* inner_conn = static_cast<InnerTcpClient*>(connection);
-      inner_conn->SetServerHostInfo(uauth);
-      INFO_LOG() << "Welcome anonim user: " << uauth.GetLogin();
-      return common::Error();
-    }
+  AuthInfo uauth;
+  common::Error err = AuthInfo::DeSerialize(obj, &uauth);
+  json_object_put(obj);
+  if (err) {
+    const std::string error_str = err->GetDescription();
+    cmd_approve_t resp = WhoAreYouApproveResponceFail(id, error_str);
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return err;
+  }
 
-    // registered user
-    InnerTcpClient* fclient = parent_->FindInnerConnectionByUserIDAndDeviceID(uid, dev);
-    if (fclient) {
-      const std::string error_str = "Double connection reject";
-      cmd_approve_t resp = WhoAreYouApproveResponceFail(id, error_str);
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return err;
-    }
+  if (!uauth.IsValid()) {
+    common::Error lerr = common::make_error_inval();
+    cmd_approve_t resp = WhoAreYouApproveResponceFail(id, lerr->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return lerr;
+  }
 
-    cmd_approve_t resp = WhoAreYouApproveResponceSuccsess(id);
-    err = connection->Write(resp);
-    if (err) {
-      return err;
-    }
+  protocol_version_t accepted = PROTOCOL_V1;  // old clients not accept
+  if (config_.server.binary_protocol && argv.size() > 3 && ConvertFromString(argv[3].as_string(), &accepted) &&
+      accepted == PROTOCOL_V2) {
+    connection->SetProtocolVersion(PROTOCOL_V2);
+  }
 
-    err = parent_->RegisterInnerConnectionByUser(uid, uauth, connection);
-    if (err) {
-      return err;
-    }
+  fastotv::inner::frame_codec_t codec;  // old clients not select, legacy snappy frames
+  if (argv.size() > 4 && fastotv::inner::ConvertFromString(argv[4].as_string(), &codec) &&
+      fastotv::inner::IsFrameCodecOffered(config_.server.frame_codecs, codec)) {
+    connection->SetFrameCodec(codec);
+  }
 
-    PublishUserStateInfo(UserStateInfo(uid, dev, true));
-    INFO_LOG() << "Welcome registered user: " << uauth.GetLogin();
-    return common::Error();
-  } else if (IS_EQUAL_COMMAND(command, SERVER_GET_CLIENT_INFO)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = SystemInfoApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
-    }
+  InnerTcpClient* iclient = static_cast<InnerTcpClient*>(connection);
+  const std::chrono::steady_clock::time_point auth_start = std::chrono::steady_clock::now();
+  auto cb = [this, id, uauth, auth_start](InnerTcpClient* client, common::Error find_err, user_id_t uid,
+                                          const UserInfo& user) {
+    parent_->GetMetrics()->GetAuthLatency()->RecordNsec(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - auth_start).count());
+    common::Error lerr = WhoAreYouUserFound(client, id, uauth, find_err, uid, user);
+    RecordCommandCompleted(OPCODE_SERVER_WHO_ARE_YOU, auth_start);
+    if (lerr) {
+      DEBUG_MSG_ERROR(lerr, common::logging::LOG_LEVEL_ERR);
+      CloseConnection(client);
+    }
+  };
+  FindUserAsync(iclient, uauth, cb);
+  return common::Error();
+}
 
-    ClientInfo cinf;
-    common::Error err = ClientInfo::DeSerialize(obj, &cinf);
-    json_object_put(obj);
-    if (err) {
-      const std::string error_str = err->GetDescription();
-      cmd_approve_t resp = SystemInfoApproveResponceFail(id, error_str);
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return err;
-    }
+common::Error InnerTcpHandlerHost::HandleClientInfoResponce(fastotv::inner::InnerClient* connection,
+                                                            cmd_seq_t id,
+                                                            const CommandArgsView& argv) {
+  json_object* obj = NULL;
+  common::Error parse_err = ParserResponceResponceCommand(argv, &obj);
+  if (parse_err) {
+    cmd_approve_t resp = SystemInfoApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
+  }
 
-    if (!cinf.IsValid()) {
-      common::Error lerr = common::make_error_inval();
-      cmd_approve_t resp = SystemInfoApproveResponceFail(id, lerr->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return lerr;
-    }
+  ClientInfo cinf;
+  common::Error err = ClientInfo::DeSerialize(obj, &cinf);
+  json_object_put(obj);
+  if (err) {
+    const std::string error_str = err->GetDescription();
+    cmd_approve_t resp = SystemInfoApproveResponceFail(id, error_str);
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return err;
+  }
 
-    cmd_approve_t resp = SystemInfoApproveResponceSuccsess(id);
-    err = connection->Write(resp);
-    if (err) {
-      return err;
-    }
-    return common::Error();
-  } else if (IS_EQUAL_COMMAND(command, SERVER_SEND_CHAT_MESSAGE)) {
-    json_object* obj = NULL;
-    common::Error parse_err = ParserResponceResponceCommand(argc, argv, &obj);
-    if (parse_err) {
-      cmd_approve_t resp = ServerSendChatMessageApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return parse_err;
-    }
+  if (!cinf.IsValid()) {
+    common::Error lerr = common::make_error_inval();
+    cmd_approve_t resp = SystemInfoApproveResponceFail(id, lerr->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return lerr;
+  }
 
-    ChatMessage msg;
-    common::Error err = ChatMessage::DeSerialize(obj, &msg);
-    json_object_put(obj);
-    if (err) {
-      cmd_approve_t resp = ServerSendChatMessageApproveResponceFail(id, parse_err->GetDescription());
-      common::Error write_err = connection->Write(resp);
-      UNUSED(write_err);
-      return err;
-    }
+  cmd_approve_t resp = SystemInfoApproveResponceSuccsess(id);
+  err = connection->Write(resp);
+  if (err) {
+    return err;
+  }
+  return common::Error();
+}
 
-    cmd_approve_t resp = ServerSendChatMessageApproveResponceSuccsess(id);
-    err = connection->Write(resp);
-    if (err) {
-      return err;
-    }
-    return common::Error();
+common::Error InnerTcpHandlerHost::HandleServerChatMessageResponce(fastotv::inner::InnerClient* connection,
+                                                                   cmd_seq_t id,
+                                                                   const CommandArgsView& argv) {
+  json_object* obj = NULL;
+  common::Error parse_err = ParserResponceResponceCommand(argv, &obj);
+  if (parse_err) {
+    cmd_approve_t resp = ServerSendChatMessageApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return parse_err;
   }
 
-  const std::string error_str = common::MemSPrintf("UNKNOWN RESPONCE COMMAND: %s", command);
-  return common::make_error(error_str);
+  ChatMessage msg;
+  common::Error err = ChatMessage::DeSerialize(obj, &msg);
+  json_object_put(obj);
+  if (err) {
+    cmd_approve_t resp = ServerSendChatMessageApproveResponceFail(id, parse_err->GetDescription());
+    common::Error write_err = connection->Write(resp);
+    UNUSED(write_err);
+    return err;
+  }
+
+  cmd_approve_t resp = ServerSendChatMessageApproveResponceSuccsess(id);
+  err = connection->Write(resp);
+  if (err) {
+    return err;
+  }
+  return common::Error();
 }
 
 common::Error InnerTcpHandlerHost::HandleInnerFailedResponceCommand(fastotv::inner::InnerClient* connection,
                                                                     cmd_seq_t id,
-                                                                    int argc,
-                                                                    char* argv[]) {
+                                                                    const CommandArgsView& argv) {
   UNUSED(connection);
   UNUSED(id);
-  UNUSED(argc);
 
-  char* command = argv[1];
+  const char* command = argv[1].data();
   const std::string error_str =
       common::MemSPrintf("Sorry now we can't handle failed pesponce for command: %s", command);
   return common::make_error(error_str);
@@ -650,50 +753,23 @@ common::Error InnerTcpHandlerHost::HandleInnerFailedResponceCommand(fastotv::inn
 
 void InnerTcpHandlerHost::HandleInnerApproveCommand(fastotv::inner::InnerClient* connection,
                                                     cmd_seq_t id,
-                                                    int argc,
-                                                    char* argv[]) {
+                                                    const CommandArgsView& argv) {
   UNUSED(connection);
   UNUSED(id);
-  char* command = argv[0];
-
-  if (IS_EQUAL_COMMAND(command, SUCCESS_COMMAND)) {
-    if (argc > 1) {
-      const char* okrespcommand = argv[1];
-      if (IS_EQUAL_COMMAND(okrespcommand, CLIENT_PING)) {
-      } else if (IS_EQUAL_COMMAND(okrespcommand, CLIENT_GET_SERVER_INFO)) {
-      } else if (IS_EQUAL_COMMAND(okrespcommand, CLIENT_GET_CHANNELS)) {
-      } else if (IS_EQUAL_COMMAND(okrespcommand, CLIENT_GET_RUNTIME_CHANNEL_INFO)) {
-      } else if (IS_EQUAL_COMMAND(okrespcommand, CLIENT_SEND_CHAT_MESSAGE)) {
-      }
-    }
-    return;
-  } else if (IS_EQUAL_COMMAND(command, FAIL_COMMAND)) {
-    if (argc > 1) {
-      const char* failed_resp_command = argv[1];
-      if (IS_EQUAL_COMMAND(failed_resp_command, CLIENT_PING)) {
-      } else if (IS_EQUAL_COMMAND(failed_resp_command, CLIENT_GET_SERVER_INFO)) {
-      } else if (IS_EQUAL_COMMAND(failed_resp_command, CLIENT_GET_CHANNELS)) {
-      } else if (IS_EQUAL_COMMAND(failed_resp_command, CLIENT_GET_RUNTIME_CHANNEL_INFO)) {
-      } else if (IS_EQUAL_COMMAND(failed_resp_command, CLIENT_SEND_CHAT_MESSAGE)) {
-      }
-    }
+  const char* command = argv[0].data();
+  if (CommandToState(command) != STATE_NONE) {  // client approves of server responces, nothing to do
     return;
   }
 
   WARNING_LOG() << "UNKNOWN COMMAND: " << command;
 }
 
-common::Error InnerTcpHandlerHost::ParserResponceResponceCommand(int argc, char* argv[], json_object** out) {
-  if (argc < 2) {
-    return common::make_error_inval();
-  }
-
-  const char* arg_2_str = argv[2];
-  if (!arg_2_str) {
+common::Error InnerTcpHandlerHost::ParserResponceResponceCommand(const CommandArgsView& argv, json_object** out) {
+  if (argv.size() < 3) {
     return common::make_error_inval();
   }
 
-  json_object* obj = json_tokener_parse(arg_2_str);
+  json_object* obj = json_tokener_parse(argv[2].data());
   if (!obj) {
     return common::make_error_inval();
   }
@@ -702,48 +778,183 @@ common::Error InnerTcpHandlerHost::ParserResponceResponceCommand(int argc, char*
   return common::Error();
 }
 
-void InnerTcpHandlerHost::SendEnterChatMessage(common::libev::IoLoop* server, stream_id sid, login_t login) {
-  BrodcastChatMessage(server, MakeEnterMessage(sid, login));
-}
+void InnerTcpHandlerHost::GetServerInfoUserFound(InnerTcpClient* client, cmd_seq_t id, common::Error err) {
+  if (err) {
+    cmd_responce_t resp = GetServerInfoResponceFail(id, err->GetDescription());
+    common::Error err = client->Write(resp);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    CloseConnection(client);
+    return;
+  }
 
-void InnerTcpHandlerHost::SendLeaveChatMessage(common::libev::IoLoop* server, stream_id sid, login_t login) {
-  BrodcastChatMessage(server, MakeLeaveMessage(sid, login));
+  ServerInfo serv(config_.server.bandwidth_host);
+  json_object* jserver_info = NULL;
+  err = serv.Serialize(&jserver_info);
+  if (err) {
+    NOTREACHED();
+  }
+
+  serializet_t server_info_str = json_object_get_string(jserver_info);
+  json_object_put(jserver_info);
+
+  cmd_responce_t server_info_responce = GetServerInfoResponceSuccsess(id, server_info_str);
+  err = client->Write(server_info_responce);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
 }
 
-void InnerTcpHandlerHost::BrodcastChatMessage(common::libev::IoLoop* server, const ChatMessage& msg) {
-  serializet_t msg_ser;
-  common::Error err = msg.SerializeToString(&msg_ser);
+void InnerTcpHandlerHost::GetChannelsUserFound(InnerTcpClient* client,
+                                               cmd_seq_t id,
+                                               const std::string& client_version,
+                                               common::Error err,
+                                               const UserInfo& user) {
+  if (err) {
+    cmd_responce_t resp = GetChannelsResponceFail(id, err->GetDescription());
+    common::Error err = client->Write(resp);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    CloseConnection(client);
+    return;
+  }
+
+  fastotv::inner::InnerClient::frame_t channels_responce;
+  {
+    ScopedLatency make_latency(parent_->GetMetrics()->GetChannelsResponceLatency());
+    err = parent_->MakeChannelsResponceFrame(id, user, client_version, client, &channels_responce);
+  }
   if (err) {
     DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    cmd_responce_t resp = GetChannelsResponceFail(id, err->GetDescription());
+    common::Error write_err = client->Write(resp);
+    if (write_err) {
+      DEBUG_MSG_ERROR(write_err, common::logging::LOG_LEVEL_ERR);
+    }
     return;
   }
 
-  std::vector<common::libev::IoClient*> online_clients = server->GetClients();
-  for (size_t i = 0; i < online_clients.size(); ++i) {
-    common::libev::IoClient* client = online_clients[i];
-    InnerTcpClient* iclient = static_cast<InnerTcpClient*>(client);
-    if (iclient && iclient->GetCurrentStreamId() == msg.GetChannelId()) {
-      const cmd_request_t message_request = ServerSendChatMessageRequest(NextRequestID(), msg_ser);
-      err = iclient->Write(message_request);
+  err = client->WriteFrame(channels_responce, false);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  }
+}
+
+common::Error InnerTcpHandlerHost::WhoAreYouUserFound(InnerTcpClient* client,
+                                                      cmd_seq_t id,
+                                                      const AuthInfo& uauth,
+                                                      common::Error err,
+                                                      user_id_t uid,
+                                                      const UserInfo& registered_user) {
+  if (err) {
+    cmd_approve_t resp = WhoAreYouApproveResponceFail(id, err->GetDescription());
+    common::Error write_err = client->Write(resp);
+    UNUSED(write_err);
+    return err;
+  }
+
+  const device_id_t dev = uauth.GetDeviceID();
+  if (!registered_user.HaveDevice(dev)) {
+    const std::string error_str = "Unknown device reject";
+    cmd_approve_t resp = WhoAreYouApproveResponceFail(id, error_str);
+    common::Error write_err = client->Write(resp);
+    UNUSED(write_err);
+    return err;
+  }
+
+  if (uauth == InnerTcpClient::anonim_user) {  // anonim user
+    cmd_approve_t resp = WhoAreYouApproveResponceSuccsess(id);
+    err = client->Write(resp);
+    if (err) {
+      return err;
+    }
+
+    client->SetServerHostInfo(uauth);
+    INFO_LOG() << "Welcome anonim user: " << uauth.GetLogin();
+    return common::Error();
+  }
+
+  // registered user, double connection rejected by registration
+  common::Error reg_err = parent_->RegisterInnerConnectionByUser(uid, uauth, client);
+  if (reg_err) {
+    cmd_approve_t resp = WhoAreYouApproveResponceFail(id, reg_err->GetDescription());
+    common::Error write_err = client->Write(resp);
+    UNUSED(write_err);
+    return reg_err;
+  }
+
+  cmd_approve_t resp = WhoAreYouApproveResponceSuccsess(id);
+  err = client->Write(resp);
+  if (err) {
+    return err;
+  }
+
+  PublishUserStateInfo(UserStateInfo(uid, dev, true));
+  INFO_LOG() << "Welcome registered user: " << uauth.GetLogin();
+  return common::Error();
+}
+
+void InnerTcpHandlerHost::SendEnterChatMessage(stream_id sid, login_t login) {
+  parent_->BrodcastChatMessage(MakeEnterMessage(sid, login));
+}
+
+void InnerTcpHandlerHost::SendLeaveChatMessage(stream_id sid, login_t login) {
+  parent_->BrodcastChatMessage(MakeLeaveMessage(sid, login));
+}
+
+InnerTcpHandlerHost::shared_frame_t InnerTcpHandlerHost::MakeChatMessageFrame(const serializet_t& msg_ser) {
+  const cmd_request_t message_request = ServerSendChatMessageRequest(NextRequestID(), msg_ser);
+  return std::make_shared<fastotv::inner::SharedFrame>(message_request.GetCmd());
+}
+
+void InnerTcpHandlerHost::BrodcastChatMessage(stream_id sid, const shared_frame_t& frame) {
+  subscribers_index_t::const_iterator it = subscribers_.find(sid);
+  if (it == subscribers_.end()) {
+    return;
+  }
+
+  ScopedLatency fanout_latency(parent_->GetMetrics()->GetChatFanoutLatency());
+  fastotv::inner::InnerClient::frame_t frames[fastotv::inner::FrameKind::count];  // by kind of watchers
+  const subscribers_t& watchers = it->second;
+  for (subscribers_t::const_iterator jt = watchers.begin(); jt != watchers.end(); ++jt) {
+    InnerTcpClient* iclient = *jt;
+    const fastotv::inner::FrameKind kind = iclient->GetFrameKind(frame->GetMessageSize());
+    fastotv::inner::InnerClient::frame_t& kind_frame = frames[kind.GetIndex()];
+    if (!kind_frame) {
+      common::Error err = frame->GetFrame(kind, &kind_frame);
       if (err) {
         DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        continue;
       }
     }
+
+    common::Error err = iclient->WriteFrame(kind_frame, true);  // dropped if client overloaded
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      slow_clients_.insert(iclient);  // closing changes watchers and can reenter, closed by CloseSlowClients
+    }
   }
+
 }
 
-size_t InnerTcpHandlerHost::GetOnlineUserByStreamId(common::libev::IoLoop* server, stream_id sid) const {
-  size_t total = 0;
-  std::vector<common::libev::IoClient*> online_clients = server->GetClients();
-  for (size_t i = 0; i < online_clients.size(); ++i) {
-    common::libev::IoClient* client = online_clients[i];
-    InnerTcpClient* iclient = static_cast<InnerTcpClient*>(client);
-    if (iclient && iclient->GetCurrentStreamId() == sid) {
-      total++;
-    }
+void InnerTcpHandlerHost::CloseConnection(fastotv::inner::InnerClient* connection) {
+  common::Error err = connection->EndWriteBatch();  // fail responce written before close, socket not waited
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
   }
+  connection->Close();
+  delete connection;
+}
 
-  return total;
+void InnerTcpHandlerHost::CloseSlowClients() {
+  while (!slow_clients_.empty()) {  // closing broadcasts leave message, can mark more clients
+    InnerTcpClient* iclient = *slow_clients_.begin();
+    slow_clients_.erase(slow_clients_.begin());
+    iclient->Close();
+    delete iclient;
+  }
 }
 
 }  // namespace inner
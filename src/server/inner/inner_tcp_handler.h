@@ -18,8 +18,15 @@
 
 #pragma once
 
-#include <memory>  // for shared_ptr
-#include <string>  // for string
+#include <atomic>         // for atomic
+#include <chrono>         // for steady_clock
+#include <functional>     // for function
+#include <memory>         // for shared_ptr
+#include <mutex>          // for mutex
+#include <string>         // for string
+#include <unordered_map>  // for unordered_map
+#include <unordered_set>  // for unordered_set
+#include <vector>         // for vector
 
 #include <json-c/json_object.h>  // for json_object
 
@@ -29,9 +36,14 @@
 #include <common/macros.h>                  // for WARN_UNUSED_RESULT
 
 #include "commands/commands.h"                      // for cmd_seq_t
+#include "inner/command_handlers.h"                 // for CommandHandlers
+#include "inner/inner_client.h"                     // for InnerClient::frame_t
 #include "inner/inner_server_command_seq_parser.h"  // for InnerServerComman...
 
-#include "server/config.h"  // for Config
+#include "auth_info.h"  // for AuthInfo
+
+#include "server/bounded_mpsc_queue.h"  // for BoundedMPSCQueue
+#include "server/config.h"              // for Config
 #include "server/user_info.h"
 
 #include "chat_message.h"
@@ -46,33 +58,36 @@ namespace libev {
 class IoLoop;
 }
 }  // namespace common
-namespace common {
-namespace threads {
-template <typename RT>
-class Thread;
-}
-}  // namespace common
 
 namespace fastotv {
-namespace inner {
-class InnerClient;
-}
 namespace server {
 class UserStateInfo;
 class ServerHost;
-namespace redis {
-class RedisPubSub;
-}
 namespace inner {
 
-class InnerSubHandler;
 class InnerTcpClient;
 
 class InnerTcpHandlerHost : public fastotv::inner::InnerServerCommandSeqParser, public common::libev::IoLoopObserver {
  public:
   enum {
     ping_timeout_clients = 60,  // sec
-    reread_cache_timeout = 150
+    requests_tick_timeout = 1,  // sec, subscribed requests expiration
+    tasks_queue_size = 4096,
+    max_tasks_per_wakeup = 64  // rest handled on next wakeup, not starves io
+  };
+  typedef std::function<void()> task_t;
+  typedef fastotv::inner::CommandHandlers<InnerTcpHandlerHost, void> request_handlers_t;
+  typedef fastotv::inner::CommandHandlers<InnerTcpHandlerHost, common::Error> responce_handlers_t;
+  typedef request_handlers_t::timing_hook_t timing_hook_t;
+
+  struct LoopStats {  // refreshed each requests tick
+    LoopStats();
+
+    size_t clients;
+    size_t pending_bytes;  // not yet written to sockets
+    size_t max_pending_bytes;
+    size_t overloaded_clients;
+    size_t dropped_frames;
   };
 
   explicit InnerTcpHandlerHost(ServerHost* parent, const Config& config);
@@ -90,54 +105,126 @@ class InnerTcpHandlerHost : public fastotv::inner::InnerServerCommandSeqParser,
 
   virtual ~InnerTcpHandlerHost();
 
-  common::Error PublishToChannelOut(const std::string& msg);
-  inner::InnerTcpClient* FindInnerConnectionByUserIDAndDeviceID(user_id_t user, device_id_t dev) const;
+  typedef std::shared_ptr<fastotv::inner::SharedFrame> shared_frame_t;
+  // thread-safe, request id shared by all receivers
+  shared_frame_t MakeChatMessageFrame(const serializet_t& msg_ser);
+  // watchers of this loop only, frame of each kind taken once per broadcast,
+  // slow clients marked and closed later by CloseSlowClients
+  void BrodcastChatMessage(stream_id sid, const shared_frame_t& frame);
+
+  // thread-safe, not blocks, false if queue full; task called in loop thread,
+  // one loop wakeup for all tasks posted before it handled
+  bool PostTask(common::libev::IoLoop* server, task_t task) WARN_UNUSED_RESULT;
+
+  // loop thread, called after each handled client request or responce,
+  // commands answered after user lookup reported when answered
+  void SetCommandsTimingHook(timing_hook_t hook);
+
+  LoopStats GetLoopStats() const;  // thread-safe
 
  private:
-  void UpdateCache();
+  typedef std::unordered_set<InnerTcpClient*> subscribers_t;
+  typedef std::unordered_map<stream_id, subscribers_t> subscribers_index_t;
+  typedef uint64_t lookup_id_t;
+  typedef std::unordered_map<lookup_id_t, InnerTcpClient*> lookups_t;
+  typedef std::function<void(InnerTcpClient* client, common::Error err, user_id_t uid, const UserInfo& uinf)>
+      user_found_cb_t;
+
+  // user lookup not blocks loop, cb not called if client closed before lookup finished
+  void FindUserAsync(InnerTcpClient* client, const AuthInfo& auth, user_found_cb_t cb);
+  void CancelLookups(InnerTcpClient* client);
+
+  void RecordCommandCompleted(cmd_opcode_t opcode, std::chrono::steady_clock::time_point start);
+
+  void HandleTasks(common::libev::IoLoop* server);
+  void CloseConnection(fastotv::inner::InnerClient* connection);  // queued responces written first
+  void CloseSlowClients();  // not called while clients iterated or handled
+  void UpdateLoopStats(common::libev::IoLoop* server);
+
+  void GetServerInfoUserFound(InnerTcpClient* client, cmd_seq_t id, common::Error err);
+  void GetChannelsUserFound(InnerTcpClient* client,
+                            cmd_seq_t id,
+                            const std::string& client_version,
+                            common::Error err,
+                            const UserInfo& user);
+  common::Error WhoAreYouUserFound(InnerTcpClient* client,
+                                   cmd_seq_t id,
+                                   const AuthInfo& uauth,
+                                   common::Error err,
+                                   user_id_t uid,
+                                   const UserInfo& registered_user) WARN_UNUSED_RESULT;
+
+  // move client between streams, keeps subscribers_ and host watchers in sync
+  void ChangeCurrentStream(InnerTcpClient* client, stream_id sid);
 
   void PublishUserStateInfo(const UserStateInfo& state);
 
   virtual void HandleInnerRequestCommand(fastotv::inner::InnerClient* connection,
                                          cmd_seq_t id,
-                                         int argc,
-                                         char* argv[]) override;
+                                         const CommandArgsView& argv) override;
   virtual void HandleInnerResponceCommand(fastotv::inner::InnerClient* connection,
                                           cmd_seq_t id,
-                                          int argc,
-                                          char* argv[]) override;
+                                          const CommandArgsView& argv) override;
   virtual void HandleInnerApproveCommand(fastotv::inner::InnerClient* connection,
                                          cmd_seq_t id,
-                                         int argc,
-                                         char* argv[]) override;
+                                         const CommandArgsView& argv) override;
+
+  // client requests
+  void HandleClientPingRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleGetServerInfoRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleGetChannelsRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+  void HandleGetRuntimeChannelInfoRequest(fastotv::inner::InnerClient* connection,
+                                          cmd_seq_t id,
+                                          const CommandArgsView& argv);
+  void HandleSendChatMessageRequest(fastotv::inner::InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv);
+
+  // client responces on server requests
+  common::Error HandleServerPingResponce(fastotv::inner::InnerClient* connection,
+                                         cmd_seq_t id,
+                                         const CommandArgsView& argv) WARN_UNUSED_RESULT;
+  common::Error HandleWhoAreYouResponce(fastotv::inner::InnerClient* connection,
+                                        cmd_seq_t id,
+                                        const CommandArgsView& argv) WARN_UNUSED_RESULT;
+  common::Error HandleClientInfoResponce(fastotv::inner::InnerClient* connection,
+                                         cmd_seq_t id,
+                                         const CommandArgsView& argv) WARN_UNUSED_RESULT;
+  common::Error HandleServerChatMessageResponce(fastotv::inner::InnerClient* connection,
+                                                cmd_seq_t id,
+                                                const CommandArgsView& argv) WARN_UNUSED_RESULT;
 
   // inner handlers
   common::Error HandleInnerSuccsessResponceCommand(fastotv::inner::InnerClient* connection,
                                                    cmd_seq_t id,
-                                                   int argc,
-                                                   char* argv[]) WARN_UNUSED_RESULT;
+                                                   const CommandArgsView& argv) WARN_UNUSED_RESULT;
   common::Error HandleInnerFailedResponceCommand(fastotv::inner::InnerClient* connection,
                                                  cmd_seq_t id,
-                                                 int argc,
-                                                 char* argv[]) WARN_UNUSED_RESULT;
+                                                 const CommandArgsView& argv) WARN_UNUSED_RESULT;
 
-  common::Error ParserResponceResponceCommand(int argc, char* argv[], json_object** out) WARN_UNUSED_RESULT;
+  common::Error ParserResponceResponceCommand(const CommandArgsView& argv, json_object** out) WARN_UNUSED_RESULT;
 
-  void SendEnterChatMessage(common::libev::IoLoop* server, stream_id sid, login_t login);
-  void SendLeaveChatMessage(common::libev::IoLoop* server, stream_id sid, login_t login);
-  void BrodcastChatMessage(common::libev::IoLoop* server, const ChatMessage& msg);
-  size_t GetOnlineUserByStreamId(common::libev::IoLoop* server, stream_id sid) const;
+  void SendEnterChatMessage(stream_id sid, login_t login);
+  void SendLeaveChatMessage(stream_id sid, login_t login);
 
   ServerHost* const parent_;
 
-  redis::RedisPubSub* sub_commands_in_;
-  InnerSubHandler* handler_;
-  std::shared_ptr<common::threads::Thread<void> > redis_subscribe_command_in_thread_;
   common::libev::timer_id_t ping_client_id_timer_;
-  common::libev::timer_id_t reread_cache_id_timer_;
+  common::libev::timer_id_t requests_timer_;
   const Config config_;
 
-  mutable std::vector<stream_id> chat_channels_;
+  subscribers_index_t subscribers_;  // watchers of this loop by stream, loop thread only
+  InnerTcpClient* reading_client_;   // client which commands handled now, reset if closed
+  subscribers_t slow_clients_;       // failed broadcast write, closed after fan-out unwinds
+  std::vector<std::string> commands_;  // decoded commands of reading client, strings capacity reused
+  lookup_id_t next_lookup_id_;
+  lookups_t lookups_;  // user lookups in flight
+  request_handlers_t request_handlers_;
+  responce_handlers_t responce_handlers_;
+  timing_hook_t commands_timing_hook_;
+  BoundedMPSCQueue<task_t> tasks_;
+  std::atomic<bool> tasks_scheduled_;  // wakeup requested and tasks not taken yet
+
+  mutable std::mutex loop_stats_mutex_;
+  LoopStats loop_stats_;
 };
 
 }  // namespace inner
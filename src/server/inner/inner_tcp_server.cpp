@@ -18,6 +18,10 @@
 
 #include "server/inner/inner_tcp_server.h"
 
+#include <fcntl.h>  // for fcntl, O_NONBLOCK
+
+#include <common/logger.h>  // for WARNING_LOG
+
 #include "server/inner/inner_tcp_client.h"
 
 namespace fastotv {
@@ -32,6 +36,24 @@ const char* InnerTcpServer::ClassName() const {
 }
 
 common::libev::tcp::TcpClient* InnerTcpServer::CreateClient(const common::net::socket_info& info) {
+  // writes must not block loop, pending data queued in client
+  const common::net::socket_descr_t fd = info.fd();
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+    WARNING_LOG() << "Can't set nonblocking mode for client socket: " << fd;
+  }
+
+  InnerTcpClient* client = new InnerTcpClient(this, info);
+  return client;
+}
+
+InnerTcpWorker::InnerTcpWorker(common::libev::IoLoopObserver* observer) : IoLoop(observer) {}
+
+const char* InnerTcpWorker::ClassName() const {
+  return "InnerTcpWorker";
+}
+
+common::libev::tcp::TcpClient* InnerTcpWorker::CreateClient(const common::net::socket_info& info) {
   InnerTcpClient* client = new InnerTcpClient(this, info);
   return client;
 }
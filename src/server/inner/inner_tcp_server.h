@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <common/libev/io_loop.h>         // for IoLoop
 #include <common/libev/tcp/tcp_client.h>  // for TcpClient
 #include <common/libev/tcp/tcp_server.h>  // for TcpServer
 
@@ -50,6 +51,16 @@ class InnerTcpServer : public common::libev::tcp::TcpServer {
   virtual common::libev::tcp::TcpClient* CreateClient(const common::net::socket_info& info) override;
 };
 
+// loop without listening socket, clients are moved into it by InnerTcpAcceptor
+class InnerTcpWorker : public common::libev::IoLoop {
+ public:
+  explicit InnerTcpWorker(common::libev::IoLoopObserver* observer);
+  virtual const char* ClassName() const override;
+
+ private:
+  virtual common::libev::tcp::TcpClient* CreateClient(const common::net::socket_info& info) override;
+};
+
 }  // namespace inner
 }  // namespace server
 }  // namespace fastotv
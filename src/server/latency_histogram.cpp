@@ -0,0 +1,128 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/latency_histogram.h"
+
+namespace fastotv {
+namespace server {
+namespace {
+
+size_t HighestBit(uint64_t value) {  // value != 0
+  size_t bit = 0;
+  while (value >>= 1) {
+    bit++;
+  }
+  return bit;
+}
+
+}  // namespace
+
+LatencyHistogram::Snapshot::Snapshot() : counts(buckets_count, 0), count(0), sum_usec(0), max_usec(0) {}
+
+uint64_t LatencyHistogram::Snapshot::ValueAtQuantile(double quantile) const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  uint64_t rank = static_cast<uint64_t>(quantile * total + 0.5);
+  if (rank == 0) {
+    rank = 1;
+  } else if (rank > total) {
+    rank = total;
+  }
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      const uint64_t bound = BucketUpperBound(i);
+      return bound < max_usec ? bound : max_usec;  // max is exact
+    }
+  }
+  return max_usec;
+}
+
+uint64_t LatencyHistogram::Snapshot::CountAtOrBelow(uint64_t usec) const {
+  uint64_t result = 0;
+  for (size_t i = 0; i < counts.size() && BucketUpperBound(i) <= usec; ++i) {
+    result += counts[i];
+  }
+  return result;
+}
+
+LatencyHistogram::LatencyHistogram() : count_(0), sum_usec_(0), max_usec_(0) {
+  for (size_t i = 0; i < buckets_count; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::Record(uint64_t usec) {
+  counts_[BucketIndex(usec)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_usec_.fetch_add(usec, std::memory_order_relaxed);
+  uint64_t max = max_usec_.load(std::memory_order_relaxed);
+  while (usec > max && !max_usec_.compare_exchange_weak(max, usec, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::RecordNsec(uint64_t nsec) {
+  Record(nsec / 1000);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+  Snapshot snapshot;
+  for (size_t i = 0; i < buckets_count; ++i) {
+    snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count = count_.load(std::memory_order_relaxed);
+  snapshot.sum_usec = sum_usec_.load(std::memory_order_relaxed);
+  snapshot.max_usec = max_usec_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t usec) {
+  if (usec < sub_buckets) {
+    return usec;
+  }
+
+  const size_t bit = HighestBit(usec);
+  if (bit >= max_value_bits) {
+    return buckets_count - 1;
+  }
+
+  const size_t shift = bit - sub_bucket_bits;
+  const size_t sub_bucket = (usec >> shift) - sub_buckets;  // [0, sub_buckets)
+  return sub_buckets + shift * sub_buckets + sub_bucket;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+  if (index < sub_buckets) {
+    return index;
+  }
+
+  const size_t shift = (index - sub_buckets) / sub_buckets;
+  const uint64_t sub_bucket = (index - sub_buckets) % sub_buckets + sub_buckets;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,91 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>  // for uint64_t
+
+#include <atomic>  // for atomic
+#include <chrono>  // for steady_clock
+#include <vector>  // for vector
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+namespace fastotv {
+namespace server {
+
+// lock-free latency histogram in microseconds, HDR style buckets:
+// values below 8 exact, above - each power of 2 split into 8 linear buckets (max error 12.5%)
+class LatencyHistogram {
+ public:
+  enum {
+    sub_bucket_bits = 3,
+    sub_buckets = 1 << sub_bucket_bits,
+    max_value_bits = 40,  // usec, ~12 days, bigger values counted in last bucket
+    buckets_count = sub_buckets + (max_value_bits - sub_bucket_bits) * sub_buckets
+  };
+
+  struct Snapshot {
+    Snapshot();
+
+    uint64_t ValueAtQuantile(double quantile) const;  // usec, upper bound of bucket, 0 if empty
+    uint64_t CountAtOrBelow(uint64_t usec) const;     // exact for buckets bounds
+
+    std::vector<uint64_t> counts;  // buckets_count
+    uint64_t count;
+    uint64_t sum_usec;
+    uint64_t max_usec;
+  };
+
+  LatencyHistogram();
+
+  void Record(uint64_t usec);  // thread-safe
+  void RecordNsec(uint64_t nsec);
+  Snapshot GetSnapshot() const;  // thread-safe, not atomic as a whole
+
+  static size_t BucketIndex(uint64_t usec);
+  static uint64_t BucketUpperBound(size_t index);  // max value counted in bucket
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LatencyHistogram);
+
+  std::atomic<uint64_t> counts_[buckets_count];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_usec_;
+  std::atomic<uint64_t> max_usec_;
+};
+
+// records time of scope
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(LatencyHistogram* histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedLatency() {
+    histogram_->RecordNsec(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ScopedLatency);
+
+  LatencyHistogram* const histogram_;
+  const std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,231 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/metrics_server.h"
+
+#include <errno.h>       // for errno
+#include <netdb.h>       // for getaddrinfo
+#include <poll.h>        // for poll
+#include <string.h>      // for memset, strerror
+#include <sys/socket.h>  // for socket, bind, listen, accept
+#include <unistd.h>      // for close
+
+#include <hiredis/hiredis.h>  // for redisReply, freeReplyObject
+
+#include <common/convert2string.h>          // for ConvertToString
+#include <common/logger.h>                  // for WARNING_LOG
+#include <common/sprintf.h>                 // for MemSPrintf
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+#include <common/time.h>                    // for current_mstime
+
+#include "server/redis/redis_pool.h"
+
+#define METRICS_PATH "/metrics"
+#define HTTP_OK_HEADER "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+#define HTTP_NOT_FOUND "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n"
+
+namespace fastotv {
+namespace server {
+namespace {
+
+common::Error Listen(const common::net::HostAndPort& host, int* out) {
+  const std::string port = common::ConvertToString(host.GetPort());
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  struct addrinfo* addrs = NULL;
+  int res = getaddrinfo(host.GetHost().c_str(), port.c_str(), &hints, &addrs);
+  if (res != 0) {
+    return common::make_error(gai_strerror(res));
+  }
+
+  int fd = -1;
+  for (struct addrinfo* addr = addrs; addr; addr = addr->ai_next) {
+    fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (fd == -1) {
+      continue;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, addr->ai_addr, addr->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0) {
+      break;
+    }
+
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addrs);
+
+  if (fd == -1) {
+    return common::make_error(common::MemSPrintf("Can't listen metrics port %s:%s", host.GetHost(), port));
+  }
+
+  *out = fd;
+  return common::Error();
+}
+
+bool SendAll(int fd, const char* data, size_t size) {
+  while (size) {
+    ssize_t nwrite = send(fd, data, size, MSG_NOSIGNAL);
+    if (nwrite <= 0) {
+      if (nwrite == -1 && errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += nwrite;
+    size -= nwrite;
+  }
+  return true;
+}
+
+bool IsMetricsRequest(const std::string& request) {  // GET /metrics[?query] HTTP/1.x
+  static const std::string prefix = "GET " METRICS_PATH;
+  if (request.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+
+  return request.size() == prefix.size() || request[prefix.size()] == ' ' || request[prefix.size()] == '?';
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(redis::RedisPool* pool, render_t render)
+    : pool_(pool), render_(render), redis_key_(), publish_interval_(0), listen_fd_(-1), stop_(false), thread_() {}
+
+MetricsServer::~MetricsServer() {
+  Stop();
+}
+
+common::Error MetricsServer::Start(const common::net::HostAndPort& host,
+                                   const std::string& redis_key,
+                                   size_t publish_interval) {
+  DCHECK(!thread_);
+  if (host.IsValid()) {
+    common::Error err = Listen(host, &listen_fd_);
+    if (err) {
+      return err;
+    }
+  }
+
+  redis_key_ = redis_key;
+  publish_interval_ = redis_key.empty() ? 0 : publish_interval;
+  if (listen_fd_ == -1 && publish_interval_ == 0) {  // nothing to do
+    return common::Error();
+  }
+
+  stop_ = false;
+  thread_ = THREAD_MANAGER()->CreateThread(&MetricsServer::Work, this);
+  bool result = thread_->Start();
+  if (!result) {
+    return common::make_error("Don't started metrics thread.");
+  }
+  return common::Error();
+}
+
+void MetricsServer::Stop() {
+  if (thread_) {
+    stop_ = true;
+    thread_->Join();
+    thread_.reset();
+  }
+
+  if (listen_fd_ != -1) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+  }
+}
+
+void MetricsServer::Work() {
+  common::time64_t last_publish_msec = common::time::current_mstime();
+  while (!stop_) {
+    if (listen_fd_ != -1) {
+      struct pollfd pfd = {listen_fd_, POLLIN, 0};
+      int res = poll(&pfd, 1, poll_timeout_msec);
+      if (res > 0 && (pfd.revents & POLLIN)) {
+        int fd = accept(listen_fd_, NULL, NULL);
+        if (fd != -1) {
+          Serve(fd);
+          close(fd);
+        }
+      }
+    } else {
+      poll(NULL, 0, poll_timeout_msec);
+    }
+
+    const common::time64_t now_msec = common::time::current_mstime();
+    if (publish_interval_ && now_msec - last_publish_msec >= static_cast<common::time64_t>(publish_interval_) * 1000) {
+      Publish();
+      last_publish_msec = now_msec;
+    }
+  }
+}
+
+void MetricsServer::Serve(int fd) {
+  struct timeval tv = {io_timeout_msec / 1000, (io_timeout_msec % 1000) * 1000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+  std::string request;  // only request line used, headers read to not reset connection
+  char buff[1024];
+  while (request.size() < max_request_size && request.find("\r\n\r\n") == std::string::npos) {
+    ssize_t nread = recv(fd, buff, sizeof(buff), 0);
+    if (nread <= 0) {
+      if (nread == -1 && errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    request.append(buff, nread);
+  }
+
+  if (!IsMetricsRequest(request)) {
+    SendAll(fd, HTTP_NOT_FOUND, sizeof(HTTP_NOT_FOUND) - 1);
+    return;
+  }
+
+  const std::string body = render_();
+  std::string responce = HTTP_OK_HEADER + common::ConvertToString(body.size()) + "\r\n\r\n";
+  responce += body;
+  if (!SendAll(fd, responce.data(), responce.size())) {
+    WARNING_LOG() << "Metrics not sent: " << strerror(errno);
+  }
+}
+
+void MetricsServer::Publish() {
+  const std::string body = render_();
+  const std::string ttl = common::ConvertToString(publish_interval_ * 3);  // stale metrics expire if server stopped
+  redisReply* reply = NULL;
+  common::Error err =
+      pool_->Command(&reply, "SET %s %b EX %s", redis_key_.c_str(), body.data(), body.size(), ttl.c_str());
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+    return;
+  }
+
+  if (reply->type == REDIS_REPLY_ERROR) {
+    WARNING_LOG() << "Metrics not published: " << reply->str;
+  }
+  freeReplyObject(reply);
+}
+
+}  // namespace server
+}  // namespace fastotv
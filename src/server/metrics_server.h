@@ -0,0 +1,81 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>      // for atomic
+#include <functional>  // for function
+#include <memory>      // for shared_ptr
+#include <string>      // for string
+
+#include <common/error.h>      // for Error
+#include <common/macros.h>     // for DISALLOW_COPY_AND_ASSIGN, WARN_UNUSED_RESULT
+#include <common/net/types.h>  // for HostAndPort
+
+namespace common {
+namespace threads {
+template <typename RT>
+class Thread;
+}
+}  // namespace common
+
+namespace fastotv {
+namespace server {
+namespace redis {
+class RedisPool;
+}
+
+// serves metrics as prometheus text on GET /metrics of admin port and publishes them to redis key,
+// both from own thread, so loops never wait for scrapers
+class MetricsServer {
+ public:
+  typedef std::function<std::string()> render_t;  // thread-safe
+  enum {
+    poll_timeout_msec = 1000,  // stop and publish checked at least so often
+    io_timeout_msec = 1000,    // slow scrapers disconnected
+    max_request_size = 4096
+  };
+
+  MetricsServer(redis::RedisPool* pool, render_t render);
+  ~MetricsServer();
+
+  // host not valid - admin port not opened, publish_interval 0 - not published
+  common::Error Start(const common::net::HostAndPort& host,
+                      const std::string& redis_key,
+                      size_t publish_interval) WARN_UNUSED_RESULT;
+  void Stop();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MetricsServer);
+
+  void Work();
+  void Serve(int fd);
+  void Publish();
+
+  redis::RedisPool* const pool_;
+  const render_t render_;
+  std::string redis_key_;
+  size_t publish_interval_;  // sec
+
+  int listen_fd_;
+  std::atomic<bool> stop_;
+  std::shared_ptr<common::threads::Thread<void> > thread_;
+};
+
+}  // namespace server
+}  // namespace fastotv
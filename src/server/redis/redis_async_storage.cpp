@@ -0,0 +1,129 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "server/redis/redis_async_storage.h"
+
+#include <common/logger.h>                  // for WARNING_LOG
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+
+#include "server/redis/redis_storage.h"
+
+namespace fastotv {
+namespace server {
+namespace redis {
+
+RedisAsyncStorage::RedisAsyncStorage(const RedisStorage* storage)
+    : storage_(storage), tasks_mutex_(), tasks_cond_(), tasks_(), stop_(false), workers_() {}
+
+RedisAsyncStorage::~RedisAsyncStorage() {
+  Stop();
+}
+
+void RedisAsyncStorage::Start(size_t workers) {
+  if (workers == 0) {
+    workers = 1;
+  }
+
+  for (size_t i = 0; i < workers; ++i) {
+    std::shared_ptr<common::threads::Thread<void> > worker =
+        THREAD_MANAGER()->CreateThread(&RedisAsyncStorage::Work, this);
+    bool result = worker->Start();
+    if (!result) {
+      WARNING_LOG() << "Don't started storage worker thread.";
+      continue;
+    }
+    workers_.push_back(worker);
+  }
+}
+
+void RedisAsyncStorage::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(tasks_mutex_);
+    stop_ = true;
+    tasks_.clear();
+  }
+  tasks_cond_.notify_all();
+
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->Join();
+  }
+  workers_.clear();
+}
+
+void RedisAsyncStorage::FindUser(const AuthInfo& auth, find_user_cb_t cb) {
+  const RedisStorage* storage = storage_;
+  auto task = [storage, auth, cb]() {
+    user_id_t uid;
+    UserInfo uinf;
+    common::Error err = storage->FindUser(auth, &uid, &uinf);
+    cb(err, uid, uinf);
+  };
+  Post(task);
+}
+
+void RedisAsyncStorage::GetChatChannels(chat_channels_cb_t cb) {
+  const RedisStorage* storage = storage_;
+  auto task = [storage, cb]() {
+    std::vector<stream_id> channels;
+    common::Error err = storage->GetChatChannels(&channels);
+    cb(err, channels);
+  };
+  Post(task);
+}
+
+size_t RedisAsyncStorage::GetQueueSize() const {
+  std::unique_lock<std::mutex> lock(tasks_mutex_);
+  return tasks_.size();
+}
+
+void RedisAsyncStorage::Post(task_t task) {
+  {
+    std::unique_lock<std::mutex> lock(tasks_mutex_);
+    if (stop_) {
+      return;
+    }
+    tasks_.push_back(task);
+  }
+  tasks_cond_.notify_one();
+}
+
+void RedisAsyncStorage::Work() {
+  while (true) {
+    task_t task;
+    {
+      std::unique_lock<std::mutex> lock(tasks_mutex_);
+      while (!stop_ && tasks_.empty()) {
+        tasks_cond_.wait(lock);
+      }
+
+      if (stop_) {
+        return;
+      }
+
+      task = tasks_.front();
+      tasks_.pop_front();
+    }
+
+    task();
+  }
+}
+
+}  // namespace redis
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,82 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <condition_variable>  // for condition_variable
+#include <deque>               // for deque
+#include <functional>          // for function
+#include <memory>              // for shared_ptr
+#include <mutex>               // for mutex
+#include <vector>              // for vector
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "auth_info.h"
+#include "server/user_info.h"  // for user_id_t, UserInfo
+
+namespace common {
+namespace threads {
+template <typename RT>
+class Thread;
+}
+}  // namespace common
+
+namespace fastotv {
+namespace server {
+namespace redis {
+
+class RedisStorage;
+
+// runs storage lookups on worker threads, callbacks called from worker thread
+class RedisAsyncStorage {
+ public:
+  typedef std::function<void(common::Error err, user_id_t uid, const UserInfo& uinf)> find_user_cb_t;
+  typedef std::function<void(common::Error err, const std::vector<stream_id>& channels)> chat_channels_cb_t;
+
+  explicit RedisAsyncStorage(const RedisStorage* storage);
+  ~RedisAsyncStorage();
+
+  void Start(size_t workers);
+  void Stop();  // not started lookups dropped
+
+  void FindUser(const AuthInfo& auth, find_user_cb_t cb);
+  void GetChatChannels(chat_channels_cb_t cb);
+
+  size_t GetQueueSize() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(RedisAsyncStorage);
+  typedef std::function<void()> task_t;
+
+  void Post(task_t task);
+  void Work();
+
+  const RedisStorage* const storage_;
+  mutable std::mutex tasks_mutex_;
+  std::condition_variable tasks_cond_;
+  std::deque<task_t> tasks_;
+  bool stop_;
+  std::vector<std::shared_ptr<common::threads::Thread<void> > > workers_;
+};
+
+}  // namespace redis
+}  // namespace server
+}  // namespace fastotv
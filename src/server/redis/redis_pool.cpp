@@ -0,0 +1,229 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "server/redis/redis_pool.h"
+
+#include <stdarg.h>  // for va_list
+#include <stddef.h>  // for NULL
+
+#include <hiredis/hiredis.h>  // for redisFree, redisvCommand
+
+#include <common/time.h>  // for current_mstime
+
+#include "server/redis/redis_connect.h"
+
+namespace fastotv {
+namespace server {
+namespace redis {
+
+RedisPool::Stats::Stats()
+    : connections(0),
+      idle(0),
+      acquires(0),
+      waits(0),
+      total_wait_msec(0),
+      max_wait_msec(0),
+      connects(0),
+      broken(0) {}
+
+RedisPool::RedisPool()
+    : mutex_(),
+      free_cond_(),
+      config_(),
+      max_connections_(default_max_connections),
+      idle_(),
+      connections_(0),
+      stats_(),
+      commands_latency_() {}
+
+RedisPool::~RedisPool() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  CloseIdle();
+}
+
+void RedisPool::SetConfig(const RedisConfig& config, size_t max_connections) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  config_ = config;
+  max_connections_ = max_connections == 0 ? 1 : max_connections;
+  CloseIdle();
+}
+
+common::Error RedisPool::Acquire(redisContext** conn) {
+  if (!conn) {
+    return common::make_error_inval();
+  }
+
+  const common::time64_t start_msec = common::time::current_mstime();
+  bool waited = false;
+  while (true) {
+    IdleConnection candidate = {NULL, 0};
+    RedisConfig config;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (idle_.empty() && connections_ >= max_connections_) {
+        waited = true;
+        free_cond_.wait(lock);
+      }
+
+      if (!idle_.empty()) {  // most recently used first
+        candidate = idle_.back();
+        idle_.pop_back();
+      } else {
+        connections_++;  // reserve place for new connection
+      }
+      config = config_;
+    }
+
+    if (candidate.context) {
+      if (IsAlive(candidate)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        AccountAcquire(start_msec, waited);
+        *conn = candidate.context;
+        return common::Error();
+      }
+
+      redisFree(candidate.context);
+      std::unique_lock<std::mutex> lock(mutex_);
+      connections_--;
+      stats_.broken++;
+      continue;
+    }
+
+    redisContext* redis = NULL;
+    common::Error err = redis_connect(config, &redis);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (err) {
+      connections_--;
+      free_cond_.notify_one();
+      return err;
+    }
+
+    stats_.connects++;
+    AccountAcquire(start_msec, waited);
+    *conn = redis;
+    return common::Error();
+  }
+}
+
+void RedisPool::Release(redisContext* conn, bool broken) {
+  if (!conn) {
+    return;
+  }
+
+  const bool is_broken = broken || conn->err;
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (is_broken || connections_ > max_connections_) {
+    redisFree(conn);
+    connections_--;
+    if (is_broken) {
+      stats_.broken++;
+    }
+  } else {
+    IdleConnection idle = {conn, common::time::current_mstime()};
+    idle_.push_back(idle);
+  }
+  free_cond_.notify_one();
+}
+
+common::Error RedisPool::Command(redisReply** reply, const char* format, ...) {
+  if (!reply || !format) {
+    return common::make_error_inval();
+  }
+
+  ScopedLatency latency(&commands_latency_);
+  for (size_t attempt = 0; attempt < 2; ++attempt) {
+    redisContext* redis = NULL;
+    common::Error err = Acquire(&redis);
+    if (err) {
+      return err;
+    }
+
+    va_list args;
+    va_start(args, format);
+    void* lreply = redisvCommand(redis, format, args);
+    va_end(args);
+    if (lreply) {
+      Release(redis, false);
+      *reply = static_cast<redisReply*>(lreply);
+      return common::Error();
+    }
+
+    err = common::make_error(redis->errstr);
+    Release(redis, true);
+    if (attempt != 0) {  // connection from pool could be dropped by server, retry once
+      return err;
+    }
+  }
+
+  return common::make_error("Redis command failed");
+}
+
+const LatencyHistogram& RedisPool::GetCommandsLatency() const {
+  return commands_latency_;
+}
+
+RedisPool::Stats RedisPool::GetStats() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.connections = connections_;
+  stats.idle = idle_.size();
+  return stats;
+}
+
+bool RedisPool::IsAlive(const IdleConnection& conn) const {
+  if (conn.context->err) {
+    return false;
+  }
+
+  if (common::time::current_mstime() - conn.last_used_msec < health_check_timeout_msec) {
+    return true;
+  }
+
+  void* reply = redisCommand(conn.context, "PING");
+  if (!reply) {
+    return false;
+  }
+
+  freeReplyObject(reply);
+  return true;
+}
+
+void RedisPool::AccountAcquire(common::time64_t start_msec, bool waited) {
+  const common::time64_t wait_msec = common::time::current_mstime() - start_msec;
+  stats_.acquires++;
+  if (waited) {
+    stats_.waits++;
+  }
+  stats_.total_wait_msec += wait_msec;
+  if (wait_msec > stats_.max_wait_msec) {
+    stats_.max_wait_msec = wait_msec;
+  }
+}
+
+void RedisPool::CloseIdle() {
+  for (size_t i = 0; i < idle_.size(); ++i) {
+    redisFree(idle_[i].context);
+    connections_--;
+  }
+  idle_.clear();
+}
+
+}  // namespace redis
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,99 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <condition_variable>  // for condition_variable
+#include <deque>               // for deque
+#include <mutex>               // for mutex
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for WARN_UNUSED_RESULT
+#include <common/types.h>   // for time64_t
+
+#include "server/latency_histogram.h"
+#include "server/redis/redis_config.h"
+
+struct redisContext;
+struct redisReply;
+
+namespace fastotv {
+namespace server {
+namespace redis {
+
+// thread-safe pool of persistent redis connections
+class RedisPool {
+ public:
+  enum {
+    default_max_connections = 8,
+    health_check_timeout_msec = 30 * 1000  // ping connection which was idle longer
+  };
+
+  struct Stats {
+    Stats();
+
+    size_t connections;  // opened now
+    size_t idle;
+    size_t acquires;
+    size_t waits;  // acquires which waited for free connection
+    common::time64_t total_wait_msec;
+    common::time64_t max_wait_msec;
+    size_t connects;  // including reconnects
+    size_t broken;
+  };
+
+  RedisPool();
+  ~RedisPool();
+
+  void SetConfig(const RedisConfig& config, size_t max_connections);
+
+  common::Error Acquire(redisContext** conn) WARN_UNUSED_RESULT;  // waits if all connections busy
+  void Release(redisContext* conn, bool broken);                  // broken connections closed
+
+  // acquire, exec and release, failed on io error command retried once on new connection
+  common::Error Command(redisReply** reply, const char* format, ...) WARN_UNUSED_RESULT;
+
+  Stats GetStats() const;
+  const LatencyHistogram& GetCommandsLatency() const;  // Command calls, acquire and retry included
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(RedisPool);
+
+  struct IdleConnection {
+    redisContext* context;
+    common::time64_t last_used_msec;
+  };
+
+  bool IsAlive(const IdleConnection& conn) const;
+  void AccountAcquire(common::time64_t start_msec, bool waited);  // under lock
+  void CloseIdle();                                                // under lock
+
+  mutable std::mutex mutex_;
+  std::condition_variable free_cond_;
+  RedisConfig config_;
+  size_t max_connections_;
+  std::deque<IdleConnection> idle_;
+  size_t connections_;
+  Stats stats_;
+  LatencyHistogram commands_latency_;
+};
+
+}  // namespace redis
+}  // namespace server
+}  // namespace fastotv
@@ -92,43 +92,6 @@ void RedisPubSub::Stop() {
   stop_ = true;
 }
 
-common::Error RedisPubSub::PublishStateToChannel(const std::string& msg) {
-  return Publish(config_.channel_clients_state, msg);
-}
-
-common::Error RedisPubSub::PublishToChannelOut(const std::string& msg) {
-  return Publish(config_.channel_out, msg);
-}
-
-common::Error RedisPubSub::Publish(const std::string& channel, const std::string& msg) {
-  if (channel.empty() || msg.empty()) {
-    return common::make_error_inval();
-  }
-
-  redisContext* redis_sub = NULL;
-  common::Error err = redis_connect(config_, &redis_sub);
-  if (err) {
-    return err;
-  }
-
-  if (channel.empty() || msg.empty()) {
-    return common::make_error_inval();
-  }
-
-  const char* chn = channel.c_str();
-  const char* m = msg.c_str();
-  void* rreply = redisCommand(redis_sub, "PUBLISH %s %s", chn, m);
-  if (!rreply) {
-    err = common::make_error(redis_sub->errstr);
-    redisFree(redis_sub);
-    return err;
-  }
-
-  freeReplyObject(rreply);
-  redisFree(redis_sub);
-  return common::Error();
-}
-
 }  // namespace redis
 }  // namespace server
 }  // namespace fastotv
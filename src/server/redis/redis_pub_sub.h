@@ -35,10 +35,6 @@ class RedisPubSub {
   void Listen();
   void Stop();
 
-  common::Error PublishStateToChannel(const std::string& msg) WARN_UNUSED_RESULT;
-  common::Error PublishToChannelOut(const std::string& msg) WARN_UNUSED_RESULT;
-  common::Error Publish(const std::string& channel, const std::string& msg) WARN_UNUSED_RESULT;
-
  private:
   RedisSubHandler* const handler_;
   RedisSubConfig config_;
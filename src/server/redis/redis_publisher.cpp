@@ -0,0 +1,184 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "server/redis/redis_publisher.h"
+
+#include <chrono>  // for milliseconds
+
+#include <hiredis/hiredis.h>  // for redisAppendCommand, redisGetReply
+
+#include <common/logger.h>                  // for DEBUG_MSG_ERROR
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+
+#include "server/redis/redis_pool.h"
+
+namespace fastotv {
+namespace server {
+namespace redis {
+
+RedisPublisher::Stats::Stats() : published(0), round_trips(0), dropped(0), failed(0) {}
+
+RedisPublisher::RedisPublisher(RedisPool* pool)
+    : pool_(pool),
+      channel_(),
+      coalesce_(false),
+      queue_(),
+      stop_(false),
+      sleeping_(false),
+      wake_mutex_(),
+      wake_cond_(),
+      published_(0),
+      round_trips_(0),
+      dropped_(0),
+      failed_(0),
+      thread_() {}
+
+RedisPublisher::~RedisPublisher() {
+  Stop();
+}
+
+void RedisPublisher::Start(const std::string& channel, size_t queue_size, bool coalesce) {
+  DCHECK(!thread_);
+  channel_ = channel;
+  coalesce_ = coalesce;
+  queue_.reset(new BoundedMPSCQueue<std::string>(queue_size));
+  stop_ = false;
+
+  thread_ = THREAD_MANAGER()->CreateThread(&RedisPublisher::Work, this);
+  bool result = thread_->Start();
+  if (!result) {
+    WARNING_LOG() << "Don't started publisher thread for channel: " << channel_;
+  }
+}
+
+void RedisPublisher::Stop() {
+  if (!thread_) {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    stop_ = true;
+    wake_cond_.notify_one();
+  }
+  thread_->Join();
+  thread_.reset();
+}
+
+bool RedisPublisher::Publish(const std::string& msg) {
+  if (!queue_ || !queue_->Push(msg)) {
+    dropped_++;
+    return false;
+  }
+
+  if (sleeping_) {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cond_.notify_one();
+  }
+  return true;
+}
+
+RedisPublisher::Stats RedisPublisher::GetStats() const {
+  Stats stats;
+  stats.published = published_;
+  stats.round_trips = round_trips_;
+  stats.dropped = dropped_;
+  stats.failed = failed_;
+  return stats;
+}
+
+void RedisPublisher::Work() {
+  std::vector<std::string> batch;
+  batch.reserve(max_batch_size);
+  while (true) {
+    batch.clear();
+    std::string msg;
+    while (batch.size() < max_batch_size && queue_->Pop(&msg)) {
+      batch.push_back(std::string());
+      batch.back().swap(msg);
+    }
+
+    if (!batch.empty()) {
+      common::Error err = Flush(batch);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    if (stop_) {  // queue drained
+      break;
+    }
+    sleeping_ = true;
+    wake_cond_.wait_for(lock, std::chrono::milliseconds(idle_wait_msec),
+                        [this]() { return stop_ || !queue_->IsEmpty(); });
+    sleeping_ = false;
+  }
+}
+
+common::Error RedisPublisher::Flush(const std::vector<std::string>& batch) {
+  redisContext* conn = NULL;
+  common::Error err = pool_->Acquire(&conn);
+  if (err) {
+    failed_ += batch.size();
+    return err;
+  }
+
+  const char* channel_str = channel_.c_str();
+  size_t commands = 0;
+  if (coalesce_) {  // messages are json objects
+    std::string joined = "[";
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (i != 0) {
+        joined += ",";
+      }
+      joined += batch[i];
+    }
+    joined += "]";
+    redisAppendCommand(conn, "PUBLISH %s %b", channel_str, joined.data(), joined.size());
+    commands = 1;
+  } else {
+    for (const std::string& msg : batch) {
+      redisAppendCommand(conn, "PUBLISH %s %b", channel_str, msg.data(), msg.size());
+    }
+    commands = batch.size();
+  }
+
+  for (size_t i = 0; i < commands; ++i) {
+    redisReply* reply = NULL;
+    if (redisGetReply(conn, reinterpret_cast<void**>(&reply)) != REDIS_OK || !reply) {
+      const std::string error_str = conn->errstr;
+      pool_->Release(conn, true);
+      failed_ += coalesce_ ? batch.size() : commands - i;
+      published_ += coalesce_ ? 0 : i;
+      return common::make_error("Publish to " + channel_ + " failed: " + error_str);
+    }
+    freeReplyObject(reply);
+  }
+
+  pool_->Release(conn, false);
+  published_ += batch.size();
+  round_trips_++;
+  return common::Error();
+}
+
+}  // namespace redis
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,103 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>              // for atomic
+#include <condition_variable>  // for condition_variable
+#include <memory>              // for shared_ptr, unique_ptr
+#include <mutex>               // for mutex
+#include <string>              // for string
+#include <vector>              // for vector
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN, WARN_UNUSED_RESULT
+
+#include "server/bounded_mpsc_queue.h"
+
+namespace common {
+namespace threads {
+template <typename RT>
+class Thread;
+}
+}  // namespace common
+
+namespace fastotv {
+namespace server {
+namespace redis {
+
+class RedisPool;
+
+// publishes messages to one channel from own thread, producers never blocked:
+// bounded lock-free queue, many PUBLISH pipelined per round trip or coalesced into one json array
+class RedisPublisher {
+ public:
+  enum {
+    default_queue_size = 8192,  // messages, rounded up to power of 2
+    max_batch_size = 256,       // messages per round trip
+    idle_wait_msec = 100        // max publisher sleep, if wakeup missed
+  };
+
+  struct Stats {
+    Stats();
+
+    size_t published;    // messages
+    size_t round_trips;  // batches
+    size_t dropped;      // queue overflow
+    size_t failed;       // redis errors
+  };
+
+  explicit RedisPublisher(RedisPool* pool);
+  ~RedisPublisher();
+
+  void Start(const std::string& channel, size_t queue_size, bool coalesce);
+  void Stop();  // queued messages published before stop
+
+  bool Publish(const std::string& msg) WARN_UNUSED_RESULT;  // thread-safe, false if queue overflowed
+
+  Stats GetStats() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(RedisPublisher);
+
+  void Work();
+  common::Error Flush(const std::vector<std::string>& batch) WARN_UNUSED_RESULT;
+
+  RedisPool* const pool_;
+  std::string channel_;
+  bool coalesce_;
+
+  std::unique_ptr<BoundedMPSCQueue<std::string> > queue_;
+
+  std::atomic<bool> stop_;
+  std::atomic<bool> sleeping_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cond_;
+
+  std::atomic<size_t> published_;
+  std::atomic<size_t> round_trips_;
+  std::atomic<size_t> dropped_;
+  std::atomic<size_t> failed_;
+
+  std::shared_ptr<common::threads::Thread<void> > thread_;
+};
+
+}  // namespace redis
+}  // namespace server
+}  // namespace fastotv
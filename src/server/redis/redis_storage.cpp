@@ -31,7 +31,9 @@
 #include <json-c/json_object.h>   // for json_object_put
 #include <json-c/json_tokener.h>  // for json_tokener_parse
 
-#include "server/redis/redis_connect.h"
+#include "server/channels_responce_cache.h"  // for ChannelsResponceCache
+#include "server/redis/redis_pool.h"
+#include "server/redis/users_cache.h"
 
 #define GET_USER_1E "GET %s"
 #define GET_CHAT_CHANNELS "GET chat_channels"
@@ -98,11 +100,7 @@ common::Error parse_chat_channels_json(const char* channels_json, std::vector<st
 
 namespace redis {
 
-RedisStorage::RedisStorage() : config_() {}
-
-void RedisStorage::SetConfig(const RedisConfig& config) {
-  config_ = config;
-}
+RedisStorage::RedisStorage(RedisPool* pool, UsersCache* cache) : pool_(pool), cache_(cache) {}
 
 common::Error RedisStorage::FindUserAuth(const AuthInfo& user, user_id_t* uid) const {
   UserInfo uinf;
@@ -114,17 +112,42 @@ common::Error RedisStorage::FindUser(const AuthInfo& user, user_id_t* uid, UserI
     return common::make_error_inval();
   }
 
-  redisContext* redis = NULL;
-  common::Error err = redis_connect(config_, &redis);
+  const login_t login = user.GetLogin();
+  UserInfo linfo;
+  user_id_t luid;
+  UsersCache::LookupResult cached = cache_ ? cache_->Find(login, &luid, &linfo) : UsersCache::CACHE_MISS;
+  if (cached == UsersCache::CACHE_NOT_FOUND) {
+    return common::make_error("User not found");
+  } else if (cached == UsersCache::CACHE_MISS) {
+    common::Error err = LoadUser(login, &luid, &linfo);
+    if (err) {
+      return err;
+    }
+  }
+
+  std::string pass = linfo.GetPassword();
+  if (user.GetPassword() != pass) {
+    return common::make_error("Password missmatch");
+  }
+
+  *uid = luid;
+  *uinf = linfo;
+  return common::Error();
+}
+
+common::Error RedisStorage::LoadUser(const login_t& login, user_id_t* uid, UserInfo* uinf) const {
+  const char* login_str = login.c_str();
+  redisReply* reply = NULL;
+  common::Error err = pool_->Command(&reply, GET_USER_1E, login_str);
   if (err) {
     return err;
   }
 
-  std::string login = user.GetLogin();
-  const char* login_str = login.c_str();
-  redisReply* reply = reinterpret_cast<redisReply*>(redisCommand(redis, GET_USER_1E, login_str));
-  if (!reply) {
-    redisFree(redis);
+  if (reply->type == REDIS_REPLY_NIL) {
+    freeReplyObject(reply);
+    if (cache_) {
+      cache_->InsertNotFound(login);
+    }
     return common::make_error("User not found");
   }
 
@@ -132,23 +155,24 @@ common::Error RedisStorage::FindUser(const AuthInfo& user, user_id_t* uid, UserI
   UserInfo linfo;
   user_id_t luid;
   err = parse_user_json(user_json, &luid, &linfo);
+  freeReplyObject(reply);
   if (err) {
-    freeReplyObject(reply);
-    redisFree(redis);
     return err;
   }
 
-  std::string pass = linfo.GetPassword();
-  if (user.GetPassword() != pass) {
-    freeReplyObject(reply);
-    redisFree(redis);
-    return common::make_error("Password missmatch");
+  packed_channels_t packed;  // once per load, not per get_channels request
+  err = ChannelsResponceCache::PackChannels(linfo.GetChannelInfo(), &packed);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);  // packed by each responce
+  } else {
+    linfo.SetPackedChannels(packed);
   }
 
+  if (cache_) {
+    cache_->Insert(login, luid, linfo);
+  }
   *uid = luid;
   *uinf = linfo;
-  freeReplyObject(reply);
-  redisFree(redis);
   return common::Error();
 }
 
@@ -157,30 +181,22 @@ common::Error RedisStorage::GetChatChannels(std::vector<stream_id>* channels) co
     return common::make_error_inval();
   }
 
-  redisContext* redis = NULL;
-  common::Error err = redis_connect(config_, &redis);
+  redisReply* reply = NULL;
+  common::Error err = pool_->Command(&reply, GET_CHAT_CHANNELS);
   if (err) {
     return err;
   }
 
-  redisReply* reply = reinterpret_cast<redisReply*>(redisCommand(redis, GET_CHAT_CHANNELS));
-  if (!reply) {
-    redisFree(redis);
-    return common::make_error("User not found");
-  }
-
   const char* channels_json = reply->str;
   std::vector<stream_id> lchannels;
   err = parse_chat_channels_json(channels_json, &lchannels);
   if (err) {
     freeReplyObject(reply);
-    redisFree(redis);
     return err;
   }
 
   *channels = lchannels;
   freeReplyObject(reply);
-  redisFree(redis);
   return common::Error();
 }
 
@@ -26,16 +26,16 @@
 #include "auth_info.h"
 #include "server/user_info.h"  // for user_id_t, UserInfo (ptr only)
 
-#include "server/redis/redis_config.h"
-
 namespace fastotv {
 namespace server {
 namespace redis {
 
+class RedisPool;
+class UsersCache;
+
 class RedisStorage {
  public:
-  RedisStorage();
-  void SetConfig(const RedisConfig& config);
+  RedisStorage(RedisPool* pool, UsersCache* cache);  // cache can be NULL
 
   common::Error FindUserAuth(const AuthInfo& user, user_id_t* uid) const WARN_UNUSED_RESULT;  // check password
   common::Error FindUser(const AuthInfo& user,
@@ -45,7 +45,10 @@ class RedisStorage {
   common::Error GetChatChannels(std::vector<stream_id>* channels) const;
 
  private:
-  RedisConfig config_;
+  common::Error LoadUser(const login_t& login, user_id_t* uid, UserInfo* uinf) const WARN_UNUSED_RESULT;
+
+  RedisPool* const pool_;
+  UsersCache* const cache_;
 };
 
 }  // namespace redis
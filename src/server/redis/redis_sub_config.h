@@ -30,6 +30,8 @@ struct RedisSubConfig : public RedisConfig {
   std::string channel_in;
   std::string channel_out;
   std::string channel_clients_state;
+  std::string channel_users_updates;          // logins which records changed
+  std::string channel_chat_channels_updates;  // any message - chat_channels key changed
 };
 }  // namespace redis
 }  // namespace server
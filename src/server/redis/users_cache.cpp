@@ -0,0 +1,156 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "server/redis/users_cache.h"
+
+#include <common/time.h>  // for current_mstime
+
+#define ALL_USERS "*"
+
+namespace fastotv {
+namespace server {
+namespace redis {
+
+UsersCache::Stats::Stats() : size(0), hits(0), not_found_hits(0), misses(0), evictions(0), invalidations(0) {}
+
+UsersCache::UsersCache()
+    : mutex_(), max_size_(default_max_size), ttl_msec_(default_ttl_msec), entries_(), index_(), stats_() {}
+
+void UsersCache::SetLimits(size_t max_size, common::time64_t ttl_msec) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  max_size_ = max_size;
+  ttl_msec_ = ttl_msec;
+  EvictOverflow();
+}
+
+UsersCache::LookupResult UsersCache::Find(const login_t& login, user_id_t* uid, UserInfo* uinf) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  index_t::iterator it = index_.find(login);
+  if (it == index_.end()) {
+    stats_.misses++;
+    return CACHE_MISS;
+  }
+
+  entries_t::iterator entry = it->second;
+  if (entry->expire_msec <= common::time::current_mstime()) {
+    entries_.erase(entry);
+    index_.erase(it);
+    stats_.misses++;
+    return CACHE_MISS;
+  }
+
+  entries_.splice(entries_.begin(), entries_, entry);
+  if (!entry->found) {
+    stats_.not_found_hits++;
+    return CACHE_NOT_FOUND;
+  }
+
+  *uid = entry->uid;
+  *uinf = entry->uinf;
+  stats_.hits++;
+  return CACHE_HIT;
+}
+
+void UsersCache::Insert(const login_t& login, const user_id_t& uid, const UserInfo& uinf) {
+  Entry entry;
+  entry.login = login;
+  entry.found = true;
+  entry.uid = uid;
+  entry.uinf = uinf;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  entry.expire_msec = common::time::current_mstime() + ttl_msec_;
+  Put(entry);
+}
+
+void UsersCache::InsertNotFound(const login_t& login) {
+  Entry entry;
+  entry.login = login;
+  entry.found = false;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  entry.expire_msec = common::time::current_mstime() + negative_ttl_msec;
+  Put(entry);
+}
+
+void UsersCache::Remove(const login_t& login) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  index_t::iterator it = index_.find(login);
+  if (it == index_.end()) {
+    return;
+  }
+
+  entries_.erase(it->second);
+  index_.erase(it);
+  stats_.invalidations++;
+}
+
+void UsersCache::Clear() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  stats_.invalidations += entries_.size();
+  entries_.clear();
+  index_.clear();
+}
+
+UsersCache::Stats UsersCache::GetStats() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.size = entries_.size();
+  return stats;
+}
+
+void UsersCache::Put(const Entry& entry) {
+  if (max_size_ == 0) {
+    return;
+  }
+
+  index_t::iterator it = index_.find(entry.login);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  entries_.push_front(entry);
+  index_[entry.login] = entries_.begin();
+  EvictOverflow();
+}
+
+void UsersCache::EvictOverflow() {
+  while (entries_.size() > max_size_) {
+    index_.erase(entries_.back().login);
+    entries_.pop_back();
+    stats_.evictions++;
+  }
+}
+
+UsersCacheInvalidator::UsersCacheInvalidator(UsersCache* cache) : cache_(cache) {}
+
+void UsersCacheInvalidator::HandleMessage(const std::string& channel, const std::string& msg) {
+  UNUSED(channel);
+  if (msg.empty() || msg == ALL_USERS) {
+    cache_->Clear();
+    return;
+  }
+
+  cache_->Remove(msg);
+}
+
+}  // namespace redis
+}  // namespace server
+}  // namespace fastotv
@@ -0,0 +1,109 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <list>           // for list
+#include <mutex>          // for mutex
+#include <string>         // for string
+#include <unordered_map>  // for unordered_map
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+#include <common/types.h>   // for time64_t
+
+#include "server/redis/redis_pub_sub_handler.h"  // for RedisSubHandler
+#include "server/user_info.h"                    // for user_id_t, UserInfo
+
+namespace fastotv {
+namespace server {
+namespace redis {
+
+// thread-safe lru cache of users records, login -> (user_id, UserInfo)
+class UsersCache {
+ public:
+  enum {
+    default_max_size = 100000,
+    default_ttl_msec = 300 * 1000,
+    negative_ttl_msec = 30 * 1000  // for unknown logins
+  };
+
+  enum LookupResult { CACHE_MISS = 0, CACHE_HIT, CACHE_NOT_FOUND };
+
+  struct Stats {
+    Stats();
+
+    size_t size;
+    size_t hits;
+    size_t not_found_hits;
+    size_t misses;
+    size_t evictions;
+    size_t invalidations;
+  };
+
+  UsersCache();
+
+  void SetLimits(size_t max_size, common::time64_t ttl_msec);  // max_size 0 - cache disabled
+
+  LookupResult Find(const login_t& login, user_id_t* uid, UserInfo* uinf);
+  void Insert(const login_t& login, const user_id_t& uid, const UserInfo& uinf);
+  void InsertNotFound(const login_t& login);
+
+  void Remove(const login_t& login);
+  void Clear();
+
+  Stats GetStats() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(UsersCache);
+
+  struct Entry {
+    login_t login;
+    bool found;
+    user_id_t uid;
+    UserInfo uinf;
+    common::time64_t expire_msec;
+  };
+  typedef std::list<Entry> entries_t;  // front - most recently used
+  typedef std::unordered_map<login_t, entries_t::iterator> index_t;
+
+  void Put(const Entry& entry);  // under lock
+  void EvictOverflow();          // under lock
+
+  mutable std::mutex mutex_;
+  size_t max_size_;
+  common::time64_t ttl_msec_;
+  entries_t entries_;
+  index_t index_;
+  Stats stats_;
+};
+
+// invalidates cache by messages from redis channel: login or '*' for all users
+class UsersCacheInvalidator : public RedisSubHandler {
+ public:
+  explicit UsersCacheInvalidator(UsersCache* cache);
+
+  virtual void HandleMessage(const std::string& channel, const std::string& msg) override;
+
+ private:
+  UsersCache* const cache_;
+};
+
+}  // namespace redis
+}  // namespace server
+}  // namespace fastotv
@@ -23,15 +23,23 @@
 #include <condition_variable>  // for cv_status, cv_status::no...
 #include <mutex>               // for mutex, unique_lock
 #include <string>              // for string
+#include <thread>              // for thread::hardware_concurrency
 
 #include <common/libev/tcp/tcp_server.h>    // for TcpServer
 #include <common/logger.h>                  // for COMPACT_LOG_FILE_CRIT
+#include <common/sprintf.h>                 // for MemSPrintf
 #include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+#include <common/time.h>                    // for current_mstime
 
-#include "inner/inner_tcp_client.h"  // for InnerTcpClient
+#include "inner/inner_server_command_seq_parser.h"  // for RequestCallback
+#include "inner/inner_tcp_client.h"                 // for InnerTcpClient
+#include "inner/sampled_log.h"                      // for SetLogCategoryPolicy
 
-#include "server/inner/inner_tcp_handler.h"  // for InnerTcpHandlerHost
+#include "server/inner/inner_external_notifier.h"  // for InnerSubHandler
+#include "server/inner/inner_tcp_acceptor.h"       // for InnerTcpAcceptor
+#include "server/inner/inner_tcp_handler.h"        // for InnerTcpHandlerHost
 #include "server/inner/inner_tcp_server.h"
+#include "server/redis/redis_pub_sub.h"  // for RedisPubSub
 
 #define BUF_SIZE 4096
 #define UNKNOWN_CLIENT_NAME "Unknown"
@@ -53,31 +61,213 @@ int exec_server(common::libev::tcp::TcpServer* server) {
 
   return server->Exec();
 }
+
+int exec_worker(common::libev::IoLoop* worker) {
+  return worker->Exec();
+}
+
+size_t workers_count(size_t configured) {
+  if (configured != 0) {
+    return configured;
+  }
+
+  unsigned int cores = std::thread::hardware_concurrency();
+  return cores == 0 ? 1 : cores;
+}
 }  // namespace
 namespace server {
+namespace {
+class ChatChannelsSubHandler : public redis::RedisSubHandler {
+ public:
+  explicit ChatChannelsSubHandler(ServerHost* host) : host_(host) {}
+
+  virtual void HandleMessage(const std::string& channel, const std::string& msg) override {
+    UNUSED(channel);
+    UNUSED(msg);
+    host_->ReloadChatChannels();  // channels list stored only in redis key
+  }
+
+ private:
+  ServerHost* const host_;
+};
+}  // namespace
 
 ServerHost::ServerHost(const Config& config)
-    : stop_(false), handler_(nullptr), server_(nullptr), rstorage_(), config_(config) {
-  handler_ = new inner::InnerTcpHandlerHost(this, config);
-  server_ = new inner::InnerTcpServer(config.server.host, handler_);
+    : stop_(false),
+      handlers_(),
+      loops_(),
+      acceptor_(nullptr),
+      server_(nullptr),
+      sub_commands_in_(nullptr),
+      sub_handler_(nullptr),
+      redis_subscribe_command_in_thread_(),
+      sub_users_updates_(nullptr),
+      users_cache_invalidator_(nullptr),
+      redis_subscribe_users_updates_thread_(),
+      sub_chat_channels_updates_(nullptr),
+      chat_channels_handler_(nullptr),
+      redis_subscribe_chat_channels_updates_thread_(),
+      connections_mutex_(),
+      connections_(),
+      watchers_mutex_(),
+      watchers_(),
+      chat_channels_(std::make_shared<const chat_channels_type>()),
+      chat_channels_reload_msec_(0),
+      redis_pool_(),
+      users_cache_(),
+      rstorage_(&redis_pool_, &users_cache_),
+      astorage_(&rstorage_),
+      channels_cache_(),
+      state_publisher_(&redis_pool_),
+      commands_out_publisher_(&redis_pool_),
+      log_sink_(),
+      metrics_(),
+      metrics_server_(&redis_pool_, [this]() { return RenderMetrics(); }),
+      config_(config) {
+  fastotv::inner::LogCategoryPolicy log_policy;
+  log_policy.sample_rate = config.server.log_sample_rate;
+  log_policy.max_per_second = config.server.log_rate_limit;
+  log_policy.max_payload_size = config.server.log_payload_size;
+  for (uint8_t i = 0; i < fastotv::inner::LOG_CATEGORY_COUNT; ++i) {
+    fastotv::inner::SetLogCategoryPolicy(static_cast<fastotv::inner::log_category_t>(i), log_policy);
+  }
+  if (config.server.log_async) {
+    log_sink_.Start(AsyncLogSink::default_queue_size);
+    fastotv::inner::SetLogSink(&log_sink_);
+  }
+
+  const size_t workers = workers_count(config.server.workers);
+  if (workers == 1) {  // accept and handle clients in one loop
+    inner::InnerTcpHandlerHost* handler = new inner::InnerTcpHandlerHost(this, config);
+    server_ = new inner::InnerTcpServer(config.server.host, handler);
+    handlers_.push_back(handler);
+    loops_.push_back(server_);
+  } else {
+    for (size_t i = 0; i < workers; ++i) {
+      inner::InnerTcpHandlerHost* handler = new inner::InnerTcpHandlerHost(this, config);
+      inner::InnerTcpWorker* worker = new inner::InnerTcpWorker(handler);
+      worker->SetName(common::MemSPrintf("inner_worker_%lu", i));
+      handlers_.push_back(handler);
+      loops_.push_back(worker);
+    }
+    acceptor_ = new inner::InnerTcpAcceptor(loops_);
+    server_ = new inner::InnerTcpServer(config.server.host, acceptor_);
+  }
   server_->SetName("inner_server");
+  for (inner::InnerTcpHandlerHost* handler : handlers_) {
+    handler->SetCommandsTimingHook(
+        [this](cmd_opcode_t opcode, uint64_t elapsed_nsec) { metrics_.RecordCommand(opcode, elapsed_nsec); });
+  }
+
+  redis_pool_.SetConfig(config.server.redis, config.server.redis_pool_size);
+  users_cache_.SetLimits(config.server.users_cache_size, config.server.users_cache_ttl * 1000);
+  channels_cache_.SetMaxSize(config.server.channels_cache_size);
+  state_publisher_.Start(config.server.redis.channel_clients_state, config.server.state_queue_size,
+                         config.server.state_coalesce);
+  commands_out_publisher_.Start(config.server.redis.channel_out, config.server.state_queue_size, false);
+  astorage_.Start(config.server.redis_pool_size);  // worker per connection
+
+  sub_handler_ = new inner::InnerSubHandler(this);
+  sub_commands_in_ = new redis::RedisPubSub(sub_handler_);
+  sub_commands_in_->SetConfig(config.server.redis);
+  redis_subscribe_command_in_thread_ = THREAD_MANAGER()->CreateThread(&redis::RedisPubSub::Listen, sub_commands_in_);
+  bool result = redis_subscribe_command_in_thread_->Start();
+  if (!result) {
+    WARNING_LOG() << "Don't started listen thread for external commands.";
+  }
 
-  rstorage_.SetConfig(config.server.redis);
+  redis::RedisSubConfig users_updates_config = config.server.redis;
+  users_updates_config.channel_in = config.server.redis.channel_users_updates;
+  users_cache_invalidator_ = new redis::UsersCacheInvalidator(&users_cache_);
+  sub_users_updates_ = new redis::RedisPubSub(users_cache_invalidator_);
+  sub_users_updates_->SetConfig(users_updates_config);
+  redis_subscribe_users_updates_thread_ =
+      THREAD_MANAGER()->CreateThread(&redis::RedisPubSub::Listen, sub_users_updates_);
+  result = redis_subscribe_users_updates_thread_->Start();
+  if (!result) {
+    WARNING_LOG() << "Don't started listen thread for users updates.";
+  }
+
+  ReloadChatChannels();
+  redis::RedisSubConfig chat_channels_updates_config = config.server.redis;
+  chat_channels_updates_config.channel_in = config.server.redis.channel_chat_channels_updates;
+  chat_channels_handler_ = new ChatChannelsSubHandler(this);
+  sub_chat_channels_updates_ = new redis::RedisPubSub(chat_channels_handler_);
+  sub_chat_channels_updates_->SetConfig(chat_channels_updates_config);
+  redis_subscribe_chat_channels_updates_thread_ =
+      THREAD_MANAGER()->CreateThread(&redis::RedisPubSub::Listen, sub_chat_channels_updates_);
+  result = redis_subscribe_chat_channels_updates_thread_->Start();
+  if (!result) {
+    WARNING_LOG() << "Don't started listen thread for chat channels updates.";
+  }
+
+  common::Error err = metrics_server_.Start(config.server.metrics_host, config.server.metrics_redis_key,
+                                            config.server.metrics_publish_interval);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+  }
 }
 
 ServerHost::~ServerHost() {
+  metrics_server_.Stop();  // renders from handlers and caches
+  astorage_.Stop();
+  state_publisher_.Stop();
+  commands_out_publisher_.Stop();
+  sub_commands_in_->Stop();
+  redis_subscribe_command_in_thread_->Join();
+  destroy(&sub_commands_in_);
+  destroy(&sub_handler_);
+  sub_users_updates_->Stop();
+  redis_subscribe_users_updates_thread_->Join();
+  destroy(&sub_users_updates_);
+  destroy(&users_cache_invalidator_);
+  sub_chat_channels_updates_->Stop();
+  redis_subscribe_chat_channels_updates_thread_->Join();
+  destroy(&sub_chat_channels_updates_);
+  destroy(&chat_channels_handler_);
+
+  if (acceptor_) {  // workers owned by ServerHost, server_ is one of them in single mode
+    for (size_t i = 0; i < loops_.size(); ++i) {
+      delete loops_[i];
+    }
+  }
   destroy(&server_);
-  destroy(&handler_);
+  destroy(&acceptor_);
+  for (size_t i = 0; i < handlers_.size(); ++i) {
+    delete handlers_[i];
+  }
+
+  fastotv::inner::SetLogSink(nullptr);  // all loggers threads stopped
+  log_sink_.Stop();
 }
 
 void ServerHost::Stop() {
   std::unique_lock<std::mutex> lock(stop_mutex_);
   stop_ = true;
   server_->Stop();
+  if (acceptor_) {
+    for (common::libev::IoLoop* worker : loops_) {
+      worker->Stop();
+    }
+  }
   stop_cond_.notify_all();
 }
 
 int ServerHost::Exec() {
+  std::vector<std::shared_ptr<common::threads::Thread<int> > > workers_threads;
+  if (acceptor_) {
+    for (common::libev::IoLoop* worker : loops_) {
+      std::shared_ptr<common::threads::Thread<int> > worker_thread =
+          THREAD_MANAGER()->CreateThread(&exec_worker, worker);
+      bool result = worker_thread->Start();
+      if (!result) {
+        NOTREACHED();
+        return EXIT_FAILURE;
+      }
+      workers_threads.push_back(worker_thread);
+    }
+  }
+
   std::shared_ptr<common::threads::Thread<int> > connection_thread =
       THREAD_MANAGER()->CreateThread(&exec_server, server_);
   bool result = connection_thread->Start();
@@ -97,7 +287,14 @@ int ServerHost::Exec() {
     }
   }
 
-  return connection_thread->JoinAndGet();
+  int res = connection_thread->JoinAndGet();
+  for (size_t i = 0; i < workers_threads.size(); ++i) {
+    int worker_res = workers_threads[i]->JoinAndGet();
+    if (worker_res != EXIT_SUCCESS) {
+      res = worker_res;
+    }
+  }
+  return res;
 }
 
 common::Error ServerHost::UnRegisterInnerConnectionByHost(common::libev::IoClient* connection) {
@@ -112,6 +309,7 @@ common::Error ServerHost::UnRegisterInnerConnectionByHost(common::libev::IoClien
     return common::make_error_inval();
   }
 
+  std::unique_lock<std::mutex> lock(connections_mutex_);
   connections_.erase(uid);
   return common::Error();
 }
@@ -126,12 +324,22 @@ common::Error ServerHost::RegisterInnerConnectionByUser(user_id_t user_id,
     return common::make_error_inval();
   }
 
-  iconnection->SetServerHostInfo(user);
-  iconnection->SetUid(user_id);
+  const device_id_t dev = user.GetDeviceID();
+  {
+    // check and insert under one lock, workers authorize same user concurrently
+    std::unique_lock<std::mutex> lock(connections_mutex_);
+    inner_connections_type::mapped_type& devices = connections_[user_id];
+    for (inner::InnerTcpClient* connected_device : devices) {
+      if (connected_device->GetServerHostInfo().GetDeviceID() == dev) {
+        return common::make_error("Double connection reject");
+      }
+    }
 
-  login_t login = user.GetLogin();
-  connections_[user_id].push_back(iconnection);
-  connection->SetName(login);
+    iconnection->SetServerHostInfo(user);
+    iconnection->SetUid(user_id);
+    devices.push_back(iconnection);
+  }
+  connection->SetName(user.GetLogin());
   return common::Error();
 }
 
@@ -147,21 +355,340 @@ common::Error ServerHost::GetChatChannels(std::vector<stream_id>* channels) cons
   return rstorage_.GetChatChannels(channels);
 }
 
-inner::InnerTcpClient* ServerHost::FindInnerConnectionByUserIDAndDeviceID(user_id_t user_id, device_id_t dev) const {
+void ServerHost::FindUserAsync(common::libev::IoLoop* loop,
+                               const AuthInfo& auth,
+                               redis::RedisAsyncStorage::find_user_cb_t cb) {
+  auto done_cb = [loop, cb](common::Error err, user_id_t uid, const UserInfo& uinf) {
+    auto loop_cb = [cb, err, uid, uinf]() { cb(err, uid, uinf); };
+    loop->ExecInLoopThread(loop_cb);
+  };
+  astorage_.FindUser(auth, done_cb);
+}
+
+bool ServerHost::IsChatChannel(stream_id sid) const {
+  std::shared_ptr<const chat_channels_type> channels = std::atomic_load(&chat_channels_);
+  return channels->find(sid) != channels->end();
+}
+
+void ServerHost::ReloadChatChannels() {
+  chat_channels_reload_msec_ = common::time::current_mstime() + chat_channels_reload_interval * 1000;
+  auto done_cb = [this](common::Error err, const std::vector<stream_id>& channels) {
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      return;
+    }
+
+    auto new_channels = std::make_shared<const chat_channels_type>(channels.begin(), channels.end());
+    std::atomic_store(&chat_channels_, new_channels);
+    INFO_LOG() << "Chat channels updated, count: " << channels.size();
+  };
+  astorage_.GetChatChannels(done_cb);
+}
+
+void ServerHost::ReloadChatChannelsIfStale() {
+  const common::time64_t now = common::time::current_mstime();
+  common::time64_t reload_msec = chat_channels_reload_msec_.load();
+  if (now < reload_msec) {
+    return;
+  }
+
+  // workers ticks at the same time, only one reloads
+  if (!chat_channels_reload_msec_.compare_exchange_strong(reload_msec, now + chat_channels_reload_interval * 1000)) {
+    return;
+  }
+
+  ReloadChatChannels();
+}
+
+inner::InnerTcpClient* ServerHost::FindInnerConnectionByUserIDAndDeviceID(common::libev::IoLoop* loop,
+                                                                          user_id_t user_id,
+                                                                          device_id_t dev) const {
+  // owner checked under lock, connection of other loop can be closed and deleted any time
+  std::unique_lock<std::mutex> lock(connections_mutex_);
   inner_connections_type::const_iterator hs = connections_.find(user_id);
   if (hs == connections_.end()) {
     return nullptr;
   }
 
-  auto devices = (*hs).second;
-  for (inner::InnerTcpClient* connected_device : devices) {
+  for (inner::InnerTcpClient* connected_device : hs->second) {
     AuthInfo uinf = connected_device->GetServerHostInfo();
     if (uinf.GetDeviceID() == dev) {
-      return connected_device;
+      return connected_device->GetServer() == loop ? connected_device : nullptr;
     }
   }
   return nullptr;
 }
 
+common::Error ServerHost::PublishToChannelOut(const std::string& msg) {
+  if (!commands_out_publisher_.Publish(msg)) {
+    return common::make_error("Commands out queue overflow");
+  }
+
+  return common::Error();
+}
+
+common::Error ServerHost::PublishStateToChannel(const std::string& msg) {
+  if (!state_publisher_.Publish(msg)) {
+    return common::make_error("Clients state queue overflow");
+  }
+
+  return common::Error();
+}
+
+redis::RedisPublisher::Stats ServerHost::GetStatePublisherStats() const {
+  return state_publisher_.GetStats();
+}
+
+AsyncLogSink::Stats ServerHost::GetLogSinkStats() const {
+  return log_sink_.GetStats();
+}
+
+ServerMetrics* ServerHost::GetMetrics() {
+  return &metrics_;
+}
+
+std::string ServerHost::RenderMetrics() const {
+  std::string out;
+  metrics_.Render(&out);
+
+  std::vector<inner::InnerTcpHandlerHost::LoopStats> loops_stats;
+  for (size_t i = 0; i < handlers_.size(); ++i) {
+    loops_stats.push_back(handlers_[i]->GetLoopStats());
+  }
+  AppendMetricHeader("worker_clients", "gauge", "Connected clients, by worker.", &out);
+  for (size_t i = 0; i < loops_stats.size(); ++i) {
+    AppendMetric("worker_clients", common::MemSPrintf("worker=\"%lu\"", i),
+                 static_cast<uint64_t>(loops_stats[i].clients), &out);
+  }
+  AppendMetricHeader("worker_pending_bytes", "gauge", "Bytes not yet written to clients, by worker.", &out);
+  for (size_t i = 0; i < loops_stats.size(); ++i) {
+    AppendMetric("worker_pending_bytes", common::MemSPrintf("worker=\"%lu\"", i),
+                 static_cast<uint64_t>(loops_stats[i].pending_bytes), &out);
+  }
+  AppendMetricHeader("worker_max_client_pending_bytes", "gauge", "Biggest client write backlog, by worker.", &out);
+  for (size_t i = 0; i < loops_stats.size(); ++i) {
+    AppendMetric("worker_max_client_pending_bytes", common::MemSPrintf("worker=\"%lu\"", i),
+                 static_cast<uint64_t>(loops_stats[i].max_pending_bytes), &out);
+  }
+  AppendMetricHeader("worker_overloaded_clients", "gauge", "Clients above write high watermark, by worker.", &out);
+  for (size_t i = 0; i < loops_stats.size(); ++i) {
+    AppendMetric("worker_overloaded_clients", common::MemSPrintf("worker=\"%lu\"", i),
+                 static_cast<uint64_t>(loops_stats[i].overloaded_clients), &out);
+  }
+  AppendMetricHeader("worker_dropped_frames", "gauge", "Frames dropped for connected slow clients, by worker.", &out);
+  for (size_t i = 0; i < loops_stats.size(); ++i) {
+    AppendMetric("worker_dropped_frames", common::MemSPrintf("worker=\"%lu\"", i),
+                 static_cast<uint64_t>(loops_stats[i].dropped_frames), &out);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(connections_mutex_);
+    AppendMetricHeader("online_users", "gauge", "Registered users with at least one device.", &out);
+    AppendMetric("online_users", std::string(), static_cast<uint64_t>(connections_.size()), &out);
+  }
+  {
+    std::unique_lock<std::mutex> lock(watchers_mutex_);
+    AppendMetricHeader("stream_watchers", "gauge", "Clients watching stream.", &out);
+    for (watchers_type::const_iterator it = watchers_.begin(); it != watchers_.end(); ++it) {
+      AppendMetric("stream_watchers", "stream=\"" + it->first + "\"", static_cast<uint64_t>(it->second), &out);
+    }
+  }
+
+  const redis::RedisPool::Stats pool = redis_pool_.GetStats();
+  AppendMetricHeader("redis_connections", "gauge", "Redis pool connections, by state.", &out);
+  AppendMetric("redis_connections", "state=\"opened\"", static_cast<uint64_t>(pool.connections), &out);
+  AppendMetric("redis_connections", "state=\"idle\"", static_cast<uint64_t>(pool.idle), &out);
+  AppendMetricHeader("redis_acquires_total", "counter", "Redis pool acquires, by result.", &out);
+  AppendMetric("redis_acquires_total", "result=\"immediate\"", static_cast<uint64_t>(pool.acquires - pool.waits),
+               &out);
+  AppendMetric("redis_acquires_total", "result=\"waited\"", static_cast<uint64_t>(pool.waits), &out);
+  AppendMetricHeader("redis_acquire_wait_seconds_total", "counter", "Time waited for free redis connection.", &out);
+  AppendMetric("redis_acquire_wait_seconds_total", std::string(), pool.total_wait_msec / 1000.0, &out);
+  AppendMetricHeader("redis_connects_total", "counter", "Redis connects, including reconnects.", &out);
+  AppendMetric("redis_connects_total", std::string(), static_cast<uint64_t>(pool.connects), &out);
+  AppendMetricHeader("redis_broken_connections_total", "counter", "Redis connections closed on errors.", &out);
+  AppendMetric("redis_broken_connections_total", std::string(), static_cast<uint64_t>(pool.broken), &out);
+  AppendMetricHeader("redis_command_duration_seconds", "histogram", "Time of redis command, including acquire.",
+                     &out);
+  AppendHistogram("redis_command_duration_seconds", std::string(), redis_pool_.GetCommandsLatency().GetSnapshot(),
+                  &out);
+
+  const redis::RedisPublisher::Stats state = state_publisher_.GetStats();
+  AppendMetricHeader("state_messages_total", "counter", "Clients state notifications, by result.", &out);
+  AppendMetric("state_messages_total", "result=\"published\"", static_cast<uint64_t>(state.published), &out);
+  AppendMetric("state_messages_total", "result=\"dropped\"", static_cast<uint64_t>(state.dropped), &out);
+  AppendMetric("state_messages_total", "result=\"failed\"", static_cast<uint64_t>(state.failed), &out);
+  AppendMetricHeader("state_round_trips_total", "counter", "Redis round trips of state publisher.", &out);
+  AppendMetric("state_round_trips_total", std::string(), static_cast<uint64_t>(state.round_trips), &out);
+
+  const redis::RedisPublisher::Stats commands_out = commands_out_publisher_.GetStats();
+  AppendMetricHeader("commands_out_messages_total", "counter", "External commands responces, by result.", &out);
+  AppendMetric("commands_out_messages_total", "result=\"published\"", static_cast<uint64_t>(commands_out.published),
+               &out);
+  AppendMetric("commands_out_messages_total", "result=\"dropped\"", static_cast<uint64_t>(commands_out.dropped),
+               &out);
+  AppendMetric("commands_out_messages_total", "result=\"failed\"", static_cast<uint64_t>(commands_out.failed), &out);
+
+  const redis::UsersCache::Stats users = users_cache_.GetStats();
+  AppendMetricHeader("users_cache_size", "gauge", "Cached users records.", &out);
+  AppendMetric("users_cache_size", std::string(), static_cast<uint64_t>(users.size), &out);
+  AppendMetricHeader("users_cache_lookups_total", "counter", "Users cache lookups, by result.", &out);
+  AppendMetric("users_cache_lookups_total", "result=\"hit\"", static_cast<uint64_t>(users.hits), &out);
+  AppendMetric("users_cache_lookups_total", "result=\"not_found_hit\"", static_cast<uint64_t>(users.not_found_hits),
+               &out);
+  AppendMetric("users_cache_lookups_total", "result=\"miss\"", static_cast<uint64_t>(users.misses), &out);
+  AppendMetricHeader("users_cache_removals_total", "counter", "Users cache removals, by reason.", &out);
+  AppendMetric("users_cache_removals_total", "reason=\"eviction\"", static_cast<uint64_t>(users.evictions), &out);
+  AppendMetric("users_cache_removals_total", "reason=\"invalidation\"", static_cast<uint64_t>(users.invalidations),
+               &out);
+
+  const ChannelsResponceCache::Stats channels = channels_cache_.GetStats();
+  AppendMetricHeader("channels_cache_size", "gauge", "Cached channels responces.", &out);
+  AppendMetric("channels_cache_size", std::string(), static_cast<uint64_t>(channels.size), &out);
+  AppendMetricHeader("channels_cache_lookups_total", "counter", "Channels responces cache lookups, by result.", &out);
+  AppendMetric("channels_cache_lookups_total", "result=\"hit\"", static_cast<uint64_t>(channels.hits), &out);
+  AppendMetric("channels_cache_lookups_total", "result=\"miss\"", static_cast<uint64_t>(channels.misses), &out);
+  AppendMetricHeader("channels_cache_evictions_total", "counter", "Channels responces evicted.", &out);
+  AppendMetric("channels_cache_evictions_total", std::string(), static_cast<uint64_t>(channels.evictions), &out);
+  AppendMetricHeader("channels_responces_total", "counter", "Channels responces sent, by kind.", &out);
+  AppendMetric("channels_responces_total", "kind=\"delta\"", static_cast<uint64_t>(channels.deltas), &out);
+  AppendMetric("channels_responces_total", "kind=\"not_modified\"", static_cast<uint64_t>(channels.not_modified),
+               &out);
+
+  const AsyncLogSink::Stats log = log_sink_.GetStats();
+  AppendMetricHeader("log_sink_messages_total", "counter", "Async log sink messages, by result.", &out);
+  AppendMetric("log_sink_messages_total", "result=\"written\"", static_cast<uint64_t>(log.written), &out);
+  AppendMetric("log_sink_messages_total", "result=\"dropped\"", static_cast<uint64_t>(log.dropped), &out);
+  return out;
+}
+
+common::libev::IoLoop* ServerHost::FindInnerConnectionLoop(user_id_t user_id, device_id_t dev) const {
+  // connections unregistered under lock before delete, so loop of found one is valid
+  std::unique_lock<std::mutex> lock(connections_mutex_);
+  inner_connections_type::const_iterator hs = connections_.find(user_id);
+  if (hs == connections_.end()) {
+    return nullptr;
+  }
+
+  for (inner::InnerTcpClient* connected_device : hs->second) {
+    AuthInfo uinf = connected_device->GetServerHostInfo();
+    if (uinf.GetDeviceID() == dev) {
+      return connected_device->GetServer();
+    }
+  }
+
+  return nullptr;
+}
+
+bool ServerHost::PostToLoop(common::libev::IoLoop* loop, std::function<void()> task) {
+  inner::InnerTcpHandlerHost* handler = FindHandlerByLoop(loop);
+  if (!handler) {
+    DNOTREACHED();
+    return false;
+  }
+
+  return handler->PostTask(loop, std::move(task));
+}
+
+void ServerHost::SubscribeRequest(common::libev::IoLoop* loop, const fastotv::inner::RequestCallback& req) {
+  inner::InnerTcpHandlerHost* handler = FindHandlerByLoop(loop);
+  if (!handler) {
+    DNOTREACHED();
+    return;
+  }
+
+  const fastotv::inner::InnerServerCommandSeqParser::tick_t timeout = config_.server.request_timeout;
+  if (loop->IsLoopThread()) {
+    handler->SubscribeRequest(req, timeout);
+    return;
+  }
+
+  // subscribed requests and wheel owned by loop thread
+  auto cb = [handler, req, timeout]() { handler->SubscribeRequest(req, timeout); };
+  loop->ExecInLoopThread(cb);
+}
+
+void ServerHost::BrodcastChatMessage(const ChatMessage& msg) {
+  serializet_t msg_ser;
+  common::Error err = msg.SerializeToString(&msg_ser);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    return;
+  }
+
+  BrodcastChatMessage(msg.GetChannelId(), msg_ser);
+}
+
+void ServerHost::BrodcastChatMessage(stream_id sid, const serializet_t& msg_ser) {
+  if (GetOnlineUserByStreamId(sid) == 0) {  // nobody watching
+    return;
+  }
+
+  // frames shared by all workers and watchers, compressed once for each kind of frames
+  const inner::InnerTcpHandlerHost::shared_frame_t frame = handlers_.front()->MakeChatMessageFrame(msg_ser);
+  for (size_t i = 0; i < loops_.size(); ++i) {
+    common::libev::IoLoop* loop = loops_[i];
+    inner::InnerTcpHandlerHost* handler = handlers_[i];
+    auto cb = [handler, sid, frame]() { handler->BrodcastChatMessage(sid, frame); };
+    loop->ExecInLoopThread(cb);
+  }
+}
+
+size_t ServerHost::GetOnlineUserByStreamId(stream_id sid) const {
+  std::unique_lock<std::mutex> lock(watchers_mutex_);
+  watchers_type::const_iterator it = watchers_.find(sid);
+  if (it == watchers_.end()) {
+    return 0;
+  }
+
+  return it->second;
+}
+
+redis::UsersCache::Stats ServerHost::GetUsersCacheStats() const {
+  return users_cache_.GetStats();
+}
+
+common::Error ServerHost::MakeChannelsResponceFrame(cmd_seq_t id,
+                                                    const UserInfo& user,
+                                                    const std::string& client_version,
+                                                    const fastotv::inner::InnerClient* client,
+                                                    fastotv::inner::InnerClient::frame_t* out) {
+  return channels_cache_.MakeResponceFrame(id, user, client_version, client, out);
+}
+
+ChannelsResponceCache::Stats ServerHost::GetChannelsResponceCacheStats() const {
+  return channels_cache_.GetStats();
+}
+
+void ServerHost::ChangeWatchingStream(stream_id prev_sid, stream_id sid) {
+  if (prev_sid == sid) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(watchers_mutex_);
+  if (prev_sid != invalid_stream_id) {
+    watchers_type::iterator it = watchers_.find(prev_sid);
+    if (it != watchers_.end()) {
+      if (--it->second == 0) {
+        watchers_.erase(it);
+      }
+    }
+  }
+
+  if (sid != invalid_stream_id) {
+    watchers_[sid]++;
+  }
+}
+
+inner::InnerTcpHandlerHost* ServerHost::FindHandlerByLoop(common::libev::IoLoop* loop) const {
+  for (size_t i = 0; i < loops_.size(); ++i) {
+    if (loops_[i] == loop) {
+      return handlers_[i];
+    }
+  }
+
+  return nullptr;
+}
+
 }  // namespace server
 }  // namespace fastotv
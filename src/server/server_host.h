@@ -18,28 +18,57 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <common/error.h>   // for Error
 #include <common/macros.h>  // for WARN_UNUSED_RESULT, DISALLOW_COPY_...
+#include <common/types.h>   // for time64_t
 
+#include "redis/redis_async_storage.h"
+#include "redis/redis_pool.h"
+#include "redis/redis_publisher.h"
 #include "redis/redis_storage.h"
+#include "redis/users_cache.h"
 
-#include "server/config.h"     // for Config
-#include "server/user_info.h"  // for user_id_t, UserInfo (ptr only)
+#include "server/channels_responce_cache.h"  // for ChannelsResponceCache
+#include "server/async_log_sink.h"           // for AsyncLogSink
+#include "server/config.h"                   // for Config
+#include "server/metrics_server.h"           // for MetricsServer
+#include "server/server_metrics.h"           // for ServerMetrics
+#include "server/user_info.h"               // for user_id_t, UserInfo (ptr only)
+
+#include "chat_message.h"
 
 namespace common {
 namespace libev {
 class IoClient;
+class IoLoop;
+}  // namespace libev
+namespace threads {
+template <typename RT>
+class Thread;
 }
 }  // namespace common
 
 namespace fastotv {
 class AuthInfo;
+namespace inner {
+class RequestCallback;
+}
 namespace server {
+namespace redis {
+class RedisPubSub;
+}
 namespace inner {
+class InnerSubHandler;
+class InnerTcpAcceptor;
 class InnerTcpClient;
 class InnerTcpHandlerHost;
 class InnerTcpServer;
@@ -47,8 +76,13 @@ class InnerTcpServer;
 
 class ServerHost {
  public:
-  enum { timeout_seconds = 1 };
+  enum {
+    timeout_seconds = 1,
+    chat_channels_reload_interval = 60  // sec, periodic reload in case updates message lost
+  };
   typedef std::unordered_map<user_id_t, std::vector<inner::InnerTcpClient*>> inner_connections_type;
+  typedef std::unordered_map<stream_id, size_t> watchers_type;
+  typedef std::unordered_set<stream_id> chat_channels_type;
 
   explicit ServerHost(const Config& config);
   ~ServerHost();
@@ -57,6 +91,7 @@ class ServerHost {
   int Exec();
 
   common::Error UnRegisterInnerConnectionByHost(common::libev::IoClient* connection) WARN_UNUSED_RESULT;
+  // thread-safe, error if same user already connected from same device
   common::Error RegisterInnerConnectionByUser(user_id_t user_id,
                                               const AuthInfo& user,
                                               common::libev::IoClient* connection) WARN_UNUSED_RESULT;
@@ -65,19 +100,83 @@ class ServerHost {
 
   common::Error GetChatChannels(std::vector<stream_id>* channels) const WARN_UNUSED_RESULT;
 
-  inner::InnerTcpClient* FindInnerConnectionByUserIDAndDeviceID(user_id_t user_id, device_id_t dev) const;
+  // thread-safe, not blocks caller, cb called in loop thread
+  void FindUserAsync(common::libev::IoLoop* loop,
+                     const AuthInfo& auth,
+                     redis::RedisAsyncStorage::find_user_cb_t cb);
+
+  // thread-safe, connection owned by loop or nullptr, should be called and used only in this loop
+  inner::InnerTcpClient* FindInnerConnectionByUserIDAndDeviceID(common::libev::IoLoop* loop,
+                                                                user_id_t user_id,
+                                                                device_id_t dev) const;
+  // thread-safe, loop which owns connection or nullptr, connection itself can be used only in this loop
+  common::libev::IoLoop* FindInnerConnectionLoop(user_id_t user_id, device_id_t dev) const;
+  // thread-safe, not blocks, false if loop tasks queue full
+  bool PostToLoop(common::libev::IoLoop* loop, std::function<void()> task) WARN_UNUSED_RESULT;
+
+  // thread-safe, can be called from any worker loop
+  common::Error PublishToChannelOut(const std::string& msg) WARN_UNUSED_RESULT;  // queued, not blocks
+  common::Error PublishStateToChannel(const std::string& msg) WARN_UNUSED_RESULT;  // queued, not blocks
+  redis::RedisPublisher::Stats GetStatePublisherStats() const;
+  AsyncLogSink::Stats GetLogSinkStats() const;
+  ServerMetrics* GetMetrics();      // thread-safe, latencies recorded by loops
+  std::string RenderMetrics() const;  // thread-safe, prometheus text format
+  // thread-safe, subscribed in loop thread which owns connection, timeout from config
+  void SubscribeRequest(common::libev::IoLoop* loop, const fastotv::inner::RequestCallback& req);
+  void BrodcastChatMessage(const ChatMessage& msg);  // to watchers of all workers
+  void BrodcastChatMessage(stream_id sid, const serializet_t& msg_ser);  // already serialized message
+  size_t GetOnlineUserByStreamId(stream_id sid) const;
+  redis::UsersCache::Stats GetUsersCacheStats() const;
+  common::Error MakeChannelsResponceFrame(cmd_seq_t id,
+                                          const UserInfo& user,
+                                          const std::string& client_version,
+                                          const fastotv::inner::InnerClient* client,
+                                          fastotv::inner::InnerClient::frame_t* out) WARN_UNUSED_RESULT;
+  ChannelsResponceCache::Stats GetChannelsResponceCacheStats() const;
+  void ChangeWatchingStream(stream_id prev_sid, stream_id sid);
+  bool IsChatChannel(stream_id sid) const;  // not blocks, set replaced as a whole by ReloadChatChannels
+  void ReloadChatChannels();                // not blocks caller, called on chat channels updates
+  void ReloadChatChannelsIfStale();         // thread-safe, workers requests ticks, not reloaded for interval
 
  private:
   DISALLOW_COPY_AND_ASSIGN(ServerHost);
+  inner::InnerTcpHandlerHost* FindHandlerByLoop(common::libev::IoLoop* loop) const;
+
   std::mutex stop_mutex_;
   std::condition_variable stop_cond_;
   bool stop_;
 
-  inner::InnerTcpHandlerHost* handler_;
+  std::vector<inner::InnerTcpHandlerHost*> handlers_;
+  std::vector<common::libev::IoLoop*> loops_;  // loops_[i] observed by handlers_[i]
+  inner::InnerTcpAcceptor* acceptor_;          // only in multi worker mode
   inner::InnerTcpServer* server_;
 
+  redis::RedisPubSub* sub_commands_in_;
+  inner::InnerSubHandler* sub_handler_;
+  std::shared_ptr<common::threads::Thread<void> > redis_subscribe_command_in_thread_;
+  redis::RedisPubSub* sub_users_updates_;
+  redis::UsersCacheInvalidator* users_cache_invalidator_;
+  std::shared_ptr<common::threads::Thread<void> > redis_subscribe_users_updates_thread_;
+  redis::RedisPubSub* sub_chat_channels_updates_;
+  redis::RedisSubHandler* chat_channels_handler_;
+  std::shared_ptr<common::threads::Thread<void> > redis_subscribe_chat_channels_updates_thread_;
+
+  mutable std::mutex connections_mutex_;
   inner_connections_type connections_;
+  mutable std::mutex watchers_mutex_;
+  watchers_type watchers_;
+  std::shared_ptr<const chat_channels_type> chat_channels_;  // std::atomic_load/atomic_store only
+  std::atomic<common::time64_t> chat_channels_reload_msec_;   // next periodic reload
+  redis::RedisPool redis_pool_;  // shared by storage and publisher
+  redis::UsersCache users_cache_;  // login -> user record, invalidated by users updates channel
   redis::RedisStorage rstorage_;
+  redis::RedisAsyncStorage astorage_;
+  ChannelsResponceCache channels_cache_;  // shared by all workers
+  redis::RedisPublisher state_publisher_;  // users connect/disconnect notifications
+  redis::RedisPublisher commands_out_publisher_;  // external commands responces, loops never wait for pool
+  AsyncLogSink log_sink_;                  // hot path messages, if log_async
+  ServerMetrics metrics_;
+  MetricsServer metrics_server_;  // admin port and redis publish of RenderMetrics
   const Config config_;
 };
 
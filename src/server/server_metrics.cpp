@@ -0,0 +1,218 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/server_metrics.h"
+
+#include <inttypes.h>  // for PRIu64
+#include <stdio.h>     // for snprintf
+
+#include <utility>  // for move
+#include <vector>   // for vector
+
+#include "inner/frame_codec.h"  // for GetFrameCodecStats
+#include "inner/sampled_log.h"  // for GetLogCategoryStats
+
+namespace fastotv {
+namespace server {
+namespace {
+
+const uint64_t histogram_bounds_usec[] = {100,    250,    500,     1000,    2500,    5000,    10000,   25000,
+                                          50000,  100000, 250000,  500000,  1000000, 2500000, 5000000, 10000000};
+const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+void AppendLabels(const std::string& labels, const char* extra, std::string* out) {
+  if (labels.empty() && !extra) {
+    return;
+  }
+
+  out->push_back('{');
+  out->append(labels);
+  if (extra) {
+    if (!labels.empty()) {
+      out->push_back(',');
+    }
+    out->append(extra);
+  }
+  out->push_back('}');
+}
+
+void AppendSample(const char* name,
+                  const char* suffix,
+                  const std::string& labels,
+                  const char* extra,
+                  const char* value,
+                  std::string* out) {
+  out->append(METRICS_PREFIX);
+  out->append(name);
+  out->append(suffix);
+  AppendLabels(labels, extra, out);
+  out->push_back(' ');
+  out->append(value);
+  out->push_back('\n');
+}
+
+std::string UsecToSeconds(uint64_t usec) {
+  char buff[32];
+  snprintf(buff, sizeof(buff), "%.6f", usec / 1000000.0);
+  return buff;
+}
+
+std::string ToString(uint64_t value) {
+  char buff[32];
+  snprintf(buff, sizeof(buff), "%" PRIu64, value);
+  return buff;
+}
+
+}  // namespace
+
+void AppendMetricHeader(const char* name, const char* type, const char* help, std::string* out) {
+  out->append("# HELP " METRICS_PREFIX);
+  out->append(name);
+  out->push_back(' ');
+  out->append(help);
+  out->append("\n# TYPE " METRICS_PREFIX);
+  out->append(name);
+  out->push_back(' ');
+  out->append(type);
+  out->push_back('\n');
+}
+
+void AppendMetric(const char* name, const std::string& labels, uint64_t value, std::string* out) {
+  AppendSample(name, "", labels, nullptr, ToString(value).c_str(), out);
+}
+
+void AppendMetric(const char* name, const std::string& labels, double value, std::string* out) {
+  char buff[32];
+  snprintf(buff, sizeof(buff), "%.6f", value);
+  AppendSample(name, "", labels, nullptr, buff, out);
+}
+
+void AppendHistogram(const char* name,
+                     const std::string& labels,
+                     const LatencyHistogram::Snapshot& hist,
+                     std::string* out) {
+  for (size_t i = 0; i < SIZEOFMASS(histogram_bounds_usec); ++i) {
+    const std::string le = "le=\"" + UsecToSeconds(histogram_bounds_usec[i]) + "\"";
+    const std::string count = ToString(hist.CountAtOrBelow(histogram_bounds_usec[i]));
+    AppendSample(name, "_bucket", labels, le.c_str(), count.c_str(), out);
+  }
+  AppendSample(name, "_bucket", labels, "le=\"+Inf\"", ToString(hist.count).c_str(), out);
+  AppendSample(name, "_sum", labels, nullptr, UsecToSeconds(hist.sum_usec).c_str(), out);
+  AppendSample(name, "_count", labels, nullptr, ToString(hist.count).c_str(), out);
+}
+
+ServerMetrics::ServerMetrics() : commands_(), auth_(), chat_fanout_(), channels_responce_() {}
+
+void ServerMetrics::RecordCommand(cmd_opcode_t opcode, uint64_t elapsed_nsec) {
+  if (opcode >= OPCODE_COUNT) {
+    DNOTREACHED();
+    return;
+  }
+
+  commands_[opcode].RecordNsec(elapsed_nsec);
+}
+
+LatencyHistogram* ServerMetrics::GetAuthLatency() {
+  return &auth_;
+}
+
+LatencyHistogram* ServerMetrics::GetChatFanoutLatency() {
+  return &chat_fanout_;
+}
+
+LatencyHistogram* ServerMetrics::GetChannelsResponceLatency() {
+  return &channels_responce_;
+}
+
+void ServerMetrics::Render(std::string* out) const {
+  AppendMetricHeader("command_duration_seconds", "histogram", "Time of handling one client command, till answered.",
+                     out);
+  std::vector<LatencyHistogram::Snapshot> commands;  // not called commands skipped
+  std::vector<std::string> commands_labels;
+  for (uint8_t i = 0; i < OPCODE_COUNT; ++i) {
+    const cmd_opcode_t opcode = static_cast<cmd_opcode_t>(i);
+    const char* command = OpcodeToCommand(opcode);
+    LatencyHistogram::Snapshot hist = commands_[opcode].GetSnapshot();
+    if (!command || hist.count == 0) {
+      continue;
+    }
+
+    const std::string labels = std::string("command=\"") + command + "\"";
+    AppendHistogram("command_duration_seconds", labels, hist, out);
+    commands.push_back(std::move(hist));
+    commands_labels.push_back(labels);
+  }
+
+  AppendMetricHeader("command_duration_quantile_seconds", "gauge",
+                     "Quantiles of command_duration_seconds, precision 12.5%.", out);
+  for (size_t i = 0; i < commands.size(); ++i) {
+    for (double quantile : quantiles) {
+      char extra[32];
+      snprintf(extra, sizeof(extra), "quantile=\"%g\"", quantile);
+      AppendSample("command_duration_quantile_seconds", "", commands_labels[i], extra,
+                   UsecToSeconds(commands[i].ValueAtQuantile(quantile)).c_str(), out);
+    }
+  }
+
+  AppendMetricHeader("auth_duration_seconds", "histogram", "Time from who_are_you answer to user lookup finished.",
+                     out);
+  AppendHistogram("auth_duration_seconds", std::string(), auth_.GetSnapshot(), out);
+  AppendMetricHeader("chat_fanout_duration_seconds", "histogram",
+                     "Time of writing one chat message to watchers of one worker.", out);
+  AppendHistogram("chat_fanout_duration_seconds", std::string(), chat_fanout_.GetSnapshot(), out);
+  AppendMetricHeader("channels_responce_duration_seconds", "histogram",
+                     "Time of making one get_channels responce frame.", out);
+  AppendHistogram("channels_responce_duration_seconds", std::string(), channels_responce_.GetSnapshot(), out);
+
+  fastotv::inner::FrameCodecStats codecs_stats[fastotv::inner::FRAME_CODEC_COUNT];
+  std::string codecs_labels[fastotv::inner::FRAME_CODEC_COUNT];
+  for (uint8_t i = 0; i < fastotv::inner::FRAME_CODEC_COUNT; ++i) {
+    const fastotv::inner::frame_codec_t codec = static_cast<fastotv::inner::frame_codec_t>(i);
+    codecs_stats[i] = fastotv::inner::GetFrameCodecStats(codec);
+    codecs_labels[i] = std::string("codec=\"") + fastotv::inner::FrameCodecToString(codec) + "\"";
+  }
+
+  AppendMetricHeader("frames_total", "counter", "Frames encoded and decoded, by codec.", out);
+  for (uint8_t i = 0; i < fastotv::inner::FRAME_CODEC_COUNT; ++i) {
+    AppendMetric("frames_total", codecs_labels[i] + ",direction=\"out\"", codecs_stats[i].encoded_frames, out);
+    AppendMetric("frames_total", codecs_labels[i] + ",direction=\"in\"", codecs_stats[i].decoded_frames, out);
+  }
+  AppendMetricHeader("frame_bytes_total", "counter", "Frames bytes before and after codec, by codec.", out);
+  for (uint8_t i = 0; i < fastotv::inner::FRAME_CODEC_COUNT; ++i) {
+    const std::string& codec_label = codecs_labels[i];
+    const fastotv::inner::FrameCodecStats& stats = codecs_stats[i];
+    AppendMetric("frame_bytes_total", codec_label + ",direction=\"out\",stage=\"raw\"", stats.encoded_raw_bytes, out);
+    AppendMetric("frame_bytes_total", codec_label + ",direction=\"out\",stage=\"wire\"", stats.encoded_bytes, out);
+    AppendMetric("frame_bytes_total", codec_label + ",direction=\"in\",stage=\"raw\"", stats.decoded_raw_bytes, out);
+    AppendMetric("frame_bytes_total", codec_label + ",direction=\"in\",stage=\"wire\"", stats.decoded_bytes, out);
+  }
+
+  AppendMetricHeader("log_messages_total", "counter", "Hot path log messages, by category and result.", out);
+  for (uint8_t i = 0; i < fastotv::inner::LOG_CATEGORY_COUNT; ++i) {
+    const fastotv::inner::log_category_t category = static_cast<fastotv::inner::log_category_t>(i);
+    const fastotv::inner::LogCategoryStats stats = fastotv::inner::GetLogCategoryStats(category);
+    const std::string category_label =
+        std::string("category=\"") + fastotv::inner::LogCategoryToString(category) + "\"";
+    AppendMetric("log_messages_total", category_label + ",result=\"logged\"", stats.logged, out);
+    AppendMetric("log_messages_total", category_label + ",result=\"sampled_out\"", stats.sampled_out, out);
+    AppendMetric("log_messages_total", category_label + ",result=\"rate_limited\"", stats.rate_limited, out);
+  }
+}
+
+}  // namespace server
+}  // namespace fastotv
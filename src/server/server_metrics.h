@@ -0,0 +1,68 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>  // for uint64_t
+
+#include <string>  // for string
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "commands/commands.h"  // for cmd_opcode_t
+
+#include "server/latency_histogram.h"
+
+#define METRICS_PREFIX "fastotv_server_"
+
+namespace fastotv {
+namespace server {
+
+// prometheus text format 0.0.4 helpers, name without METRICS_PREFIX, labels like: command="ping"
+void AppendMetricHeader(const char* name, const char* type, const char* help, std::string* out);
+void AppendMetric(const char* name, const std::string& labels, uint64_t value, std::string* out);
+void AppendMetric(const char* name, const std::string& labels, double value, std::string* out);
+void AppendHistogram(const char* name,
+                     const std::string& labels,
+                     const LatencyHistogram::Snapshot& hist,
+                     std::string* out);
+
+// process wide latencies, recorded from any loop thread
+class ServerMetrics {
+ public:
+  ServerMetrics();
+
+  void RecordCommand(cmd_opcode_t opcode, uint64_t elapsed_nsec);  // handled client request or responce
+  LatencyHistogram* GetAuthLatency();              // who_are_you responce received - user lookup finished
+  LatencyHistogram* GetChatFanoutLatency();        // one chat message written to watchers of one loop
+  LatencyHistogram* GetChannelsResponceLatency();  // get_channels responce frame made: cache, serialize, compress
+
+  // histograms and counters of frames codecs and hot path logging
+  void Render(std::string* out) const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ServerMetrics);
+
+  LatencyHistogram commands_[OPCODE_COUNT];
+  LatencyHistogram auth_;
+  LatencyHistogram chat_fanout_;
+  LatencyHistogram channels_responce_;
+};
+
+}  // namespace server
+}  // namespace fastotv
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <memory>  // for shared_ptr
 #include <string>  // for string
 
 #include <common/error.h>   // for Error
@@ -25,14 +26,22 @@
 
 #include "channels_info.h"  // for ChannelsInfo
 
-#include "serializer/json_serializer.h"
+#include "serializer/fields_serializer.h"
 
 namespace fastotv {
 namespace server {
 
 typedef std::string user_id_t;  // mongodb/redis id
 
-class UserInfo : public JsonSerializer<UserInfo> {
+struct PackedChannels {  // binary channels and hash of it, version of get_channels responce
+  PackedChannels();
+
+  std::string packed;  // ChannelsInfo::SerializeToBinary
+  uint64_t hash;
+};
+typedef std::shared_ptr<const PackedChannels> packed_channels_t;
+
+class UserInfo : public FieldsSerializer<UserInfo> {
  public:
   typedef std::vector<device_id_t> devices_t;
 
@@ -44,24 +53,27 @@ class UserInfo : public JsonSerializer<UserInfo> {
 
   bool IsValid() const;
 
-  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
-
   bool HaveDevice(device_id_t dev) const;
   devices_t GetDevices() const;
   login_t GetLogin() const;
   std::string GetPassword() const;
   ChannelsInfo GetChannelInfo() const;
+  // packed once when user loaded and shared by copies, nullptr if not packed
+  void SetPackedChannels(packed_channels_t packed);
+  packed_channels_t GetPackedChannels() const;
 
   bool Equals(const UserInfo& inf) const;
 
- protected:
-  virtual common::Error SerializeImpl(serialize_type* deserialized) const override;
-
  private:
+  friend struct serializer::FieldsAccess;
+  template <typename Self, typename Visitor>
+  static void Fields(Self* self, Visitor* visitor);
+
   login_t login_;  // unique
   std::string password_;
   ChannelsInfo ch_;
   devices_t devices_;
+  packed_channels_t packed_ch_;  // not serialized
 };
 
 inline bool operator==(const UserInfo& lhs, const UserInfo& rhs) {
@@ -0,0 +1,150 @@
+#include <inttypes.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <common/sprintf.h>
+
+#include "commands/commands.h"
+
+extern "C" {
+#include "third-party/sds/sds.h"
+}
+
+using namespace fastotv;
+
+namespace {
+
+const cmd_seq_t seq_id = "00000000000000ff";
+
+const std::string& ChatMessageArg() {
+  static const std::string chat_message =
+      "{\"channel\": \"59106ed4e4b0fa8ef4d6e3b7\", \"login\": \"atopilski@gmail.com\", "
+      "\"message\": \"Hello world\", \"type\": 0}";
+  return chat_message;
+}
+
+const std::string& ChatMessageLine() {  // command without type and id, as dispatched
+  static const std::string line = SUCCESS_COMMAND " " CLIENT_SEND_CHAT_MESSAGE " '" + ChatMessageArg() + "'";
+  return line;
+}
+
+// previous path, format parsed by printf on every command
+void BM_MemSPrintf(benchmark::State& state) {
+  const std::string& arg = ChatMessageArg();
+  for (auto _ : state) {
+    std::string cmd = common::MemSPrintf("%" PRIu8 " %s " SUCCESS_COMMAND " " CLIENT_SEND_CHAT_MESSAGE
+                                         " '%s'" END_OF_COMMAND,
+                                         RESPONCE_COMMAND, seq_id, arg);
+    benchmark::DoNotOptimize(cmd);
+  }
+}
+BENCHMARK(BM_MemSPrintf);
+
+void BM_MakeRequest_GetCmd(benchmark::State& state) {
+  for (auto _ : state) {
+    cmd_request_t req = MakeRequest(seq_id, OPCODE_SERVER_PING);
+    benchmark::DoNotOptimize(req.GetCmd());
+  }
+}
+BENCHMARK(BM_MakeRequest_GetCmd);
+
+void BM_MakeResponce_GetCmd(benchmark::State& state) {
+  const std::string& arg = ChatMessageArg();
+  for (auto _ : state) {
+    cmd_responce_t resp = MakeResponce(seq_id, STATE_SUCCESS, OPCODE_CLIENT_SEND_CHAT_MESSAGE, arg);
+    benchmark::DoNotOptimize(resp.GetCmd());
+  }
+  state.SetBytesProcessed(state.iterations() * ChatMessageArg().size());
+}
+BENCHMARK(BM_MakeResponce_GetCmd);
+
+void BM_WriteTextCommand(benchmark::State& state) {
+  const cmd_args_t args = MakeCommandArgs(ChatMessageArg());
+  std::string buffer;
+  for (auto _ : state) {
+    WriteTextCommand(RESPONCE_COMMAND, seq_id, OPCODE_CLIENT_SEND_CHAT_MESSAGE, STATE_SUCCESS, args, &buffer);
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(state.iterations() * ChatMessageArg().size());
+}
+BENCHMARK(BM_WriteTextCommand);
+
+void BM_MakeBinaryCommand(benchmark::State& state) {
+  const cmd_args_t args = MakeCommandArgs(ChatMessageArg());
+  std::string buffer;
+  for (auto _ : state) {
+    common::Error err =
+        MakeBinaryCommand(RESPONCE_COMMAND, seq_id, OPCODE_CLIENT_SEND_CHAT_MESSAGE, STATE_SUCCESS, args, &buffer);
+    benchmark::DoNotOptimize(err);
+  }
+  state.SetBytesProcessed(state.iterations() * ChatMessageArg().size());
+}
+BENCHMARK(BM_MakeBinaryCommand);
+
+void BM_ParseCommand(benchmark::State& state) {
+  const cmd_args_t args = MakeCommandArgs(ChatMessageArg());
+  const std::string command =
+      MakeTextCommand(RESPONCE_COMMAND, seq_id, OPCODE_CLIENT_SEND_CHAT_MESSAGE, STATE_SUCCESS, args);
+  cmd_id_t cmd_id;
+  cmd_seq_t id;
+  common::StringPiece cmd_str(nullptr, 0);
+  for (auto _ : state) {
+    common::Error err = ParseCommand(command, &cmd_id, &id, &cmd_str);
+    benchmark::DoNotOptimize(err);
+    benchmark::DoNotOptimize(cmd_str.data());
+  }
+  state.SetBytesProcessed(state.iterations() * command.size());
+}
+BENCHMARK(BM_ParseCommand);
+
+void BM_ParseBinaryCommand(benchmark::State& state) {
+  const cmd_args_t args = MakeCommandArgs(ChatMessageArg());
+  std::string command;
+  common::Error err =
+      MakeBinaryCommand(RESPONCE_COMMAND, seq_id, OPCODE_CLIENT_SEND_CHAT_MESSAGE, STATE_SUCCESS, args, &command);
+  if (err) {
+    state.SkipWithError("binary command not made");
+    return;
+  }
+
+  cmd_id_t cmd_id;
+  cmd_seq_t id;
+  std::string args_buffer;
+  std::vector<common::StringPiece> argv;
+  for (auto _ : state) {
+    err = ParseBinaryCommand(command, &cmd_id, &id, &args_buffer, &argv);
+    benchmark::DoNotOptimize(err);
+  }
+  state.SetBytesProcessed(state.iterations() * command.size());
+}
+BENCHMARK(BM_ParseBinaryCommand);
+
+void BM_sdssplitargslong(benchmark::State& state) {
+  const std::string& line = ChatMessageLine();
+  for (auto _ : state) {
+    int argc;
+    sds* argv = sdssplitargslong(line.c_str(), &argc);
+    benchmark::DoNotOptimize(argv);
+    sdsfreesplitres(argv, argc);
+  }
+  state.SetBytesProcessed(state.iterations() * line.size());
+}
+BENCHMARK(BM_sdssplitargslong);
+
+void BM_SplitCommandArgs(benchmark::State& state) {
+  const std::string& line = ChatMessageLine();
+  std::string args_buffer;
+  std::vector<common::StringPiece> argv;
+  for (auto _ : state) {
+    common::Error err = SplitCommandArgs(line.data(), line.size(), &args_buffer, &argv);
+    benchmark::DoNotOptimize(err);
+  }
+  state.SetBytesProcessed(state.iterations() * line.size());
+}
+BENCHMARK(BM_SplitCommandArgs);
+
+}  // namespace
@@ -0,0 +1,143 @@
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "inner/frame_codec.h"
+#include "inner/inner_client.h"
+#include "inner/inner_server_command_seq_parser.h"
+
+using namespace fastotv;
+
+namespace {
+
+const cmd_seq_t seq_id = "00000000000000ff";
+
+class RequestsParser : public inner::InnerServerCommandSeqParser {
+ public:
+  using inner::InnerServerCommandSeqParser::NextRequestID;
+
+ private:
+  void HandleInnerRequestCommand(inner::InnerClient*, cmd_seq_t, const CommandArgsView&) override {}
+  void HandleInnerResponceCommand(inner::InnerClient*, cmd_seq_t, const CommandArgsView&) override {}
+  void HandleInnerApproveCommand(inner::InnerClient*, cmd_seq_t, const CommandArgsView&) override {}
+};
+
+// json like payload of given size, compressible as real channels and chat messages
+std::string MakePayload(size_t size) {
+  static const std::string chunk =
+      "{\"channel\": \"59106ed4e4b0fa8ef4d6e3b7\", \"login\": \"atopilski@gmail.com\", "
+      "\"message\": \"Hello world\", \"type\": 0}, ";
+  std::string result;
+  while (result.size() < size) {
+    result += chunk;
+  }
+  result.resize(size);
+  return result;
+}
+
+void PayloadArgs(benchmark::internal::Benchmark* bench) {
+  bench->Arg(128)->Arg(4 * 1024)->Arg(256 * 1024);
+}
+
+void BM_NextRequestID(benchmark::State& state) {
+  RequestsParser parser;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parser.NextRequestID());
+  }
+}
+BENCHMARK(BM_NextRequestID);
+
+// legacy snappy frame of one request, as written until codec negotiated
+void BM_InnerClient_MakeFrame(benchmark::State& state) {
+  const cmd_request_t request = MakeRequest(seq_id, OPCODE_SERVER_SEND_CHAT_MESSAGE, MakePayload(state.range(0)));
+  request.GetCmd();  // text made once, as for broadcast
+  for (auto _ : state) {
+    inner::InnerClient::frame_t frame;
+    common::Error err = inner::InnerClient::MakeFrame(inner::FrameKind(), request.GetCmd(), &frame);
+    if (err) {
+      state.SkipWithError("frame not made");
+      return;
+    }
+    benchmark::DoNotOptimize(frame);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_InnerClient_MakeFrame)->Apply(PayloadArgs);
+
+// per client frame of broadcast: tail compressed once, only head spliced
+void BM_InnerClient_MakeFrameWithTail(benchmark::State& state) {
+  const std::string tail = MakePayload(state.range(0));
+  inner::InnerClient::frame_t encoded_tail;
+  common::Error err = inner::InnerClient::EncodeTail(inner::FrameKind(), tail, &encoded_tail);
+  if (err) {
+    state.SkipWithError("tail not compressed");
+    return;
+  }
+
+  std::string head;
+  WriteTextCommandHead(REQUEST_COMMAND, seq_id, &head);
+  for (auto _ : state) {
+    inner::InnerClient::frame_t frame;
+    err = inner::InnerClient::MakeFrame(inner::FrameKind(), head, tail, encoded_tail, &frame);
+    if (err) {
+      state.SkipWithError("frame not made");
+      return;
+    }
+    benchmark::DoNotOptimize(frame);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_InnerClient_MakeFrameWithTail)->Apply(PayloadArgs);
+
+void EncodeFrame(benchmark::State& state, inner::frame_codec_t codec) {
+  if (!inner::IsFrameCodecSupported(codec)) {
+    state.SkipWithError("codec not built");
+    return;
+  }
+
+  const std::string payload = MakePayload(state.range(0));
+  std::string encoded;
+  for (auto _ : state) {
+    common::Error err = inner::EncodeFramePayload(codec, payload, &encoded);
+    if (err) {
+      state.SkipWithError("not encoded");
+      return;
+    }
+    benchmark::DoNotOptimize(encoded.data());
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+  state.counters["ratio"] = static_cast<double>(payload.size()) / encoded.size();
+}
+
+void DecodeFrame(benchmark::State& state, inner::frame_codec_t codec) {
+  if (!inner::IsFrameCodecSupported(codec)) {
+    state.SkipWithError("codec not built");
+    return;
+  }
+
+  const std::string payload = MakePayload(state.range(0));
+  std::string encoded;
+  common::Error err = inner::EncodeFramePayload(codec, payload, &encoded);
+  if (err) {
+    state.SkipWithError("not encoded");
+    return;
+  }
+
+  std::string decoded;
+  for (auto _ : state) {
+    err = inner::DecodeFramePayload(codec, encoded, inner::InnerClient::default_max_frame_size, &decoded);
+    if (err) {
+      state.SkipWithError("not decoded");
+      return;
+    }
+    benchmark::DoNotOptimize(decoded.data());
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+BENCHMARK_CAPTURE(EncodeFrame, snappy, inner::FRAME_CODEC_SNAPPY)->Apply(PayloadArgs);
+BENCHMARK_CAPTURE(DecodeFrame, snappy, inner::FRAME_CODEC_SNAPPY)->Apply(PayloadArgs);
+BENCHMARK_CAPTURE(EncodeFrame, zstd, inner::FRAME_CODEC_ZSTD)->Apply(PayloadArgs);
+BENCHMARK_CAPTURE(DecodeFrame, zstd, inner::FRAME_CODEC_ZSTD)->Apply(PayloadArgs);
+
+}  // namespace
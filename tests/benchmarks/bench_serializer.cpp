@@ -0,0 +1,209 @@
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <common/convert2string.h>
+
+#include "channels_info.h"
+#include "chat_message.h"
+
+#include "server/user_info.h"
+
+using namespace fastotv;
+
+namespace {
+
+const timestamp_t programme_duration_msec = 30 * 60 * 1000;
+
+ProgrammeInfo MakeProgramme(const stream_id& sid, size_t index) {
+  const timestamp_t start = 1505462400000 + static_cast<timestamp_t>(index) * programme_duration_msec;
+  return ProgrammeInfo(sid, start, start + programme_duration_msec,
+                       "Programme " + common::ConvertToString(index) + " of channel " + sid);
+}
+
+EpgInfo MakeEpg(size_t index, size_t programmes) {
+  const stream_id sid = "59106ed4e4b0fa8ef4d6" + common::ConvertToString(1000 + index);
+  const common::uri::Url url("http://localhost:8080/hls/" + sid + "/play.m3u8");
+  EpgInfo epg(sid, url, "Channel " + common::ConvertToString(index));
+  EpgInfo::programs_t progs;
+  for (size_t i = 0; i < programmes; ++i) {
+    progs.push_back(MakeProgramme(sid, i));
+  }
+  epg.SetPrograms(progs);
+  return epg;
+}
+
+ChannelsInfo MakeChannels(size_t channels, size_t programmes) {
+  ChannelsInfo result;
+  for (size_t i = 0; i < channels; ++i) {
+    result.AddChannel(ChannelInfo(MakeEpg(i, programmes), true, true));
+  }
+  return result;
+}
+
+ChatMessage MakeChatMessage() {
+  return ChatMessage("59106ed4e4b0fa8ef4d6e3b7", "atopilski@gmail.com", "Hello world", ChatMessage::MESSAGE);
+}
+
+server::UserInfo MakeUser(size_t channels, size_t programmes) {
+  return server::UserInfo("atopilski@gmail.com", "2ae66f90b7788ab8950e8f81b829c947",
+                          MakeChannels(channels, programmes), {"5971d32fc976287338c015c0"});
+}
+
+template <typename T>
+void SerializeToString(benchmark::State& state, const T& obj) {
+  size_t size = 0;
+  for (auto _ : state) {
+    std::string data;
+    common::Error err = obj.SerializeToString(&data);
+    if (err) {
+      state.SkipWithError("not serialized");
+      return;
+    }
+    size = data.size();
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void DeSerializeFromString(benchmark::State& state, const T& obj) {
+  std::string data;
+  common::Error err = obj.SerializeToString(&data);
+  if (err) {
+    state.SkipWithError("not serialized");
+    return;
+  }
+
+  for (auto _ : state) {
+    typename T::serialize_type serialized = NULL;
+    err = obj.SerializeFromString(data, &serialized);
+    if (err) {
+      state.SkipWithError("not parsed");
+      return;
+    }
+
+    T result;
+    err = T::DeSerialize(serialized, &result);
+    json_object_put(serialized);
+    if (err) {
+      state.SkipWithError("not deserialized");
+      return;
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+template <typename T>
+void SerializeToBinary(benchmark::State& state, const T& obj) {
+  size_t size = 0;
+  for (auto _ : state) {
+    std::string data;
+    common::Error err = obj.SerializeToBinary(&data);
+    if (err) {
+      state.SkipWithError("not serialized");
+      return;
+    }
+    size = data.size();
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void DeSerializeFromBinary(benchmark::State& state, const T& obj) {
+  std::string data;
+  common::Error err = obj.SerializeToBinary(&data);
+  if (err) {
+    state.SkipWithError("not serialized");
+    return;
+  }
+
+  for (auto _ : state) {
+    T result;
+    err = T::DeSerializeFromBinary(data, &result);
+    if (err) {
+      state.SkipWithError("not deserialized");
+      return;
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// args: channels, programmes per channel
+void ChannelsArgs(benchmark::internal::Benchmark* bench) {
+  bench->Args({100, 0})->Args({1000, 0})->Args({1000, 200})->Unit(benchmark::kMillisecond);
+}
+
+void BM_ProgrammeInfo_Serialize(benchmark::State& state) {
+  SerializeToString(state, MakeProgramme("59106ed4e4b0fa8ef4d6e3b7", 0));
+}
+BENCHMARK(BM_ProgrammeInfo_Serialize);
+
+void BM_ProgrammeInfo_DeSerialize(benchmark::State& state) {
+  DeSerializeFromString(state, MakeProgramme("59106ed4e4b0fa8ef4d6e3b7", 0));
+}
+BENCHMARK(BM_ProgrammeInfo_DeSerialize);
+
+// args: programmes
+void BM_EpgInfo_Serialize(benchmark::State& state) {
+  SerializeToString(state, MakeEpg(0, state.range(0)));
+}
+BENCHMARK(BM_EpgInfo_Serialize)->Arg(0)->Arg(200);
+
+void BM_EpgInfo_DeSerialize(benchmark::State& state) {
+  DeSerializeFromString(state, MakeEpg(0, state.range(0)));
+}
+BENCHMARK(BM_EpgInfo_DeSerialize)->Arg(0)->Arg(200);
+
+void BM_ChannelsInfo_Serialize(benchmark::State& state) {
+  SerializeToString(state, MakeChannels(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_ChannelsInfo_Serialize)->Apply(ChannelsArgs);
+
+void BM_ChannelsInfo_DeSerialize(benchmark::State& state) {
+  DeSerializeFromString(state, MakeChannels(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_ChannelsInfo_DeSerialize)->Apply(ChannelsArgs);
+
+void BM_ChannelsInfo_SerializeBinary(benchmark::State& state) {
+  SerializeToBinary(state, MakeChannels(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_ChannelsInfo_SerializeBinary)->Apply(ChannelsArgs);
+
+void BM_ChannelsInfo_DeSerializeBinary(benchmark::State& state) {
+  DeSerializeFromBinary(state, MakeChannels(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_ChannelsInfo_DeSerializeBinary)->Apply(ChannelsArgs);
+
+void BM_ChatMessage_Serialize(benchmark::State& state) {
+  SerializeToString(state, MakeChatMessage());
+}
+BENCHMARK(BM_ChatMessage_Serialize);
+
+void BM_ChatMessage_DeSerialize(benchmark::State& state) {
+  DeSerializeFromString(state, MakeChatMessage());
+}
+BENCHMARK(BM_ChatMessage_DeSerialize);
+
+void BM_UserInfo_Serialize(benchmark::State& state) {
+  SerializeToString(state, MakeUser(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_UserInfo_Serialize)->Apply(ChannelsArgs);
+
+void BM_UserInfo_DeSerialize(benchmark::State& state) {
+  DeSerializeFromString(state, MakeUser(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_UserInfo_DeSerialize)->Apply(ChannelsArgs);
+
+void BM_UserInfo_SerializeBinary(benchmark::State& state) {
+  SerializeToBinary(state, MakeUser(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_UserInfo_SerializeBinary)->Apply(ChannelsArgs);
+
+void BM_UserInfo_DeSerializeBinary(benchmark::State& state) {
+  DeSerializeFromBinary(state, MakeUser(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_UserInfo_DeSerializeBinary)->Apply(ChannelsArgs);
+
+}  // namespace
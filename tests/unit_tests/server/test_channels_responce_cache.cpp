@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <common/sys_byteorder.h>
+
+#include "server/channels_responce_cache.h"
+#include "server/commands.h"
+
+#include "channels_delta.h"
+
+namespace {
+
+typedef fastotv::server::ChannelsResponceCache ChannelsResponceCache;
+typedef fastotv::inner::InnerClient::frame_t frame_t;
+
+const fastotv::cmd_seq_t id = "00000001";
+
+fastotv::ChannelsInfo MakeChannels(size_t count) {
+  const common::uri::Url url("http://localhost:8080/hls/69_avformat_test_alex_2/play.m3u8");
+  fastotv::ChannelsInfo chan;
+  for (size_t i = 0; i < count; ++i) {
+    const fastotv::stream_id sid = std::to_string(i);
+    chan.AddChannel(fastotv::ChannelInfo(fastotv::EpgInfo(sid, url, "name_" + sid), true, true));
+  }
+  return chan;
+}
+
+std::string VersionOf(const fastotv::ChannelsInfo& chan) {
+  std::string packed;
+  common::Error err = chan.SerializeToBinary(&packed);
+  EXPECT_TRUE(!err);
+  return ChannelsResponceCache::MakeVersion(ChannelsResponceCache::MakeHash(packed));
+}
+
+std::string ExpectedMessage(const std::string& tail) {
+  return fastotv::server::GetChannelsResponceSuccsessHead(id) + tail;
+}
+
+std::string FullMessage(const fastotv::ChannelsInfo& chan) {
+  std::string channels_str;
+  common::Error err = chan.SerializeToString(&channels_str);
+  EXPECT_TRUE(!err);
+  return ExpectedMessage(fastotv::server::GetChannelsResponceSuccsessTail(channels_str, VersionOf(chan)));
+}
+
+fastotv::server::UserInfo MakeUser(const fastotv::ChannelsInfo& chan) {
+  return fastotv::server::UserInfo("alex", "pass", chan, fastotv::server::UserInfo::devices_t());
+}
+
+// message as client decodes it, kind of frame
+std::string DecodeFrame(const frame_t& frame, fastotv::inner::FrameKind* kind) {
+  typedef fastotv::inner::InnerClient::protocoled_size_t protocoled_size_t;
+  EXPECT_TRUE(frame && frame->size() > sizeof(protocoled_size_t));
+  if (!frame || frame->size() <= sizeof(protocoled_size_t)) {
+    return std::string();
+  }
+
+  protocoled_size_t header = 0;
+  memcpy(&header, frame->data(), sizeof(protocoled_size_t));
+  header = common::NetToHost32(header);
+  EXPECT_EQ(header & ~FRAME_CODEC_FLAG, frame->size() - sizeof(protocoled_size_t));
+  const char* data = frame->data() + sizeof(protocoled_size_t);
+  size_t size = frame->size() - sizeof(protocoled_size_t);
+  *kind = fastotv::inner::FrameKind();
+  if (header & FRAME_CODEC_FLAG) {
+    *kind = fastotv::inner::FrameKind(static_cast<fastotv::inner::frame_codec_t>(data[0]));
+    data++;
+    size--;
+  }
+
+  std::string message;
+  common::Error err = fastotv::inner::DecodeFramePayload(kind->codec, common::StringPiece(data, size),
+                                                         fastotv::inner::InnerClient::default_max_frame_size, &message);
+  EXPECT_TRUE(!err);
+  return message;
+}
+
+class Client {  // frames settings of connection, not connected
+ public:
+  Client() : client_(nullptr, common::net::socket_info()) {}
+  explicit Client(fastotv::inner::frame_codec_t codec) : client_(nullptr, common::net::socket_info()) {
+    client_.SetFrameCodec(codec);
+  }
+
+  const fastotv::inner::InnerClient* get() const { return &client_; }
+  void SetCompressionThreshold(size_t size) { client_.SetCompressionThreshold(size); }
+
+ private:
+  fastotv::inner::InnerClient client_;
+};
+
+std::string MakeMessage(ChannelsResponceCache* cache,
+                        const fastotv::ChannelsInfo& chan,
+                        const std::string& version,
+                        const Client& client = Client(),
+                        fastotv::inner::FrameKind* kind = NULL) {
+  frame_t frame;
+  common::Error err = cache->MakeResponceFrame(id, MakeUser(chan), version, client.get(), &frame);
+  EXPECT_TRUE(!err);
+  fastotv::inner::FrameKind lkind;
+  const std::string message = DecodeFrame(frame, &lkind);
+  if (kind) {
+    *kind = lkind;
+  } else {
+    EXPECT_TRUE(lkind.legacy);
+  }
+  return message;
+}
+
+}  // namespace
+
+TEST(ChannelsResponceCache, full_and_cached) {
+  ChannelsResponceCache cache;
+  const fastotv::ChannelsInfo chan = MakeChannels(3);
+  ASSERT_EQ(MakeMessage(&cache, chan, std::string()), FullMessage(chan));
+  ASSERT_EQ(MakeMessage(&cache, chan, std::string()), FullMessage(chan));
+
+  ChannelsResponceCache::Stats stats = cache.GetStats();
+  ASSERT_EQ(stats.size, 1u);
+  ASSERT_EQ(stats.misses, 1u);
+  ASSERT_EQ(stats.hits, 1u);
+
+  fastotv::server::UserInfo user = MakeUser(chan);  // as loaded by storage
+  fastotv::server::packed_channels_t packed;
+  common::Error err = ChannelsResponceCache::PackChannels(chan, &packed);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(ChannelsResponceCache::MakeVersion(packed->hash), VersionOf(chan));
+  user.SetPackedChannels(packed);
+  const Client client;
+  frame_t frame;
+  err = cache.MakeResponceFrame(id, user, std::string(), client.get(), &frame);
+  ASSERT_TRUE(!err);
+  fastotv::inner::FrameKind kind;
+  ASSERT_EQ(DecodeFrame(frame, &kind), FullMessage(chan));
+  ASSERT_EQ(cache.GetStats().hits, 2u);
+
+  frame.reset();
+  err = cache.MakeResponceFrame(id, user, std::string(), client.get(), NULL);
+  ASSERT_TRUE(err);
+  err = cache.MakeResponceFrame(id, user, std::string(), NULL, &frame);
+  ASSERT_TRUE(err);
+  ASSERT_FALSE(frame);
+}
+
+TEST(ChannelsResponceCache, frame_kinds) {
+  ChannelsResponceCache cache;
+  const fastotv::ChannelsInfo chan = MakeChannels(3);
+  const fastotv::inner::FrameCodecStats before = fastotv::inner::GetFrameCodecStats(fastotv::inner::FRAME_CODEC_SNAPPY);
+  fastotv::inner::FrameKind kind;
+  ASSERT_EQ(MakeMessage(&cache, chan, std::string(), Client(fastotv::inner::FRAME_CODEC_SNAPPY), &kind),
+            FullMessage(chan));
+  ASSERT_FALSE(kind.legacy);
+  ASSERT_EQ(kind.codec, fastotv::inner::FRAME_CODEC_SNAPPY);
+  ASSERT_EQ(MakeMessage(&cache, chan, std::string()), FullMessage(chan));  // legacy shares encoded tail
+
+  Client small(fastotv::inner::FRAME_CODEC_SNAPPY);
+  small.SetCompressionThreshold(FullMessage(chan).size() + 1);
+  ASSERT_EQ(MakeMessage(&cache, chan, std::string(), small, &kind), FullMessage(chan));
+  ASSERT_FALSE(kind.legacy);
+  ASSERT_EQ(kind.codec, fastotv::inner::FRAME_CODEC_NONE);  // below compression threshold
+  ASSERT_EQ(cache.GetStats().hits, 2u);
+
+  const std::string version = VersionOf(chan);
+  const std::string not_modified =
+      ExpectedMessage(fastotv::server::GetChannelsNotModifiedResponceSuccsessTail(version));
+  ASSERT_EQ(MakeMessage(&cache, chan, version, Client(fastotv::inner::FRAME_CODEC_NONE), &kind), not_modified);
+  ASSERT_FALSE(kind.legacy);
+  ASSERT_EQ(kind.codec, fastotv::inner::FRAME_CODEC_NONE);
+
+  const fastotv::inner::FrameCodecStats after = fastotv::inner::GetFrameCodecStats(fastotv::inner::FRAME_CODEC_SNAPPY);
+  ASSERT_EQ(after.encoded_frames - before.encoded_frames, 2u);  // each spliced frame, not shared tail
+  ASSERT_EQ(after.encoded_raw_bytes - before.encoded_raw_bytes, 2 * FullMessage(chan).size());
+}
+
+TEST(ChannelsResponceCache, not_modified) {
+  ChannelsResponceCache cache;
+  const fastotv::ChannelsInfo chan = MakeChannels(3);
+  const std::string version = VersionOf(chan);
+  const std::string expected = ExpectedMessage(fastotv::server::GetChannelsNotModifiedResponceSuccsessTail(version));
+  ASSERT_EQ(MakeMessage(&cache, chan, version), expected);  // version known by content, not cache
+  ASSERT_EQ(cache.GetStats().not_modified, 1u);
+}
+
+TEST(ChannelsResponceCache, delta) {
+  ChannelsResponceCache cache;
+  const fastotv::ChannelsInfo prev = MakeChannels(3);
+  const fastotv::ChannelsInfo cur = MakeChannels(4);
+  ASSERT_EQ(MakeMessage(&cache, prev, std::string()), FullMessage(prev));
+
+  std::string delta_str;
+  common::Error err = fastotv::ChannelsDelta(prev, cur).SerializeToString(&delta_str);
+  ASSERT_TRUE(!err);
+  const std::string expected =
+      ExpectedMessage(fastotv::server::GetChannelsDeltaResponceSuccsessTail(delta_str, VersionOf(cur)));
+  ASSERT_EQ(MakeMessage(&cache, cur, VersionOf(prev)), expected);
+  ASSERT_EQ(cache.GetStats().deltas, 1u);
+
+  ASSERT_EQ(MakeMessage(&cache, cur, std::string()), FullMessage(cur));  // delta base not used as full responce
+  const fastotv::ChannelsInfo next = MakeChannels(2);
+  err = fastotv::ChannelsDelta(cur, next).SerializeToString(&delta_str);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(MakeMessage(&cache, next, VersionOf(cur)),
+            ExpectedMessage(fastotv::server::GetChannelsDeltaResponceSuccsessTail(delta_str, VersionOf(next))));
+  ASSERT_EQ(cache.GetStats().deltas, 2u);
+}
+
+TEST(ChannelsResponceCache, unknown_version_full_responce) {
+  ChannelsResponceCache cache;
+  const fastotv::ChannelsInfo prev = MakeChannels(3);
+  const fastotv::ChannelsInfo cur = MakeChannels(4);
+  const std::string prev_version = VersionOf(prev);
+
+  ASSERT_EQ(MakeMessage(&cache, cur, prev_version), FullMessage(cur));  // never cached
+  ASSERT_EQ(MakeMessage(&cache, cur, "garbage"), FullMessage(cur));
+
+  cache.SetMaxSize(1);
+  ASSERT_EQ(MakeMessage(&cache, prev, std::string()), FullMessage(prev));
+  ASSERT_EQ(MakeMessage(&cache, MakeChannels(5), std::string()), FullMessage(MakeChannels(5)));  // prev evicted
+  ASSERT_EQ(MakeMessage(&cache, cur, prev_version), FullMessage(cur));
+
+  cache.Clear();
+  ASSERT_EQ(MakeMessage(&cache, cur, VersionOf(MakeChannels(5))), FullMessage(cur));
+
+  cache.SetMaxSize(0);  // disabled, no base versions
+  ASSERT_EQ(MakeMessage(&cache, prev, std::string()), FullMessage(prev));
+  ASSERT_EQ(MakeMessage(&cache, cur, prev_version), FullMessage(cur));
+  ASSERT_EQ(cache.GetStats().deltas, 0u);
+  ASSERT_EQ(cache.GetStats().size, 0u);
+}
+
+TEST(ChannelsResponceCache, parse_version) {
+  const ChannelsResponceCache::hash_t hash = 0x0123456789abcdefULL;
+  const std::string version = ChannelsResponceCache::MakeVersion(hash);
+  ASSERT_EQ(version, "0123456789abcdef");
+
+  ChannelsResponceCache::hash_t parsed = 0;
+  ASSERT_TRUE(ChannelsResponceCache::ParseVersion(version, &parsed));
+  ASSERT_EQ(parsed, hash);
+  ASSERT_TRUE(ChannelsResponceCache::ParseVersion("ff", &parsed));
+  ASSERT_EQ(parsed, 0xffu);
+
+  parsed = 1;
+  ASSERT_FALSE(ChannelsResponceCache::ParseVersion(std::string(), &parsed));
+  ASSERT_FALSE(ChannelsResponceCache::ParseVersion("xyz", &parsed));
+  ASSERT_FALSE(ChannelsResponceCache::ParseVersion(version + "z", &parsed));
+  ASSERT_FALSE(ChannelsResponceCache::ParseVersion(version + " ", &parsed));
+  ASSERT_FALSE(ChannelsResponceCache::ParseVersion("12 34", &parsed));
+  ASSERT_EQ(parsed, 1u);
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "server/latency_histogram.h"
+
+using namespace fastotv::server;
+
+TEST(LatencyHistogram, buckets) {
+  for (uint64_t usec = 0; usec < 8; ++usec) {
+    ASSERT_EQ(LatencyHistogram::BucketIndex(usec), usec);
+    ASSERT_EQ(LatencyHistogram::BucketUpperBound(usec), usec);
+  }
+
+  for (uint64_t usec = 8; usec < 100000; usec += 7) {
+    const size_t index = LatencyHistogram::BucketIndex(usec);
+    const uint64_t upper = LatencyHistogram::BucketUpperBound(index);
+    ASSERT_LE(usec, upper);
+    ASSERT_GT(usec, LatencyHistogram::BucketUpperBound(index - 1));
+    ASSERT_LE(upper - usec, usec / 8);  // 12.5%
+  }
+
+  ASSERT_EQ(LatencyHistogram::BucketIndex(UINT64_MAX), static_cast<size_t>(LatencyHistogram::buckets_count - 1));
+}
+
+TEST(LatencyHistogram, quantiles) {
+  LatencyHistogram hist;
+  ASSERT_EQ(hist.GetSnapshot().ValueAtQuantile(0.5), 0u);
+
+  for (uint64_t usec = 1; usec <= 1000; ++usec) {
+    hist.Record(usec);
+  }
+  hist.RecordNsec(5000000000);  // 5 sec
+
+  LatencyHistogram::Snapshot snapshot = hist.GetSnapshot();
+  ASSERT_EQ(snapshot.count, 1001u);
+  ASSERT_EQ(snapshot.sum_usec, 500500u + 5000000u);
+  ASSERT_EQ(snapshot.max_usec, 5000000u);
+
+  const uint64_t median = snapshot.ValueAtQuantile(0.5);
+  ASSERT_GE(median, 500u);
+  ASSERT_LE(median, 500u + 500u / 8);
+  ASSERT_EQ(snapshot.ValueAtQuantile(1.0), 5000000u);  // max exact
+
+  ASSERT_EQ(snapshot.CountAtOrBelow(7), 7u);
+  ASSERT_EQ(snapshot.CountAtOrBelow(LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketIndex(1000))), 1000u);
+  ASSERT_EQ(snapshot.CountAtOrBelow(UINT64_MAX), 1001u);
+}
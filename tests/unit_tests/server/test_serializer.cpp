@@ -131,3 +131,21 @@ TEST(ResponceInfo, serialize_deserialize) {
 
   ASSERT_EQ(ust, dust);
 }
+
+TEST(UserInfo, binary_serialize_deserialize) {
+  const common::uri::Url url("http://localhost:8080/hls/69_avformat_test_alex_2/play.m3u8");
+  fastotv::ChannelsInfo channel_info;
+  channel_info.AddChannel(fastotv::ChannelInfo(fastotv::EpgInfo("123", url, "alex"), true, false));
+  fastotv::server::UserInfo::devices_t devices = {"dev1", "dev2"};
+
+  fastotv::server::UserInfo uinf("palecc", "faf", channel_info, devices);
+  std::string bin;
+  common::Error err = uinf.SerializeToBinary(&bin);
+  ASSERT_TRUE(!err);
+  fastotv::server::UserInfo duinf;
+  err = fastotv::server::UserInfo::DeSerializeFromBinary(bin, &duinf);
+  ASSERT_TRUE(!err);
+
+  ASSERT_EQ(uinf, duinf);
+  ASSERT_EQ(duinf.GetDevices(), devices);
+}
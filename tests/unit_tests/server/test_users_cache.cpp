@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "server/redis/users_cache.h"
+
+namespace {
+
+typedef fastotv::server::redis::UsersCache UsersCache;
+
+fastotv::server::UserInfo MakeUser(const fastotv::login_t& login) {
+  return fastotv::server::UserInfo(login, "pass", fastotv::ChannelsInfo(), fastotv::server::UserInfo::devices_t());
+}
+
+}  // namespace
+
+TEST(UsersCache, hit_and_miss) {
+  UsersCache cache;
+  fastotv::server::user_id_t uid;
+  fastotv::server::UserInfo uinf;
+  ASSERT_EQ(cache.Find("alex", &uid, &uinf), UsersCache::CACHE_MISS);
+
+  const fastotv::server::UserInfo user = MakeUser("alex");
+  cache.Insert("alex", "1", user);
+  ASSERT_EQ(cache.Find("alex", &uid, &uinf), UsersCache::CACHE_HIT);
+  ASSERT_EQ(uid, "1");
+  ASSERT_EQ(uinf, user);
+
+  cache.InsertNotFound("bob");
+  ASSERT_EQ(cache.Find("bob", &uid, &uinf), UsersCache::CACHE_NOT_FOUND);
+
+  cache.Insert("bob", "2", MakeUser("bob"));  // replaces negative entry
+  ASSERT_EQ(cache.Find("bob", &uid, &uinf), UsersCache::CACHE_HIT);
+  ASSERT_EQ(uid, "2");
+
+  UsersCache::Stats stats = cache.GetStats();
+  ASSERT_EQ(stats.size, 2u);
+  ASSERT_EQ(stats.hits, 2u);
+  ASSERT_EQ(stats.not_found_hits, 1u);
+  ASSERT_EQ(stats.misses, 1u);
+}
+
+TEST(UsersCache, expiry) {
+  UsersCache cache;
+  cache.SetLimits(UsersCache::default_max_size, 0);  // expired when inserted
+  cache.Insert("alex", "1", MakeUser("alex"));
+
+  fastotv::server::user_id_t uid;
+  fastotv::server::UserInfo uinf;
+  ASSERT_EQ(cache.Find("alex", &uid, &uinf), UsersCache::CACHE_MISS);
+  ASSERT_EQ(cache.GetStats().size, 0u);  // expired entry dropped on lookup
+
+  cache.SetLimits(UsersCache::default_max_size, UsersCache::default_ttl_msec);
+  cache.Insert("alex", "1", MakeUser("alex"));
+  ASSERT_EQ(cache.Find("alex", &uid, &uinf), UsersCache::CACHE_HIT);
+}
+
+TEST(UsersCache, lru_eviction) {
+  UsersCache cache;
+  cache.SetLimits(2, UsersCache::default_ttl_msec);
+  cache.Insert("a", "1", MakeUser("a"));
+  cache.Insert("b", "2", MakeUser("b"));
+
+  fastotv::server::user_id_t uid;
+  fastotv::server::UserInfo uinf;
+  ASSERT_EQ(cache.Find("a", &uid, &uinf), UsersCache::CACHE_HIT);  // b now least recently used
+
+  cache.Insert("c", "3", MakeUser("c"));
+  ASSERT_EQ(cache.Find("b", &uid, &uinf), UsersCache::CACHE_MISS);
+  ASSERT_EQ(cache.Find("a", &uid, &uinf), UsersCache::CACHE_HIT);
+  ASSERT_EQ(cache.Find("c", &uid, &uinf), UsersCache::CACHE_HIT);
+
+  UsersCache::Stats stats = cache.GetStats();
+  ASSERT_EQ(stats.size, 2u);
+  ASSERT_EQ(stats.evictions, 1u);
+
+  cache.SetLimits(1, UsersCache::default_ttl_msec);  // shrink evicts least recently used
+  ASSERT_EQ(cache.Find("a", &uid, &uinf), UsersCache::CACHE_MISS);
+  ASSERT_EQ(cache.Find("c", &uid, &uinf), UsersCache::CACHE_HIT);
+
+  cache.SetLimits(0, UsersCache::default_ttl_msec);  // disabled
+  cache.Insert("d", "4", MakeUser("d"));
+  ASSERT_EQ(cache.Find("d", &uid, &uinf), UsersCache::CACHE_MISS);
+  ASSERT_EQ(cache.GetStats().size, 0u);
+}
+
+TEST(UsersCache, invalidator) {
+  UsersCache cache;
+  fastotv::server::redis::UsersCacheInvalidator invalidator(&cache);
+  cache.Insert("a", "1", MakeUser("a"));
+  cache.Insert("b", "2", MakeUser("b"));
+  cache.InsertNotFound("c");
+
+  fastotv::server::user_id_t uid;
+  fastotv::server::UserInfo uinf;
+  invalidator.HandleMessage("users", "a");
+  ASSERT_EQ(cache.Find("a", &uid, &uinf), UsersCache::CACHE_MISS);
+  ASSERT_EQ(cache.Find("b", &uid, &uinf), UsersCache::CACHE_HIT);
+  invalidator.HandleMessage("users", "unknown");  // not cached, nothing removed
+  ASSERT_EQ(cache.GetStats().invalidations, 1u);
+
+  invalidator.HandleMessage("users", "*");
+  ASSERT_EQ(cache.GetStats().size, 0u);
+  ASSERT_EQ(cache.GetStats().invalidations, 3u);
+  ASSERT_EQ(cache.Find("b", &uid, &uinf), UsersCache::CACHE_MISS);
+  ASSERT_EQ(cache.Find("c", &uid, &uinf), UsersCache::CACHE_MISS);
+
+  cache.Insert("a", "1", MakeUser("a"));
+  invalidator.HandleMessage("users", std::string());  // empty message - all users
+  ASSERT_EQ(cache.GetStats().size, 0u);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <json-c/json_tokener.h>
+
+#include "channels_delta.h"
+
+namespace {
+
+const common::uri::Url url("http://localhost:8080/hls/69_avformat_test_alex_2/play.m3u8");
+
+fastotv::ChannelInfo MakeChannel(const fastotv::stream_id& sid, const std::string& name, bool enable_video) {
+  return fastotv::ChannelInfo(fastotv::EpgInfo(sid, url, name), true, enable_video);
+}
+
+std::string ToString(const fastotv::ChannelsInfo& chan) {  // Equals not compares programs and icon
+  std::string result;
+  common::Error err = chan.SerializeToString(&result);
+  EXPECT_TRUE(!err);
+  return result;
+}
+
+// delta sent to client: serialized, parsed back and applied to client channels
+void ExpectApplied(const fastotv::ChannelsInfo& prev, const fastotv::ChannelsInfo& cur) {
+  const fastotv::ChannelsDelta delta(prev, cur);
+  ASSERT_TRUE(delta.IsValid());
+
+  std::string delta_str;
+  common::Error err = delta.SerializeToString(&delta_str);
+  ASSERT_TRUE(!err);
+  json_object* jdelta = json_tokener_parse(delta_str.c_str());
+  ASSERT_TRUE(jdelta);
+  fastotv::ChannelsDelta parsed;
+  err = fastotv::ChannelsDelta::DeSerialize(jdelta, &parsed);
+  json_object_put(jdelta);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(parsed, delta);
+
+  fastotv::ChannelsInfo applied;
+  err = parsed.Apply(prev, &applied);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(ToString(applied), ToString(cur));
+}
+
+}  // namespace
+
+TEST(ChannelsDelta, apply) {
+  fastotv::ChannelsInfo prev;
+  prev.AddChannel(MakeChannel("1", "first", true));
+  prev.AddChannel(MakeChannel("2", "second", true));
+  prev.AddChannel(MakeChannel("3", "third", true));
+
+  fastotv::ChannelsInfo cur;  // 3 moved, 2 removed, 1 changed, 4 added
+  cur.AddChannel(MakeChannel("3", "third", true));
+  cur.AddChannel(MakeChannel("1", "first", false));
+  cur.AddChannel(MakeChannel("4", "fourth", true));
+
+  const fastotv::ChannelsDelta delta(prev, cur);
+  ASSERT_EQ(delta.GetOrder(), fastotv::ChannelsDelta::ids_t({"3", "1", "4"}));
+  ASSERT_EQ(delta.GetUpdated().size(), 2u);  // unchanged 3 not sent
+  ExpectApplied(prev, cur);
+
+  fastotv::ChannelInfo programs = MakeChannel("3", "third", true);  // only epg changed
+  fastotv::EpgInfo epg = programs.GetEpg();
+  epg.SetPrograms({fastotv::ProgrammeInfo("3", 0, 1000, "news")});
+  programs = fastotv::ChannelInfo(epg, true, true);
+  fastotv::ChannelsInfo with_programs;
+  with_programs.AddChannel(programs);
+  ASSERT_EQ(fastotv::ChannelsDelta(prev, with_programs).GetUpdated().size(), 1u);
+  ExpectApplied(prev, with_programs);
+
+  ExpectApplied(prev, prev);
+  ASSERT_TRUE(fastotv::ChannelsDelta(prev, prev).GetUpdated().empty());
+  ExpectApplied(fastotv::ChannelsInfo(), cur);
+  ExpectApplied(cur, fastotv::ChannelsInfo());
+}
+
+TEST(ChannelsDelta, apply_to_other_version) {
+  fastotv::ChannelsInfo prev;
+  prev.AddChannel(MakeChannel("1", "first", true));
+  prev.AddChannel(MakeChannel("2", "second", true));
+  fastotv::ChannelsInfo cur;
+  cur.AddChannel(MakeChannel("2", "second", true));
+  const fastotv::ChannelsDelta delta(prev, cur);
+
+  fastotv::ChannelsInfo other;  // client has not base version, unchanged channel missing
+  other.AddChannel(MakeChannel("1", "first", true));
+  fastotv::ChannelsInfo applied;
+  common::Error err = delta.Apply(other, &applied);
+  ASSERT_TRUE(err);
+  err = delta.Apply(prev, NULL);
+  ASSERT_TRUE(err);
+}
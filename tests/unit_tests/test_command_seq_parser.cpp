@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include "inner/inner_client.h"
+#include "inner/inner_server_command_seq_parser.h"
+
+using namespace fastotv;
+using namespace fastotv::inner;
+
+namespace {
+
+class TestParser : public InnerServerCommandSeqParser {
+ public:
+  TestParser() : connection_(nullptr, common::net::socket_info()), answered(), expired(), responces(0) {}
+
+  using InnerServerCommandSeqParser::ExpireRequests;
+
+  void Subscribe(const cmd_seq_t& id, tick_t timeout) {
+    auto cb = [this](cmd_seq_t request_id, const CommandArgsView& argv) {
+      UNUSED(argv);
+      answered.push_back(request_id);
+    };
+    auto timeout_cb = [this](cmd_seq_t request_id) { expired.push_back(request_id); };
+    SubscribeRequest(RequestCallback(id, cb, timeout_cb), timeout);
+  }
+
+  void Answer(const cmd_seq_t& id) {
+    HandleInnerDataReceived(&connection_, MakeResponce(id, STATE_SUCCESS, OPCODE_SERVER_PING).GetCmd());
+  }
+
+  void Tick(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      ExpireRequests();
+    }
+  }
+
+  std::vector<cmd_seq_t> answered;
+  std::vector<cmd_seq_t> expired;
+  size_t responces;
+
+ private:
+  virtual void HandleInnerRequestCommand(InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv) override {
+    UNUSED(connection);
+    UNUSED(id);
+    UNUSED(argv);
+  }
+  virtual void HandleInnerResponceCommand(InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv) override {
+    UNUSED(connection);
+    UNUSED(id);
+    UNUSED(argv);
+    responces++;
+  }
+  virtual void HandleInnerApproveCommand(InnerClient* connection, cmd_seq_t id, const CommandArgsView& argv) override {
+    UNUSED(connection);
+    UNUSED(id);
+    UNUSED(argv);
+  }
+
+  InnerClient connection_;  // not read or written, commands passed directly
+};
+
+typedef std::vector<cmd_seq_t> ids_t;
+
+}  // namespace
+
+TEST(InnerServerCommandSeqParser, deadlines_across_wheel_wrap) {
+  TestParser parser;
+  const InnerServerCommandSeqParser::tick_t wheel = InnerServerCommandSeqParser::requests_wheel_size;
+  parser.Subscribe("short", 3);
+  parser.Subscribe("wrap", wheel + 3);  // same slot as short, next round
+  parser.Subscribe("wraps", 2 * wheel + 1);
+  parser.Subscribe("zero", 0);  // at least one tick
+  ASSERT_EQ(parser.GetSubscribedRequestsCount(), 4u);
+
+  parser.Tick(1);
+  ASSERT_EQ(parser.expired, ids_t({"zero"}));
+  parser.Tick(2);
+  ASSERT_EQ(parser.expired, ids_t({"zero", "short"}));
+
+  parser.Tick(wheel - 1);  // tick wheel + 2
+  ASSERT_EQ(parser.expired.size(), 2u);
+  parser.Tick(1);
+  ASSERT_EQ(parser.expired, ids_t({"zero", "short", "wrap"}));
+
+  parser.Tick(wheel - 3);  // tick 2 * wheel
+  ASSERT_EQ(parser.expired.size(), 3u);
+  parser.Tick(1);
+  ASSERT_EQ(parser.expired, ids_t({"zero", "short", "wrap", "wraps"}));
+  ASSERT_EQ(parser.GetSubscribedRequestsCount(), 0u);
+
+  parser.Tick(3 * wheel);  // nothing notified twice
+  ASSERT_EQ(parser.expired.size(), 4u);
+  ASSERT_TRUE(parser.answered.empty());
+}
+
+TEST(InnerServerCommandSeqParser, responce_after_expiry) {
+  TestParser parser;
+  parser.Subscribe("late", 2);
+  parser.Tick(2);
+  ASSERT_EQ(parser.expired, ids_t({"late"}));
+
+  parser.Answer("late");  // handled as not subscribed responce
+  ASSERT_TRUE(parser.answered.empty());
+  ASSERT_EQ(parser.responces, 1u);
+
+  parser.Subscribe("answered", 2);
+  parser.Answer("answered");
+  parser.Answer("answered");  // duplicate not calls callback again
+  ASSERT_EQ(parser.answered, ids_t({"answered"}));
+  parser.Tick(2);
+  ASSERT_EQ(parser.expired, ids_t({"late"}));  // stale wheel entry skipped
+}
+
+TEST(InnerServerCommandSeqParser, out_of_order_responces) {
+  TestParser parser;
+  parser.Subscribe("a", 5);
+  parser.Subscribe("b", 1);
+  parser.Subscribe("c", 3);
+
+  parser.Answer("c");
+  parser.Answer("a");
+  ASSERT_EQ(parser.answered, ids_t({"c", "a"}));
+  ASSERT_EQ(parser.GetSubscribedRequestsCount(), 1u);
+
+  parser.Tick(1);
+  ASSERT_EQ(parser.expired, ids_t({"b"}));
+  parser.Answer("b");
+  parser.Tick(5);
+  ASSERT_EQ(parser.answered, ids_t({"c", "a"}));
+  ASSERT_EQ(parser.expired, ids_t({"b"}));
+}
+
+TEST(InnerServerCommandSeqParser, resubscribed_request) {
+  TestParser parser;
+  parser.Subscribe("same", 2);
+  parser.Tick(1);
+  parser.Subscribe("same", 4);  // replaces, old deadline entry stale
+  ASSERT_EQ(parser.GetSubscribedRequestsCount(), 1u);
+
+  parser.Tick(3);
+  ASSERT_TRUE(parser.expired.empty());
+  parser.Tick(1);
+  ASSERT_EQ(parser.expired, ids_t({"same"}));
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "commands/commands.h"
+
+extern "C" {
+#include "third-party/sds/sds.h"
+}
+
+using namespace fastotv;
+
+TEST(commands, binary_request) {
+  const cmd_seq_t seq_id_const = "00000000000000ff";
+  cmd_request_t req = MakeRequest(seq_id_const, OPCODE_CLIENT_GET_CHANNELS, "0123456789abcdef");
+  ASSERT_TRUE(req.IsBinarySupported());
+  std::string binary;
+  common::Error err = req.GetBinaryCmd(&binary);
+  ASSERT_TRUE(!err);
+  ASSERT_TRUE(IsBinaryCommand(binary));
+  ASSERT_EQ(binary.size(), BINARY_COMMAND_HEADER_SIZE + 4 + 16);
+
+  cmd_id_t cmd_id;
+  cmd_seq_t seq_id;
+  std::string buffer;
+  std::vector<common::StringPiece> argv;
+  err = ParseBinaryCommand(binary, &cmd_id, &seq_id, &buffer, &argv);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(cmd_id, REQUEST_COMMAND);
+  ASSERT_EQ(seq_id, seq_id_const);
+  ASSERT_EQ(argv.size(), 2u);
+  ASSERT_EQ(argv[0].as_string(), CLIENT_GET_CHANNELS);
+  ASSERT_EQ(argv[1].as_string(), "0123456789abcdef");
+  ASSERT_STREQ(argv[1].data(), "0123456789abcdef");  // zero terminated for c api
+}
+
+TEST(commands, binary_responce_text_seq) {
+  const cmd_seq_t seq_id_const = "10";
+  const std::string json = "{\"cause\": \"it's raw\"}";
+  cmd_responce_t resp = MakeResponce(seq_id_const, STATE_FAIL, OPCODE_SERVER_PING, json, std::string());
+  std::string binary;
+  common::Error err = resp.GetBinaryCmd(&binary);
+  ASSERT_TRUE(!err);
+
+  cmd_id_t cmd_id;
+  cmd_seq_t seq_id;
+  std::string buffer;
+  std::vector<common::StringPiece> argv;
+  err = ParseBinaryCommand(binary, &cmd_id, &seq_id, &buffer, &argv);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(cmd_id, RESPONCE_COMMAND);
+  ASSERT_EQ(seq_id, seq_id_const);
+  ASSERT_EQ(argv.size(), 4u);
+  ASSERT_EQ(argv[0].as_string(), FAIL_COMMAND);
+  ASSERT_EQ(argv[1].as_string(), SERVER_PING);
+  ASSERT_EQ(argv[2].as_string(), json);
+  ASSERT_TRUE(argv[3].empty());
+
+  binary.resize(binary.size() - 1);
+  err = ParseBinaryCommand(binary, &cmd_id, &seq_id, &buffer, &argv);
+  ASSERT_TRUE(err);
+}
+
+TEST(commands, text_from_structured) {
+  cmd_approve_t approve = MakeApproveResponce("10", STATE_SUCCESS, OPCODE_SERVER_WHO_ARE_YOU);
+  ASSERT_FALSE(IsBinaryCommand(approve.GetCmd()));
+  cmd_id_t cmd_id;
+  cmd_seq_t seq_id;
+  std::string command_str;
+  common::Error err = ParseCommand(approve.GetCmd(), &cmd_id, &seq_id, &command_str);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(cmd_id, APPROVE_COMMAND);
+  ASSERT_EQ(seq_id, "10");
+  ASSERT_EQ(command_str, SUCCESS_COMMAND " " SERVER_WHO_ARE_YOU);
+
+  cmd_request_t text("10", "0 10 custom\r\n");
+  ASSERT_FALSE(text.IsBinarySupported());
+}
+
+TEST(commands, command_to_opcode) {
+  for (uint8_t op = OPCODE_CLIENT_PING; op < OPCODE_COUNT; ++op) {
+    const cmd_opcode_t opcode = static_cast<cmd_opcode_t>(op);
+    ASSERT_EQ(CommandToOpcode(OpcodeToCommand(opcode)), opcode);
+  }
+  ASSERT_EQ(CommandToOpcode("client_ping_x"), OPCODE_UNKNOWN);
+  ASSERT_EQ(CommandToOpcode("client_pin"), OPCODE_UNKNOWN);
+  ASSERT_EQ(CommandToOpcode(""), OPCODE_UNKNOWN);
+  ASSERT_EQ(CommandToOpcode(NULL), OPCODE_UNKNOWN);
+
+  ASSERT_EQ(CommandToState(SUCCESS_COMMAND), STATE_SUCCESS);
+  ASSERT_EQ(CommandToState(FAIL_COMMAND), STATE_FAIL);
+  ASSERT_EQ(CommandToState("oks"), STATE_NONE);
+}
+
+TEST(commands, text_quoted_args) {
+  const std::string json = "{\"cause\": \"it's quoted\"}";
+  cmd_responce_t resp = MakeResponce("10", STATE_FAIL, OPCODE_SERVER_PING, json, std::string());
+  const std::string text = resp.GetCmd();
+  ASSERT_EQ(text, "1 10 " FAIL_COMMAND " " SERVER_PING " '{\"cause\": \"it\\'s quoted\"}' ''" END_OF_COMMAND);
+
+  std::string reused;
+  reused.reserve(1024);
+  resp.WriteCmd(&reused);
+  ASSERT_EQ(text, reused);
+  ASSERT_GE(reused.capacity(), 1024u);
+
+  cmd_id_t cmd_id;
+  cmd_seq_t seq_id;
+  std::string command_str;
+  common::Error err = ParseCommand(text, &cmd_id, &seq_id, &command_str);
+  ASSERT_TRUE(!err);
+  int argc;
+  sds* argv = sdssplitargslong(command_str.c_str(), &argc);
+  ASSERT_EQ(argc, 4);
+  ASSERT_EQ(json, argv[2]);
+  ASSERT_STREQ(argv[3], "");
+  sdsfreesplitres(argv, argc);
+}
+
+TEST(commands, split_args_as_sds) {
+  const char* lines[] = {"client_ping",
+                         "  ok   get_channels '{\"channels\": []}' 1a2b delta ",
+                         "fail server_ping 'it\\'s' \"hex \\x41\\x4a\" {\"a\": {\"b\": \"}\"}} tail",
+                         "ok who_are_you {\"login\": \"a\\}b\"} 2",
+                         "get_runtime_channel_info ''",
+                         "a'b c' d",
+                         "",
+                         "   "};
+  std::string buffer;
+  std::vector<common::StringPiece> argv;
+  for (const char* line : lines) {
+    common::Error err = SplitCommandArgs(line, strlen(line), &buffer, &argv);
+    ASSERT_TRUE(!err) << line;
+    int argc;
+    sds* sargv = sdssplitargslong(line, &argc);
+    ASSERT_TRUE(sargv);
+    ASSERT_EQ(static_cast<size_t>(argc), argv.size()) << line;
+    for (int i = 0; i < argc; ++i) {
+      ASSERT_EQ(std::string(sargv[i], sdslen(sargv[i])), argv[i].as_string()) << line;
+      ASSERT_STREQ(sargv[i], argv[i].data()) << line;
+    }
+    sdsfreesplitres(sargv, argc);
+  }
+
+  const char* invalid_lines[] = {"ok 'unterminated", "ok \"unterminated", "ok {\"a\": 1", "ok 'a'b", "a'b c'd"};
+  for (const char* line : invalid_lines) {
+    common::Error err = SplitCommandArgs(line, strlen(line), &buffer, &argv);
+    ASSERT_TRUE(err) << line;
+    int argc;
+    ASSERT_FALSE(sdssplitargslong(line, &argc)) << line;
+  }
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "inner/frame_codec.h"
+
+using namespace fastotv::inner;
+
+TEST(frame_codec, negotiation) {
+  frame_codec_t codec;
+  ASSERT_TRUE(ConvertFromString("snappy", &codec));
+  ASSERT_EQ(codec, FRAME_CODEC_SNAPPY);
+  ASSERT_FALSE(ConvertFromString("lz4", &codec));
+  ASSERT_STREQ(FrameCodecToString(FRAME_CODEC_NONE), "none");
+
+  ASSERT_EQ(GetSupportedFrameCodecs("lz4,snappy,,none"), "snappy,none");
+  ASSERT_EQ(GetSupportedFrameCodecs(""), "");
+  ASSERT_TRUE(SelectFrameCodec("lz4,none,snappy", &codec));
+  ASSERT_EQ(codec, FRAME_CODEC_NONE);
+  ASSERT_FALSE(SelectFrameCodec("lz4", &codec));
+
+  ASSERT_TRUE(IsFrameCodecOffered("zstd,snappy", FRAME_CODEC_SNAPPY));
+  ASSERT_FALSE(IsFrameCodecOffered("zstd,snappy", FRAME_CODEC_NONE));
+  ASSERT_FALSE(IsFrameCodecOffered("snappynone", FRAME_CODEC_NONE));
+#ifdef HAVE_ZSTD
+  ASSERT_TRUE(SelectFrameCodec("zstd,snappy", &codec));
+  ASSERT_EQ(codec, FRAME_CODEC_ZSTD);
+#else
+  ASSERT_FALSE(IsFrameCodecSupported(FRAME_CODEC_ZSTD));
+  ASSERT_TRUE(SelectFrameCodec("zstd,snappy", &codec));
+  ASSERT_EQ(codec, FRAME_CODEC_SNAPPY);
+#endif
+}
+
+TEST(frame_codec, round_trip) {
+  std::string message;
+  for (size_t i = 0; i < 64; ++i) {
+    message += "{\"id\": \"59106ed4e4b0fa8ef4d6e3b7\", \"name\": \"Channel\", \"enable_audio\": true}, ";
+  }
+
+  for (uint8_t i = 0; i < FRAME_CODEC_COUNT; ++i) {
+    const frame_codec_t codec = static_cast<frame_codec_t>(i);
+    if (!IsFrameCodecSupported(codec)) {
+      continue;
+    }
+
+    const FrameCodecStats before = GetFrameCodecStats(codec);
+    std::string encoded;
+    common::Error err = EncodeFramePayload(codec, message, &encoded);
+    ASSERT_TRUE(!err) << FrameCodecToString(codec);
+    if (codec != FRAME_CODEC_NONE) {
+      ASSERT_LT(encoded.size(), message.size()) << FrameCodecToString(codec);
+    }
+
+    std::string decoded;
+    err = DecodeFramePayload(codec, encoded, message.size(), &decoded);
+    ASSERT_TRUE(!err) << FrameCodecToString(codec);
+    ASSERT_EQ(decoded, message);
+
+    const FrameCodecStats after = GetFrameCodecStats(codec);
+    ASSERT_EQ(after.encoded_frames, before.encoded_frames + 1);
+    ASSERT_EQ(after.encoded_raw_bytes, before.encoded_raw_bytes + message.size());
+    ASSERT_EQ(after.decoded_raw_bytes, before.decoded_raw_bytes + message.size());
+  }
+}
+
+TEST(frame_codec, max_size) {
+  const std::string message(64 * 1024, 'a');  // small after compression
+
+  for (uint8_t i = 0; i < FRAME_CODEC_COUNT; ++i) {
+    const frame_codec_t codec = static_cast<frame_codec_t>(i);
+    if (!IsFrameCodecSupported(codec)) {
+      continue;
+    }
+
+    std::string encoded;
+    common::Error err = EncodeFramePayload(codec, message, &encoded);
+    ASSERT_TRUE(!err) << FrameCodecToString(codec);
+
+    std::string decoded;
+    err = DecodeFramePayload(codec, encoded, message.size() - 1, &decoded);
+    ASSERT_TRUE(err) << FrameCodecToString(codec);
+    ASSERT_TRUE(decoded.empty()) << FrameCodecToString(codec);
+
+    err = DecodeFramePayload(codec, encoded, message.size(), &decoded);
+    ASSERT_TRUE(!err) << FrameCodecToString(codec);
+    ASSERT_EQ(decoded, message);
+  }
+}
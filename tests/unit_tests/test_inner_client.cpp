@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <common/sys_byteorder.h>
+
+#include "inner/inner_client.h"
+
+using namespace fastotv::inner;
+
+namespace {
+
+// codec frame without compression: [size | FRAME_CODEC_FLAG][FRAME_CODEC_NONE][message]
+std::string MakeRawFrame(const std::string& message) {
+  const InnerClient::protocoled_size_t header = common::HostToNet32((message.size() + 1) | FRAME_CODEC_FLAG);
+  std::string frame(reinterpret_cast<const char*>(&header), sizeof(header));
+  frame.push_back(static_cast<char>(FRAME_CODEC_NONE));
+  frame.append(message);
+  return frame;
+}
+
+std::string MakeHeader(InnerClient::protocoled_size_t size) {
+  const InnerClient::protocoled_size_t header = common::HostToNet32(size);
+  return std::string(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// client reads from one end of socket pair, test writes to other
+class ClientPair {
+ public:
+  ClientPair() : client_fd_(-1), peer_fd_(-1), client_(nullptr) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0) {
+      client_fd_ = fds[0];
+      peer_fd_ = fds[1];
+    }
+    client_ = new InnerClient(nullptr, common::net::socket_info(client_fd_));
+  }
+
+  ~ClientPair() {
+    delete client_;
+    close(client_fd_);
+    ClosePeer();
+  }
+
+  InnerClient* client() const { return client_; }
+
+  void ClosePeer() {
+    if (peer_fd_ != -1) {
+      close(peer_fd_);
+      peer_fd_ = -1;
+    }
+  }
+
+  std::string ReceiveWritten() {  // written by client and not read yet
+    std::string data;
+    char buff[4096];
+    ssize_t nread;
+    while ((nread = recv(peer_fd_, buff, sizeof(buff), MSG_DONTWAIT)) > 0) {
+      data.append(buff, nread);
+    }
+    return data;
+  }
+
+  void Send(const std::string& data) {  // whole data read by one ReadCommands
+    ASSERT_EQ(write(peer_fd_, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+  }
+
+  std::vector<std::string> Receive(const std::string& data) {
+    Send(data);
+    std::vector<std::string> commands;
+    common::Error err = Read(&commands);
+    EXPECT_TRUE(!err);
+    return commands;
+  }
+
+  common::Error Read(std::vector<std::string>* commands) {  // decoded into pool, as by handlers
+    size_t count = 0;
+    common::Error err = client_->ReadCommands(&pool_, &count);
+    commands->assign(pool_.begin(), pool_.begin() + count);
+    return err;
+  }
+
+  const std::vector<std::string>& pool() const { return pool_; }
+
+ private:
+  int client_fd_;
+  int peer_fd_;
+  InnerClient* client_;
+  std::vector<std::string> pool_;
+};
+
+}  // namespace
+
+TEST(InnerClient, read_split_header) {
+  ClientPair pair;
+  const std::string frame = MakeRawFrame("ping");
+  ASSERT_TRUE(pair.Receive(frame.substr(0, 1)).empty());
+  ASSERT_TRUE(pair.Receive(frame.substr(1, 2)).empty());
+  const std::vector<std::string> commands = pair.Receive(frame.substr(3));
+  ASSERT_EQ(commands, std::vector<std::string>({"ping"}));
+}
+
+TEST(InnerClient, read_split_payload) {
+  ClientPair pair;
+  const std::string frame = MakeRawFrame("get_channels");
+  ASSERT_TRUE(pair.Receive(frame.substr(0, 4)).empty());  // header only
+  ASSERT_TRUE(pair.Receive(frame.substr(4, 5)).empty());
+  ASSERT_EQ(pair.Receive(frame.substr(9)), std::vector<std::string>({"get_channels"}));
+
+  const std::string message(3 * InnerClient::read_chunk_size + 7, 'x');  // bigger than one read chunk
+  const std::string big_frame = MakeRawFrame(message);
+  std::vector<std::string> commands;
+  for (size_t pos = 0; pos < big_frame.size(); pos += InnerClient::read_chunk_size / 2) {
+    ASSERT_TRUE(commands.empty());
+    commands = pair.Receive(big_frame.substr(pos, InnerClient::read_chunk_size / 2));
+  }
+  ASSERT_EQ(commands, std::vector<std::string>({message}));
+}
+
+TEST(InnerClient, read_several_frames_in_one_read) {
+  ClientPair pair;
+  fastotv::cmd_request_t request("00000001", "ping");
+  InnerClient::frame_t legacy_frame;
+  common::Error err = InnerClient::MakeFrame(FrameKind(), request.GetCmd(), &legacy_frame);
+  ASSERT_TRUE(!err);
+
+  const std::string first = MakeRawFrame("first");
+  const std::string second = MakeRawFrame("second");
+  std::vector<std::string> commands = pair.Receive(first + *legacy_frame + second + second.substr(0, 6));
+  ASSERT_EQ(commands, std::vector<std::string>({"first", request.GetCmd(), "second"}));
+
+  commands = pair.Receive(second.substr(6) + first);  // rest of partial frame and next frame
+  ASSERT_EQ(commands, std::vector<std::string>({"second", "first"}));
+}
+
+TEST(InnerClient, read_zero_size_frame) {
+  ClientPair pair;
+  pair.Send(MakeRawFrame("before") + MakeHeader(0));
+  std::vector<std::string> commands;
+  common::Error err = pair.Read(&commands);
+  ASSERT_TRUE(err);
+  ASSERT_EQ(commands, std::vector<std::string>({"before"}));  // decoded before invalid frame
+}
+
+TEST(InnerClient, read_too_large_frame) {
+  ClientPair pair;
+  pair.client()->SetMaxFrameSize(1024);
+  ASSERT_EQ(pair.Receive(MakeRawFrame(std::string(1023, 'x'))).size(), 1u);  // size with codec byte
+
+  pair.Send(MakeHeader(1025 | FRAME_CODEC_FLAG));  // rejected by header, payload not waited
+  std::vector<std::string> commands;
+  common::Error err = pair.Read(&commands);
+  ASSERT_TRUE(err);
+  ASSERT_TRUE(commands.empty());
+}
+
+TEST(InnerClient, read_connection_closed) {
+  ClientPair pair;
+  const std::string frame = MakeRawFrame("last");
+  pair.Send(frame + frame.substr(0, 5));
+  pair.ClosePeer();
+
+  std::vector<std::string> commands;
+  common::Error err = pair.Read(&commands);  // complete frame read
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(commands, std::vector<std::string>({"last"}));
+  commands.clear();
+  err = pair.Read(&commands);
+  ASSERT_TRUE(err);
+  ASSERT_TRUE(commands.empty());  // partial frame dropped
+}
+
+TEST(InnerClient, read_reuses_strings) {
+  ClientPair pair;
+  const std::string big(4096, 'x');
+  ASSERT_EQ(pair.Receive(MakeRawFrame(big) + MakeRawFrame(big)), std::vector<std::string>({big, big}));
+  const char* first = pair.pool()[0].data();
+
+  ASSERT_EQ(pair.Receive(MakeRawFrame("ping")), std::vector<std::string>({"ping"}));
+  ASSERT_EQ(pair.pool().size(), 2u);  // not shrunk
+  ASSERT_EQ(pair.pool()[0].data(), first);  // decoded into existing capacity
+  ASSERT_GE(pair.pool()[1].capacity(), big.size());
+}
+
+TEST(InnerClient, shared_frame_kinds) {
+  SharedFrame shared("chat message");
+  InnerClient::frame_t legacy_frame;
+  common::Error err = shared.GetFrame(FrameKind(), &legacy_frame);
+  ASSERT_TRUE(!err);
+  InnerClient::frame_t frame;
+  err = shared.GetFrame(FrameKind(), &frame);
+  ASSERT_TRUE(!err);
+  ASSERT_TRUE(frame == legacy_frame);  // made once
+
+  InnerClient::frame_t raw_frame;
+  err = shared.GetFrame(FrameKind(FRAME_CODEC_NONE), &raw_frame);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(*raw_frame, MakeRawFrame("chat message"));
+
+  ClientPair pair;
+  ASSERT_EQ(pair.Receive(*legacy_frame + *raw_frame), std::vector<std::string>({"chat message", "chat message"}));
+
+  pair.client()->SetFrameCodec(FRAME_CODEC_SNAPPY);
+  pair.client()->SetCompressionThreshold(shared.GetMessageSize() + 1);
+  ASSERT_EQ(pair.client()->GetFrameKind(shared.GetMessageSize()).GetIndex(), FrameKind(FRAME_CODEC_NONE).GetIndex());
+  pair.client()->SetCompressionThreshold(shared.GetMessageSize());
+  ASSERT_EQ(pair.client()->GetFrameKind(shared.GetMessageSize()).GetIndex(), FrameKind(FRAME_CODEC_SNAPPY).GetIndex());
+}
+
+TEST(InnerClient, write_batch) {
+  ClientPair pair;
+  pair.client()->SetFrameCodec(FRAME_CODEC_NONE);
+  pair.client()->SetCompressionThreshold(1024);
+  const fastotv::cmd_responce_t first("00000001", "first");
+  const fastotv::cmd_responce_t second("00000002", "second");
+
+  pair.client()->BeginWriteBatch();
+  common::Error err = pair.client()->Write(first);
+  ASSERT_TRUE(!err);
+  err = pair.client()->Write(second);
+  ASSERT_TRUE(!err);
+  ASSERT_TRUE(pair.ReceiveWritten().empty());  // queued until batch ended
+  ASSERT_EQ(pair.client()->GetPendingBytes(), 2 * 5 + first.GetCmd().size() + second.GetCmd().size());
+
+  err = pair.client()->EndWriteBatch();
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(pair.client()->GetPendingBytes(), 0u);
+  ASSERT_EQ(pair.ReceiveWritten(), MakeRawFrame(first.GetCmd()) + MakeRawFrame(second.GetCmd()));
+
+  err = pair.client()->Write(first);  // not batched, written directly
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(pair.ReceiveWritten(), MakeRawFrame(first.GetCmd()));
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "inner/sampled_log.h"
+
+using namespace fastotv::inner;
+
+namespace {
+
+class CollectSink : public ILogSink {
+ public:
+  virtual void Write(common::logging::LOG_LEVEL level, std::string&& message) override {
+    UNUSED(level);
+    messages.push_back(message);
+  }
+
+  std::vector<std::string> messages;
+};
+
+size_t formatted_count = 0;
+
+const char* Formatted() {
+  formatted_count++;
+  return "formatted";
+}
+
+}  // namespace
+
+TEST(sampled_log, sample_and_rate_limit) {
+  CollectSink sink;
+  SetLogSink(&sink);
+
+  LogCategoryPolicy policy;
+  policy.sample_rate = 4;
+  SetLogCategoryPolicy(LOG_CATEGORY_PINGS, policy);
+  const LogCategoryStats before = GetLogCategoryStats(LOG_CATEGORY_PINGS);
+  for (size_t i = 0; i < 100; ++i) {
+    SAMPLED_LOG(LOG_CATEGORY_PINGS) << Formatted();
+  }
+  ASSERT_EQ(sink.messages.size(), 25u);
+  ASSERT_EQ(formatted_count, 25u);  // not passed messages never formatted
+  ASSERT_EQ(sink.messages[0], "[pings] formatted");
+  const LogCategoryStats after = GetLogCategoryStats(LOG_CATEGORY_PINGS);
+  ASSERT_EQ(after.logged - before.logged, 25u);
+  ASSERT_EQ(after.sampled_out - before.sampled_out, 75u);
+
+  policy.sample_rate = 1;
+  policy.max_per_second = 10;
+  SetLogCategoryPolicy(LOG_CATEGORY_PINGS, policy);
+  sink.messages.clear();
+  for (size_t i = 0; i < 100; ++i) {
+    SAMPLED_LOG(LOG_CATEGORY_PINGS) << i;
+  }
+  ASSERT_LE(sink.messages.size(), 20u);  // one or two windows
+  ASSERT_GE(sink.messages.size(), 10u);
+
+  policy.sample_rate = 0;
+  SetLogCategoryPolicy(LOG_CATEGORY_PINGS, policy);
+  sink.messages.clear();
+  SAMPLED_LOG(LOG_CATEGORY_PINGS) << "disabled";
+  ASSERT_TRUE(sink.messages.empty());
+
+  SetLogCategoryPolicy(LOG_CATEGORY_PINGS, LogCategoryPolicy());
+  SetLogSink(nullptr);
+}
+
+TEST(sampled_log, payload_truncated) {
+  LogCategoryPolicy policy;
+  policy.max_payload_size = 4;
+  SetLogCategoryPolicy(LOG_CATEGORY_COMMANDS, policy);
+
+  std::ostringstream out;
+  out << LogPayload(LOG_CATEGORY_COMMANDS, "0123456789") << "|" << LogPayload(LOG_CATEGORY_COMMANDS, "abc");
+  ASSERT_EQ(out.str(), "0123...(10 bytes)|abc");
+
+  SetLogCategoryPolicy(LOG_CATEGORY_COMMANDS, LogCategoryPolicy());
+}
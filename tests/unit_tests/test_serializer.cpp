@@ -2,6 +2,7 @@
 
 #include "auth_info.h"
 #include "channel_info.h"
+#include "channels_delta.h"
 #include "channels_info.h"
 #include "client_info.h"
 #include "ping_info.h"
@@ -182,3 +183,124 @@ TEST(RuntimeChannelInfo, serialize_deserialize) {
 
   ASSERT_EQ(rinf_info, dser);
 }
+
+TEST(EpgInfo, binary_serialize_deserialize) {
+  const fastotv::stream_id stream_id = "123";
+  fastotv::EpgInfo epg_info(stream_id, common::uri::Url("http://localhost:8080/hls/play.m3u8"), "alex");
+  epg_info.SetIconUrl(common::uri::Url("http://localhost:8080/icon.png"));
+  fastotv::EpgInfo::programs_t programs = {fastotv::ProgrammeInfo(stream_id, -1000, 1510000000000, "news"),
+                                           fastotv::ProgrammeInfo(stream_id, 1510000000000, 1510003600000, "weather")};
+  epg_info.SetPrograms(programs);
+
+  std::string bin;
+  common::Error err = epg_info.SerializeToBinary(&bin);
+  ASSERT_TRUE(!err);
+  fastotv::EpgInfo depg;
+  err = fastotv::EpgInfo::DeSerializeFromBinary(bin, &depg);
+  ASSERT_TRUE(!err);
+
+  ASSERT_EQ(epg_info, depg);
+  ASSERT_EQ(epg_info.GetIconUrl(), depg.GetIconUrl());
+  ASSERT_EQ(depg.GetPrograms().size(), programs.size());
+  ASSERT_EQ(depg.GetPrograms()[0], programs[0]);
+  ASSERT_EQ(depg.GetPrograms()[1], programs[1]);
+
+  err = fastotv::EpgInfo::DeSerializeFromBinary(common::StringPiece(bin.data(), bin.size() - 1), &depg);  // truncated
+  ASSERT_TRUE(err);
+  err = fastotv::EpgInfo::DeSerializeFromBinary(std::string(), &depg);  // required fields missing
+  ASSERT_TRUE(err);
+
+  err = fastotv::EpgInfo::DeSerializeFromBinary(bin + std::string(3, '\x01'), &depg);  // fields of newer version
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(epg_info, depg);
+}
+
+TEST(channels_t, binary_serialize_deserialize) {
+  const common::uri::Url url("http://localhost:8080/hls/69_avformat_test_alex_2/play.m3u8");
+  fastotv::ChannelsInfo channels;
+  channels.AddChannel(fastotv::ChannelInfo(fastotv::EpgInfo("123", url, "alex"), true, false));
+  channels.AddChannel(fastotv::ChannelInfo(fastotv::EpgInfo("124", url, "sasha"), false, true));
+
+  std::string bin;
+  common::Error err = channels.SerializeToBinary(&bin);
+  ASSERT_TRUE(!err);
+  fastotv::ChannelsInfo dchannels;
+  err = fastotv::ChannelsInfo::DeSerializeFromBinary(bin, &dchannels);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(channels, dchannels);
+
+  fastotv::ChannelsInfo with_invalid = channels;
+  with_invalid.AddChannel(fastotv::ChannelInfo());  // skipped as in json
+  err = with_invalid.SerializeToBinary(&bin);
+  ASSERT_TRUE(!err);
+  err = fastotv::ChannelsInfo::DeSerializeFromBinary(bin, &dchannels);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(channels, dchannels);
+
+  std::string json;
+  err = channels.SerializeToString(&json);
+  ASSERT_TRUE(!err);
+  ASSERT_LT(bin.size(), json.size());
+}
+
+TEST(RuntimeChannelInfo, binary_serialize_deserialize) {
+  const std::vector<fastotv::ChatMessage> msgs = {
+      fastotv::ChatMessage("1234", "alex", "test", fastotv::ChatMessage::MESSAGE),
+      fastotv::ChatMessage("1234", "sasha", "hi", fastotv::ChatMessage::CONTROL)};
+  fastotv::RuntimeChannelInfo rinf_info("1234", 7, fastotv::PRIVATE_CHANNEL, true, false, msgs);
+
+  std::string bin;
+  common::Error err = rinf_info.SerializeToBinary(&bin);
+  ASSERT_TRUE(!err);
+  fastotv::RuntimeChannelInfo dser;
+  err = fastotv::RuntimeChannelInfo::DeSerializeFromBinary(bin, &dser);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(rinf_info, dser);
+  ASSERT_EQ(dser.GetMessages().size(), msgs.size());
+  ASSERT_EQ(dser.GetMessages()[1], msgs[1]);
+
+  err = fastotv::RuntimeChannelInfo::DeSerializeFromBinary(std::string(), &dser);  // channel id required
+  ASSERT_TRUE(err);
+}
+
+// streaming SerializeToString same as json objects tree
+template <typename T>
+void ExpectSameAsJsonTree(const T& obj) {
+  serialize_t ser = NULL;
+  common::Error err = obj.Serialize(&ser);
+  ASSERT_TRUE(!err);
+  const std::string tree = json_object_get_string(ser);
+  json_object_put(ser);
+
+  std::string stream = "reused buffer";
+  err = obj.SerializeToString(&stream);
+  ASSERT_TRUE(!err);
+  ASSERT_EQ(stream, tree);
+}
+
+TEST(JsonStringFieldsWriter, same_as_json_tree) {
+  const char raw[] = "q\"b\\s/t\tn\nr\rf\fb\bc\x01\x1f\x7f \xd0\xbf";
+  const std::string escaped = std::string(raw, sizeof(raw));  // with '\0'
+  const common::uri::Url url("http://localhost:8080/hls/69_avformat_test_alex_2/play.m3u8");
+  fastotv::EpgInfo epg_info("123", url, escaped);
+  epg_info.SetPrograms({fastotv::ProgrammeInfo("123", -1, INT64_MAX, escaped),
+                        fastotv::ProgrammeInfo("123", 0, 1, "")});  // invalid skipped
+  fastotv::ChannelsInfo channels;
+  channels.AddChannel(fastotv::ChannelInfo(epg_info, true, false));
+  channels.AddChannel(fastotv::ChannelInfo());  // invalid skipped
+  channels.AddChannel(fastotv::ChannelInfo(fastotv::EpgInfo("124", url, "sasha"), false, true));
+  ExpectSameAsJsonTree(channels);
+  ExpectSameAsJsonTree(fastotv::ChannelsInfo());
+
+  const std::vector<fastotv::ChatMessage> msgs = {
+      fastotv::ChatMessage("1234", "alex", escaped, fastotv::ChatMessage::MESSAGE)};
+  ExpectSameAsJsonTree(msgs[0]);
+  ExpectSameAsJsonTree(fastotv::RuntimeChannelInfo("1234", 7, fastotv::OFFICAL_CHANNEL, true, false, msgs));
+  fastotv::ChannelsInfo updated;
+  updated.AddChannel(fastotv::ChannelInfo(epg_info, true, true));
+  ExpectSameAsJsonTree(fastotv::ChannelsDelta(channels, updated));
+
+  std::string out;
+  common::Error err = fastotv::ChannelInfo().SerializeToString(&out);
+  ASSERT_TRUE(err);
+}